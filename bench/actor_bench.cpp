@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include "actor_system.hpp"
+
+namespace {
+void fillActors(ActorSystem& actors, int count) {
+    ActorDesc desc;
+    for (int i = 0; i < count; ++i) {
+        desc.position = {static_cast<float>((i * 37) % 4000), static_cast<float>((i * 91) % 3000)};
+        desc.velocity = {static_cast<float>(i % 7) - 3.f, static_cast<float>(i % 5) - 2.f};
+        actors.spawn(desc);
+    }
+}
+
+// Integração, animação e reconstrução do índice espacial, sem mapa
+void BM_ActorUpdate(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    ActorSystem actors;
+    fillActors(actors, count);
+    for (auto _ : state) {
+        actors.update(1.f / 60.f);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ActorUpdate)->ArgName("actors")->Arg(1000)->Arg(10000);
+
+void BM_ActorVertices(benchmark::State& state) {
+    const auto count = static_cast<int>(state.range(0));
+    ActorSystem actors;
+    fillActors(actors, count);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(actors.buildBatches(0.5f).data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ActorVertices)->ArgName("actors")->Arg(1000)->Arg(10000);
+} // namespace
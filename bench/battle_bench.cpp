@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+#include "battle.hpp"
+
+namespace {
+const Database& benchDatabase() {
+    static Database db = [] {
+        QuietLogs quiet;
+        Database loaded;
+        loaded.load("game/data", benchDirectory() / "battle_database.ldb");
+        return loaded;
+    }();
+    return db;
+}
+
+// Grupo nível 5 contra os três inimigos do projeto
+BattleSetup benchSetup() {
+    BattleSetup setup;
+    setup.party = {{1, 5}, {1, 5}, {1, 5}, {1, 5}};
+    setup.troop = {1, 2, 3};
+    return setup;
+}
+
+void BM_BattleRun(benchmark::State& state) {
+    const BattleRules rules(benchDatabase());
+    const BattleSetup setup = benchSetup();
+    BattleReport report;
+    Battle battle(rules);
+    battle.setReport(&report);
+    std::uint32_t seed = 0;
+    for (auto _ : state) {
+        battle.reset(setup, ++seed);
+        benchmark::DoNotOptimize(battle.run());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BattleRun);
+
+// Lote de 10000 batalhas; argumento = threads
+void BM_BattleSimulate(benchmark::State& state) {
+    const BattleRules rules(benchDatabase());
+    const BattleSetup setup = benchSetup();
+    SimulationOptions options;
+    options.battles = 10000;
+    options.threads = static_cast<unsigned>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simulateBattles(rules, setup, options));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(options.battles));
+}
+BENCHMARK(BM_BattleSimulate)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace
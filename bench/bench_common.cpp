@@ -0,0 +1,106 @@
+#include "bench_common.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+namespace {
+constexpr unsigned TileSize = 32;
+constexpr unsigned TilesetColumns = 8;
+constexpr unsigned TilesPerTileset = TilesetColumns * TilesetColumns;
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuffer nullBuffer;
+
+std::filesystem::path tilesetImage(unsigned index) {
+    const auto path = benchDirectory() / ("tileset_" + std::to_string(index) + ".png");
+    if (!std::filesystem::exists(path)) {
+        const auto shade = static_cast<std::uint8_t>(40 + index * 50);
+        sf::Image image({TileSize * TilesetColumns, TileSize * TilesetColumns}, sf::Color(shade, 120, 200));
+        if (!image.saveToFile(path)) {
+            std::cerr << "[lumy-bench] Falha ao gravar " << path << "\n";
+        }
+    }
+    return path;
+}
+} // namespace
+
+const std::filesystem::path& benchDirectory() {
+    static const std::filesystem::path dir = [] {
+        auto path = std::filesystem::temp_directory_path() / "lumy_bench";
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        return path;
+    }();
+    return dir;
+}
+
+std::filesystem::path generatedMapPath(unsigned size, unsigned layers, unsigned tilesets) {
+    const auto path = benchDirectory() / ("map_" + std::to_string(size) + "_" + std::to_string(layers) + "_" +
+                                          std::to_string(tilesets) + ".tmx");
+    if (std::filesystem::exists(path)) {
+        return path;
+    }
+
+    std::ofstream out(path);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<map version=\"1.10\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"" << size
+        << "\" height=\"" << size << "\" tilewidth=\"" << TileSize << "\" tileheight=\"" << TileSize
+        << "\" infinite=\"0\" nextlayerid=\"" << layers + 1 << "\" nextobjectid=\"1\">\n";
+
+    for (unsigned t = 0; t < tilesets; ++t) {
+        out << " <tileset firstgid=\"" << 1 + t * TilesPerTileset << "\" name=\"bench_" << t << "\" tilewidth=\""
+            << TileSize << "\" tileheight=\"" << TileSize << "\" tilecount=\"" << TilesPerTileset
+            << "\" columns=\"" << TilesetColumns << "\">\n"
+            << "  <image source=\"" << tilesetImage(t).filename().string() << "\" width=\""
+            << TileSize * TilesetColumns << "\" height=\"" << TileSize * TilesetColumns << "\"/>\n"
+            << "  <tile id=\"0\"><properties><property name=\"collidable\" type=\"bool\" value=\"true\"/>"
+            << "</properties></tile>\n"
+            << " </tileset>\n";
+    }
+
+    // LCG determinístico: o mesmo mapa em todas as execuções
+    std::uint32_t seed = size * 2654435761u + layers * 40503u + tilesets;
+    const auto next = [&seed] {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    std::string row;
+    for (unsigned l = 0; l < layers; ++l) {
+        out << " <layer id=\"" << l + 1 << "\" name=\"" << (l == 0 ? "ground_0" : "object_" + std::to_string(l))
+            << "\" width=\"" << size << "\" height=\"" << size << "\">\n  <data encoding=\"csv\">\n";
+        for (unsigned y = 0; y < size; ++y) {
+            row.clear();
+            for (unsigned x = 0; x < size; ++x) {
+                const std::uint32_t r = next();
+                // Camadas superiores são esparsas (~25% preenchidas), como decoração
+                std::uint32_t gid = 0;
+                if (l == 0 || r % 4 == 0) {
+                    gid = 1 + (r / 4 % tilesets) * TilesPerTileset + (r / 16 % TilesPerTileset);
+                }
+                row += std::to_string(gid);
+                if (x + 1 < size || y + 1 < size) {
+                    row += ',';
+                }
+            }
+            out << row << '\n';
+        }
+        out << "  </data>\n </layer>\n";
+    }
+    out << "</map>\n";
+    return path;
+}
+
+QuietLogs::QuietLogs() : previous_(std::cout.rdbuf(&nullBuffer)) {}
+
+QuietLogs::~QuietLogs() {
+    std::cout.rdbuf(previous_);
+}
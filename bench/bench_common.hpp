@@ -0,0 +1,26 @@
+#pragma once
+
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+
+// Generates (once per process) a TMX map of size x size tiles with the given
+// number of tile layers and tilesets. Tilesets are 8x8 grids of 32 px tiles;
+// tile 0 of each tileset is marked collidable. Returns the .tmx path.
+std::filesystem::path generatedMapPath(unsigned size, unsigned layers, unsigned tilesets);
+
+// Scratch directory for bench files (removed and recreated on first use).
+const std::filesystem::path& benchDirectory();
+
+// Silences std::cout while alive: the runtime logs every load/save, which
+// would otherwise dominate the measurements.
+class QuietLogs {
+public:
+    QuietLogs();
+    ~QuietLogs();
+    QuietLogs(const QuietLogs&) = delete;
+    QuietLogs& operator=(const QuietLogs&) = delete;
+
+private:
+    std::streambuf* previous_;
+};
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+#include "database.hpp"
+
+namespace {
+// Dados do projeto (game/data); o cache fica no diretório do bench
+const std::filesystem::path DataDirectory = "game/data";
+
+void BM_DatabaseLoadJson(benchmark::State& state) {
+    const std::filesystem::path cache = benchDirectory() / "database_json.ldb";
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove(cache); // Força o parse do JSON
+        state.ResumeTiming();
+        Database db;
+        benchmark::DoNotOptimize(db.load(DataDirectory, cache));
+    }
+}
+BENCHMARK(BM_DatabaseLoadJson)->Unit(benchmark::kMicrosecond);
+
+void BM_DatabaseLoadCache(benchmark::State& state) {
+    const std::filesystem::path cache = benchDirectory() / "database_cache.ldb";
+    Database warm;
+    warm.load(DataDirectory, cache);
+    for (auto _ : state) {
+        Database db;
+        benchmark::DoNotOptimize(db.load(DataDirectory, cache));
+    }
+}
+BENCHMARK(BM_DatabaseLoadCache)->Unit(benchmark::kMicrosecond);
+} // namespace
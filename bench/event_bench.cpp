@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+#include "event_system.hpp"
+#include "scene_stack.hpp"
+#include "texture_manager.hpp"
+
+namespace {
+// Evento só com comandos síncronos (switch, variável, condicional), que
+// executam inteiros dentro de triggerEvent
+GameEvent makeCommandEvent(int commandCount) {
+    GameEvent event(1, "bench", 0, 0);
+    EventPage page;
+    for (int i = 0; i < commandCount; ++i) {
+        switch (i % 4) {
+        case 0:
+            page.commands.emplace_back(EventCommandType::SetSwitch, EventCommandParams{{}, {i % 100, i % 2}, {}, {}});
+            break;
+        case 1:
+            page.commands.emplace_back(EventCommandType::SetVariable, EventCommandParams{{}, {i % 100, i}, {}, {}});
+            break;
+        case 2:
+            page.commands.emplace_back(EventCommandType::ConditionalBranch, EventCommandParams{{}, {0, i % 100, 1}, {}, {}});
+            break;
+        default:
+            page.commands.emplace_back(EventCommandType::EndConditional);
+            break;
+        }
+    }
+    event.pages.push_back(std::move(page));
+    return event;
+}
+
+void BM_EventCommandThroughput(benchmark::State& state) {
+    const auto commandCount = static_cast<int>(state.range(0));
+    SceneStack stack;
+    TextureManager textures;
+
+    QuietLogs quiet;
+    EventSystem events(&stack, &textures);
+    events.addEvent(makeCommandEvent(commandCount));
+    for (auto _ : state) {
+        events.triggerEvent(1);
+        benchmark::DoNotOptimize(events.isEventRunning());
+    }
+    state.SetItemsProcessed(state.iterations() * commandCount);
+}
+BENCHMARK(BM_EventCommandThroughput)->ArgName("commands")->Arg(16)->Arg(128)->Arg(1024);
+} // namespace
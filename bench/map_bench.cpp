@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <SFML/Graphics/RenderTexture.hpp>
+
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "bench_common.hpp"
+#include "map.hpp"
+#include "texture_manager.hpp"
+
+namespace {
+TextureManager& benchTextures() {
+    static TextureManager textures;
+    return textures;
+}
+
+// Mapas carregados uma vez por combinação (draw/isCollidable não medem o load);
+// ninguém escreve neles
+Map& loadedMap(unsigned size, unsigned layers, unsigned tilesets) {
+    static std::map<std::tuple<unsigned, unsigned, unsigned>, std::unique_ptr<Map>> cache;
+    auto& slot = cache[{size, layers, tilesets}];
+    if (!slot) {
+        QuietLogs quiet;
+        slot = std::make_unique<Map>(benchTextures());
+        slot->load(generatedMapPath(size, layers, tilesets).string());
+    }
+    return *slot;
+}
+
+// Alvo headless: 640x360 como a janela do hello-town
+sf::RenderTexture& renderTarget() {
+    static sf::RenderTexture target(sf::Vector2u{640, 360});
+    return target;
+}
+
+void mapArguments(benchmark::internal::Benchmark* bench) {
+    for (int size : {64, 256, 1024, 2048}) {
+        for (int layers : {1, 4, 8}) {
+            for (int tilesets : {1, 4}) {
+                bench->Args({size, layers, tilesets});
+            }
+        }
+    }
+    bench->ArgNames({"size", "layers", "tilesets"});
+}
+
+void BM_MapLoad(benchmark::State& state) {
+    const auto size = static_cast<unsigned>(state.range(0));
+    const auto layers = static_cast<unsigned>(state.range(1));
+    const auto tilesets = static_cast<unsigned>(state.range(2));
+    const std::string path = generatedMapPath(size, layers, tilesets).string();
+
+    QuietLogs quiet;
+    loadedMap(size, layers, tilesets); // Gera o arquivo e aquece o cache de texturas
+    for (auto _ : state) {
+        Map map(benchTextures());
+        benchmark::DoNotOptimize(map.load(path));
+    }
+    state.SetItemsProcessed(state.iterations() * size * size * layers);
+}
+BENCHMARK(BM_MapLoad)->Apply(mapArguments)->Unit(benchmark::kMillisecond);
+
+void BM_MapDrawRange(benchmark::State& state) {
+    Map& map = loadedMap(static_cast<unsigned>(state.range(0)), static_cast<unsigned>(state.range(1)),
+                         static_cast<unsigned>(state.range(2)));
+    sf::RenderTexture& target = renderTarget();
+    for (auto _ : state) {
+        target.clear();
+        map.drawRange(0, map.getLayerCount(), target);
+        target.display();
+    }
+}
+BENCHMARK(BM_MapDrawRange)->Apply(mapArguments)->Unit(benchmark::kMicrosecond);
+
+void BM_MapSetTileIdBurst(benchmark::State& state) {
+    const auto size = static_cast<unsigned>(state.range(0));
+    // Cópia própria: as escritas não podem vazar para o mapa do cache, que
+    // outros benchmarks medem depois (o resultado dependeria da ordem e do filtro)
+    loadedMap(size, 1, 1); // Gera o arquivo e aquece o cache de texturas
+    Map map(benchTextures());
+    {
+        QuietLogs quiet;
+        map.load(generatedMapPath(size, 1, 1).string());
+    }
+    constexpr int Burst = 1024;
+    std::uint32_t seed = 12345;
+    for (auto _ : state) {
+        for (int i = 0; i < Burst; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            map.setTileID(0, (seed >> 8) % size, (seed >> 20) % size, 1 + (seed >> 4) % 64);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * Burst);
+}
+BENCHMARK(BM_MapSetTileIdBurst)->ArgName("size")->Arg(64)->Arg(256)->Arg(1024)->Arg(2048);
+
+void BM_MapIsCollidableSweep(benchmark::State& state) {
+    const auto size = static_cast<unsigned>(state.range(0));
+    Map& map = loadedMap(size, 1, 1);
+    for (auto _ : state) {
+        std::size_t blocked = 0;
+        for (unsigned y = 0; y < size; ++y) {
+            for (unsigned x = 0; x < size; ++x) {
+                blocked += map.isCollidable(x, y) ? 1 : 0;
+            }
+        }
+        benchmark::DoNotOptimize(blocked);
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_MapIsCollidableSweep)->ArgName("size")->Arg(64)->Arg(256)->Arg(1024)->Arg(2048);
+} // namespace
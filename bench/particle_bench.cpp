@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+
+#include "particle_system.hpp"
+
+#include <algorithm>
+
+namespace {
+// Emissores de faíscas com o pool cheio; argumento = partículas no total
+void fillParticles(ParticleSystem& particles, std::size_t count) {
+    constexpr std::size_t PerEmitter = 4096;
+    for (std::size_t left = count; left > 0;) {
+        EmitterDesc desc = EmitterDesc::sparks(sf::Color::Yellow);
+        desc.capacity = std::min(left, PerEmitter);
+        desc.lifetimeMin = 1000.f; // Ninguém morre durante a medição
+        desc.lifetimeMax = 1000.f;
+        particles.burst(particles.addEmitter(desc), desc.capacity);
+        left -= desc.capacity;
+    }
+}
+
+void BM_ParticleUpdate(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    ParticleSystem particles;
+    fillParticles(particles, count);
+    for (auto _ : state) {
+        particles.update(1.f / 60.f);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleUpdate)->ArgName("particles")->Arg(10000)->Arg(100000);
+
+void BM_ParticleVertices(benchmark::State& state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    ParticleSystem particles;
+    fillParticles(particles, count);
+    particles.update(1.f / 60.f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(particles.buildBatches(0.5f).data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParticleVertices)->ArgName("particles")->Arg(10000)->Arg(100000);
+} // namespace
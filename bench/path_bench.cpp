@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+
+#include "bench_common.hpp"
+#include "map.hpp"
+#include "pathfinding.hpp"
+#include "texture_manager.hpp"
+
+namespace {
+// Mapa gerado com ~1/64 dos tiles colidíveis, carregado uma vez por tamanho
+struct PathWorld {
+    TextureManager textures;
+    Map map{textures};
+    std::unique_ptr<Pathfinder> pathfinder;
+};
+
+PathWorld& world(unsigned size) {
+    static std::map<unsigned, std::unique_ptr<PathWorld>> cache;
+    auto& slot = cache[size];
+    if (!slot) {
+        QuietLogs quiet;
+        slot = std::make_unique<PathWorld>();
+        slot->map.load(generatedMapPath(size, 1, 1).string());
+        slot->pathfinder = std::make_unique<Pathfinder>(slot->map);
+    }
+    return *slot;
+}
+
+// Canto a canto: o pior caso para uma busca isolada
+GridPos freeNear(const Pathfinder& pathfinder, int x, int y) {
+    while (!pathfinder.walkable({x, y}) && x > 0) {
+        --x;
+    }
+    return {x, y};
+}
+
+void BM_PathJps(benchmark::State& state) {
+    const auto size = static_cast<int>(state.range(0));
+    Pathfinder& pathfinder = *world(static_cast<unsigned>(size)).pathfinder;
+    const GridPos start = freeNear(pathfinder, 1, 1);
+    const GridPos goal = freeNear(pathfinder, size - 2, size - 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pathfinder.findPathJps(start, goal).size());
+    }
+}
+BENCHMARK(BM_PathJps)->ArgName("size")->Arg(64)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+void BM_PathHierarchical(benchmark::State& state) {
+    const auto size = static_cast<int>(state.range(0));
+    Pathfinder& pathfinder = *world(static_cast<unsigned>(size)).pathfinder;
+    const GridPos start = freeNear(pathfinder, 1, 1);
+    const GridPos goal = freeNear(pathfinder, size - 2, size - 2);
+    pathfinder.findPathHierarchical(start, goal); // Constrói os clusters fora da medição
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pathfinder.findPathHierarchical(start, goal).size());
+    }
+}
+BENCHMARK(BM_PathHierarchical)->ArgName("size")->Arg(256)->Arg(1024)->Arg(2048)->Unit(benchmark::kMicrosecond);
+
+void BM_PathFlowField(benchmark::State& state) {
+    const auto size = static_cast<int>(state.range(0));
+    PathWorld& w = world(static_cast<unsigned>(size));
+    const GridPos goal = freeNear(*w.pathfinder, size / 2, size / 2);
+    for (auto _ : state) {
+        // Pathfinder novo a cada iteração para não medir o cache
+        state.PauseTiming();
+        Pathfinder pathfinder(w.map);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(pathfinder.flowField(goal).get());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_PathFlowField)->ArgName("size")->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+} // namespace
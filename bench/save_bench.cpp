@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include "bench_common.hpp"
+#include "save_system.hpp"
+
+namespace {
+// Estado típico de fim de jogo: `entries` switches ON e variáveis não nulas
+void fillState(SaveSystem& saves, int entries) {
+    for (int id = 1; id <= entries; ++id) {
+        saves.setSwitch(id * 3, true);
+        saves.setVariable(id * 2, id * 7 - 500);
+    }
+    std::vector<int> inventory(static_cast<std::size_t>(entries / 4), 12);
+    saves.setInventory(inventory);
+    saves.setParty({1, 2, 3, 4});
+    saves.setMapName("bench");
+}
+
+void BM_SaveRoundTrip(benchmark::State& state) {
+    QuietLogs quiet;
+    SaveSystem saves;
+    saves.initialize((benchDirectory() / "save_roundtrip").string());
+    fillState(saves, static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(saves.saveGame(1));
+        benchmark::DoNotOptimize(saves.loadGame(1));
+    }
+}
+BENCHMARK(BM_SaveRoundTrip)->ArgName("entries")->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+void BM_SaveAutosaveJournal(benchmark::State& state) {
+    QuietLogs quiet;
+    SaveSystem saves;
+    saves.initialize((benchDirectory() / "save_journal").string());
+    fillState(saves, 1000);
+    saves.saveGame(SaveSystem::AutosaveSlot);
+
+    int tick = 0;
+    for (auto _ : state) {
+        // Poucas mudanças entre autosaves, como no jogo real
+        saves.setVariable(1, ++tick);
+        saves.setPlayerPosition(1, static_cast<float>(tick % 640), 64.f, 2);
+        benchmark::DoNotOptimize(saves.autosave());
+    }
+}
+BENCHMARK(BM_SaveAutosaveJournal)->Unit(benchmark::kMicrosecond);
+} // namespace
@@ -0,0 +1,75 @@
+"""Compare two lumy-bench runs.
+
+Both inputs are Google Benchmark JSON files, e.g.::
+
+    lumy-bench --benchmark_out=base.json --benchmark_out_format=json
+    python scripts/compare_bench.py base.json new.json --threshold 10
+
+Benchmarks are matched by name. The script prints the relative change of
+the selected time metric and exits with status 1 when any benchmark got
+slower than ``--threshold`` percent, so it can gate CI.
+"""
+from __future__ import annotations
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+
+def load_results(path: Path, metric: str) -> dict[str, float]:
+    """Return ``{benchmark name: time}`` for a Google Benchmark JSON file.
+
+    Aggregates (``_mean``, ``_median``...) from ``--benchmark_repetitions``
+    are skipped except for the mean, which replaces the raw repetitions.
+    """
+    data = json.loads(path.read_text(encoding="utf-8"))
+    results: dict[str, float] = {}
+    means: dict[str, float] = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("error_occurred"):
+            continue
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "mean":
+                means[bench["run_name"]] = float(bench[metric])
+            continue
+        results[bench["name"]] = float(bench[metric])
+    results.update(means)
+    return results
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline", type=Path)
+    parser.add_argument("contender", type=Path)
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="cpu_time")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="max allowed slowdown in percent (default: 10)")
+    args = parser.parse_args()
+
+    base = load_results(args.baseline, args.metric)
+    new = load_results(args.contender, args.metric)
+
+    regressions = []
+    width = max((len(name) for name in base.keys() | new.keys()), default=10)
+    print(f"{'benchmark':<{width}}  {'base':>12}  {'new':>12}  {'change':>8}")
+    for name in sorted(base.keys() | new.keys()):
+        if name not in base or name not in new:
+            status = "added" if name in new else "removed"
+            print(f"{name:<{width}}  {status:>36}")
+            continue
+        change = (new[name] - base[name]) / base[name] * 100.0 if base[name] else 0.0
+        marker = ""
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  <-- regression"
+        print(f"{name:<{width}}  {base[name]:>12.3f}  {new[name]:>12.3f}  {change:>+7.1f}%{marker}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than {args.threshold:.1f}%", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
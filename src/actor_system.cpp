@@ -0,0 +1,366 @@
+#include "actor_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "map.hpp"
+#include "profiler.hpp"
+#include "render_commands.hpp"
+#include "sprite_batch.hpp"
+
+ActorHandle ActorSystem::spawn(const ActorDesc& desc) {
+    std::uint32_t slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(denseOf_.size());
+        denseOf_.push_back(0);
+        generation_.push_back(0);
+    }
+    denseOf_[slot] = static_cast<std::uint32_t>(x_.size());
+
+    x_.push_back(desc.position.x);
+    y_.push_back(desc.position.y);
+    prevX_.push_back(desc.position.x);
+    prevY_.push_back(desc.position.y);
+    vx_.push_back(desc.velocity.x);
+    vy_.push_back(desc.velocity.y);
+    halfW_.push_back(desc.boxSize.x * 0.5f);
+    halfH_.push_back(desc.boxSize.y * 0.5f);
+    animTime_.push_back(0.f);
+    sheet_.push_back(sheetIndex(desc.sheet));
+    clip_.push_back(desc.sheet ? desc.sheet->idleClip() : SpriteSheet::NoClip);
+    frame_.push_back(clip_.back() != SpriteSheet::NoClip ? desc.sheet->column(desc.sheet->clip(clip_.back()), 0.f) : 0);
+    facing_.push_back(desc.facing);
+    color_.push_back(desc.color);
+    slotOf_.push_back(slot);
+    gridStale_ = true;
+    return ActorHandle{slot, generation_[slot]};
+}
+
+bool ActorSystem::destroy(ActorHandle handle) {
+    const std::uint32_t index = indexOf(handle);
+    if (index == ActorHandle::InvalidSlot) {
+        return false;
+    }
+    // Swap the last actor into the hole so the arrays stay dense
+    const std::size_t last = x_.size() - 1;
+    const auto moveLast = [index, last](auto& values) {
+        values[index] = values[last];
+        values.pop_back();
+    };
+    moveLast(x_);
+    moveLast(y_);
+    moveLast(prevX_);
+    moveLast(prevY_);
+    moveLast(vx_);
+    moveLast(vy_);
+    moveLast(halfW_);
+    moveLast(halfH_);
+    moveLast(animTime_);
+    moveLast(sheet_);
+    moveLast(clip_);
+    moveLast(frame_);
+    moveLast(facing_);
+    moveLast(color_);
+    moveLast(slotOf_);
+    if (index < x_.size()) {
+        denseOf_[slotOf_[index]] = index;
+    }
+
+    generation_[handle.slot]++;
+    freeSlots_.push_back(handle.slot);
+    gridStale_ = true;
+    return true;
+}
+
+bool ActorSystem::alive(ActorHandle handle) const {
+    return indexOf(handle) != ActorHandle::InvalidSlot;
+}
+
+void ActorSystem::clear() {
+    for (std::size_t i = 0; i < x_.size(); ++i) {
+        generation_[slotOf_[i]]++;
+        freeSlots_.push_back(slotOf_[i]);
+    }
+    for (auto* values : {&x_, &y_, &prevX_, &prevY_, &vx_, &vy_, &halfW_, &halfH_, &animTime_}) {
+        values->clear();
+    }
+    for (auto* values : {&sheet_, &clip_, &frame_}) {
+        values->clear();
+    }
+    facing_.clear();
+    color_.clear();
+    slotOf_.clear();
+    grid_.clear();
+    gridStale_ = false;
+}
+
+ActorHandle ActorSystem::handleAt(std::size_t index) const {
+    const std::uint32_t slot = slotOf_[index];
+    return ActorHandle{slot, generation_[slot]};
+}
+
+std::uint32_t ActorSystem::indexOf(ActorHandle handle) const {
+    if (handle.slot >= denseOf_.size() || generation_[handle.slot] != handle.generation) {
+        return ActorHandle::InvalidSlot;
+    }
+    const std::uint32_t index = denseOf_[handle.slot];
+    return index < slotOf_.size() && slotOf_[index] == handle.slot ? index : ActorHandle::InvalidSlot;
+}
+
+sf::Vector2f ActorSystem::position(ActorHandle handle) const {
+    const std::uint32_t i = indexOf(handle);
+    return i == ActorHandle::InvalidSlot ? sf::Vector2f{} : sf::Vector2f{x_[i], y_[i]};
+}
+
+void ActorSystem::setPosition(ActorHandle handle, sf::Vector2f position) {
+    const std::uint32_t i = indexOf(handle);
+    if (i != ActorHandle::InvalidSlot) {
+        x_[i] = prevX_[i] = position.x;
+        y_[i] = prevY_[i] = position.y;
+        gridStale_ = true;
+    }
+}
+
+sf::Vector2f ActorSystem::velocity(ActorHandle handle) const {
+    const std::uint32_t i = indexOf(handle);
+    return i == ActorHandle::InvalidSlot ? sf::Vector2f{} : sf::Vector2f{vx_[i], vy_[i]};
+}
+
+void ActorSystem::setVelocity(ActorHandle handle, sf::Vector2f velocity) {
+    const std::uint32_t i = indexOf(handle);
+    if (i != ActorHandle::InvalidSlot) {
+        vx_[i] = velocity.x;
+        vy_[i] = velocity.y;
+    }
+}
+
+Facing ActorSystem::facing(ActorHandle handle) const {
+    const std::uint32_t i = indexOf(handle);
+    return i == ActorHandle::InvalidSlot ? Facing::Down : facing_[i];
+}
+
+std::uint16_t ActorSystem::frame(ActorHandle handle) const {
+    const std::uint32_t i = indexOf(handle);
+    return i == ActorHandle::InvalidSlot ? 0 : frame_[i];
+}
+
+std::uint16_t ActorSystem::clip(ActorHandle handle) const {
+    const std::uint32_t i = indexOf(handle);
+    return i == ActorHandle::InvalidSlot ? SpriteSheet::NoClip : clip_[i];
+}
+
+void ActorSystem::play(ActorHandle handle, std::uint16_t clip) {
+    const std::uint32_t i = indexOf(handle);
+    const SpriteSheet* sheet = i == ActorHandle::InvalidSlot ? nullptr : sheets_[sheet_[i]];
+    if (!sheet || clip >= sheet->clipCount()) {
+        return;
+    }
+    clip_[i] = clip;
+    animTime_[i] = 0.f;
+    frame_[i] = sheet->column(sheet->clip(clip), 0.f);
+}
+
+std::uint16_t ActorSystem::sheetIndex(const SpriteSheet* sheet) {
+    const auto it = std::find(sheets_.begin(), sheets_.end(), sheet);
+    if (it != sheets_.end()) {
+        return static_cast<std::uint16_t>(it - sheets_.begin());
+    }
+    sheets_.push_back(sheet);
+    return static_cast<std::uint16_t>(sheets_.size() - 1);
+}
+
+bool ActorSystem::blocked(const Map& map, float x, float y, float halfW, float halfH) const {
+    const float left = x - halfW;
+    const float top = y - halfH;
+    if (left < 0.f || top < 0.f) {
+        return true; // Outside the map
+    }
+    const auto& tile = map.getTileSize();
+    const unsigned firstX = static_cast<unsigned>(left / static_cast<float>(tile.x));
+    const unsigned firstY = static_cast<unsigned>(top / static_cast<float>(tile.y));
+    // The box edge itself belongs to the next tile only when it crosses into it
+    const unsigned lastX = static_cast<unsigned>(std::nextafter(x + halfW, left) / static_cast<float>(tile.x));
+    const unsigned lastY = static_cast<unsigned>(std::nextafter(y + halfH, top) / static_cast<float>(tile.y));
+    for (unsigned ty = firstY; ty <= lastY; ++ty) {
+        for (unsigned tx = firstX; tx <= lastX; ++tx) {
+            if (map.isCollidable(tx, ty)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ActorSystem::update(float deltaTime, const Map* map) {
+    LUMY_PROFILE_SCOPE("ActorSystem::update");
+    const std::size_t n = x_.size();
+    float* __restrict x = x_.data();
+    float* __restrict y = y_.data();
+    const float* __restrict vx = vx_.data();
+    const float* __restrict vy = vy_.data();
+
+    std::copy(x_.begin(), x_.end(), prevX_.begin());
+    std::copy(y_.begin(), y_.end(), prevY_.begin());
+
+    // Integration: straight float loops the compiler can vectorize
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] += vx[i] * deltaTime;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        y[i] += vy[i] * deltaTime;
+    }
+
+    // Collision per axis: X at the old Y first, then Y, so actors slide along walls
+    if (map) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (vx[i] == 0.f && vy[i] == 0.f) {
+                continue;
+            }
+            if (x[i] != prevX_[i] && blocked(*map, x[i], prevY_[i], halfW_[i], halfH_[i])) {
+                x[i] = prevX_[i];
+            }
+            if (y[i] != prevY_[i] && blocked(*map, x[i], y[i], halfW_[i], halfH_[i])) {
+                y[i] = prevY_[i];
+            }
+        }
+    }
+
+    // Facing follows the dominant axis of the velocity; still actors keep theirs
+    for (std::size_t i = 0; i < n; ++i) {
+        const float ax = std::abs(vx[i]);
+        const float ay = std::abs(vy[i]);
+        if (ax > ay) {
+            facing_[i] = vx[i] < 0.f ? Facing::Left : Facing::Right;
+        } else if (ay > 0.f) {
+            facing_[i] = vy[i] < 0.f ? Facing::Up : Facing::Down;
+        }
+    }
+
+    // Clips: walk while moving, idle when standing; other clips keep playing
+    for (std::size_t i = 0; i < n; ++i) {
+        animTime_[i] += deltaTime;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        const SpriteSheet* sheet = sheets_[sheet_[i]];
+        if (!sheet) {
+            continue;
+        }
+        std::uint16_t clip = clip_[i];
+        if (clip == sheet->idleClip() || clip == sheet->walkClip()) {
+            const bool moving = vx[i] != 0.f || vy[i] != 0.f;
+            const std::uint16_t wanted = moving ? sheet->walkClip() : sheet->idleClip();
+            if (wanted != SpriteSheet::NoClip && wanted != clip) {
+                clip = clip_[i] = wanted;
+                animTime_[i] = deltaTime;
+            }
+        }
+        if (clip == SpriteSheet::NoClip) {
+            continue;
+        }
+        const AnimationClip& playing = sheet->clip(clip);
+        const float length = playing.frameSeconds * playing.frameCount;
+        if (playing.loop && animTime_[i] >= length) {
+            animTime_[i] = std::fmod(animTime_[i], length); // Keep float precision in long sessions
+        }
+        frame_[i] = sheet->column(playing, animTime_[i]);
+    }
+
+    grid_.build(x, y, n);
+    gridStale_ = false;
+}
+
+std::vector<ActorHandle> ActorSystem::queryRadius(sf::Vector2f center, float radius) const {
+    if (gridStale_) {
+        grid_.build(x_.data(), y_.data(), x_.size());
+        gridStale_ = false;
+    }
+    std::vector<ActorHandle> result;
+    grid_.forEachInRadius(center, radius, [this, &result](std::uint32_t index) {
+        result.push_back(handleAt(index));
+    });
+    return result;
+}
+
+const std::vector<std::vector<sf::Vertex>>& ActorSystem::buildBatches(float alpha) const {
+    LUMY_PROFILE_SCOPE("ActorSystem::buildBatches");
+    const std::size_t n = x_.size();
+    batches_.resize(sheets_.size());
+    batchFill_.assign(sheets_.size(), 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        batchFill_[sheet_[i]] += 6;
+    }
+    // resize() keeps the capacity, so steady frames don't allocate
+    for (std::size_t s = 0; s < batches_.size(); ++s) {
+        batches_[s].resize(batchFill_[s]);
+        batchFill_[s] = 0;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const SpriteSheet* sheet = sheets_[sheet_[i]];
+        sf::Vertex* v = batches_[sheet_[i]].data() + batchFill_[sheet_[i]];
+        batchFill_[sheet_[i]] += 6;
+
+        const float px = prevX_[i] + (x_[i] - prevX_[i]) * alpha;
+        const float py = prevY_[i] + (y_[i] - prevY_[i]) * alpha;
+        float left = px - halfW_[i];
+        float right = px + halfW_[i];
+        float top = py - halfH_[i];
+        const float bottom = py + halfH_[i];
+        float u0 = 0.f, v0 = 0.f, u1 = 0.f, v1 = 0.f;
+        if (sheet) {
+            // Sprites stand on the bottom of the collision box
+            const float fw = static_cast<float>(sheet->frameSize().x);
+            const float fh = static_cast<float>(sheet->frameSize().y);
+            left = px - fw * 0.5f;
+            right = px + fw * 0.5f;
+            top = bottom - fh;
+            u0 = fw * frame_[i];
+            v0 = fh * sheet->row(facing_[i]);
+            u1 = u0 + fw;
+            v1 = v0 + fh;
+        }
+
+        v[0] = {{left, top}, color_[i], {u0, v0}};
+        v[1] = {{right, top}, color_[i], {u1, v0}};
+        v[2] = {{right, bottom}, color_[i], {u1, v1}};
+        v[3] = {{left, top}, color_[i], {u0, v0}};
+        v[4] = {{right, bottom}, color_[i], {u1, v1}};
+        v[5] = {{left, bottom}, color_[i], {u0, v1}};
+    }
+    return batches_;
+}
+
+void ActorSystem::draw(sf::RenderTarget& target, float alpha) const {
+    const auto& batches = buildBatches(alpha);
+    for (std::size_t s = 0; s < batches.size(); ++s) {
+        if (batches[s].empty()) {
+            continue;
+        }
+        sf::RenderStates states;
+        states.texture = sheets_[s] ? sheets_[s]->texture() : nullptr;
+        target.draw(batches[s].data(), batches[s].size(), sf::PrimitiveType::Triangles, states);
+    }
+}
+
+void ActorSystem::record(RenderCommandList& commands, float alpha) const {
+    const auto& batches = buildBatches(alpha);
+    for (std::size_t s = 0; s < batches.size(); ++s) {
+        if (batches[s].empty()) {
+            continue;
+        }
+        sf::RenderStates states;
+        states.texture = sheets_[s] ? sheets_[s]->texture() : nullptr;
+        commands.draw(snapshots_.share(batches[s]), sf::PrimitiveType::Triangles, states);
+    }
+}
+
+void ActorSystem::submit(SpriteBatch& batch, float alpha, int layer) const {
+    const auto& batches = buildBatches(alpha);
+    for (std::size_t s = 0; s < batches.size(); ++s) {
+        batch.add(layer, sheets_[s] ? sheets_[s]->texture() : nullptr, batches[s].data(), batches[s].size());
+    }
+}
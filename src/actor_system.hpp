@@ -0,0 +1,117 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render_commands.hpp"
+#include "spatial_grid.hpp"
+#include "sprite_sheet.hpp"
+
+class Map;
+class SpriteBatch;
+
+// Handle to an actor. Stays valid while the actor lives, no matter how many
+// others are spawned or destroyed; a destroyed actor's handle never matches
+// a later actor (generation check).
+struct ActorHandle {
+    static constexpr std::uint32_t InvalidSlot = 0xFFFFFFFFu;
+
+    std::uint32_t slot = InvalidSlot;
+    std::uint32_t generation = 0;
+
+    bool operator==(const ActorHandle&) const = default;
+};
+
+struct ActorDesc {
+    sf::Vector2f position;          // Center of the collision box
+    sf::Vector2f velocity;          // Pixels per second
+    sf::Vector2f boxSize{24.f, 24.f};
+    Facing facing = Facing::Down;
+    sf::Color color = sf::Color::White;
+    const SpriteSheet* sheet = nullptr; // Null: drawn as a colored box. Must outlive the actor.
+};
+
+// NPCs and other moving characters, stored as structure-of-arrays: every
+// field lives in its own contiguous vector indexed by a dense index, so the
+// per-frame loops (movement, animation, vertex emission) walk plain float
+// arrays. Destroying swaps the last actor into the hole; handles go through
+// a slot table and stay stable.
+//
+// Actors with a sprite sheet play its "walk" clip while moving and "idle"
+// while standing, unless play() picked another clip. Drawing writes one
+// vertex batch per sheet texture, reused between frames.
+class ActorSystem {
+public:
+    ActorHandle spawn(const ActorDesc& desc);
+    bool destroy(ActorHandle handle);
+    bool alive(ActorHandle handle) const;
+    void clear();
+
+    std::size_t size() const { return x_.size(); }
+    ActorHandle handleAt(std::size_t index) const;
+
+    sf::Vector2f position(ActorHandle handle) const;
+    void setPosition(ActorHandle handle, sf::Vector2f position); // Teleport, no interpolation
+    sf::Vector2f velocity(ActorHandle handle) const;
+    void setVelocity(ActorHandle handle, sf::Vector2f velocity);
+    Facing facing(ActorHandle handle) const;
+    std::uint16_t frame(ActorHandle handle) const; // Sheet column being shown
+    std::uint16_t clip(ActorHandle handle) const;
+    // Restarts the actor on a clip of its sheet. Idle/walk keep switching
+    // with movement; any other clip stays until the next play().
+    void play(ActorHandle handle, std::uint16_t clip);
+
+    // Moves every actor by its velocity, resolves collision against the
+    // map's collision grid per axis (an actor slides along walls), updates
+    // facing and walk animation, and rebuilds the spatial index.
+    void update(float deltaTime, const Map* map = nullptr);
+
+    // Actors whose position is within radius of center.
+    std::vector<ActorHandle> queryRadius(sf::Vector2f center, float radius) const;
+
+    // Writes 6 vertices (two triangles) per actor, interpolated between the
+    // previous and current step, into the batch of its sheet. Batch 0 holds
+    // actors without a sheet; sheets are numbered in order of first spawn.
+    const std::vector<std::vector<sf::Vertex>>& buildBatches(float alpha) const;
+    // One draw call per sheet in use.
+    void draw(sf::RenderTarget& target, float alpha) const;
+    void record(RenderCommandList& commands, float alpha) const;
+    // Hands the batches to a SpriteBatch instead, so actors share draw calls
+    // with whatever else uses the same texture.
+    void submit(SpriteBatch& batch, float alpha, int layer = 0) const;
+
+private:
+    std::uint32_t indexOf(ActorHandle handle) const;
+    std::uint16_t sheetIndex(const SpriteSheet* sheet);
+    bool blocked(const Map& map, float x, float y, float halfW, float halfH) const;
+
+    // Hot data, one entry per live actor
+    std::vector<float> x_, y_;
+    std::vector<float> prevX_, prevY_;
+    std::vector<float> vx_, vy_;
+    std::vector<float> halfW_, halfH_;
+    std::vector<float> animTime_;
+    std::vector<std::uint16_t> sheet_;  // Into sheets_
+    std::vector<std::uint16_t> clip_;   // SpriteSheet::NoClip without a sheet
+    std::vector<std::uint16_t> frame_;
+    std::vector<Facing> facing_;
+    std::vector<sf::Color> color_;
+    std::vector<std::uint32_t> slotOf_; // Dense index -> slot
+
+    // Slot table for handles
+    std::vector<std::uint32_t> denseOf_; // Slot -> dense index
+    std::vector<std::uint32_t> generation_;
+    std::vector<std::uint32_t> freeSlots_;
+
+    // Dense indices, so spawn/destroy/setPosition leave it stale; the next
+    // queryRadius() rebuilds it once (update() rebuilds it anyway)
+    mutable SpatialGrid grid_;
+    mutable bool gridStale_ = false;
+    std::vector<const SpriteSheet*> sheets_{nullptr};
+    mutable std::vector<std::vector<sf::Vertex>> batches_; // Per sheet, reused by buildBatches()
+    mutable std::vector<std::size_t> batchFill_;
+    mutable VertexSnapshotPool snapshots_; // Recorded copies of batches_
+};
@@ -0,0 +1,333 @@
+#include "archive.hpp"
+#include "save_codec.hpp"
+
+#include <lz4.h>
+#include <lz4hc.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::uint8_t ArchiveMagic[4] = {'L', 'P', 'A', 'K'};
+constexpr std::uint16_t ArchiveVersion = 1;
+constexpr std::size_t HeaderSize = 32;
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+FileData FileData::view(const std::uint8_t* data, std::size_t size) {
+    FileData file;
+    file.data_ = data;
+    file.size_ = size;
+    file.valid_ = true;
+    return file;
+}
+
+FileData FileData::owned(std::vector<std::uint8_t> bytes) {
+    FileData file;
+    file.owned_ = std::move(bytes);
+    file.data_ = file.owned_.data();
+    file.size_ = file.owned_.size();
+    file.valid_ = true;
+    return file;
+}
+
+FileData::FileData(FileData&& other) noexcept {
+    *this = std::move(other);
+}
+
+FileData& FileData::operator=(FileData&& other) noexcept {
+    if (this != &other) {
+        const bool ownsData = !other.owned_.empty() && other.data_ == other.owned_.data();
+        owned_ = std::move(other.owned_);
+        data_ = ownsData ? owned_.data() : other.data_;
+        size_ = other.size_;
+        valid_ = other.valid_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.valid_ = false;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const std::uint8_t*>(view);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    data_ = static_cast<const std::uint8_t*>(view);
+    size_ = static_cast<std::size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (!data_) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    CloseHandle(static_cast<HANDLE>(file_));
+    file_ = nullptr;
+    mapping_ = nullptr;
+#else
+    munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool Archive::open(const std::filesystem::path& path) {
+    close();
+    static_assert(std::endian::native == std::endian::little, "the index is read in place");
+    if (!file_.open(path)) {
+        return false;
+    }
+    const std::uint8_t* data = file_.data();
+    const std::size_t size = file_.size();
+    const auto invalid = [&](const char* reason) {
+        std::cerr << "[Archive] " << path.string() << ": " << reason << "\n";
+        close();
+        return false;
+    };
+    if (size < HeaderSize || std::memcmp(data, ArchiveMagic, sizeof(ArchiveMagic)) != 0) {
+        return invalid("não é um arquivo .lpak");
+    }
+    if (readLE(data + 4, 2) != ArchiveVersion) {
+        return invalid("versão não suportada");
+    }
+    const std::uint64_t count = readLE(data + 8, 4);
+    const std::uint64_t indexOffset = readLE(data + 12, 8);
+    const std::uint64_t namesOffset = readLE(data + 20, 8);
+    const std::uint64_t namesSize = readLE(data + 28, 4);
+    if (indexOffset % alignof(Entry) != 0 || indexOffset > size || count > (size - indexOffset) / sizeof(Entry) ||
+        namesOffset > size || namesSize > size - namesOffset) {
+        return invalid("índice corrompido");
+    }
+    const auto* entries = reinterpret_cast<const Entry*>(data + indexOffset);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Entry& entry = entries[i];
+        if (entry.offset > size || entry.storedSize > size - entry.offset ||
+            static_cast<std::uint64_t>(entry.nameOffset) + entry.nameLength > namesSize ||
+            (i > 0 && entries[i - 1].hash > entry.hash)) {
+            return invalid("entrada corrompida");
+        }
+    }
+    entries_ = entries;
+    count_ = static_cast<std::size_t>(count);
+    names_ = reinterpret_cast<const char*>(data + namesOffset);
+    namesSize_ = static_cast<std::size_t>(namesSize);
+    return true;
+}
+
+void Archive::close() {
+    file_.close();
+    entries_ = nullptr;
+    count_ = 0;
+    names_ = nullptr;
+    namesSize_ = 0;
+}
+
+std::uint64_t Archive::hashName(std::string_view name) {
+    // FNV-1a, 64 bits
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char c : name) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+const Archive::Entry* Archive::find(std::string_view name) const {
+    if (!entries_) {
+        return nullptr;
+    }
+    const std::uint64_t hash = hashName(name);
+    const Entry* end = entries_ + count_;
+    const Entry* it = std::lower_bound(entries_, end, hash,
+                                       [](const Entry& entry, std::uint64_t value) { return entry.hash < value; });
+    // Colliding hashes sit next to each other; the stored name settles it
+    for (; it != end && it->hash == hash; ++it) {
+        if (nameOf(*it) == name) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view Archive::nameOf(const Entry& entry) const {
+    return {names_ + entry.nameOffset, entry.nameLength};
+}
+
+FileData Archive::read(const Entry& entry) const {
+    const std::uint8_t* stored = file_.data() + entry.offset;
+    if (entry.compression == Compression::None) {
+        return FileData::view(stored, static_cast<std::size_t>(entry.storedSize));
+    }
+    if (entry.compression != Compression::Lz4 || entry.size > static_cast<std::uint64_t>(LZ4_MAX_INPUT_SIZE)) {
+        return {};
+    }
+    std::vector<std::uint8_t> bytes(static_cast<std::size_t>(entry.size));
+    const int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(stored), reinterpret_cast<char*>(bytes.data()),
+                                            static_cast<int>(entry.storedSize), static_cast<int>(entry.size));
+    if (decoded < 0 || static_cast<std::uint64_t>(decoded) != entry.size) {
+        std::cerr << "[Archive] Falha ao descompactar " << nameOf(entry) << "\n";
+        return {};
+    }
+    return FileData::owned(std::move(bytes));
+}
+
+bool Archive::write(const std::filesystem::path& path, std::vector<Source> sources) {
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) {
+        const std::uint64_t ha = hashName(a.name);
+        const std::uint64_t hb = hashName(b.name);
+        return ha != hb ? ha < hb : a.name < b.name;
+    });
+    for (std::size_t i = 1; i < sources.size(); ++i) {
+        if (sources[i].name == sources[i - 1].name) {
+            std::cerr << "[Archive] Caminho duplicado: " << sources[i].name << "\n";
+            return false;
+        }
+    }
+
+    ByteBuffer out(HeaderSize, 0);
+    std::vector<Entry> entries;
+    std::string names;
+    entries.reserve(sources.size());
+    for (const Source& source : sources) {
+        if (source.name.size() > std::numeric_limits<std::uint16_t>::max() ||
+            source.bytes.size() > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+            std::cerr << "[Archive] Entrada grande demais: " << source.name << "\n";
+            return false;
+        }
+        out.resize(alignUp(out.size(), Alignment), 0);
+
+        Entry entry{};
+        entry.hash = hashName(source.name);
+        entry.offset = out.size();
+        entry.size = source.bytes.size();
+        entry.nameOffset = static_cast<std::uint32_t>(names.size());
+        entry.nameLength = static_cast<std::uint16_t>(source.name.size());
+        names += source.name;
+
+        std::vector<std::uint8_t> packed;
+        if (source.compress && !source.bytes.empty()) {
+            const int srcSize = static_cast<int>(source.bytes.size());
+            packed.resize(static_cast<std::size_t>(LZ4_compressBound(srcSize)));
+            const int packedSize = LZ4_compress_HC(reinterpret_cast<const char*>(source.bytes.data()),
+                                                   reinterpret_cast<char*>(packed.data()), srcSize,
+                                                   static_cast<int>(packed.size()), LZ4HC_CLEVEL_DEFAULT);
+            // Not worth a decode unless it saves at least an eighth
+            if (packedSize > 0 && static_cast<std::size_t>(packedSize) < source.bytes.size() - source.bytes.size() / 8) {
+                packed.resize(static_cast<std::size_t>(packedSize));
+                entry.compression = Compression::Lz4;
+            }
+        }
+        const std::vector<std::uint8_t>& stored = entry.compression == Compression::Lz4 ? packed : source.bytes;
+        entry.storedSize = stored.size();
+        out.insert(out.end(), stored.begin(), stored.end());
+        entries.push_back(entry);
+    }
+
+    out.resize(alignUp(out.size(), Alignment), 0);
+    const std::uint64_t indexOffset = out.size();
+    for (const Entry& entry : entries) {
+        writeLE(out, entry.hash, 8);
+        writeLE(out, entry.offset, 8);
+        writeLE(out, entry.storedSize, 8);
+        writeLE(out, entry.size, 8);
+        writeLE(out, entry.nameOffset, 4);
+        writeLE(out, entry.nameLength, 2);
+        writeLE(out, static_cast<std::uint8_t>(entry.compression), 1);
+        writeLE(out, 0, 1);
+    }
+    const std::uint64_t namesOffset = out.size();
+    out.insert(out.end(), names.begin(), names.end());
+
+    ByteBuffer header(ArchiveMagic, ArchiveMagic + sizeof(ArchiveMagic));
+    writeLE(header, ArchiveVersion, 2);
+    writeLE(header, 0, 2);
+    writeLE(header, entries.size(), 4);
+    writeLE(header, indexOffset, 8);
+    writeLE(header, namesOffset, 8);
+    writeLE(header, names.size(), 4);
+    std::copy(header.begin(), header.end(), out.begin());
+
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+    const std::filesystem::path tempPath = path.string() + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bytes of one file. Either a view into a memory-mapped archive (no copy;
+// valid while the archive stays open) or a buffer it owns (compressed
+// entries, loose files).
+class FileData {
+public:
+    FileData() = default;
+    static FileData view(const std::uint8_t* data, std::size_t size);
+    static FileData owned(std::vector<std::uint8_t> bytes);
+
+    FileData(FileData&& other) noexcept;
+    FileData& operator=(FileData&& other) noexcept;
+    FileData(const FileData&) = delete;
+    FileData& operator=(const FileData&) = delete;
+
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::string_view text() const { return {reinterpret_cast<const char*>(data_), size_}; }
+    bool valid() const { return valid_; }
+    explicit operator bool() const { return valid_; }
+
+private:
+    std::vector<std::uint8_t> owned_;
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool valid_ = false;
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+// Single-file asset archive (.lpak), opened with one mmap.
+//
+//   header (32 bytes)  magic "LPAK" | version u16 | reserved u16 | entry count u32
+//                      | index offset u64 | names offset u64 | names size u32
+//   data               entry payloads, each starting on an Alignment boundary
+//   index              Entry[count], sorted by path hash
+//   names              entry paths back to back (for listing and hash collisions)
+//
+// All integers are little-endian. Uncompressed entries are handed out as
+// views into the mapping; compressed ones (LZ4) are decoded into a buffer.
+class Archive {
+public:
+    static constexpr std::size_t Alignment = 64;
+
+    enum class Compression : std::uint8_t { None = 0, Lz4 = 1 };
+
+    struct Entry {
+        std::uint64_t hash;
+        std::uint64_t offset;
+        std::uint64_t storedSize;
+        std::uint64_t size;
+        std::uint32_t nameOffset;
+        std::uint16_t nameLength;
+        Compression compression;
+        std::uint8_t reserved;
+    };
+    static_assert(sizeof(Entry) == 40);
+
+    struct Source {
+        std::string name; // Path inside the archive, '/' separated
+        std::vector<std::uint8_t> bytes;
+        bool compress = true; // Kept raw anyway when LZ4 doesn't shrink it
+    };
+
+    Archive() = default;
+    Archive(const Archive&) = delete;
+    Archive& operator=(const Archive&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return entries_ != nullptr; }
+
+    // Entry for a normalized path ('/' separated, no "." or ".."), or nullptr.
+    const Entry* find(std::string_view name) const;
+    FileData read(const Entry& entry) const;
+    std::size_t entryCount() const { return count_; }
+    const Entry& entryAt(std::size_t index) const { return entries_[index]; }
+    std::string_view nameOf(const Entry& entry) const;
+
+    static std::uint64_t hashName(std::string_view name);
+    static bool write(const std::filesystem::path& path, std::vector<Source> sources);
+
+private:
+    MappedFile file_;
+    const Entry* entries_ = nullptr;
+    std::size_t count_ = 0;
+    const char* names_ = nullptr;
+    std::size_t namesSize_ = 0;
+};
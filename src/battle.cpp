@@ -0,0 +1,1107 @@
+#include "battle.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+constexpr std::int32_t DamageCap = 9999;
+constexpr std::int32_t MaxTp = 100;
+// Larger samples are counted as this value
+constexpr std::uint32_t HistogramLimit = 1u << 16;
+// Battles taken by a worker at a time
+constexpr std::uint64_t SimulationChunk = 64;
+
+// Skill scopes (skills.json "scope")
+//   1 one enemy, 2 all enemies, 3..6 1..4 random enemies,
+//   7 one ally, 8 all allies, 9 one dead ally, 10 all dead allies, 11 the user
+bool forOpponents(std::int32_t scope) {
+    return scope >= 1 && scope <= 6;
+}
+bool forDeadAllies(std::int32_t scope) {
+    return scope == 9 || scope == 10;
+}
+
+// Damage types (skills.json "damage.type")
+//   1 HP damage, 2 MP damage, 3 HP recovery, 4 MP recovery, 5 HP drain, 6 MP drain
+bool isRecovery(std::int32_t type) {
+    return type == 3 || type == 4;
+}
+bool hitsHp(std::int32_t type) {
+    return type == 1 || type == 3 || type == 5;
+}
+
+std::uint32_t battleSeed(std::uint32_t seed, std::uint64_t index) {
+    // splitmix64 finalizer over (seed, index)
+    std::uint64_t x = (static_cast<std::uint64_t>(seed) << 32) + index * 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<std::uint32_t>((x ^ (x >> 31)) >> 32);
+}
+
+} // namespace
+
+// ===== DamageFormula =====
+
+class DamageFormula::Parser {
+public:
+    Parser(std::string_view text, DamageFormula& out) : text_(text), out_(out) {}
+
+    bool parse(std::string& error) {
+        if (!expression()) {
+            error = error_;
+            return false;
+        }
+        skipSpace();
+        if (pos_ != text_.size()) {
+            error = "caractere inesperado em " + std::to_string(pos_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool fail(std::string message) {
+        if (error_.empty()) {
+            error_ = std::move(message);
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    std::string_view word() {
+        skipSpace();
+        const std::size_t start = pos_;
+        while (pos_ < text_.size() && (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '_')) {
+            ++pos_;
+        }
+        return text_.substr(start, pos_ - start);
+    }
+
+    bool emit(Op op, int stackChange, std::uint8_t field = 0, float value = 0.f) {
+        depth_ += stackChange;
+        if (depth_ > static_cast<int>(MaxStack)) {
+            return fail("expressão profunda demais");
+        }
+        out_.code_.push_back({op, field, value});
+        return true;
+    }
+
+    // expression := term (('+' | '-') term)*
+    bool expression() {
+        if (!term()) {
+            return false;
+        }
+        for (;;) {
+            if (accept('+')) {
+                if (!term() || !emit(Op::Add, -1)) {
+                    return false;
+                }
+            } else if (accept('-')) {
+                if (!term() || !emit(Op::Sub, -1)) {
+                    return false;
+                }
+            } else {
+                return true;
+            }
+        }
+    }
+
+    // term := unary (('*' | '/') unary)*
+    bool term() {
+        if (!unary()) {
+            return false;
+        }
+        for (;;) {
+            if (accept('*')) {
+                if (!unary() || !emit(Op::Mul, -1)) {
+                    return false;
+                }
+            } else if (accept('/')) {
+                if (!unary() || !emit(Op::Div, -1)) {
+                    return false;
+                }
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool unary() {
+        if (accept('-')) {
+            return unary() && emit(Op::Neg, 0);
+        }
+        if (accept('+')) {
+            return unary();
+        }
+        return primary();
+    }
+
+    bool primary() {
+        skipSpace();
+        if (pos_ >= text_.size()) {
+            return fail("fim inesperado");
+        }
+        const char c = text_[pos_];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* begin = text_.data() + pos_;
+            char* end = nullptr;
+            const std::string number(begin, text_.size() - pos_);
+            const float value = std::strtof(number.c_str(), &end);
+            if (end == number.c_str()) {
+                return fail("número inválido em " + std::to_string(pos_));
+            }
+            pos_ += static_cast<std::size_t>(end - number.c_str());
+            return emit(Op::Push, 1, 0, value);
+        }
+        if (accept('(')) {
+            if (!expression()) {
+                return false;
+            }
+            return accept(')') || fail("falta ')'");
+        }
+
+        std::string_view name = word();
+        if (name.empty()) {
+            return fail(std::string("caractere inesperado '") + c + "'");
+        }
+        if (name == "Math") {
+            if (!accept('.')) {
+                return fail("esperado '.' depois de Math");
+            }
+            name = word();
+        }
+        if (name == "a" || name == "b") {
+            if (!accept('.')) {
+                return fail("esperado '.' depois de " + std::string(name));
+            }
+            const std::string_view fieldName = word();
+            static constexpr std::string_view FieldNames[] = {"mhp", "mmp", "atk", "def", "mat", "mdf",
+                                                              "agi", "luk", "hp",  "mp",  "tp",  "level"};
+            const auto it = std::find(std::begin(FieldNames), std::end(FieldNames), fieldName);
+            if (it == std::end(FieldNames)) {
+                return fail("campo desconhecido '" + std::string(fieldName) + "'");
+            }
+            return emit(name == "a" ? Op::LoadA : Op::LoadB, 1, static_cast<std::uint8_t>(it - std::begin(FieldNames)));
+        }
+
+        Op op;
+        int arguments = 1;
+        if (name == "min") {
+            op = Op::Min;
+            arguments = 2;
+        } else if (name == "max") {
+            op = Op::Max;
+            arguments = 2;
+        } else if (name == "floor") {
+            op = Op::Floor;
+        } else {
+            return fail("nome desconhecido '" + std::string(name) + "'");
+        }
+        if (!accept('(') || !expression()) {
+            return fail("esperado '(' depois de " + std::string(name));
+        }
+        for (int i = 1; i < arguments; ++i) {
+            if (!accept(',') || !expression()) {
+                return fail(std::string(name) + " espera " + std::to_string(arguments) + " argumentos");
+            }
+        }
+        if (!accept(')')) {
+            return fail("falta ')'");
+        }
+        return emit(op, 1 - arguments);
+    }
+
+    std::string_view text_;
+    DamageFormula& out_;
+    std::size_t pos_ = 0;
+    int depth_ = 0;
+    std::string error_;
+};
+
+DamageFormula DamageFormula::compile(std::string_view text, std::string* error) {
+    DamageFormula formula;
+    std::string message;
+    if (!Parser(text, formula).parse(message)) {
+        formula.code_.clear();
+        if (error) {
+            *error = message;
+        }
+    }
+    return formula;
+}
+
+float DamageFormula::evaluate(const Fields& a, const Fields& b) const {
+    float stack[MaxStack];
+    std::size_t top = 0;
+    for (const Instruction& in : code_) {
+        switch (in.op) {
+        case Op::Push:
+            stack[top++] = in.value;
+            break;
+        case Op::LoadA:
+            stack[top++] = a[in.field];
+            break;
+        case Op::LoadB:
+            stack[top++] = b[in.field];
+            break;
+        case Op::Add:
+            --top;
+            stack[top - 1] += stack[top];
+            break;
+        case Op::Sub:
+            --top;
+            stack[top - 1] -= stack[top];
+            break;
+        case Op::Mul:
+            --top;
+            stack[top - 1] *= stack[top];
+            break;
+        case Op::Div:
+            --top;
+            stack[top - 1] = stack[top] != 0.f ? stack[top - 1] / stack[top] : 0.f;
+            break;
+        case Op::Neg:
+            stack[top - 1] = -stack[top - 1];
+            break;
+        case Op::Min:
+            --top;
+            stack[top - 1] = std::min(stack[top - 1], stack[top]);
+            break;
+        case Op::Max:
+            --top;
+            stack[top - 1] = std::max(stack[top - 1], stack[top]);
+            break;
+        case Op::Floor:
+            stack[top - 1] = std::floor(stack[top - 1]);
+            break;
+        }
+    }
+    return top ? stack[0] : 0.f;
+}
+
+// ===== BattleRules =====
+
+BattleRules::BattleRules(const Database& db) : db_(db), formulas_(db.skills().size()) {
+    for (const SkillData& skill : db.skills().rows()) {
+        if (skill.id == 0 || skill.damage.type == 0) {
+            continue;
+        }
+        std::string error;
+        formulas_[static_cast<std::size_t>(skill.id)] = DamageFormula::compile(db.text(skill.damage.formula), &error);
+        if (!error.empty()) {
+            std::cerr << "[Battle] Fórmula inválida na skill " << skill.id << " (\"" << db.text(skill.damage.formula)
+                      << "\"): " << error << "\n";
+        }
+    }
+
+    const auto addPartySkill = [&](std::int32_t id) {
+        if (db.skills().find(id) && std::find(partySkills_.begin(), partySkills_.end(), id) == partySkills_.end()) {
+            partySkills_.push_back(id);
+        }
+    };
+    addPartySkill(db.system().attackSkillId);
+    for (const std::int32_t id : db.ids(db.system().magicSkillIds)) {
+        addPartySkill(id);
+    }
+}
+
+// ===== Histogram / report =====
+
+void Histogram::add(std::uint32_t value) {
+    value = std::min(value, HistogramLimit);
+    if (value >= counts_.size()) {
+        counts_.resize(static_cast<std::size_t>(value) + 1, 0);
+    }
+    ++counts_[value];
+    ++count_;
+    sum_ += value;
+}
+
+void Histogram::merge(const Histogram& other) {
+    if (other.counts_.size() > counts_.size()) {
+        counts_.resize(other.counts_.size(), 0);
+    }
+    for (std::size_t i = 0; i < other.counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+}
+
+std::uint32_t Histogram::min() const {
+    const auto it = std::find_if(counts_.begin(), counts_.end(), [](std::uint64_t n) { return n != 0; });
+    return it == counts_.end() ? 0 : static_cast<std::uint32_t>(it - counts_.begin());
+}
+
+std::uint32_t Histogram::max() const {
+    const auto it = std::find_if(counts_.rbegin(), counts_.rend(), [](std::uint64_t n) { return n != 0; });
+    return it == counts_.rend() ? 0 : static_cast<std::uint32_t>(counts_.rend() - it - 1);
+}
+
+std::uint32_t Histogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) *
+                                                                                        static_cast<double>(count_))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    return max();
+}
+
+void SkillStats::merge(const SkillStats& other) {
+    uses += other.uses;
+    misses += other.misses;
+    criticals += other.criticals;
+    damage.merge(other.damage);
+    healing.merge(other.healing);
+}
+
+void BattleReport::merge(const BattleReport& other) {
+    battles += other.battles;
+    victories += other.victories;
+    defeats += other.defeats;
+    timeouts += other.timeouts;
+    turns.merge(other.turns);
+    partyHpLeft.merge(other.partyHpLeft);
+    const auto mergeSkills = [](std::vector<SkillStats>& into, const std::vector<SkillStats>& from) {
+        if (from.size() > into.size()) {
+            into.resize(from.size());
+        }
+        for (std::size_t i = 0; i < from.size(); ++i) {
+            into[i].merge(from[i]);
+        }
+    };
+    mergeSkills(partySkills, other.partySkills);
+    mergeSkills(troopSkills, other.troopSkills);
+}
+
+// ===== Battle =====
+
+Battle::Battle(const BattleRules& rules) : rules_(rules), db_(rules.database()) {}
+
+std::uint32_t Battle::random(std::uint32_t n) {
+    // Plain modulo instead of std::uniform_int_distribution, whose output
+    // differs between standard libraries; the bias is far below what a
+    // balancing run can see
+    return n > 1 ? static_cast<std::uint32_t>(rng_() % n) : 0;
+}
+
+float Battle::chance() {
+    return static_cast<float>(rng_() >> 8) * (1.f / 16777216.f);
+}
+
+void Battle::reset(const BattleSetup& setup, std::uint32_t seed) {
+    rng_.seed(seed);
+    turn_ = 0;
+    maxTurns_ = std::max(1, setup.maxTurns);
+    outcome_ = BattleOutcome::Ongoing;
+    chosen_ = {};
+    battlerCount_ = 0;
+
+    for (const BattleSetup::Member& member : setup.party) {
+        const ActorData* actor = db_.actors().find(member.actorId);
+        if (!actor || battlerCount_ == MaxPartySize) {
+            continue;
+        }
+        Battler& battler = battlers_[battlerCount_++];
+        battler = Battler{};
+        battler.actor = true;
+        battler.id = actor->id;
+        battler.level = std::clamp(member.level, 1, actor->maxLevel);
+        battler.params = db_.actorParams(*actor, battler.level);
+        battler.hp = battler.params[0];
+        battler.mp = battler.params[1];
+        refresh(battler);
+    }
+    partySize_ = battlerCount_;
+
+    for (const std::int32_t enemyId : setup.troop) {
+        const EnemyData* enemy = db_.enemies().find(enemyId);
+        if (!enemy || battlerCount_ == partySize_ + MaxTroopSize) {
+            continue;
+        }
+        Battler& battler = battlers_[battlerCount_++];
+        battler = Battler{};
+        battler.id = enemy->id;
+        battler.params = enemy->params;
+        battler.hp = battler.params[0];
+        battler.mp = battler.params[1];
+        refresh(battler);
+    }
+    updateOutcome();
+}
+
+bool Battle::alive(std::size_t battler) const {
+    return battler < battlerCount_ && !hasState(battler, DeathStateId);
+}
+
+bool Battle::hasState(std::size_t battler, std::int32_t stateId) const {
+    const Battler& b = battlers_[battler];
+    return std::any_of(b.states.begin(), b.states.begin() + b.stateCount,
+                       [&](const ActiveState& state) { return state.id == stateId; });
+}
+
+void Battle::setAction(std::size_t member, std::int32_t skillId, std::size_t target) {
+    if (member < partySize_) {
+        chosen_[member] = {skillId, static_cast<std::int32_t>(target), 0};
+    }
+}
+
+void Battle::refresh(Battler& battler) const {
+    battler.hit = 1.f;
+    battler.evasion = 0.f;
+    battler.critical = 0.f;
+    battler.magicEvasion = 0.f;
+    battler.hpPerTurn = 0.f;
+    battler.restriction = 0;
+    battler.elementRates.fill(1.f);
+
+    // Ex-parameters add up; HIT is 100% until a trait sets it
+    float hit = 0.f;
+    bool hitTrait = false;
+    const auto applyTraits = [&](std::span<const Trait> traits) {
+        for (const Trait& trait : traits) {
+            if (trait.code == TraitElementRate) {
+                if (trait.dataId >= 0 && static_cast<std::size_t>(trait.dataId) < MaxElements) {
+                    battler.elementRates[static_cast<std::size_t>(trait.dataId)] *= trait.value;
+                }
+            } else if (trait.code == TraitExParam) {
+                switch (trait.dataId) {
+                case 0:
+                    hit += trait.value;
+                    hitTrait = true;
+                    break;
+                case 1:
+                    battler.evasion += trait.value;
+                    break;
+                case 2:
+                    battler.critical += trait.value;
+                    break;
+                case 4:
+                    battler.magicEvasion += trait.value;
+                    break;
+                default:
+                    break;
+                }
+            } else if (trait.code == TraitHpPerTurn) {
+                battler.hpPerTurn += trait.value / 100.f;
+            }
+        }
+    };
+
+    if (!battler.actor) {
+        applyTraits(db_.traits(db_.enemies()[battler.id].traits));
+    }
+    for (std::size_t i = 0; i < battler.stateCount; ++i) {
+        const StateData& state = db_.states()[battler.states[i].id];
+        applyTraits(db_.traits(state.traits));
+        battler.restriction = std::max(battler.restriction, state.restriction);
+    }
+    if (hitTrait) {
+        battler.hit = hit;
+    }
+}
+
+DamageFormula::Fields Battle::fields(const Battler& battler) const {
+    DamageFormula::Fields f{};
+    for (std::size_t i = 0; i < ParamCount; ++i) {
+        f[i] = static_cast<float>(battler.params[i]);
+    }
+    f[static_cast<std::size_t>(DamageFormula::Field::Hp)] = static_cast<float>(battler.hp);
+    f[static_cast<std::size_t>(DamageFormula::Field::Mp)] = static_cast<float>(battler.mp);
+    f[static_cast<std::size_t>(DamageFormula::Field::Tp)] = static_cast<float>(battler.tp);
+    f[static_cast<std::size_t>(DamageFormula::Field::Level)] = static_cast<float>(battler.level);
+    return f;
+}
+
+bool Battle::canUse(const Battler& battler, const SkillData& skill) const {
+    // Occasion 0 always, 1 battle only (2 menu, 3 never)
+    return battler.mp >= skill.mpCost && battler.tp >= skill.tpCost && (skill.occasion == 0 || skill.occasion == 1);
+}
+
+float Battle::expected(std::size_t user, std::size_t target, const SkillData& skill) const {
+    float value = std::max(rules_.formula(skill.id).evaluate(fields(battlers_[user]), fields(battlers_[target])), 0.f);
+    if (skill.damage.elementId > 0 && static_cast<std::size_t>(skill.damage.elementId) < MaxElements) {
+        value *= battlers_[target].elementRates[static_cast<std::size_t>(skill.damage.elementId)];
+    }
+    return value * static_cast<float>(skill.successRate) / 100.f * static_cast<float>(std::max(1, skill.repeats));
+}
+
+Battle::Action Battle::decideActor(std::size_t index) {
+    if (chosen_[index].skillId != 0) {
+        return chosen_[index];
+    }
+    const Battler& self = battlers_[index];
+
+    // Ally under half HP, the most hurt one
+    std::int32_t hurt = -1;
+    float lowest = 0.5f;
+    for (std::size_t i = 0; i < partySize_; ++i) {
+        const float rate = static_cast<float>(battlers_[i].hp) / static_cast<float>(std::max(1, battlers_[i].params[0]));
+        if (alive(i) && rate < lowest) {
+            lowest = rate;
+            hurt = static_cast<std::int32_t>(i);
+        }
+    }
+    // Weakest enemy
+    std::int32_t weakest = -1;
+    for (std::size_t i = partySize_; i < battlerCount_; ++i) {
+        if (alive(i) && (weakest < 0 || battlers_[i].hp < battlers_[static_cast<std::size_t>(weakest)].hp)) {
+            weakest = static_cast<std::int32_t>(i);
+        }
+    }
+
+    Action best{db_.system().attackSkillId, weakest, 0};
+    float bestScore = -1.f;
+    for (const std::int32_t skillId : rules_.partySkills()) {
+        const SkillData& skill = db_.skills()[skillId];
+        if (!canUse(self, skill)) {
+            continue;
+        }
+        if (skill.damage.type == 3 && (skill.scope == 7 || skill.scope == 8) && hurt >= 0) {
+            return {skillId, hurt, 0};
+        }
+        if ((skill.damage.type == 1 || skill.damage.type == 5) && forOpponents(skill.scope) && weakest >= 0) {
+            float score = expected(index, static_cast<std::size_t>(weakest), skill);
+            if (skill.scope == 2) {
+                score *= static_cast<float>(std::count_if(battlers_.begin() + static_cast<std::ptrdiff_t>(partySize_),
+                                                          battlers_.begin() + static_cast<std::ptrdiff_t>(battlerCount_),
+                                                          [](const Battler& b) { return b.hp > 0; }));
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                best = {skillId, weakest, 0};
+            }
+        }
+    }
+    return best;
+}
+
+Battle::Action Battle::decideEnemy(std::size_t index) {
+    const Battler& self = battlers_[index];
+    const EnemyData& enemy = db_.enemies()[self.id];
+
+    const auto conditionMet = [&](const EnemyAction& action) {
+        const float p1 = action.conditionParam1;
+        const float p2 = action.conditionParam2;
+        switch (action.conditionType) {
+        case 0: // Always
+            return true;
+        case 1: { // Turn p1 + p2 * X
+            const float turn = static_cast<float>(turn_);
+            return p2 == 0.f ? turn == p1 : turn >= p1 && std::fmod(turn - p1, p2) == 0.f;
+        }
+        case 2: { // HP between p1 and p2 (rates)
+            const float rate = static_cast<float>(self.hp) / static_cast<float>(std::max(1, self.params[0]));
+            return rate >= p1 && rate <= p2;
+        }
+        case 3: {
+            const float rate = static_cast<float>(self.mp) / static_cast<float>(std::max(1, self.params[1]));
+            return rate >= p1 && rate <= p2;
+        }
+        case 4:
+            return hasState(index, static_cast<std::int32_t>(p1));
+        case 5: { // Highest party level
+            std::int32_t level = 0;
+            for (std::size_t i = 0; i < partySize_; ++i) {
+                level = std::max(level, battlers_[i].level);
+            }
+            return static_cast<float>(level) >= p1;
+        }
+        default: // Switches: no game state inside a battle simulation
+            return false;
+        }
+    };
+
+    // Ratings as in the editor: only actions within 2 of the best rating, the
+    // better ones more often
+    std::array<const EnemyAction*, 16> candidates{};
+    std::size_t count = 0;
+    std::int32_t bestRating = 0;
+    for (const EnemyAction& action : db_.actions(enemy.actions)) {
+        const SkillData* skill = db_.skills().find(action.skillId);
+        if (count < candidates.size() && skill && canUse(self, *skill) && conditionMet(action)) {
+            candidates[count++] = &action;
+            bestRating = std::max(bestRating, action.rating);
+        }
+    }
+    const std::int32_t ratingZero = bestRating - 3;
+    std::uint32_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += static_cast<std::uint32_t>(std::max(0, candidates[i]->rating - ratingZero));
+    }
+    if (total == 0) {
+        return {db_.system().attackSkillId, -1, 0};
+    }
+    std::int32_t pick = static_cast<std::int32_t>(random(total));
+    for (std::size_t i = 0; i < count; ++i) {
+        pick -= std::max(0, candidates[i]->rating - ratingZero);
+        if (pick < 0) {
+            return {candidates[i]->skillId, -1, 0};
+        }
+    }
+    return {db_.system().attackSkillId, -1, 0};
+}
+
+Battle::Action Battle::restrictedAction(std::size_t index) {
+    // Restriction 1 attacks an enemy, 2 anyone, 3 an ally (4 can't move)
+    const std::int32_t restriction = battlers_[index].restriction;
+    bool enemies = restriction != 3;
+    if (restriction == 2) {
+        enemies = random(2) == 0;
+    }
+    return {db_.system().attackSkillId, randomTarget(index, enemies, false), 0};
+}
+
+std::int32_t Battle::randomTarget(std::size_t user, bool enemies, bool dead) {
+    std::array<std::uint8_t, MaxBattlers> candidates{};
+    std::uint32_t count = 0;
+    for (std::size_t i = 0; i < battlerCount_; ++i) {
+        if (opponents(user, i) == enemies && alive(i) != dead) {
+            candidates[count++] = static_cast<std::uint8_t>(i);
+        }
+    }
+    return count ? candidates[random(count)] : -1;
+}
+
+void Battle::execute(std::size_t user, const Action& action) {
+    const SkillData* skill = db_.skills().find(action.skillId);
+    if (!skill) {
+        return;
+    }
+    Battler& self = battlers_[user];
+    if (!canUse(self, *skill)) {
+        return;
+    }
+    self.mp -= skill->mpCost;
+    self.tp = std::min(MaxTp, self.tp - skill->tpCost + skill->tpGain);
+    if (SkillStats* stats = statsFor(user, skill->id)) {
+        ++stats->uses;
+    }
+
+    std::array<std::uint8_t, MaxBattlers> targets{};
+    std::size_t count = 0;
+    const std::int32_t scope = skill->scope;
+    const bool enemies = forOpponents(scope);
+    const bool dead = forDeadAllies(scope);
+    if (scope == 1 || scope == 7 || scope == 9) {
+        std::int32_t target = action.target;
+        if (target < 0 || static_cast<std::size_t>(target) >= battlerCount_ ||
+            opponents(user, static_cast<std::size_t>(target)) != enemies ||
+            alive(static_cast<std::size_t>(target)) == dead) {
+            target = randomTarget(user, enemies, dead);
+        }
+        if (target >= 0) {
+            targets[count++] = static_cast<std::uint8_t>(target);
+        }
+    } else if (scope == 2 || scope == 8 || scope == 10) {
+        for (std::size_t i = 0; i < battlerCount_; ++i) {
+            if (opponents(user, i) == enemies && alive(i) != dead) {
+                targets[count++] = static_cast<std::uint8_t>(i);
+            }
+        }
+    } else if (scope >= 3 && scope <= 6) {
+        for (std::int32_t i = 0; i < scope - 2; ++i) {
+            const std::int32_t target = randomTarget(user, true, false);
+            if (target >= 0) {
+                targets[count++] = static_cast<std::uint8_t>(target);
+            }
+        }
+    } else if (scope == 11) {
+        targets[count++] = static_cast<std::uint8_t>(user);
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::int32_t repeat = 0; repeat < std::max(1, skill->repeats); ++repeat) {
+            apply(user, targets[i], *skill);
+        }
+    }
+}
+
+void Battle::apply(std::size_t user, std::size_t target, const SkillData& skill) {
+    Battler& a = battlers_[user];
+    Battler& b = battlers_[target];
+    SkillStats* stats = statsFor(user, skill.id);
+    BattleEvent event{static_cast<std::uint8_t>(user), static_cast<std::uint8_t>(target), skill.id, 0, false, false};
+
+    // Hit type 0 certain, 1 physical (HIT vs evasion), 2 magical (vs magic evasion)
+    float hitRate = static_cast<float>(skill.successRate) / 100.f;
+    float evadeRate = 0.f;
+    if (skill.hitType == 1) {
+        hitRate *= a.hit;
+        evadeRate = b.evasion;
+    } else if (skill.hitType == 2) {
+        evadeRate = b.magicEvasion;
+    }
+    event.hit = chance() < hitRate && !(evadeRate > 0.f && chance() < evadeRate);
+    if (!event.hit) {
+        if (stats) {
+            ++stats->misses;
+        }
+        if (log_) {
+            log_->push_back(event);
+        }
+        return;
+    }
+
+    // Dead targets only take effects (a revive removes the death state first)
+    const std::int32_t type = skill.damage.type;
+    if (type != 0 && !(hitsHp(type) && !alive(target))) {
+        float value = std::max(rules_.formula(skill.id).evaluate(fields(a), fields(b)), 0.f);
+        if (skill.damage.elementId > 0 && static_cast<std::size_t>(skill.damage.elementId) < MaxElements) {
+            value *= b.elementRates[static_cast<std::size_t>(skill.damage.elementId)];
+        }
+        if (skill.damage.critical && a.critical > 0.f && chance() < a.critical) {
+            value *= 3.f;
+            event.critical = true;
+            if (stats) {
+                ++stats->criticals;
+            }
+        }
+        // Bound before the integer conversions: a large formula (mhp * mhp)
+        // would overflow them. A formula that yields NaN/inf does nothing.
+        value = std::isfinite(value) ? std::clamp(value, 0.f, static_cast<float>(DamageCap)) : 0.f;
+        const float variance = static_cast<float>(std::clamp(skill.damage.variance, 0, 100));
+        const auto spread = static_cast<std::uint32_t>(std::floor(value * variance / 100.f));
+        value += static_cast<float>(random(spread + 1)) + static_cast<float>(random(spread + 1)) - static_cast<float>(spread);
+        std::int32_t amount = std::clamp(static_cast<std::int32_t>(std::lround(value)), 0, DamageCap);
+
+        switch (type) {
+        case 1:
+            b.hp -= amount;
+            break;
+        case 2:
+            amount = std::min(amount, b.mp);
+            b.mp -= amount;
+            break;
+        case 3:
+            amount = std::min(amount, b.params[0] - b.hp);
+            b.hp += amount;
+            break;
+        case 4:
+            amount = std::min(amount, b.params[1] - b.mp);
+            b.mp += amount;
+            break;
+        case 5:
+            amount = std::min(amount, b.hp);
+            b.hp -= amount;
+            a.hp = std::min(a.params[0], a.hp + amount);
+            break;
+        case 6:
+            amount = std::min(amount, b.mp);
+            b.mp -= amount;
+            a.mp = std::min(a.params[1], a.mp + amount);
+            break;
+        default:
+            amount = 0;
+            break;
+        }
+        event.value = isRecovery(type) ? -amount : amount;
+        if (stats) {
+            (isRecovery(type) ? stats->healing : stats->damage).add(static_cast<std::uint32_t>(amount));
+        }
+
+        if ((type == 1 || type == 5) && amount > 0) {
+            for (std::size_t i = 0; i < b.stateCount;) {
+                const StateData& state = db_.states()[b.states[i].id];
+                if (state.removeByDamage && random(100) < static_cast<std::uint32_t>(std::max(0, state.chanceByDamage))) {
+                    removeState(b, state.id);
+                } else {
+                    ++i;
+                }
+            }
+            if (b.hp <= 0) {
+                die(b);
+            }
+        }
+    }
+
+    for (const Effect& effect : db_.effects(skill.effects)) {
+        switch (effect.code) {
+        case EffectRecoverHp:
+            if (alive(target)) {
+                const auto amount = static_cast<std::int32_t>(static_cast<float>(b.params[0]) * effect.value1 + effect.value2);
+                b.hp = std::clamp(b.hp + amount, 1, b.params[0]);
+            }
+            break;
+        case EffectRecoverMp: {
+            const auto amount = static_cast<std::int32_t>(static_cast<float>(b.params[1]) * effect.value1 + effect.value2);
+            b.mp = std::clamp(b.mp + amount, 0, b.params[1]);
+            break;
+        }
+        case EffectAddState:
+            if (alive(target) && chance() < effect.value1) {
+                if (effect.dataId == DeathStateId) {
+                    die(b);
+                } else {
+                    addState(b, effect.dataId);
+                }
+            }
+            break;
+        case EffectRemoveState:
+            if (effect.dataId == DeathStateId && !alive(target)) {
+                b.hp = 1;
+            }
+            removeState(b, effect.dataId);
+            break;
+        default:
+            break;
+        }
+    }
+    if (log_) {
+        log_->push_back(event);
+    }
+}
+
+void Battle::addState(Battler& battler, std::int32_t stateId) {
+    const StateData* state = db_.states().find(stateId);
+    if (!state) {
+        return;
+    }
+    const std::int32_t turns =
+        state->minTurns + static_cast<std::int32_t>(random(static_cast<std::uint32_t>(std::max(0, state->maxTurns - state->minTurns)) + 1));
+    for (std::size_t i = 0; i < battler.stateCount; ++i) {
+        if (battler.states[i].id == stateId) {
+            battler.states[i].turns = turns; // Added again: the count starts over
+            return;
+        }
+    }
+    if (battler.stateCount == MaxActiveStates) {
+        return;
+    }
+    battler.states[battler.stateCount++] = {stateId, turns};
+    refresh(battler);
+}
+
+void Battle::removeState(Battler& battler, std::int32_t stateId) {
+    for (std::size_t i = 0; i < battler.stateCount; ++i) {
+        if (battler.states[i].id == stateId) {
+            battler.states[i] = battler.states[--battler.stateCount];
+            refresh(battler);
+            return;
+        }
+    }
+}
+
+void Battle::die(Battler& battler) {
+    battler.hp = 0;
+    battler.tp = 0;
+    battler.stateCount = 0;
+    battler.states[battler.stateCount++] = {DeathStateId, 0};
+    refresh(battler);
+}
+
+void Battle::removeExpiredStates(Battler& battler, std::int32_t timing) {
+    // Auto-removal timing: 1 at the end of the battler's action, 2 at turn end
+    for (std::size_t i = 0; i < battler.stateCount;) {
+        const ActiveState active = battler.states[i];
+        if (db_.states()[active.id].autoRemovalTiming == timing && active.turns <= 0) {
+            removeState(battler, active.id);
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool Battle::playTurn() {
+    if (outcome_ != BattleOutcome::Ongoing) {
+        return false;
+    }
+    ++turn_;
+
+    struct Ordered {
+        std::uint8_t battler;
+        Action action;
+    };
+    std::array<Ordered, MaxBattlers> order{};
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < battlerCount_; ++i) {
+        const Battler& battler = battlers_[i];
+        if (!alive(i) || battler.restriction >= 4) {
+            continue;
+        }
+        Action action = battler.restriction > 0 ? restrictedAction(i) : i < partySize_ ? decideActor(i) : decideEnemy(i);
+        const SkillData* skill = db_.skills().find(action.skillId);
+        if (!skill) {
+            continue;
+        }
+        const std::int32_t agility = std::max(0, battler.params[6]);
+        action.speed = agility + static_cast<std::int32_t>(random(static_cast<std::uint32_t>(5 + agility / 4))) + skill->speed;
+        // Faster first; ties keep battler order
+        std::size_t at = count++;
+        for (; at > 0 && order[at - 1].action.speed < action.speed; --at) {
+            order[at] = order[at - 1];
+        }
+        order[at] = {static_cast<std::uint8_t>(i), action};
+    }
+    chosen_ = {};
+
+    for (std::size_t k = 0; k < count && outcome_ == BattleOutcome::Ongoing; ++k) {
+        const std::size_t user = order[k].battler;
+        if (!alive(user) || battlers_[user].restriction >= 4) {
+            continue;
+        }
+        execute(user, order[k].action);
+        removeExpiredStates(battlers_[user], 1);
+        updateOutcome();
+    }
+    if (outcome_ == BattleOutcome::Ongoing) {
+        endTurn();
+        updateOutcome();
+    }
+    if (outcome_ == BattleOutcome::Ongoing && turn_ >= maxTurns_) {
+        finish(BattleOutcome::Timeout);
+    }
+    return outcome_ == BattleOutcome::Ongoing;
+}
+
+BattleOutcome Battle::run() {
+    while (playTurn()) {
+    }
+    return outcome_;
+}
+
+void Battle::endTurn() {
+    for (std::size_t i = 0; i < battlerCount_; ++i) {
+        if (!alive(i)) {
+            continue;
+        }
+        Battler& battler = battlers_[i];
+        if (battler.hpPerTurn != 0.f) {
+            // Damage over time leaves at least 1 HP
+            const auto delta = static_cast<std::int32_t>(std::lround(static_cast<float>(battler.params[0]) * battler.hpPerTurn));
+            battler.hp = std::clamp(battler.hp + delta, std::min(battler.hp, 1), battler.params[0]);
+        }
+        for (std::size_t s = 0; s < battler.stateCount; ++s) {
+            if (db_.states()[battler.states[s].id].autoRemovalTiming != 0) {
+                --battler.states[s].turns;
+            }
+        }
+        removeExpiredStates(battler, 2);
+    }
+}
+
+void Battle::updateOutcome() {
+    if (outcome_ != BattleOutcome::Ongoing) {
+        return;
+    }
+    bool partyAlive = false;
+    bool troopAlive = false;
+    for (std::size_t i = 0; i < battlerCount_; ++i) {
+        (i < partySize_ ? partyAlive : troopAlive) |= alive(i);
+    }
+    if (!partyAlive) {
+        finish(BattleOutcome::Defeat);
+    } else if (!troopAlive) {
+        finish(BattleOutcome::Victory);
+    }
+}
+
+void Battle::finish(BattleOutcome outcome) {
+    outcome_ = outcome;
+    if (!report_) {
+        return;
+    }
+    ++report_->battles;
+    report_->turns.add(static_cast<std::uint32_t>(turn_));
+    if (outcome_ == BattleOutcome::Victory) {
+        ++report_->victories;
+        std::int64_t hp = 0;
+        std::int64_t maxHp = 0;
+        for (std::size_t i = 0; i < partySize_; ++i) {
+            hp += battlers_[i].hp;
+            maxHp += battlers_[i].params[0];
+        }
+        report_->partyHpLeft.add(static_cast<std::uint32_t>(maxHp > 0 ? hp * 100 / maxHp : 0));
+    } else if (outcome_ == BattleOutcome::Defeat) {
+        ++report_->defeats;
+    } else {
+        ++report_->timeouts;
+    }
+}
+
+SkillStats* Battle::statsFor(std::size_t user, std::int32_t skillId) {
+    if (!report_) {
+        return nullptr;
+    }
+    std::vector<SkillStats>& skills = user < partySize_ ? report_->partySkills : report_->troopSkills;
+    if (skills.size() < db_.skills().size()) {
+        skills.resize(db_.skills().size());
+    }
+    return &skills[static_cast<std::size_t>(skillId)];
+}
+
+// ===== Simulation =====
+
+BattleReport simulateBattles(const BattleRules& rules, const BattleSetup& setup, const SimulationOptions& options) {
+    LUMY_PROFILE_SCOPE("simulateBattles");
+    const auto start = std::chrono::steady_clock::now();
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(
+        std::min<std::uint64_t>(threads, std::max<std::uint64_t>(1, (options.battles + SimulationChunk - 1) / SimulationChunk)));
+
+    // One report per worker, merged at the end: no sharing inside the loop
+    std::vector<BattleReport> reports(threads);
+    std::atomic<std::uint64_t> next{0};
+    const auto work = [&](BattleReport& report) {
+        Battle battle(rules);
+        battle.setReport(&report);
+        for (;;) {
+            const std::uint64_t first = next.fetch_add(SimulationChunk, std::memory_order_relaxed);
+            if (first >= options.battles) {
+                return;
+            }
+            const std::uint64_t last = std::min(options.battles, first + SimulationChunk);
+            for (std::uint64_t i = first; i < last; ++i) {
+                battle.reset(setup, battleSeed(options.seed, i));
+                battle.run();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(work, std::ref(reports[i]));
+    }
+    work(reports[0]);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    BattleReport total;
+    for (const BattleReport& report : reports) {
+        total.merge(report);
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
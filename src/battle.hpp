@@ -0,0 +1,267 @@
+#pragma once
+
+#include "database.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr std::size_t MaxPartySize = 4;
+constexpr std::size_t MaxTroopSize = 8;
+constexpr std::size_t MaxBattlers = MaxPartySize + MaxTroopSize;
+constexpr std::size_t MaxActiveStates = 8;
+constexpr std::size_t MaxElements = 16;
+
+// Trait codes read by the battle rules (traits of enemies and states).
+//   11  element rate      dataId element, value multiplier (0.8 = takes 80%)
+//   22  ex-parameter      dataId 0 hit, 1 evasion, 2 critical, 4 magic evasion
+//   31  HP per turn       value in percent of max HP (-10 = poison)
+constexpr std::int32_t TraitElementRate = 11;
+constexpr std::int32_t TraitExParam = 22;
+constexpr std::int32_t TraitHpPerTurn = 31;
+
+// Effect codes applied by skills after the damage.
+//   11 recover HP (value1 rate of max, value2 flat), 12 recover MP,
+//   21 add state (dataId, value1 chance), 22 remove state
+constexpr std::int32_t EffectRecoverHp = 11;
+constexpr std::int32_t EffectRecoverMp = 12;
+constexpr std::int32_t EffectAddState = 21;
+constexpr std::int32_t EffectRemoveState = 22;
+
+// State given to battlers at 0 HP.
+constexpr std::int32_t DeathStateId = 1;
+
+// Damage formula compiled to a small stack program, so evaluating it in the
+// inner loop of a simulation costs a few dozen instructions.
+//
+// Grammar: numbers, a.<field> (user) and b.<field> (target), + - * / with
+// parentheses and unary minus, and min(x, y), max(x, y), floor(x) (a "Math."
+// prefix is accepted). Fields: mhp mmp atk def mat mdf agi luk hp mp tp level.
+class DamageFormula {
+public:
+    enum class Field : std::uint8_t { Mhp, Mmp, Atk, Def, Mat, Mdf, Agi, Luk, Hp, Mp, Tp, Level, Count };
+    using Fields = std::array<float, static_cast<std::size_t>(Field::Count)>;
+
+    // Empty formula (evaluates to 0) when the text doesn't parse; error says why.
+    static DamageFormula compile(std::string_view text, std::string* error = nullptr);
+
+    bool empty() const { return code_.empty(); }
+    float evaluate(const Fields& a, const Fields& b) const;
+
+private:
+    enum class Op : std::uint8_t { Push, LoadA, LoadB, Add, Sub, Mul, Div, Neg, Min, Max, Floor };
+    struct Instruction {
+        Op op;
+        std::uint8_t field;
+        float value;
+    };
+    static constexpr std::size_t MaxStack = 32;
+
+    class Parser;
+    std::vector<Instruction> code_;
+};
+
+// Read-only combat data built once from a Database (compiled damage formulas,
+// the party's skill list). Shared by any number of battles and threads.
+class BattleRules {
+public:
+    explicit BattleRules(const Database& db);
+
+    const Database& database() const { return db_; }
+    const DamageFormula& formula(int skillId) const { return formulas_[static_cast<std::size_t>(skillId)]; }
+    // Skills the party picks from: the attack skill, then system magicSkillIds
+    // (actors.json has no per-actor skill lists yet).
+    const std::vector<std::int32_t>& partySkills() const { return partySkills_; }
+
+private:
+    const Database& db_;
+    std::vector<DamageFormula> formulas_; // By skill id
+    std::vector<std::int32_t> partySkills_;
+};
+
+struct BattleSetup {
+    struct Member {
+        std::int32_t actorId = 0;
+        std::int32_t level = 1;
+    };
+    std::vector<Member> party; // Up to MaxPartySize
+    std::vector<std::int32_t> troop; // Enemy ids, up to MaxTroopSize
+    int maxTurns = 100; // Still undecided after this many turns: timeout
+};
+
+enum class BattleOutcome : std::uint8_t { Ongoing, Victory, Defeat, Timeout };
+
+// One skill use on one target, for logs and statistics.
+struct BattleEvent {
+    std::uint8_t user = 0; // Battler indices (party first, then troop)
+    std::uint8_t target = 0;
+    std::int32_t skillId = 0;
+    std::int32_t value = 0; // Damage (positive) or recovery (negative)
+    bool hit = false;
+    bool critical = false;
+};
+
+// Counts of non-negative integer samples (damage, turns), exact per value.
+class Histogram {
+public:
+    void add(std::uint32_t value);
+    void merge(const Histogram& other);
+
+    std::uint64_t count() const { return count_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+    std::uint32_t min() const;
+    std::uint32_t max() const;
+    // Smallest value with at least p (0..1) of the samples at or below it.
+    std::uint32_t percentile(double p) const;
+    const std::vector<std::uint64_t>& counts() const { return counts_; }
+
+private:
+    std::vector<std::uint64_t> counts_; // By value
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+};
+
+// Per skill, per side: how it landed and what it did.
+struct SkillStats {
+    std::uint64_t uses = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t criticals = 0;
+    Histogram damage; // HP or MP damage of each hit
+    Histogram healing;
+
+    void merge(const SkillStats& other);
+};
+
+struct BattleReport {
+    std::uint64_t battles = 0;
+    std::uint64_t victories = 0;
+    std::uint64_t defeats = 0;
+    std::uint64_t timeouts = 0;
+    Histogram turns;
+    Histogram partyHpLeft; // Percent of the party's max HP, after victories
+    std::vector<SkillStats> partySkills; // By skill id
+    std::vector<SkillStats> troopSkills;
+    double seconds = 0.0;
+
+    double winRate() const { return battles ? static_cast<double>(victories) / static_cast<double>(battles) : 0.0; }
+    void merge(const BattleReport& other);
+};
+
+// One turn-based battle, no rendering: every battler picks an action, actions
+// run in speed order, states tick at action and turn end. Given the same
+// rules, setup and seed the battle always plays out the same way.
+//
+// Actors act on their own (heal a hurt ally, otherwise the strongest hit on
+// the weakest enemy) unless setAction() picked something for this turn;
+// enemies follow their action patterns and ratings.
+class Battle {
+public:
+    explicit Battle(const BattleRules& rules);
+
+    // Starts over; the object can be reused for many battles without allocating.
+    void reset(const BattleSetup& setup, std::uint32_t seed);
+    // Plays one turn. False once the battle is over.
+    bool playTurn();
+    // Plays to the end.
+    BattleOutcome run();
+
+    // Chosen action of a party member for the next turn (by the battle scene).
+    void setAction(std::size_t member, std::int32_t skillId, std::size_t target);
+
+    BattleOutcome outcome() const { return outcome_; }
+    int turn() const { return turn_; }
+    std::size_t partySize() const { return partySize_; }
+    std::size_t troopSize() const { return battlerCount_ - partySize_; }
+    std::int32_t hp(std::size_t battler) const { return battlers_[battler].hp; }
+    std::int32_t mp(std::size_t battler) const { return battlers_[battler].mp; }
+    bool alive(std::size_t battler) const;
+    bool hasState(std::size_t battler, std::int32_t stateId) const;
+
+    // Optional sinks, left untouched by reset(): events are appended as they
+    // happen, statistics are added to the report.
+    void setLog(std::vector<BattleEvent>* log) { log_ = log; }
+    void setReport(BattleReport* report) { report_ = report; }
+
+private:
+    struct ActiveState {
+        std::int32_t id = 0;
+        std::int32_t turns = 0;
+    };
+    struct Battler {
+        bool actor = false;
+        std::int32_t id = 0;
+        std::int32_t level = 1;
+        ParamSet params{};
+        std::int32_t hp = 0;
+        std::int32_t mp = 0;
+        std::int32_t tp = 0;
+        std::array<ActiveState, MaxActiveStates> states{};
+        std::uint8_t stateCount = 0;
+        // From enemy and state traits, refreshed when states change
+        float hit = 1.f;
+        float evasion = 0.f;
+        float critical = 0.f;
+        float magicEvasion = 0.f;
+        float hpPerTurn = 0.f;
+        std::int32_t restriction = 0;
+        std::array<float, MaxElements> elementRates{};
+    };
+    struct Action {
+        std::int32_t skillId = 0;
+        std::int32_t target = -1; // -1: pick when acting
+        std::int32_t speed = 0;
+    };
+
+    std::uint32_t random(std::uint32_t n); // [0, n)
+    float chance();                        // [0, 1)
+
+    void refresh(Battler& battler) const;
+    DamageFormula::Fields fields(const Battler& battler) const;
+    bool canUse(const Battler& battler, const SkillData& skill) const;
+    bool opponents(std::size_t a, std::size_t b) const { return (a < partySize_) != (b < partySize_); }
+
+    Action decideActor(std::size_t index);
+    Action decideEnemy(std::size_t index);
+    Action restrictedAction(std::size_t index);
+    std::int32_t randomTarget(std::size_t user, bool enemies, bool dead);
+    void execute(std::size_t user, const Action& action);
+    void apply(std::size_t user, std::size_t target, const SkillData& skill);
+    float expected(std::size_t user, std::size_t target, const SkillData& skill) const;
+
+    void addState(Battler& battler, std::int32_t stateId);
+    void removeState(Battler& battler, std::int32_t stateId);
+    void die(Battler& battler);
+    void removeExpiredStates(Battler& battler, std::int32_t timing);
+    void endTurn();
+    void updateOutcome();
+    void finish(BattleOutcome outcome);
+    SkillStats* statsFor(std::size_t user, std::int32_t skillId);
+
+    const BattleRules& rules_;
+    const Database& db_;
+    std::mt19937 rng_;
+    std::array<Battler, MaxBattlers> battlers_{};
+    std::array<Action, MaxPartySize> chosen_{};
+    std::size_t partySize_ = 0;
+    std::size_t battlerCount_ = 0;
+    int turn_ = 0;
+    int maxTurns_ = 100;
+    BattleOutcome outcome_ = BattleOutcome::Ongoing;
+    std::vector<BattleEvent>* log_ = nullptr;
+    BattleReport* report_ = nullptr;
+};
+
+struct SimulationOptions {
+    std::uint64_t battles = 10000;
+    std::uint32_t seed = 1;
+    unsigned threads = 0; // 0: one per hardware thread
+};
+
+// Plays options.battles battles across worker threads. Battle i is seeded
+// from (seed, i) alone, so the report doesn't depend on the thread count.
+BattleReport simulateBattles(const BattleRules& rules, const BattleSetup& setup, const SimulationOptions& options);
@@ -0,0 +1,178 @@
+// src/battle_sim_main.cpp
+// lumy-battle: simula milhares de batalhas com os dados de game/data para
+// balanceamento.
+//   lumy-battle --troop 1,2,3 [--party 1:5,...] [--battles N] [--seed S]
+//               [--threads T] [--max-turns N] [--data dir] [--json saída.json]
+#include "battle.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using json = nlohmann::json;
+
+namespace {
+
+void usage() {
+    std::cerr << "Uso: lumy-battle --troop <id,id,...> [--party <ator:nível,...>] [--battles N] [--seed S]\n"
+                 "                 [--threads T] [--max-turns N] [--data <diretório>] [--json <saída.json>]\n";
+}
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    for (std::string part; std::getline(stream, part, separator);) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+json histogramJson(const Histogram& histogram) {
+    return {{"count", histogram.count()},          {"mean", histogram.mean()},
+            {"min", histogram.min()},              {"p50", histogram.percentile(0.5)},
+            {"p90", histogram.percentile(0.9)},    {"p99", histogram.percentile(0.99)},
+            {"max", histogram.max()},              {"counts", histogram.counts()}};
+}
+
+json skillsJson(const Database& db, const std::vector<SkillStats>& skills) {
+    json out = json::array();
+    for (std::size_t id = 0; id < skills.size(); ++id) {
+        const SkillStats& stats = skills[id];
+        if (stats.uses == 0) {
+            continue;
+        }
+        out.push_back({{"id", id},
+                       {"name", db.text(db.skills()[static_cast<int>(id)].name)},
+                       {"uses", stats.uses},
+                       {"misses", stats.misses},
+                       {"criticals", stats.criticals},
+                       {"damage", histogramJson(stats.damage)},
+                       {"healing", histogramJson(stats.healing)}});
+    }
+    return out;
+}
+
+void printSkills(const Database& db, const char* side, const std::vector<SkillStats>& skills) {
+    for (std::size_t id = 0; id < skills.size(); ++id) {
+        const SkillStats& stats = skills[id];
+        if (stats.uses == 0) {
+            continue;
+        }
+        const Histogram& values = stats.damage.count() ? stats.damage : stats.healing;
+        std::cout << "  [" << side << "] " << std::left << std::setw(16) << db.text(db.skills()[static_cast<int>(id)].name)
+                  << std::right << " usos " << std::setw(9) << stats.uses << "  erros " << std::setw(5) << std::fixed
+                  << std::setprecision(1) << 100.0 * static_cast<double>(stats.misses) / static_cast<double>(stats.uses)
+                  << "%  " << (stats.damage.count() ? "dano" : "cura") << " média " << std::setw(7) << values.mean()
+                  << "  p50 " << values.percentile(0.5) << "  p90 " << values.percentile(0.9) << "  máx " << values.max()
+                  << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BattleSetup setup;
+    SimulationOptions options;
+    std::string dataDirectory = "game/data";
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--troop") {
+            for (const std::string& id : split(value, ',')) {
+                setup.troop.push_back(std::atoi(id.c_str()));
+            }
+        } else if (arg == "--party") {
+            for (const std::string& member : split(value, ',')) {
+                const auto colon = member.find(':');
+                setup.party.push_back({std::atoi(member.substr(0, colon).c_str()),
+                                       colon == std::string::npos ? 1 : std::atoi(member.substr(colon + 1).c_str())});
+            }
+        } else if (arg == "--battles") {
+            options.battles = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--max-turns") {
+            setup.maxTurns = std::atoi(value.c_str());
+        } else if (arg == "--data") {
+            dataDirectory = value;
+        } else if (arg == "--json") {
+            jsonPath = value;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (setup.troop.empty()) {
+        usage();
+        return 1;
+    }
+
+    Database db;
+    if (!db.load(dataDirectory)) {
+        std::cerr << "[lumy-battle] Falha ao carregar " << dataDirectory << "\n";
+        return 1;
+    }
+    // Sem --party: o grupo inicial de system.json no nível inicial de cada ator
+    if (setup.party.empty()) {
+        for (const std::int32_t id : db.ids(db.system().partyMembers)) {
+            if (const ActorData* actor = db.actors().find(id)) {
+                setup.party.push_back({id, actor->initialLevel});
+            }
+        }
+    }
+
+    const BattleRules rules(db);
+    const BattleReport report = simulateBattles(rules, setup, options);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "[lumy-battle] " << report.battles << " batalhas em " << std::setprecision(2) << report.seconds
+              << " s (" << std::setprecision(0) << static_cast<double>(report.battles) / std::max(report.seconds, 1e-9)
+              << " por segundo)\n"
+              << std::setprecision(1) << "  Vitórias " << 100.0 * report.winRate() << "%  derrotas "
+              << 100.0 * static_cast<double>(report.defeats) / static_cast<double>(std::max<std::uint64_t>(1, report.battles))
+              << "%  tempo esgotado "
+              << 100.0 * static_cast<double>(report.timeouts) / static_cast<double>(std::max<std::uint64_t>(1, report.battles))
+              << "%\n"
+              << "  Turnos: média " << report.turns.mean() << "  p50 " << report.turns.percentile(0.5) << "  p90 "
+              << report.turns.percentile(0.9) << "  máx " << report.turns.max() << "\n"
+              << "  PV do grupo ao vencer: média " << report.partyHpLeft.mean() << "%  p10 "
+              << report.partyHpLeft.percentile(0.1) << "%\n";
+    printSkills(db, "grupo", report.partySkills);
+    printSkills(db, "inimigos", report.troopSkills);
+
+    if (!jsonPath.empty()) {
+        json out = {{"battles", report.battles},
+                    {"seed", options.seed},
+                    {"seconds", report.seconds},
+                    {"victories", report.victories},
+                    {"defeats", report.defeats},
+                    {"timeouts", report.timeouts},
+                    {"winRate", report.winRate()},
+                    {"turns", histogramJson(report.turns)},
+                    {"partyHpLeft", histogramJson(report.partyHpLeft)},
+                    {"partySkills", skillsJson(db, report.partySkills)},
+                    {"troopSkills", skillsJson(db, report.troopSkills)}};
+        std::ofstream file(jsonPath);
+        if (!file.is_open()) {
+            std::cerr << "[lumy-battle] Falha ao gravar " << jsonPath << "\n";
+            return 1;
+        }
+        file << out.dump(2) << "\n";
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "boot_scene.hpp"
 #include "title_scene.hpp"
+#include "render_commands.hpp"
 #include <iostream>
 #include <memory>
 
@@ -18,7 +19,11 @@ void BootScene::update(float) {
     }
 }
 
-void BootScene::draw(sf::RenderWindow& target) const {
+void BootScene::draw(sf::RenderTarget& target) const {
     map_.draw(target);
 }
 
+void BootScene::record(RenderCommandList& commands, float) const {
+    map_.recordRange(0, map_.getLayerCount(), commands);
+}
+
@@ -11,7 +11,8 @@ public:
 
     void handleEvent(const sf::Event& event) override;
     void update(float deltaTime) override;
-    void draw(sf::RenderWindow& window) const override;
+    void draw(sf::RenderTarget& target) const override;
+    void record(RenderCommandList& commands, float alpha) const override;
 
 private:
     SceneStack& stack_;
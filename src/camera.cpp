@@ -0,0 +1,140 @@
+#include "camera.hpp"
+
+#include <SFML/Graphics/Sprite.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+Camera::Camera(sf::Vector2f viewSize) : viewSize_(viewSize) {}
+
+void Camera::setWorldBounds(const sf::FloatRect& bounds) {
+    bounds_ = bounds;
+    goal_ = clamp(goal_);
+    center_ = clamp(center_);
+    previousCenter_ = clamp(previousCenter_);
+}
+
+void Camera::setDeadzone(sf::Vector2f size) {
+    deadzone_ = {std::max(size.x, 0.f), std::max(size.y, 0.f)};
+}
+
+void Camera::setSmoothing(float halfLife) {
+    halfLife_ = std::max(halfLife, 0.f);
+}
+
+void Camera::snapTo(sf::Vector2f target) {
+    goal_ = clamp(target);
+    center_ = goal_;
+    previousCenter_ = goal_;
+}
+
+void Camera::update(sf::Vector2f target, float deltaTime) {
+    previousCenter_ = center_;
+
+    // Push the goal only as far as needed to keep the target in the deadzone
+    const sf::Vector2f half = deadzone_ / 2.f;
+    const sf::Vector2f offset = target - goal_;
+    if (offset.x > half.x) {
+        goal_.x = target.x - half.x;
+    } else if (offset.x < -half.x) {
+        goal_.x = target.x + half.x;
+    }
+    if (offset.y > half.y) {
+        goal_.y = target.y - half.y;
+    } else if (offset.y < -half.y) {
+        goal_.y = target.y + half.y;
+    }
+    goal_ = clamp(goal_);
+
+    if (halfLife_ <= 0.f) {
+        center_ = goal_;
+        return;
+    }
+    // Exponential decay is frame-rate independent: two half steps land where
+    // one full step does
+    const float blend = 1.f - std::exp2(-deltaTime / halfLife_);
+    center_ += (goal_ - center_) * blend;
+}
+
+sf::View Camera::view(float alpha) const {
+    return sf::View(visibleRect(alpha));
+}
+
+sf::FloatRect Camera::visibleRect(float alpha) const {
+    const sf::Vector2f topLeft = interpolatedCenter(alpha) - viewSize_ / 2.f;
+    return {{std::round(topLeft.x), std::round(topLeft.y)}, viewSize_};
+}
+
+sf::Vector2f Camera::clamp(sf::Vector2f center) const {
+    if (!bounds_) {
+        return center;
+    }
+    const auto axis = [](float value, float start, float length, float view) {
+        if (length <= view) {
+            return start + length / 2.f; // Smaller than the view: centered
+        }
+        return std::clamp(value, start + view / 2.f, start + length - view / 2.f);
+    };
+    return {axis(center.x, bounds_->position.x, bounds_->size.x, viewSize_.x),
+            axis(center.y, bounds_->position.y, bounds_->size.y, viewSize_.y)};
+}
+
+sf::Vector2f Camera::interpolatedCenter(float alpha) const {
+    return previousCenter_ + (center_ - previousCenter_) * alpha;
+}
+
+sf::RenderTexture& LowResTarget::begin(sf::Color clearColor) {
+    if (!ready_) {
+        ready_ = true;
+        if (!texture_.resize(size_)) {
+            std::cerr << "[LowResTarget] Falha ao criar textura " << size_.x << "x" << size_.y << "\n";
+        }
+        texture_.setSmooth(false);
+    }
+    texture_.clear(clearColor);
+    return texture_;
+}
+
+void LowResTarget::present(sf::RenderTarget& target) const {
+    if (!ready_) {
+        return;
+    }
+    const sf::Vector2u window = target.getSize();
+    const sf::FloatRect area = viewportFor(size_, window);
+    const float scale = scaleFor(size_, window);
+
+    sf::Sprite sprite(texture_.getTexture());
+    sprite.setScale({scale, scale});
+    sprite.setPosition(area.position);
+
+    // Window pixels, whatever view the target had
+    const sf::View previous = target.getView();
+    target.setView(sf::View(sf::FloatRect({0.f, 0.f}, {static_cast<float>(window.x), static_cast<float>(window.y)})));
+    target.draw(sprite);
+    target.setView(previous);
+}
+
+float LowResTarget::scaleFor(sf::Vector2u internal, sf::Vector2u window) {
+    if (internal.x == 0 || internal.y == 0 || window.x == 0 || window.y == 0) {
+        return 1.f;
+    }
+    const float fit = std::min(static_cast<float>(window.x) / static_cast<float>(internal.x),
+                               static_cast<float>(window.y) / static_cast<float>(internal.y));
+    return fit >= 1.f ? std::floor(fit) : fit;
+}
+
+sf::FloatRect LowResTarget::viewportFor(sf::Vector2u internal, sf::Vector2u window) {
+    const float scale = scaleFor(internal, window);
+    const sf::Vector2f scaled{static_cast<float>(internal.x) * scale, static_cast<float>(internal.y) * scale};
+    const sf::Vector2f offset{std::floor((static_cast<float>(window.x) - scaled.x) / 2.f),
+                              std::floor((static_cast<float>(window.y) - scaled.y) / 2.f)};
+    return {offset, scaled};
+}
+
+sf::Vector2f LowResTarget::toInternal(sf::Vector2i windowPixel, sf::Vector2u windowSize) const {
+    const sf::FloatRect area = viewportFor(size_, windowSize);
+    const float scale = scaleFor(size_, windowSize);
+    return {(static_cast<float>(windowPixel.x) - area.position.x) / scale,
+            (static_cast<float>(windowPixel.y) - area.position.y) / scale};
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <optional>
+
+// 2D camera that follows a target. The target can move freely inside the
+// deadzone (centered on the screen); once it leaves, the camera's goal is
+// pushed just enough to bring it back, and the center eases towards that
+// goal. The view never shows anything outside the world bounds.
+//
+// update() runs on the fixed simulation step; view(alpha) blends the last two
+// steps like the rest of the interpolated rendering.
+class Camera {
+public:
+    explicit Camera(sf::Vector2f viewSize);
+
+    // Map area in pixels. Worlds smaller than the view are centered.
+    void setWorldBounds(const sf::FloatRect& bounds);
+    void setDeadzone(sf::Vector2f size);
+    // Time for the camera to cover half the distance to its goal; 0 disables
+    // smoothing.
+    void setSmoothing(float halfLife);
+
+    // Jumps straight to the target (spawn, teleports, loaded saves).
+    void snapTo(sf::Vector2f target);
+    void update(sf::Vector2f target, float deltaTime);
+
+    sf::Vector2f center() const { return center_; }
+    sf::Vector2f viewSize() const { return viewSize_; }
+    // View at alpha between the last two updates. The top-left corner is
+    // snapped to whole pixels so tiles don't shimmer in the low-res target.
+    sf::View view(float alpha = 1.f) const;
+    sf::FloatRect visibleRect(float alpha = 1.f) const;
+
+private:
+    sf::Vector2f clamp(sf::Vector2f center) const;
+    sf::Vector2f interpolatedCenter(float alpha) const;
+
+    sf::Vector2f viewSize_;
+    std::optional<sf::FloatRect> bounds_;
+    sf::Vector2f deadzone_;
+    float halfLife_ = 0.f;
+
+    sf::Vector2f goal_;
+    sf::Vector2f center_;
+    sf::Vector2f previousCenter_;
+};
+
+// Fixed-resolution render target for the world. Scenes draw into it and
+// present() upscales it to the window by the largest whole factor that fits,
+// centered with black bars, so pixel art stays crisp and the fill cost is the
+// same at 720p and 4K.
+class LowResTarget {
+public:
+    explicit LowResTarget(sf::Vector2u size) : size_(size) {}
+
+    sf::Vector2u size() const { return size_; }
+
+    // Cleared texture to draw the world into. Created on first use, since
+    // scenes may be built away from the render thread.
+    sf::RenderTexture& begin(sf::Color clearColor = sf::Color::Black);
+    // Draws the finished texture onto target; leaves target's view untouched.
+    void present(sf::RenderTarget& target) const;
+
+    // Whole-number scale for a window (never below 1 unless the window is
+    // smaller than the internal size, in which case it shrinks to fit).
+    static float scaleFor(sf::Vector2u internal, sf::Vector2u window);
+    // Area of a window of the given size covered by the upscaled image.
+    static sf::FloatRect viewportFor(sf::Vector2u internal, sf::Vector2u window);
+    // Maps a window pixel to internal-resolution coordinates.
+    sf::Vector2f toInternal(sf::Vector2i windowPixel, sf::Vector2u windowSize) const;
+
+private:
+    sf::Vector2u size_;
+    sf::RenderTexture texture_;
+    bool ready_ = false;
+};
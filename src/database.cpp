@@ -0,0 +1,587 @@
+#include "database.hpp"
+#include "profiler.hpp"
+#include "save_codec.hpp"
+#include "vfs.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr std::uint8_t CacheMagic[4] = {'L', 'D', 'B', 'C'};
+constexpr std::uint16_t CacheVersion = 1;
+// magic[4] | version u16 | reserved u16 | source hash u64 | layout u64
+constexpr std::size_t CacheHeaderSize = 24;
+
+constexpr const char* SourceFiles[] = {"actors.json", "items.json",   "skills.json",
+                                       "states.json", "enemies.json", "system.json"};
+constexpr int MaxLevelLimit = 999;
+// Tables and name lists are sized to their highest id: a typo'd id must not
+// turn into a multi-gigabyte allocation
+constexpr int MaxTableId = 9999;
+
+// FNV-1a, 64 bits
+constexpr std::uint64_t FnvOffset = 14695981039346656037ull;
+constexpr std::uint64_t FnvPrime = 1099511628211ull;
+
+std::uint64_t fnv1a(std::uint64_t hash, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * FnvPrime;
+    }
+    return hash;
+}
+
+// Row sizes; a cache written by a build with different structs is rejected
+std::uint64_t layoutHash() {
+    const std::size_t sizes[] = {sizeof(ActorData), sizeof(ItemData),    sizeof(SkillData), sizeof(StateData),
+                                 sizeof(EnemyData), sizeof(SystemData),  sizeof(Effect),    sizeof(Trait),
+                                 sizeof(DropItem),  sizeof(EnemyAction), sizeof(ParamSet)};
+    return fnv1a(FnvOffset, sizes, sizeof(sizes));
+}
+
+// Sources come through the Vfs (archive or loose files); the cache is always on disk
+bool readSource(const std::filesystem::path& path, std::string& out) {
+    const FileData file = Vfs::instance().read(path);
+    if (!file) {
+        return false;
+    }
+    out.assign(file.text());
+    return true;
+}
+
+bool readFile(const std::filesystem::path& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+std::int32_t clampToInt32(std::int64_t value) {
+    return static_cast<std::int32_t>(std::clamp<std::int64_t>(value, std::numeric_limits<std::int32_t>::min(),
+                                                              std::numeric_limits<std::int32_t>::max()));
+}
+
+ItemType parseItemType(const std::string& type) {
+    if (type == "weapon") {
+        return ItemType::Weapon;
+    }
+    if (type == "armor") {
+        return ItemType::Armor;
+    }
+    if (type == "key") {
+        return ItemType::Key;
+    }
+    return ItemType::Consumable;
+}
+
+ParamSet parseParams(const json& values) {
+    ParamSet params{};
+    if (!values.is_array()) {
+        return params;
+    }
+    for (std::size_t i = 0; i < ParamCount && i < values.size(); ++i) {
+        params[i] = values[i].get<std::int32_t>();
+    }
+    return params;
+}
+
+int checkedId(int id) {
+    if (id > MaxTableId) {
+        throw std::out_of_range("id " + std::to_string(id) + " acima do limite " + std::to_string(MaxTableId));
+    }
+    return id;
+}
+
+// Rows of a table array, sized to the highest id
+template <typename Row>
+std::vector<Row> rowsFor(const json& entries) {
+    int maxId = 0;
+    for (const auto& entry : entries) {
+        maxId = std::max(maxId, checkedId(entry.value("id", 0)));
+    }
+    return std::vector<Row>(static_cast<std::size_t>(maxId) + 1);
+}
+
+template <typename T>
+void writeSection(ByteBuffer& out, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    writeLE(out, values.size(), 4);
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(values.data());
+    out.insert(out.end(), bytes, bytes + values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readSection(const ByteBuffer& in, std::size_t& pos, std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (pos + 4 > in.size()) {
+        return false;
+    }
+    const std::uint64_t count = readLE(in.data() + pos, 4);
+    pos += 4;
+    if (count > (in.size() - pos) / sizeof(T)) {
+        return false;
+    }
+    values.resize(count);
+    std::memcpy(values.data(), in.data() + pos, count * sizeof(T));
+    pos += count * sizeof(T);
+    return true;
+}
+
+} // namespace
+
+bool Database::load(const std::filesystem::path& dataDirectory, const std::filesystem::path& cachePath) {
+    LUMY_PROFILE_SCOPE("Database::load");
+    clear();
+
+    // The key covers every source file, so any edit invalidates the cache
+    std::uint64_t hash = fnv1a(FnvOffset, &CacheVersion, sizeof(CacheVersion));
+    bool anyFile = false;
+    for (const char* name : SourceFiles) {
+        std::string contents;
+        const bool found = readSource(dataDirectory / name, contents);
+        anyFile = anyFile || found;
+        hash = fnv1a(hash, name, std::strlen(name));
+        const std::uint64_t size = found ? contents.size() : std::numeric_limits<std::uint64_t>::max();
+        hash = fnv1a(hash, &size, sizeof(size));
+        hash = fnv1a(hash, contents.data(), contents.size());
+    }
+    if (!anyFile) {
+        std::cerr << "[Database] Nenhum arquivo de dados em " << dataDirectory.string() << "\n";
+        return false;
+    }
+    sourceHash_ = hash;
+
+    const std::filesystem::path cache =
+        cachePath.empty() ? dataDirectory.parent_path() / "cache" / "database.ldb" : cachePath;
+    if (readCache(cache)) {
+        fromCache_ = true;
+        return true;
+    }
+
+    clear();
+    sourceHash_ = hash;
+    if (!parse(dataDirectory)) {
+        clear();
+        return false;
+    }
+    if (!writeCache(cache)) {
+        std::cerr << "[Database] Falha ao gravar cache: " << cache.string() << "\n";
+    }
+    return true;
+}
+
+void Database::clear() {
+    *this = Database{};
+    textPool_.push_back('\0'); // TextId 0 is ""
+}
+
+std::string_view Database::text(TextId id) const {
+    if (id >= textPool_.size()) {
+        return {};
+    }
+    return textPool_.data() + id;
+}
+
+TextId Database::intern(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    const auto [it, inserted] = interned_.try_emplace(std::string(text), static_cast<TextId>(textPool_.size()));
+    if (inserted) {
+        textPool_.append(text);
+        textPool_.push_back('\0');
+    }
+    return it->second;
+}
+
+const ParamSet& Database::actorParams(const ActorData& actor, int level) const {
+    level = std::clamp(level, 1, actor.maxLevel);
+    return actorParams_[actor.curve + static_cast<std::size_t>(level - 1)];
+}
+
+std::int32_t Database::expForLevel(const ActorData& actor, int level) const {
+    level = std::clamp(level, 1, actor.maxLevel);
+    return actorExp_[actor.curve + static_cast<std::size_t>(level - 1)];
+}
+
+bool Database::parse(const std::filesystem::path& dataDirectory) {
+    LUMY_PROFILE_SCOPE("Database::parse");
+    std::unordered_map<std::string, json> documents;
+    for (const char* name : SourceFiles) {
+        std::string contents;
+        if (!readSource(dataDirectory / name, contents)) {
+            std::cerr << "[Database] Arquivo ausente (tabela vazia): " << name << "\n";
+            documents[name] = json::object();
+            continue;
+        }
+        documents[name] = json::parse(contents, nullptr, false);
+        if (documents[name].is_discarded()) {
+            std::cerr << "[Database] JSON inválido: " << name << "\n";
+            return false;
+        }
+    }
+
+    const auto addEffects = [this](const json& entries) {
+        IndexRange range{static_cast<std::uint32_t>(effects_.size()), 0};
+        for (const auto& entry : entries) {
+            effects_.push_back({entry.value("code", 0), entry.value("dataId", 0), entry.value("value1", 0.f),
+                                entry.value("value2", 0.f)});
+            ++range.count;
+        }
+        return range;
+    };
+    const auto addTraits = [this](const json& entries) {
+        IndexRange range{static_cast<std::uint32_t>(traits_.size()), 0};
+        for (const auto& entry : entries) {
+            traits_.push_back({entry.value("code", 0), entry.value("dataId", 0), entry.value("value", 0.f)});
+            ++range.count;
+        }
+        return range;
+    };
+    const auto addIds = [this](const json& entries) {
+        IndexRange range{static_cast<std::uint32_t>(ids_.size()), 0};
+        for (const auto& entry : entries) {
+            ids_.push_back(entry.get<std::int32_t>());
+            ++range.count;
+        }
+        return range;
+    };
+    const auto addTexts = [this](const json& entries) {
+        IndexRange range{static_cast<std::uint32_t>(textLists_.size()), 0};
+        if (entries.is_array()) {
+            for (const auto& entry : entries) {
+                textLists_.push_back(intern(entry.get<std::string>()));
+                ++range.count;
+            }
+        } else if (entries.is_object()) {
+            // {"id": "name"}: one slot per id up to the highest
+            int maxId = 0;
+            for (const auto& [key, value] : entries.items()) {
+                maxId = std::max(maxId, checkedId(std::atoi(key.c_str())));
+            }
+            range.count = static_cast<std::uint32_t>(maxId) + 1;
+            textLists_.resize(textLists_.size() + range.count, 0);
+            for (const auto& [key, value] : entries.items()) {
+                const int id = std::atoi(key.c_str());
+                if (id > 0) {
+                    textLists_[range.first + static_cast<std::size_t>(id)] = intern(value.get<std::string>());
+                }
+            }
+        }
+        return range;
+    };
+    const json empty = json::array();
+    const auto list = [&empty](const json& object, const char* key) -> const json& {
+        const auto it = object.find(key);
+        return it != object.end() && it->is_array() ? *it : empty;
+    };
+
+    try {
+        const json& actors = list(documents["actors.json"], "actors");
+        actors_.rows_ = rowsFor<ActorData>(actors);
+        for (const auto& entry : actors) {
+            ActorData actor;
+            actor.id = entry.value("id", 0);
+            if (actor.id <= 0) {
+                continue;
+            }
+            actor.name = intern(entry.value("name", ""));
+            actor.nickname = intern(entry.value("nickname", ""));
+            actor.profile = intern(entry.value("profile", ""));
+            actor.classId = entry.value("classId", 0);
+            actor.maxLevel = std::clamp(entry.value("maxLevel", 99), 1, MaxLevelLimit);
+            actor.initialLevel = std::clamp(entry.value("initialLevel", 1), 1, actor.maxLevel);
+            actor.curve = static_cast<std::uint32_t>(actorParams_.size());
+
+            // Stats per level: listed values first, then the last step repeated
+            const json& params = list(entry, "params");
+            for (int level = 1; level <= actor.maxLevel; ++level) {
+                ParamSet row{};
+                for (std::size_t p = 0; p < ParamCount && p < params.size(); ++p) {
+                    const json& values = params[p];
+                    const auto known = static_cast<int>(values.size());
+                    if (known == 0) {
+                        continue;
+                    }
+                    if (level <= known) {
+                        row[p] = values[level - 1].get<std::int32_t>();
+                        continue;
+                    }
+                    const std::int64_t last = values[known - 1].get<std::int64_t>();
+                    const std::int64_t step = known > 1 ? last - values[known - 2].get<std::int64_t>() : 0;
+                    row[p] = clampToInt32(last + step * (level - known));
+                }
+                actorParams_.push_back(row);
+            }
+
+            // Exp per level: listed points, linear between them, and past the
+            // last one each step grows by as much as the last step grew
+            std::vector<std::int64_t> exp(static_cast<std::size_t>(actor.maxLevel), -1);
+            exp[0] = 0;
+            for (const auto& point : list(entry, "exp")) {
+                const int level = point.value("level", 0);
+                if (level >= 1 && level <= actor.maxLevel) {
+                    exp[static_cast<std::size_t>(level - 1)] = point.value("exp", 0);
+                }
+            }
+            std::size_t known = 0;
+            for (std::size_t i = 1; i < exp.size(); ++i) {
+                if (exp[i] < 0) {
+                    continue;
+                }
+                for (std::size_t j = known + 1; j < i; ++j) {
+                    exp[j] = exp[known] + (exp[i] - exp[known]) * static_cast<std::int64_t>(j - known) /
+                                              static_cast<std::int64_t>(i - known);
+                }
+                known = i;
+            }
+            std::int64_t step = known > 0 ? exp[known] - exp[known - 1] : 0;
+            const std::int64_t growth = known > 1 ? step - (exp[known - 1] - exp[known - 2]) : 0;
+            for (std::size_t i = known + 1; i < exp.size(); ++i) {
+                step += growth;
+                exp[i] = std::min<std::int64_t>(exp[i - 1] + std::max<std::int64_t>(step, 0),
+                                                std::numeric_limits<std::int32_t>::max());
+            }
+            for (const std::int64_t value : exp) {
+                actorExp_.push_back(clampToInt32(value));
+            }
+            actors_.rows_[static_cast<std::size_t>(actor.id)] = actor;
+        }
+
+        const json& items = list(documents["items.json"], "items");
+        items_.rows_ = rowsFor<ItemData>(items);
+        for (const auto& entry : items) {
+            ItemData item;
+            item.id = entry.value("id", 0);
+            if (item.id <= 0) {
+                continue;
+            }
+            item.name = intern(entry.value("name", ""));
+            item.description = intern(entry.value("description", ""));
+            item.iconIndex = entry.value("iconIndex", 0);
+            item.type = parseItemType(entry.value("itemType", "consumable"));
+            item.consumable = entry.value("consumable", false);
+            item.price = entry.value("price", 0);
+            item.params = parseParams(entry.value("params", json()));
+            item.effects = addEffects(list(entry, "effects"));
+            item.traits = addTraits(list(entry, "traits"));
+            items_.rows_[static_cast<std::size_t>(item.id)] = item;
+        }
+
+        const json& skills = list(documents["skills.json"], "skills");
+        skills_.rows_ = rowsFor<SkillData>(skills);
+        for (const auto& entry : skills) {
+            SkillData skill;
+            skill.id = entry.value("id", 0);
+            if (skill.id <= 0) {
+                continue;
+            }
+            skill.name = intern(entry.value("name", ""));
+            skill.description = intern(entry.value("description", ""));
+            skill.iconIndex = entry.value("iconIndex", 0);
+            skill.scope = entry.value("scope", 0);
+            skill.mpCost = entry.value("mpCost", 0);
+            skill.tpCost = entry.value("tpCost", 0);
+            skill.occasion = entry.value("occasion", 0);
+            skill.speed = entry.value("speed", 0);
+            skill.successRate = entry.value("successRate", 100);
+            skill.repeats = entry.value("repeats", 1);
+            skill.tpGain = entry.value("tpGain", 0);
+            skill.hitType = entry.value("hitType", 0);
+            skill.animationId = entry.value("animationId", 0);
+            if (const auto damage = entry.find("damage"); damage != entry.end() && damage->is_object()) {
+                skill.damage.type = damage->value("type", 0);
+                skill.damage.elementId = damage->value("elementId", 0);
+                skill.damage.formula = intern(damage->value("formula", ""));
+                skill.damage.variance = damage->value("variance", 0);
+                skill.damage.critical = damage->value("critical", false);
+            }
+            skill.effects = addEffects(list(entry, "effects"));
+            skill.requiredWtypeId1 = entry.value("requiredWtypeId1", 0);
+            skill.requiredWtypeId2 = entry.value("requiredWtypeId2", 0);
+            skills_.rows_[static_cast<std::size_t>(skill.id)] = skill;
+        }
+
+        const json& states = list(documents["states.json"], "states");
+        states_.rows_ = rowsFor<StateData>(states);
+        for (const auto& entry : states) {
+            StateData state;
+            state.id = entry.value("id", 0);
+            if (state.id <= 0) {
+                continue;
+            }
+            state.name = intern(entry.value("name", ""));
+            state.restriction = entry.value("restriction", 0);
+            state.priority = entry.value("priority", 0);
+            state.removeAtBattleEnd = entry.value("removeAtBattleEnd", false);
+            state.removeByRestriction = entry.value("removeByRestriction", false);
+            state.removeByDamage = entry.value("removeByDamage", false);
+            state.removeByWalking = entry.value("removeByWalking", false);
+            state.autoRemovalTiming = entry.value("autoRemovalTiming", 0);
+            state.minTurns = entry.value("minTurns", 0);
+            state.maxTurns = entry.value("maxTurns", 0);
+            state.chanceByDamage = entry.value("chanceByDamage", 0);
+            state.stepToRemove = entry.value("stepToRemove", 0);
+            state.iconIndex = entry.value("iconIndex", 0);
+            for (std::size_t i = 0; i < state.messages.size(); ++i) {
+                state.messages[i] = intern(entry.value("message" + std::to_string(i + 1), ""));
+            }
+            state.traits = addTraits(list(entry, "traits"));
+            states_.rows_[static_cast<std::size_t>(state.id)] = state;
+        }
+
+        const json& enemies = list(documents["enemies.json"], "enemies");
+        enemies_.rows_ = rowsFor<EnemyData>(enemies);
+        for (const auto& entry : enemies) {
+            EnemyData enemy;
+            enemy.id = entry.value("id", 0);
+            if (enemy.id <= 0) {
+                continue;
+            }
+            enemy.name = intern(entry.value("name", ""));
+            enemy.battlerName = intern(entry.value("battlerName", ""));
+            enemy.battlerHue = entry.value("battlerHue", 0);
+            enemy.params = parseParams(entry.value("params", json()));
+            enemy.exp = entry.value("exp", 0);
+            enemy.gold = entry.value("gold", 0);
+            enemy.drops.first = static_cast<std::uint32_t>(drops_.size());
+            for (const auto& drop : list(entry, "dropItems")) {
+                drops_.push_back({drop.value("itemId", 0), std::max(drop.value("denominator", 1), 1)});
+                ++enemy.drops.count;
+            }
+            enemy.actions.first = static_cast<std::uint32_t>(actions_.size());
+            for (const auto& action : list(entry, "actions")) {
+                actions_.push_back({action.value("skillId", 0), action.value("conditionType", 0),
+                                    action.value("conditionParam1", 0.f), action.value("conditionParam2", 0.f),
+                                    action.value("rating", 5)});
+                ++enemy.actions.count;
+            }
+            enemy.traits = addTraits(list(entry, "traits"));
+            enemies_.rows_[static_cast<std::size_t>(enemy.id)] = enemy;
+        }
+
+        const json& document = documents["system.json"];
+        if (const auto system = document.find("system"); system != document.end() && system->is_object()) {
+            system_.gameTitle = intern(system->value("gameTitle", ""));
+            system_.versionId = system->value("versionId", 0);
+            system_.locale = intern(system->value("locale", ""));
+            system_.currencyUnit = intern(system->value("currencyUnit", ""));
+            system_.attackSkillId = system->value("attackSkillId", 0);
+            system_.startMapId = system->value("startMapId", 0);
+            system_.startX = system->value("startX", 0);
+            system_.startY = system->value("startY", 0);
+            system_.startDirection = system->value("startDirection", 2);
+            system_.partyMembers = addIds(list(*system, "partyMembers"));
+            system_.magicSkillIds = addIds(list(*system, "magicSkillIds"));
+            system_.switchNames = addTexts(system->value("switches", json::object()));
+            system_.variableNames = addTexts(system->value("variables", json::object()));
+            system_.elements = addTexts(list(*system, "elements"));
+            system_.skillTypes = addTexts(list(*system, "skillTypes"));
+            system_.weaponTypes = addTexts(list(*system, "weaponTypes"));
+            system_.armorTypes = addTexts(list(*system, "armorTypes"));
+            system_.paramNames = addTexts(list(*system, "params"));
+        }
+    } catch (const std::exception& e) { // json::exception or an id over MaxTableId
+        std::cerr << "[Database] Erro ao ler dados: " << e.what() << "\n";
+        return false;
+    }
+
+    interned_.clear();
+    return true;
+}
+
+bool Database::readCache(const std::filesystem::path& cachePath) {
+    LUMY_PROFILE_SCOPE("Database::readCache");
+    std::string contents;
+    if (!readFile(cachePath, contents) || contents.size() < CacheHeaderSize) {
+        return false;
+    }
+    const ByteBuffer data(contents.begin(), contents.end());
+    if (std::memcmp(data.data(), CacheMagic, sizeof(CacheMagic)) != 0 || readLE(data.data() + 4, 2) != CacheVersion ||
+        readLE(data.data() + 8, 8) != sourceHash_ || readLE(data.data() + 16, 8) != layoutHash()) {
+        return false; // Stale or from another build: parse again
+    }
+
+    std::size_t pos = CacheHeaderSize;
+    std::vector<SystemData> system;
+    std::vector<char> text;
+    const bool ok = readSection(data, pos, actors_.rows_) && readSection(data, pos, items_.rows_) &&
+                    readSection(data, pos, skills_.rows_) && readSection(data, pos, states_.rows_) &&
+                    readSection(data, pos, enemies_.rows_) && readSection(data, pos, system) &&
+                    readSection(data, pos, text) && readSection(data, pos, effects_) &&
+                    readSection(data, pos, traits_) && readSection(data, pos, drops_) &&
+                    readSection(data, pos, actions_) && readSection(data, pos, ids_) &&
+                    readSection(data, pos, textLists_) && readSection(data, pos, actorParams_) &&
+                    readSection(data, pos, actorExp_) && pos == data.size() && system.size() == 1 &&
+                    !text.empty() && text.back() == '\0';
+    if (!ok) {
+        std::cerr << "[Database] Cache corrompido, relendo JSON: " << cachePath.string() << "\n";
+        return false;
+    }
+    system_ = system.front();
+    textPool_.assign(text.begin(), text.end());
+
+    // Curves are indexed without checks later on
+    for (const ActorData& actor : actors_.rows_) {
+        if (actor.id != 0 &&
+            (actor.maxLevel < 1 || static_cast<std::size_t>(actor.curve) + actor.maxLevel > actorParams_.size() ||
+             actorParams_.size() != actorExp_.size())) {
+            std::cerr << "[Database] Cache corrompido, relendo JSON: " << cachePath.string() << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Database::writeCache(const std::filesystem::path& cachePath) const {
+    ByteBuffer out(CacheMagic, CacheMagic + sizeof(CacheMagic));
+    writeLE(out, CacheVersion, 2);
+    writeLE(out, 0, 2);
+    writeLE(out, sourceHash_, 8);
+    writeLE(out, layoutHash(), 8);
+    writeSection(out, actors_.rows_);
+    writeSection(out, items_.rows_);
+    writeSection(out, skills_.rows_);
+    writeSection(out, states_.rows_);
+    writeSection(out, enemies_.rows_);
+    writeSection(out, std::vector<SystemData>{system_});
+    writeSection(out, std::vector<char>(textPool_.begin(), textPool_.end()));
+    writeSection(out, effects_);
+    writeSection(out, traits_);
+    writeSection(out, drops_);
+    writeSection(out, actions_);
+    writeSection(out, ids_);
+    writeSection(out, textLists_);
+    writeSection(out, actorParams_);
+    writeSection(out, actorExp_);
+
+    std::error_code ec;
+    std::filesystem::create_directories(cachePath.parent_path(), ec);
+    const std::filesystem::path tempPath = cachePath.string() + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::filesystem::rename(tempPath, cachePath, ec);
+    return !ec;
+}
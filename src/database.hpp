@@ -0,0 +1,259 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Offset of an interned string in Database's text pool; 0 is "".
+using TextId = std::uint32_t;
+
+// Stat order follows system.json "params": MHP, MMP, ATK, DEF, MAT, MDF, AGI, LUK.
+constexpr std::size_t ParamCount = 8;
+using ParamSet = std::array<std::int32_t, ParamCount>;
+
+// Slice of one of Database's shared pools (effects, traits, ...).
+struct IndexRange {
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+};
+
+struct Effect {
+    std::int32_t code = 0;
+    std::int32_t dataId = 0;
+    float value1 = 0.f;
+    float value2 = 0.f;
+};
+
+struct Trait {
+    std::int32_t code = 0;
+    std::int32_t dataId = 0;
+    float value = 0.f;
+};
+
+struct ActorData {
+    std::int32_t id = 0; // 0 marks an unused row
+    TextId name = 0;
+    TextId nickname = 0;
+    TextId profile = 0;
+    std::int32_t classId = 0;
+    std::int32_t initialLevel = 1;
+    std::int32_t maxLevel = 1;
+    std::uint32_t curve = 0; // First level-1 row in the actor curve tables
+};
+
+enum class ItemType : std::uint8_t { Consumable, Weapon, Armor, Key };
+
+struct ItemData {
+    std::int32_t id = 0;
+    TextId name = 0;
+    TextId description = 0;
+    std::int32_t iconIndex = 0;
+    ItemType type = ItemType::Consumable;
+    bool consumable = false;
+    std::int32_t price = 0;
+    ParamSet params{}; // Equipment bonuses
+    IndexRange effects;
+    IndexRange traits;
+};
+
+struct Damage {
+    std::int32_t type = 0; // 0 none, 1 HP damage, 2 MP damage, 3 HP recovery, ...
+    std::int32_t elementId = 0;
+    TextId formula = 0;
+    std::int32_t variance = 0;
+    bool critical = false;
+};
+
+struct SkillData {
+    std::int32_t id = 0;
+    TextId name = 0;
+    TextId description = 0;
+    std::int32_t iconIndex = 0;
+    std::int32_t scope = 0;
+    std::int32_t mpCost = 0;
+    std::int32_t tpCost = 0;
+    std::int32_t occasion = 0;
+    std::int32_t speed = 0;
+    std::int32_t successRate = 100;
+    std::int32_t repeats = 1;
+    std::int32_t tpGain = 0;
+    std::int32_t hitType = 0;
+    std::int32_t animationId = 0;
+    Damage damage;
+    IndexRange effects;
+    std::int32_t requiredWtypeId1 = 0;
+    std::int32_t requiredWtypeId2 = 0;
+};
+
+struct StateData {
+    std::int32_t id = 0;
+    TextId name = 0;
+    std::int32_t restriction = 0;
+    std::int32_t priority = 0;
+    bool removeAtBattleEnd = false;
+    bool removeByRestriction = false;
+    bool removeByDamage = false;
+    bool removeByWalking = false;
+    std::int32_t autoRemovalTiming = 0;
+    std::int32_t minTurns = 0;
+    std::int32_t maxTurns = 0;
+    std::int32_t chanceByDamage = 0;
+    std::int32_t stepToRemove = 0;
+    std::int32_t iconIndex = 0;
+    std::array<TextId, 4> messages{};
+    IndexRange traits;
+};
+
+struct DropItem {
+    std::int32_t itemId = 0; // Weapons and armors are rows of items() too
+    std::int32_t denominator = 1;
+};
+
+struct EnemyAction {
+    std::int32_t skillId = 0;
+    std::int32_t conditionType = 0;
+    float conditionParam1 = 0.f;
+    float conditionParam2 = 0.f;
+    std::int32_t rating = 5;
+};
+
+struct EnemyData {
+    std::int32_t id = 0;
+    TextId name = 0;
+    TextId battlerName = 0;
+    std::int32_t battlerHue = 0;
+    ParamSet params{};
+    std::int32_t exp = 0;
+    std::int32_t gold = 0;
+    IndexRange drops;
+    IndexRange actions;
+    IndexRange traits;
+};
+
+struct SystemData {
+    TextId gameTitle = 0;
+    std::int32_t versionId = 0;
+    TextId locale = 0;
+    TextId currencyUnit = 0;
+    std::int32_t attackSkillId = 0;
+    std::int32_t startMapId = 0;
+    std::int32_t startX = 0;
+    std::int32_t startY = 0;
+    std::int32_t startDirection = 2;
+    IndexRange partyMembers;  // Ids in Database::ids()
+    IndexRange magicSkillIds; // Ids in Database::ids()
+    // Indexed by id (switches, variables) or by type index (the rest)
+    IndexRange switchNames;
+    IndexRange variableNames;
+    IndexRange elements;
+    IndexRange skillTypes;
+    IndexRange weaponTypes;
+    IndexRange armorTypes;
+    IndexRange paramNames;
+};
+
+// Rows indexed directly by id; row 0 and ids missing from the JSON are empty
+// (id == 0). Lookups are a bounds check and an array access.
+template <typename Row>
+class DataTable {
+public:
+    static_assert(std::is_trivially_copyable_v<Row>, "rows are written to the cache as raw bytes");
+
+    const Row* find(int id) const {
+        if (id <= 0 || static_cast<std::size_t>(id) >= rows_.size() || rows_[id].id == 0) {
+            return nullptr;
+        }
+        return &rows_[id];
+    }
+    // Unchecked; for ids already validated by find() or taken from the table.
+    const Row& operator[](int id) const { return rows_[static_cast<std::size_t>(id)]; }
+    // One past the highest id.
+    std::size_t size() const { return rows_.size(); }
+    std::span<const Row> rows() const { return rows_; }
+
+private:
+    friend class Database;
+    std::vector<Row> rows_;
+};
+
+// Game data from game/data/*.json (actors, items, skills, states, enemies and
+// system) parsed once into flat tables. Strings are interned into one pool,
+// variable-length lists live in shared pools addressed by IndexRange, and
+// actor stat and exp curves are expanded for every level up front.
+//
+// The result is written to a binary cache keyed by a hash of the source
+// files, so later launches with unchanged data skip JSON parsing and only
+// read the tables back.
+class Database {
+public:
+    bool load(const std::filesystem::path& dataDirectory, const std::filesystem::path& cachePath = {});
+    // True when the last load() was served from the cache.
+    bool loadedFromCache() const { return fromCache_; }
+    std::uint64_t sourceHash() const { return sourceHash_; }
+
+    const DataTable<ActorData>& actors() const { return actors_; }
+    const DataTable<ItemData>& items() const { return items_; }
+    const DataTable<SkillData>& skills() const { return skills_; }
+    const DataTable<StateData>& states() const { return states_; }
+    const DataTable<EnemyData>& enemies() const { return enemies_; }
+    const SystemData& system() const { return system_; }
+
+    std::string_view text(TextId id) const;
+    std::span<const Effect> effects(IndexRange range) const { return slice(effects_, range); }
+    std::span<const Trait> traits(IndexRange range) const { return slice(traits_, range); }
+    std::span<const DropItem> drops(IndexRange range) const { return slice(drops_, range); }
+    std::span<const EnemyAction> actions(IndexRange range) const { return slice(actions_, range); }
+    std::span<const std::int32_t> ids(IndexRange range) const { return slice(ids_, range); }
+    std::span<const TextId> texts(IndexRange range) const { return slice(textLists_, range); }
+
+    // Stats of an actor at a level, clamped to [1, maxLevel].
+    const ParamSet& actorParams(const ActorData& actor, int level) const;
+    // Total exp needed to reach a level.
+    std::int32_t expForLevel(const ActorData& actor, int level) const;
+
+private:
+    template <typename T>
+    static std::span<const T> slice(const std::vector<T>& pool, IndexRange range) {
+        if (static_cast<std::size_t>(range.first) + range.count > pool.size()) {
+            return {};
+        }
+        return std::span<const T>(pool).subspan(range.first, range.count);
+    }
+
+    void clear();
+    bool parse(const std::filesystem::path& dataDirectory);
+    TextId intern(std::string_view text);
+    bool readCache(const std::filesystem::path& cachePath);
+    bool writeCache(const std::filesystem::path& cachePath) const;
+
+    DataTable<ActorData> actors_;
+    DataTable<ItemData> items_;
+    DataTable<SkillData> skills_;
+    DataTable<StateData> states_;
+    DataTable<EnemyData> enemies_;
+    SystemData system_;
+
+    std::string textPool_; // NUL-terminated strings back to back
+    std::unordered_map<std::string, TextId> interned_; // Only while parsing
+
+    std::vector<Effect> effects_;
+    std::vector<Trait> traits_;
+    std::vector<DropItem> drops_;
+    std::vector<EnemyAction> actions_;
+    std::vector<std::int32_t> ids_;
+    std::vector<TextId> textLists_;
+
+    // Per actor, maxLevel rows starting at ActorData::curve
+    std::vector<ParamSet> actorParams_;
+    std::vector<std::int32_t> actorExp_;
+
+    std::uint64_t sourceHash_ = 0;
+    bool fromCache_ = false;
+};
@@ -2,22 +2,34 @@
 #include "event_system.hpp"
 #include "scene_stack.hpp"
 #include "texture_manager.hpp"
+#include "profiler.hpp"
+#include "render_commands.hpp"
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
 
-EventSystem::EventSystem(SceneStack* stack, TextureManager* textures)
-    : sceneStack(stack), textureManager(textures) {
+EventSystem::EventSystem(SceneStack* stack, TextureManager* textures, GameState* state)
+    : sceneStack(stack), textureManager(textures), gameState(state) {
+    if (!gameState) {
+        ownedGameState = std::make_unique<GameState>();
+        gameState = ownedGameState.get();
+    }
+    
     // Inicializar Lua
     lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::string);
     
     // Configurar display de texto
     textBackground.setFillColor(sf::Color(0, 0, 0, 180));
     // textDisplay será inicializado quando a fonte for carregada
+    if (sceneStack) {
+        textGlyphs.setFence([stack = sceneStack] { stack->fenceRender(); });
+    }
 }
 
 bool EventSystem::initialize() {
     // Tentar carregar fonte
-    if (!font.openFromFile("game/font.ttf")) {
+    fontData = Vfs::instance().read("game/font.ttf");
+    if (!fontData || !font.openFromMemory(fontData.data(), fontData.size())) {
         std::cerr << "[EventSystem] Erro: não foi possível carregar game/font.ttf\n";
         return false;
     }
@@ -29,32 +41,90 @@ bool EventSystem::initialize() {
     return true;
 }
 
+bool EventSystem::runScript(const std::string& path) {
+    LUMY_PROFILE_SCOPE("EventSystem::runScript");
+    const FileData file = Vfs::instance().read(path);
+    if (!file) {
+        std::cerr << "[EventSystem] Script não encontrado: " << path << "\n";
+        return false;
+    }
+    const sol::protected_function_result result = lua.safe_script(std::string(file.text()), sol::script_pass_on_error);
+    if (!result.valid()) {
+        const sol::error error = result;
+        std::cerr << "[EventSystem] Erro no script " << path << ": " << error.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
 void EventSystem::setSwitch(int id, bool value) {
-    switches[id] = value;
+    gameState->setSwitch(id, value);
     std::cout << "[EventSystem] Switch " << id << " = " << (value ? "ON" : "OFF") << "\n";
 }
 
 bool EventSystem::getSwitch(int id) const {
-    auto it = switches.find(id);
-    return it != switches.end() ? it->second : false;
+    return gameState->getSwitch(id);
 }
 
 void EventSystem::setVariable(int id, int value) {
-    variables[id] = value;
+    gameState->setVariable(id, value);
     std::cout << "[EventSystem] Variable " << id << " = " << value << "\n";
 }
 
 int EventSystem::getVariable(int id) const {
-    auto it = variables.find(id);
-    return it != variables.end() ? it->second : 0;
+    return gameState->getVariable(id);
+}
+
+void EventSystem::setSelfSwitch(int mapId, int eventId, int index, bool value) {
+    gameState->setSelfSwitch(mapId, eventId, index, value);
+    std::cout << "[EventSystem] Self switch " << mapId << ":" << eventId << ":"
+              << static_cast<char>('A' + index) << " = " << (value ? "ON" : "OFF") << "\n";
+}
+
+bool EventSystem::getSelfSwitch(int mapId, int eventId, int index) const {
+    return gameState->getSelfSwitch(mapId, eventId, index);
 }
 
-void EventSystem::addEvent(const GameEvent& event) {
-    events.push_back(event);
-    std::cout << "[EventSystem] Evento adicionado: " << event.name << " (ID: " << event.id << ")\n";
+void EventSystem::addEvent(GameEvent event) {
+    events.push_back(std::move(event));
+    eventIndexStale = true;
+    std::cout << "[EventSystem] Evento adicionado: " << events.back().name << " (ID: " << events.back().id << ")\n";
+}
+
+std::pmr::vector<int> EventSystem::eventsNear(sf::Vector2f position, float radius,
+                                              std::pmr::memory_resource* memory) const {
+    if (eventIndexStale) {
+        LUMY_PROFILE_SCOPE("EventSystem::rebuildIndex");
+        std::pmr::vector<float> xs(memory);
+        std::pmr::vector<float> ys(memory);
+        xs.reserve(events.size());
+        ys.reserve(events.size());
+        for (const auto& e : events) {
+            xs.push_back(static_cast<float>(e.x));
+            ys.push_back(static_cast<float>(e.y));
+        }
+        eventIndex.build(xs.data(), ys.data(), events.size());
+        eventIndexStale = false;
+    }
+    
+    std::pmr::vector<std::pair<float, int>> found(memory);
+    eventIndex.forEachInRadius(position, radius, [&](std::uint32_t index) {
+        const sf::Vector2f d{static_cast<float>(events[index].x) - position.x,
+                             static_cast<float>(events[index].y) - position.y};
+        found.emplace_back(d.x * d.x + d.y * d.y, events[index].id);
+    });
+    std::sort(found.begin(), found.end());
+    
+    std::pmr::vector<int> ids(memory);
+    ids.reserve(found.size());
+    for (const auto& [distance, id] : found) {
+        ids.push_back(id);
+    }
+    return ids;
 }
 
 void EventSystem::triggerEvent(int eventId) {
+    LUMY_PROFILE_SCOPE("EventSystem::triggerEvent");
     for (auto& event : events) {
         if (event.id == eventId) {
             std::cout << "[EventSystem] Executando evento: " << event.name << "\n";
@@ -116,6 +186,7 @@ void EventSystem::executeCommand(const EventCommand& command) {
 }
 
 void EventSystem::update(float deltaTime) {
+    LUMY_PROFILE_SCOPE("EventSystem::update");
     if (isWaiting) {
         waitTimer -= deltaTime;
         if (waitTimer <= 0.0f) {
@@ -129,31 +200,53 @@ void EventSystem::update(float deltaTime) {
     }
 }
 
-void EventSystem::draw(sf::RenderWindow& window) {
+void EventSystem::draw(sf::RenderTarget& target) {
+    LUMY_PROFILE_SCOPE("EventSystem::draw");
     if (showingText && textDisplay.has_value()) {
-        window.draw(textBackground);
-        window.draw(*textDisplay);
+        target.draw(textBackground);
+        target.draw(*textDisplay);
     }
     
     // Desenhar imagens
-    for (const auto& [id, sprite] : pictures) {
-        if (sprite) {
-            window.draw(*sprite);
+    pictureSprites().draw(target);
+}
+
+void EventSystem::record(RenderCommandList& commands) const {
+    if (showingText && textDisplay.has_value()) {
+        commands.draw(textBackground);
+        commands.draw(*textDisplay);
+    }
+    
+    pictureSprites().record(commands);
+}
+
+const SpriteBatch& EventSystem::pictureSprites() const {
+    if (picturesChanged) {
+        // Imagens no mesmo atlas saem numa chamada só, na ordem dos números
+        pictureBatch.clear();
+        for (const auto& [id, picture] : pictures) {
+            pictureBatch.add(id, picture.region, picture.position);
         }
+        picturesChanged = false;
     }
+    return pictureBatch;
 }
 
 void EventSystem::handleInput(const sf::Event& event) {
-    if (showingText) {
-        if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
-            if (key->code == sf::Keyboard::Key::Space || key->code == sf::Keyboard::Key::Enter) {
-                showingText = false;
-                continueExecution();
-            }
+    if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
+        if (key->code == sf::Keyboard::Key::Space || key->code == sf::Keyboard::Key::Enter) {
+            confirm();
         }
     }
 }
 
+void EventSystem::confirm() {
+    if (showingText) {
+        showingText = false;
+        continueExecution();
+    }
+}
+
 // Implementação dos comandos específicos
 
 void EventSystem::executeShowText(const EventCommandParams& params) {
@@ -172,6 +265,9 @@ void EventSystem::executeShowText(const EventCommandParams& params) {
         if (textDisplay.has_value()) {
             textDisplay->setString(currentText);
             textDisplay->setPosition({30, windowHeight - 110});
+            // A fonte pode estar numa lista publicada: o render não pode
+            // desenhar a página enquanto ela recebe glifos novos
+            textGlyphs.preload(*textDisplay);
         }
         
         std::cout << "[EventSystem] Exibindo texto: " << currentText << "\n";
@@ -246,18 +342,46 @@ void EventSystem::executeWait(const EventCommandParams& params) {
 }
 
 void EventSystem::executeTransferPlayer(const EventCommandParams& params) {
-    // Implementação básica - apenas log por agora
-    if (params.intParams.size() >= 3) {
-        int mapId = params.intParams[0];
-        int x = params.intParams[1];
-        int y = params.intParams[2];
-        std::cout << "[EventSystem] Transfer para mapa " << mapId << " posição (" << x << ", " << y << ")\n";
-        
-        // TODO: Implementar transferência real quando tivermos sistema de mapas completo
+    if (const auto target = transferTarget(params)) {
+        std::cout << "[EventSystem] Transfer para mapa " << target->mapId << " posição (" << target->position.x << ", "
+                  << target->position.y << ")\n";
+        if (transferHandler) {
+            transferHandler(*target);
+        }
     }
     continueExecution();
 }
 
+std::optional<TransferTarget> EventSystem::transferTarget(const EventCommandParams& params) {
+    if (params.intParams.size() < 3) {
+        return std::nullopt;
+    }
+    TransferTarget target;
+    target.mapId = params.intParams[0];
+    target.position = {static_cast<float>(params.intParams[1]), static_cast<float>(params.intParams[2])};
+    if (!params.stringParams.empty()) {
+        target.mapFile = params.stringParams[0];
+    }
+    return target;
+}
+
+std::vector<TransferTarget> EventSystem::transferTargets() const {
+    std::vector<TransferTarget> targets;
+    for (const auto& event : events) {
+        for (const auto& page : event.pages) {
+            for (const auto& command : page.commands) {
+                if (command.type != EventCommandType::TransferPlayer) {
+                    continue;
+                }
+                if (const auto target = transferTarget(command.params)) {
+                    targets.push_back(*target);
+                }
+            }
+        }
+    }
+    return targets;
+}
+
 void EventSystem::executePlayBGM(const EventCommandParams& params) {
     if (!params.stringParams.empty()) {
         std::string filename = params.stringParams[0];
@@ -283,11 +407,17 @@ void EventSystem::executeShowPicture(const EventCommandParams& params) {
         int y = params.intParams[2];
         std::string filename = params.stringParams[0];
         
-        // Tentar carregar a imagem através do TextureManager
+        // Tentar carregar a imagem pelo atlas, ou inteira pelo TextureManager
         try {
-            const sf::Texture& texture = textureManager->acquire(filename);
-            pictures[pictureId] = std::make_unique<sf::Sprite>(texture);
-            pictures[pictureId]->setPosition({static_cast<float>(x), static_cast<float>(y)});
+            AtlasRegion region;
+            if (atlas) {
+                region = atlas->acquire(filename);
+            } else {
+                const sf::Texture& texture = textureManager->acquire(filename);
+                region = {&texture, {{0, 0}, sf::Vector2i(texture.getSize())}};
+            }
+            pictures[pictureId] = {region, {static_cast<float>(x), static_cast<float>(y)}};
+            picturesChanged = true;
             std::cout << "[EventSystem] Exibindo imagem " << pictureId << ": " << filename << "\n";
         } catch (const std::exception& e) {
             std::cerr << "[EventSystem] Erro ao carregar imagem: " << filename << " - " << e.what() << "\n";
@@ -300,6 +430,7 @@ void EventSystem::executeErasePicture(const EventCommandParams& params) {
     if (!params.intParams.empty()) {
         int pictureId = params.intParams[0];
         pictures.erase(pictureId);
+        picturesChanged = true;
         std::cout << "[EventSystem] Removendo imagem " << pictureId << "\n";
     }
     continueExecution();
@@ -6,9 +6,16 @@
 #include <unordered_map>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <SFML/Graphics.hpp>
 #include <sol/sol.hpp>
+#include "game_state.hpp"
+#include "render_commands.hpp"
+#include "spatial_grid.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
+#include "vfs.hpp"
 
 // Forward declarations
 class SceneStack;
@@ -37,6 +44,14 @@ struct EventCommandParams {
     std::unordered_map<std::string, std::string> extraData;
 };
 
+// Destino de TransferPlayer: intParams = {mapId, x, y} (posição em pixels);
+// stringParams[0], se houver, é o arquivo TMX (relativo ao mapa atual)
+struct TransferTarget {
+    int mapId = 0;
+    std::string mapFile;
+    sf::Vector2f position;
+};
+
 // Classe para um comando de evento
 class EventCommand {
 public:
@@ -44,8 +59,8 @@ public:
     EventCommandParams params;
     int indent = 0; // Para controlar estruturas if/else
 
-    EventCommand(EventCommandType t, const EventCommandParams& p = {}) 
-        : type(t), params(p) {}
+    EventCommand(EventCommandType t, EventCommandParams p = {}) 
+        : type(t), params(std::move(p)) {}
 };
 
 // Classe para uma página de evento
@@ -69,8 +84,8 @@ public:
     int x, y; // Posição no mapa
     std::vector<EventPage> pages;
     
-    GameEvent(int eventId, const std::string& eventName, int posX, int posY)
-        : id(eventId), name(eventName), x(posX), y(posY) {}
+    GameEvent(int eventId, std::string eventName, int posX, int posY)
+        : id(eventId), name(std::move(eventName)), x(posX), y(posY) {}
 };
 
 // Sistema de execução de eventos
@@ -80,10 +95,17 @@ private:
     TextureManager* textureManager;
     sol::state lua;
     
-    // Estado do sistema
-    std::unordered_map<int, bool> switches;
-    std::unordered_map<int, int> variables;
+    // Estado do sistema (switches/variáveis vivem no GameState compartilhado)
+    std::unique_ptr<GameState> ownedGameState;
+    GameState* gameState = nullptr;
     std::vector<GameEvent> events;
+    // Posições dos eventos. addEvent só marca como desatualizado; a próxima
+    // consulta reconstrói uma vez, então carregar n eventos custa O(n)
+    mutable SpatialGrid eventIndex;
+    mutable bool eventIndexStale = false;
+    
+    // Quem realiza a transferência de mapa (MapScene)
+    std::function<void(const TransferTarget&)> transferHandler;
     
     // Controle de execução
     bool isExecuting = false;
@@ -91,8 +113,10 @@ private:
     std::vector<EventCommand>* currentCommands = nullptr;
     
     // UI para texto
+    FileData fontData; // Mantido enquanto a fonte existir
     sf::Font font;
     std::optional<sf::Text> textDisplay;
+    GlyphPreloader textGlyphs; // Mensagens novas esperam o render antes de carregar glifos
     sf::RectangleShape textBackground;
     bool showingText = false;
     std::string currentText;
@@ -102,33 +126,65 @@ private:
     float waitTimer = 0.0f;
     bool isWaiting = false;
     
-    // Sistema de imagens
-    std::unordered_map<int, std::unique_ptr<sf::Sprite>> pictures;
+    // Sistema de imagens: cada uma é uma região do atlas (ou a textura
+    // inteira, sem atlas) e o número da imagem é a camada no SpriteBatch
+    struct Picture {
+        AtlasRegion region;
+        sf::Vector2f position;
+    };
+    std::unordered_map<int, Picture> pictures;
+    TextureAtlas* atlas = nullptr;
+    mutable SpriteBatch pictureBatch; // Refeito só quando as imagens mudam
+    mutable bool picturesChanged = false;
 
 public:
-    EventSystem(SceneStack* stack, TextureManager* textures);
+    // Sem GameState externo, o sistema usa um próprio
+    EventSystem(SceneStack* stack, TextureManager* textures, GameState* state = nullptr);
+    
+    GameState& state() { return *gameState; }
+    // Imagens de ShowPicture passam a ser copiadas para este atlas (de quem
+    // chama, que o mantém vivo enquanto o sistema existir)
+    void setTextureAtlas(TextureAtlas* textureAtlas) { atlas = textureAtlas; }
     
     // Inicialização
     bool initialize();
     
+    // Lua dos eventos; a cena registra nele as APIs que expõe (ex.: bindMapApi)
+    sol::state& luaState() { return lua; }
+    // Executa um script lido pelo Vfs; erros vão para o log
+    bool runScript(const std::string& path);
+    
     // Controle de switches e variáveis
     void setSwitch(int id, bool value);
     bool getSwitch(int id) const;
     void setVariable(int id, int value);
     int getVariable(int id) const;
+    void setSelfSwitch(int mapId, int eventId, int index, bool value);
+    bool getSelfSwitch(int mapId, int eventId, int index) const;
     
     // Controle de eventos
-    void addEvent(const GameEvent& event);
+    // Por valor: quem não precisa mais do evento passa com std::move, sem copiar páginas e comandos
+    void addEvent(GameEvent event);
+    // IDs dos eventos a até `radius` pixels de `position`, do mais próximo ao mais distante.
+    // Resultado e rascunho vêm de `memory` (ex.: &frameArena() em código por frame)
+    std::pmr::vector<int> eventsNear(sf::Vector2f position, float radius,
+                                     std::pmr::memory_resource* memory = std::pmr::get_default_resource()) const;
     void triggerEvent(int eventId);
+    // Destinos de todos os TransferPlayer dos eventos, para pré-carregar mapas
+    std::vector<TransferTarget> transferTargets() const;
+    void setTransferHandler(std::function<void(const TransferTarget&)> handler) { transferHandler = std::move(handler); }
+    static std::optional<TransferTarget> transferTarget(const EventCommandParams& params);
     void executeCommand(const EventCommand& command);
     
     // Sistema de execução
     void update(float deltaTime);
-    void draw(sf::RenderWindow& window);
+    void draw(sf::RenderTarget& target);
+    void record(RenderCommandList& commands) const; // Renderer em thread separada
     bool isEventRunning() const { return isExecuting; }
     
     // Manipulação de input durante eventos
     void handleInput(const sf::Event& event);
+    void confirm(); // Ação Confirm: avança o texto exibido
     
     // Comandos específicos
 private:
@@ -144,6 +200,7 @@ private:
     void executeErasePicture(const EventCommandParams& params);
     
     // Utilitários
+    const SpriteBatch& pictureSprites() const;
     bool evaluateCondition(int switchId, bool switchValue, int varId, int varValue);
     void continueExecution();
     void stopExecution();
@@ -0,0 +1,56 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+FrameArena::FrameArena(std::size_t capacity)
+    : block_(capacity > 0 ? std::make_unique_for_overwrite<std::byte[]>(capacity) : nullptr), capacity_(capacity) {}
+
+FrameArena::~FrameArena() {
+    freeOverflow(); // No growth: the block goes away with the arena
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    const auto base = reinterpret_cast<std::uintptr_t>(block_.get());
+    const std::size_t start = ((base + offset_ + alignment - 1) & ~(std::uintptr_t{alignment} - 1)) - base;
+    used_ += bytes;
+    if (block_ && start + bytes <= capacity_) {
+        offset_ = start + bytes;
+        return block_.get() + start;
+    }
+
+    // Doesn't fit: heap block with the list link in front, aligned past it
+    const std::size_t align = std::max(alignment, alignof(Overflow));
+    const std::size_t header = std::max(sizeof(Overflow), align);
+    void* memory = ::operator new(header + bytes, std::align_val_t{align});
+    overflow_ = new (memory) Overflow{overflow_, align};
+    ++overflows_;
+    return static_cast<std::byte*>(memory) + header;
+}
+
+void FrameArena::freeOverflow() {
+    while (overflow_) {
+        Overflow* next = overflow_->next;
+        ::operator delete(overflow_, std::align_val_t{overflow_->alignment});
+        overflow_ = next;
+    }
+}
+
+void FrameArena::reset() {
+    freeOverflow();
+    peak_ = std::max(peak_, used_);
+    if (overflows_ > 0) {
+        // Room for the whole frame next time (plus alignment slack)
+        capacity_ = std::bit_ceil(peak_ + peak_ / 8);
+        block_ = std::make_unique_for_overwrite<std::byte[]>(capacity_);
+    }
+    offset_ = 0;
+    used_ = 0;
+    overflows_ = 0;
+}
+
+FrameArena& frameArena() {
+    thread_local FrameArena arena;
+    return arena;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+// Linear (bump) allocator for memory that only lives until the end of the
+// frame: scratch vectors, sorted query results, formatted strings. Allocation
+// is a pointer bump, deallocation is a no-op, and reset() frees everything at
+// once.
+//
+//   std::pmr::vector<int> ids(&frameArena());
+//
+// When a frame needs more than the block holds, the excess comes from the
+// heap and reset() grows the block to that frame's peak, so a steady frame
+// ends up never touching the heap. Not thread-safe: each thread has its own
+// arena (frameArena()), and memory from it must not be handed to another
+// thread, the render thread included.
+class FrameArena final : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t DefaultCapacity = 64 * 1024;
+
+    explicit FrameArena(std::size_t capacity = DefaultCapacity);
+    ~FrameArena() override;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Invalidates everything allocated since the previous reset().
+    void reset();
+
+    // Bytes handed out since reset(), overflow included.
+    std::size_t used() const { return used_; }
+    std::size_t capacity() const { return capacity_; }
+    // Highest used() seen at a reset().
+    std::size_t peak() const { return peak_; }
+    // Allocations since reset() that didn't fit in the block.
+    std::uint32_t overflows() const { return overflows_; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Overflow {
+        Overflow* next;
+        std::size_t alignment;
+    };
+
+    void freeOverflow();
+
+    std::unique_ptr<std::byte[]> block_;
+    std::size_t capacity_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t used_ = 0;
+    std::size_t peak_ = 0;
+    std::uint32_t overflows_ = 0;
+    Overflow* overflow_ = nullptr; // Heap blocks of this frame, freed by reset() and the destructor
+};
+
+// The calling thread's arena. GameLoop resets the main thread's one at the
+// start of every frame (runHeadless: every step).
+FrameArena& frameArena();
@@ -0,0 +1,393 @@
+#include "game_loop.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "frame_arena.hpp"
+#include "input.hpp"
+#include "profiler.hpp"
+#include "render_commands.hpp"
+#include "scene_stack.hpp"
+
+namespace {
+float secondsBetween(FramePacer::Clock::time_point from, FramePacer::Clock::time_point to) {
+    return std::chrono::duration<float>(to - from).count();
+}
+
+// Step times in 10 µs bins up to 100 ms, so a soak run keeps a constant
+// footprint however many steps it takes; p99 comes out to within one bin.
+// Slower steps share the last bin, where the exact maximum stands in.
+class StepHistogram {
+public:
+    StepHistogram() : bins_(BinCount, 0) {}
+
+    void add(double ms) {
+        const auto bin = static_cast<std::size_t>(std::max(ms, 0.0) / BinMs);
+        ++bins_[std::min(bin, BinCount - 1)];
+        ++count_;
+        sum_ += ms;
+        max_ = std::max(max_, ms);
+    }
+
+    std::uint64_t count() const { return count_; }
+    double mean() const { return count_ > 0 ? sum_ / static_cast<double>(count_) : 0.0; }
+    double max() const { return max_; }
+
+    // Upper edge of the bin holding the sample at that rank (same rank as
+    // sorting every sample and taking index count * fraction).
+    double percentile(double fraction) const {
+        const auto rank = std::min(count_ - 1, static_cast<std::uint64_t>(static_cast<double>(count_) * fraction)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t bin = 0; bin + 1 < BinCount; ++bin) {
+            seen += bins_[bin];
+            if (seen >= rank) {
+                return std::min(static_cast<double>(bin + 1) * BinMs, max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr double BinMs = 0.01;
+    static constexpr std::size_t BinCount = 10000;
+
+    std::vector<std::uint64_t> bins_;
+    std::uint64_t count_ = 0;
+    double sum_ = 0.0;
+    double max_ = 0.0;
+};
+
+std::size_t peakResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss); // Bytes
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // Kilobytes
+#endif
+#endif
+}
+} // namespace
+
+FixedTimestep::FixedTimestep(float stepSeconds, int maxStepsPerFrame)
+    : step_(stepSeconds), maxSteps_(std::max(1, maxStepsPerFrame)) {}
+
+int FixedTimestep::advance(float elapsedSeconds) {
+    accumulator_ += std::max(0.f, elapsedSeconds);
+    int steps = static_cast<int>(std::floor(accumulator_ / step_));
+    accumulator_ -= static_cast<double>(steps) * step_;
+
+    droppedSteps_ = 0;
+    if (steps > maxSteps_) {
+        droppedSteps_ = steps - maxSteps_;
+        steps = maxSteps_;
+        std::cout << "[Frame drop] " << droppedSteps_ << " fixed steps skipped\n";
+    }
+    return steps;
+}
+
+float FixedTimestep::alpha() const {
+    return static_cast<float>(std::clamp(accumulator_ / step_, 0.0, 1.0));
+}
+
+FramePacer::FramePacer(float targetFps, std::chrono::microseconds spinWindow)
+    : spinWindow_(spinWindow) {
+    setTargetFps(targetFps);
+}
+
+void FramePacer::setTargetFps(float targetFps) {
+    period_ = targetFps > 0.f
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.f / targetFps))
+        : Clock::duration::zero();
+    next_ = Clock::time_point{};
+}
+
+float FramePacer::wait() {
+    if (period_ == Clock::duration::zero()) {
+        return 0.f;
+    }
+
+    const auto start = Clock::now();
+    if (next_ == Clock::time_point{}) {
+        next_ = start;
+    }
+    next_ += period_;
+
+    // More than a whole frame late: resync instead of rushing to catch up.
+    if (start > next_) {
+        next_ = start;
+        return 0.f;
+    }
+
+    if (next_ - start > spinWindow_) {
+        std::this_thread::sleep_until(next_ - spinWindow_);
+    }
+    while (Clock::now() < next_) {
+        std::this_thread::yield();
+    }
+    return secondsBetween(start, Clock::now());
+}
+
+HeadlessReport runHeadless(SceneStack& stack, const HeadlessConfig& config) {
+    using Clock = FramePacer::Clock;
+
+    HeadlessReport report;
+    Input& input = Input::instance();
+    if (config.maxSteps == 0 && input.mode() != Input::Mode::Replaying) {
+        std::cerr << "[GameLoop] Modo headless sem replay nem limite de passos\n";
+        return report;
+    }
+
+    const float step = 1.f / config.simulationHz;
+    const auto realStep = config.speed > 0.f ? std::chrono::duration_cast<Clock::duration>(
+                                                   std::chrono::duration<double>(step / config.speed))
+                                             : Clock::duration::zero();
+    RenderCommandList frame;
+    StepHistogram stepMs;
+    const auto start = Clock::now();
+    stack.applyPending();
+    while ((config.maxSteps == 0 || report.steps < config.maxSteps) && !input.replayFinished() && stack.current()) {
+        if (realStep > Clock::duration::zero()) {
+            std::this_thread::sleep_until(start + realStep * static_cast<Clock::rep>(report.steps));
+        }
+        const auto stepStart = Clock::now();
+#if defined(LUMY_PROFILER)
+        const std::uint64_t allocationsBefore = Profiler::threadAllocations();
+#endif
+        frameArena().reset();
+        input.beginStep();
+        stack.update(step);
+        {
+            LUMY_PROFILE_SCOPE("Scene::update");
+            stack.current()->update(step);
+        }
+        stack.applyPending();
+        if (config.recordFrames && stack.current()) {
+            LUMY_PROFILE_SCOPE("Scene::record");
+            frame.clear();
+            stack.record(frame, 1.f);
+        }
+#if defined(LUMY_PROFILER)
+        const std::uint64_t stepAllocations = Profiler::threadAllocations() - allocationsBefore;
+        report.heapAllocations += stepAllocations;
+        report.maxStepAllocations = std::max(report.maxStepAllocations, stepAllocations);
+        report.allocationFreeSteps += stepAllocations == 0 ? 1 : 0;
+#endif
+        stepMs.add(std::chrono::duration<double, std::milli>(Clock::now() - stepStart).count());
+        report.steps++;
+        LUMY_PROFILE_FRAME();
+    }
+    report.totalSeconds = secondsBetween(start, Clock::now());
+    report.peakMemoryBytes = peakResidentBytes();
+
+    if (stepMs.count() > 0) {
+        report.meanStepMs = static_cast<float>(stepMs.mean());
+        report.ticksPerSecond = report.totalSeconds > 0.f ? static_cast<float>(report.steps) / report.totalSeconds : 0.f;
+        report.p99StepMs = static_cast<float>(stepMs.percentile(0.99));
+        report.maxStepMs = static_cast<float>(stepMs.max());
+    }
+    return report;
+}
+
+GameLoop::GameLoop(sf::RenderWindow& window, SceneStack& stack, const GameLoopConfig& config)
+    : window_(window),
+      stack_(stack),
+      timestep_(1.f / config.simulationHz, config.maxStepsPerFrame),
+      pacer_(config.vsync ? 0.f : config.targetFps),
+      threadedRender_(config.threadedRender) {
+    window_.setVerticalSyncEnabled(config.vsync);
+#if defined(LUMY_PROFILER)
+    if (!profilerOverlay_.loadFont("game/font.ttf")) {
+        std::cerr << "[Profiler] Fonte game/font.ttf indisponível; overlay só com gráfico\n";
+    }
+#endif
+}
+
+void GameLoop::run() {
+    using Clock = FramePacer::Clock;
+
+    // Threaded mode: the render thread takes the window's GL context; events,
+    // simulation and recording stay here because SFML delivers events only to
+    // the thread that created the window.
+    RenderQueue queue;
+    std::thread renderThread;
+    if (threadedRender_) {
+        if (window_.setActive(false)) {
+            renderQueue_ = &queue;
+            // Scenes are destroyed (and atlas pages rewritten) only once the
+            // render thread holds no list that may reference them
+            stack_.setRenderFence([&queue] { queue.drain(); });
+            renderThread = std::thread([this, &queue] { renderLoop(queue); });
+#if defined(LUMY_PROFILER)
+            std::cout << "[Profiler] Overlay indisponível com render em thread separada\n";
+#endif
+        } else {
+            std::cerr << "[GameLoop] Não foi possível liberar o contexto OpenGL; render na thread principal\n";
+        }
+    }
+
+    std::size_t fpsFrameCount = 0;
+    float fpsAccumulated = 0.f;
+    auto lastFrame = Clock::now();
+
+    while (running()) {
+        const auto frameStart = Clock::now();
+        // Scratch memory of the previous frame (already recorded and drawn)
+        frameArena().reset();
+        stats_.frameSeconds = secondsBetween(lastFrame, frameStart);
+        lastFrame = frameStart;
+
+        // Average FPS every ~1 second
+        fpsFrameCount++;
+        fpsAccumulated += stats_.frameSeconds;
+        if (fpsAccumulated >= 1.f) {
+            std::cout << "FPS médio: " << static_cast<float>(fpsFrameCount) / fpsAccumulated << "\n";
+            fpsFrameCount = 0;
+            fpsAccumulated = 0.f;
+        }
+
+        processEvents();
+        stack_.applyPending();
+
+        if (!running()) {
+            break;
+        }
+
+        const auto updateStart = Clock::now();
+        stats_.steps = timestep_.advance(stats_.frameSeconds);
+        stats_.droppedSteps = timestep_.droppedSteps();
+        for (int i = 0; i < stats_.steps; ++i) {
+            Input::instance().beginStep();
+            stack_.update(timestep_.step());
+            if (auto* current = stack_.current()) {
+                LUMY_PROFILE_SCOPE("Scene::update");
+                current->update(timestep_.step());
+            }
+            // Scene changes requested during a step take effect before the next one
+            stack_.applyPending();
+        }
+        const auto updateEnd = Clock::now();
+        stats_.updateSeconds = secondsBetween(updateStart, updateEnd);
+        if (Input::instance().replayFinished()) {
+            std::cout << "[Input] Replay concluído em " << Input::instance().stepIndex() << " passos\n";
+            requestClose();
+        }
+
+        stats_.alpha = timestep_.alpha();
+        if (renderQueue_) {
+            {
+                LUMY_PROFILE_SCOPE("Scene::record");
+                stack_.record(queue.back(), stats_.alpha);
+            }
+            // Waits only if the render thread hasn't picked up the previous frame
+            LUMY_PROFILE_SCOPE("GameLoop::publish");
+            queue.publish();
+        } else {
+            window_.clear(sf::Color::Black);
+            {
+                LUMY_PROFILE_SCOPE("Scene::draw");
+                stack_.draw(window_, stats_.alpha);
+            }
+            stack_.drawTransition(window_);
+#if defined(LUMY_PROFILER)
+            profilerOverlay_.draw(window_);
+#endif
+            LUMY_PROFILE_SCOPE("GameLoop::display");
+            window_.display();
+        }
+        stats_.drawSeconds = secondsBetween(updateEnd, Clock::now());
+
+        stats_.idleSeconds = pacer_.wait();
+        stats_.frameIndex++;
+        LUMY_PROFILE_FRAME();
+    }
+
+    if (renderThread.joinable()) {
+        stack_.setRenderFence(nullptr);
+        queue.stop();
+        renderThread.join();
+        renderQueue_ = nullptr;
+        if (!window_.setActive(true)) {
+            std::cerr << "[GameLoop] Não foi possível recuperar o contexto OpenGL\n";
+        }
+    }
+    if (closeRequested_) {
+        window_.close();
+    }
+}
+
+void GameLoop::renderLoop(RenderQueue& queue) {
+    if (!window_.setActive(true)) {
+        std::cerr << "[GameLoop] Render thread sem contexto OpenGL\n";
+    }
+    while (const RenderCommandList* commands = queue.acquire()) {
+        window_.clear(sf::Color::Black);
+        commands->replay(window_);
+        {
+            LUMY_PROFILE_SCOPE("GameLoop::display");
+            window_.display();
+        }
+        queue.release();
+    }
+    (void)window_.setActive(false);
+}
+
+bool GameLoop::running() const {
+    return window_.isOpen() && !closeRequested_;
+}
+
+void GameLoop::requestClose() {
+    // The render thread may be presenting; close only after it has stopped
+    if (renderQueue_) {
+        closeRequested_ = true;
+    } else {
+        window_.close();
+    }
+}
+
+void GameLoop::processEvents() {
+    LUMY_PROFILE_SCOPE("GameLoop::processEvents");
+    while (auto event = window_.pollEvent()) {
+        if (event->is<sf::Event::Closed>()) {
+            requestClose();
+        }
+        if (const auto* key = event->getIf<sf::Event::KeyPressed>()) {
+            if (key->code == sf::Keyboard::Key::Escape) {
+                requestClose();
+            }
+#if defined(LUMY_PROFILER)
+            if (key->code == sf::Keyboard::Key::F3) {
+                profilerOverlay_.toggle();
+            } else if (key->code == sf::Keyboard::Key::F4) {
+                Profiler::instance().exportChromeTrace("lumy_trace.json");
+            }
+#endif
+        }
+        Input::instance().handleEvent(*event);
+        if (auto* current = stack_.current()) {
+            current->handleEvent(*event);
+        }
+    }
+}
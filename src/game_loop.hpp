@@ -0,0 +1,139 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "profiler_overlay.hpp"
+
+namespace sf {
+class RenderWindow;
+}
+class SceneStack;
+class RenderQueue;
+
+// Accumulates real frame time and hands it out as fixed simulation steps.
+// The remainder becomes the interpolation factor used when drawing.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(float stepSeconds = 1.f / 60.f, int maxStepsPerFrame = 5);
+
+    // Adds elapsed real time and returns how many fixed steps to run now.
+    // At most maxStepsPerFrame steps are returned; any extra backlog is
+    // dropped (spiral-of-death protection) and reported by droppedSteps().
+    int advance(float elapsedSeconds);
+
+    float step() const { return step_; }
+    // Fraction of a step left in the accumulator, in [0, 1).
+    float alpha() const;
+    int droppedSteps() const { return droppedSteps_; }
+
+private:
+    float step_;
+    int maxSteps_;
+    double accumulator_ = 0.0;
+    int droppedSteps_ = 0;
+};
+
+// Hybrid frame limiter: sleeps for most of the frame, then spins for the
+// last spinWindow to hit the deadline with low jitter.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(float targetFps = 60.f,
+                        std::chrono::microseconds spinWindow = std::chrono::microseconds(1500));
+
+    // A target of 0 disables pacing (vsync or uncapped).
+    void setTargetFps(float targetFps);
+
+    // Blocks until the end of the current frame period. Returns idle seconds.
+    float wait();
+
+private:
+    Clock::duration period_{};
+    std::chrono::microseconds spinWindow_;
+    Clock::time_point next_{};
+};
+
+struct GameLoopConfig {
+    float simulationHz = 60.f;
+    int maxStepsPerFrame = 5;
+    bool vsync = false;
+    float targetFps = 60.f; // Ignored when vsync is enabled; 0 = uncapped
+    // Simulation and recording on the calling thread, GL drawing on a render
+    // thread that replays RenderCommandLists. Scenes must implement record().
+    bool threadedRender = false;
+};
+
+// Per-frame timing, refreshed every iteration of GameLoop::run().
+struct FrameStats {
+    std::size_t frameIndex = 0;
+    float frameSeconds = 0.f;  // Real time since the previous frame
+    float updateSeconds = 0.f; // Time spent in fixed updates
+    float drawSeconds = 0.f;   // Drawing and presenting (threaded: recording and handoff)
+    float idleSeconds = 0.f;   // Time spent in the pacer
+    int steps = 0;             // Fixed updates run this frame
+    int droppedSteps = 0;      // Steps discarded by spiral-of-death protection
+    float alpha = 0.f;         // Interpolation factor passed to the scene
+};
+
+struct HeadlessConfig {
+    float simulationHz = 60.f;
+    std::size_t maxSteps = 0; // 0 = only the end of the input replay stops the run
+    float speed = 0.f;        // Multiple of real time to pace steps at; 0 = as fast as possible
+    // Null render target: every step is recorded into a RenderCommandList that
+    // is dropped without replay, so recording costs are measured with no GPU.
+    // Text layout still needs a GL context for glyphs; off by default.
+    bool recordFrames = false;
+};
+
+// Wall-clock cost of the fixed steps run by runHeadless().
+struct HeadlessReport {
+    std::size_t steps = 0;
+    float totalSeconds = 0.f;
+    float ticksPerSecond = 0.f;
+    float meanStepMs = 0.f;
+    float p99StepMs = 0.f; // To within 10 µs (histogram bin)
+    float maxStepMs = 0.f;
+    std::size_t peakMemoryBytes = 0; // Peak resident set of the process; 0 if unknown
+    // Heap allocations inside the steps (profiler builds only, else 0)
+    std::uint64_t heapAllocations = 0;
+    std::uint64_t maxStepAllocations = 0;
+    std::size_t allocationFreeSteps = 0;
+};
+
+// Runs fixed steps with no window or drawing until the input replay ends or
+// config.maxSteps is reached. Input comes only from the replay (if any).
+HeadlessReport runHeadless(SceneStack& stack, const HeadlessConfig& config);
+
+// Drives the scene stack: events, fixed-step updates, interpolated draw, pacing.
+// Input is sampled once per fixed step (Input::beginStep); when an input
+// replay ends the window is closed.
+class GameLoop {
+public:
+    GameLoop(sf::RenderWindow& window, SceneStack& stack, const GameLoopConfig& config = {});
+
+    // Runs until the window is closed.
+    void run();
+
+    const FrameStats& stats() const { return stats_; }
+
+private:
+    void processEvents();
+    bool running() const;
+    void requestClose();
+    void renderLoop(RenderQueue& queue);
+
+    sf::RenderWindow& window_;
+    SceneStack& stack_;
+    FixedTimestep timestep_;
+    FramePacer pacer_;
+    FrameStats stats_;
+    bool threadedRender_;
+    RenderQueue* renderQueue_ = nullptr; // Set while the render thread runs
+    bool closeRequested_ = false;
+#if defined(LUMY_PROFILER)
+    ProfilerOverlay profilerOverlay_; // F3 toggles, F4 exports a Chrome trace
+#endif
+};
@@ -0,0 +1,235 @@
+// src/game_state.cpp
+#include "game_state.hpp"
+
+#include <utility>
+
+namespace {
+
+// Garante que `ptr` seja exclusivo antes de escrever (copy-on-write)
+template <typename T>
+T& detach(std::shared_ptr<T>& ptr) {
+    if (!ptr) {
+        ptr = std::make_shared<T>();
+    } else if (ptr.use_count() > 1) {
+        ptr = std::make_shared<T>(*ptr);
+    }
+    return *ptr;
+}
+
+std::uint64_t selfSwitchKey(int mapId, int eventId) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(mapId)) << 32) |
+           static_cast<std::uint32_t>(eventId);
+}
+
+} // namespace
+
+GameState::GameState()
+    : switches_(std::make_shared<PageTable<SwitchPage>>()),
+      variables_(std::make_shared<PageTable<VariablePage>>()),
+      selfSwitches_(std::make_shared<std::map<std::uint64_t, std::uint8_t>>()),
+      player_(std::make_shared<PlayerSaveData>(defaultPlayer())) {}
+
+GameState::GameState(const GameState& other)
+    : switches_(other.switches_),
+      variables_(other.variables_),
+      selfSwitches_(other.selfSwitches_),
+      player_(other.player_) {}
+
+GameState& GameState::operator=(const GameState& other) {
+    if (this != &other) {
+        switches_ = other.switches_;
+        variables_ = other.variables_;
+        selfSwitches_ = other.selfSwitches_;
+        player_ = other.player_;
+    }
+    return *this;
+}
+
+void GameState::restore(const GameState& snapshot) {
+    *this = snapshot;
+    notify({Change::Reset});
+}
+
+void GameState::reset() {
+    *this = GameState();
+    notify({Change::Reset});
+}
+
+PlayerSaveData GameState::defaultPlayer() {
+    PlayerSaveData defaults;
+    defaults.party.push_back(1); // Hero por padrão
+    return defaults;
+}
+
+template <typename Page>
+Page* GameState::writablePage(std::shared_ptr<PageTable<Page>>& table, std::size_t index) {
+    auto& pages = detach(table).pages;
+    if (index >= pages.size()) {
+        pages.resize(index + 1);
+    }
+    return &detach(pages[index]);
+}
+
+template <typename Page>
+const Page* GameState::findPage(const std::shared_ptr<PageTable<Page>>& table, std::size_t index) {
+    if (!table || index >= table->pages.size()) {
+        return nullptr;
+    }
+    return table->pages[index].get();
+}
+
+bool GameState::getSwitch(int id) const {
+    if (id < 0) return false;
+    const auto* page = findPage(switches_, static_cast<std::size_t>(id) / PageSize);
+    return page && page->test(static_cast<std::size_t>(id) % PageSize);
+}
+
+void GameState::setSwitch(int id, bool value) {
+    if (id < 0 || getSwitch(id) == value) return;
+    writablePage(switches_, static_cast<std::size_t>(id) / PageSize)
+        ->set(static_cast<std::size_t>(id) % PageSize, value);
+    notify({Change::Switch, id, value ? 1 : 0});
+}
+
+int GameState::getVariable(int id) const {
+    if (id < 0) return 0;
+    const auto* page = findPage(variables_, static_cast<std::size_t>(id) / PageSize);
+    return page ? (*page)[static_cast<std::size_t>(id) % PageSize] : 0;
+}
+
+void GameState::setVariable(int id, int value) {
+    // Escrever o valor atual não suja a página (evita cópias após snapshot)
+    // nem gera registro no journal
+    if (id < 0 || getVariable(id) == value) return;
+    (*writablePage(variables_, static_cast<std::size_t>(id) / PageSize))
+        [static_cast<std::size_t>(id) % PageSize] = value;
+    notify({Change::Variable, id, value});
+}
+
+bool GameState::getSelfSwitch(int mapId, int eventId, int index) const {
+    if (index < 0 || index >= SelfSwitchCount) return false;
+    return (getSelfSwitchMask(mapId, eventId) >> index) & 1u;
+}
+
+void GameState::setSelfSwitch(int mapId, int eventId, int index, bool value) {
+    if (index < 0 || index >= SelfSwitchCount) return;
+    std::uint8_t mask = getSelfSwitchMask(mapId, eventId);
+    const auto bit = static_cast<std::uint8_t>(1u << index);
+    mask = value ? static_cast<std::uint8_t>(mask | bit) : static_cast<std::uint8_t>(mask & ~bit);
+    setSelfSwitchMask(mapId, eventId, mask);
+}
+
+std::uint8_t GameState::getSelfSwitchMask(int mapId, int eventId) const {
+    auto it = selfSwitches_->find(selfSwitchKey(mapId, eventId));
+    return it != selfSwitches_->end() ? it->second : 0;
+}
+
+void GameState::setSelfSwitchMask(int mapId, int eventId, std::uint8_t mask) {
+    if (getSelfSwitchMask(mapId, eventId) == mask) return;
+    auto& table = detach(selfSwitches_);
+    if (mask == 0) {
+        table.erase(selfSwitchKey(mapId, eventId));
+    } else {
+        table[selfSwitchKey(mapId, eventId)] = mask;
+    }
+    notify({Change::SelfSwitch, eventId, mask, mapId});
+}
+
+void GameState::forEachSwitch(const std::function<void(int id)>& fn) const {
+    const auto& pages = switches_->pages;
+    for (std::size_t p = 0; p < pages.size(); ++p) {
+        if (!pages[p] || pages[p]->none()) continue;
+        for (std::size_t bit = 0; bit < PageSize; ++bit) {
+            if (pages[p]->test(bit)) {
+                fn(static_cast<int>(p * PageSize + bit));
+            }
+        }
+    }
+}
+
+void GameState::forEachVariable(const std::function<void(int id, int value)>& fn) const {
+    const auto& pages = variables_->pages;
+    for (std::size_t p = 0; p < pages.size(); ++p) {
+        if (!pages[p]) continue;
+        for (std::size_t i = 0; i < PageSize; ++i) {
+            if (int value = (*pages[p])[i]; value != 0) {
+                fn(static_cast<int>(p * PageSize + i), value);
+            }
+        }
+    }
+}
+
+void GameState::forEachSelfSwitch(const std::function<void(int mapId, int eventId, std::uint8_t mask)>& fn) const {
+    for (const auto& [key, mask] : *selfSwitches_) {
+        fn(static_cast<int>(static_cast<std::uint32_t>(key >> 32)),
+           static_cast<int>(static_cast<std::uint32_t>(key)), mask);
+    }
+}
+
+PlayerSaveData& GameState::writablePlayer() {
+    return detach(player_);
+}
+
+void GameState::setPlayer(const PlayerSaveData& player) {
+    writablePlayer() = player;
+    notify({Change::Reset});
+}
+
+void GameState::setPosition(int mapId, float x, float y, int direction) {
+    auto& p = writablePlayer();
+    p.mapId = mapId;
+    p.x = x;
+    p.y = y;
+    p.direction = direction;
+    notify({Change::Position});
+}
+
+void GameState::setStats(int level, int exp, int gold) {
+    auto& p = writablePlayer();
+    p.level = level;
+    p.exp = exp;
+    p.gold = gold;
+    notify({Change::Stats});
+}
+
+void GameState::setParty(const std::vector<int>& party) {
+    writablePlayer().party = party;
+    notify({Change::Party});
+}
+
+void GameState::setInventory(const std::vector<int>& inventory) {
+    writablePlayer().inventory = inventory;
+    notify({Change::Inventory});
+}
+
+void GameState::setMapName(const std::string& mapName) {
+    if (player_->mapName != mapName) {
+        writablePlayer().mapName = mapName;
+    }
+}
+
+void GameState::addPlaytime(double seconds) {
+    writablePlayer().playtimeSeconds += seconds;
+}
+
+void GameState::setChangeListener(ChangeListener listener) {
+    listener_ = std::move(listener);
+}
+
+std::size_t GameState::sharedPageCount(const GameState& other) const {
+    std::size_t shared = 0;
+    const auto countShared = [&shared](const auto& a, const auto& b) {
+        for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) {
+            if (a[i] && a[i] == b[i]) ++shared;
+        }
+    };
+    countShared(switches_->pages, other.switches_->pages);
+    countShared(variables_->pages, other.variables_->pages);
+    return shared;
+}
+
+void GameState::notify(const ChangeEvent& event) const {
+    if (listener_) {
+        listener_(event);
+    }
+}
@@ -0,0 +1,126 @@
+// src/game_state.hpp
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Estrutura para salvar dados do jogador
+struct PlayerSaveData {
+    int mapId = 1;
+    float x = 5.0f;
+    float y = 5.0f;
+    int direction = 2; // 0=up, 1=right, 2=down, 3=left
+    int level = 1;
+    int exp = 0;
+    int gold = 0;
+    std::vector<int> party; // IDs dos membros do grupo
+    std::vector<int> inventory; // IDs dos itens no inventário
+    std::string mapName; // Nome exibido na lista de slots
+    double playtimeSeconds = 0.0;
+};
+
+// Estado de jogo único compartilhado por EventSystem e SaveSystem.
+//
+// Switches e variáveis ficam em páginas de PageSize IDs, referenciadas por uma
+// tabela também compartilhada. Copiar um GameState (snapshot) copia só quatro
+// shared_ptr: O(1). A primeira escrita depois de um snapshot copia a tabela e
+// a página tocada; as demais páginas continuam compartilhadas.
+//
+// Não é thread-safe para escrita: um único thread escreve no estado vivo,
+// snapshots podem ser lidos em outros threads.
+class GameState {
+public:
+    static constexpr std::size_t PageSize = 256;
+    static constexpr int SelfSwitchCount = 4; // A, B, C, D
+
+    enum class Change { Switch, Variable, SelfSwitch, Position, Stats, Party, Inventory, Reset };
+
+    // id/value dependem do tipo: Switch/Variable -> ID e valor novo;
+    // SelfSwitch -> id = evento, mapId, value = máscara A-D resultante.
+    struct ChangeEvent {
+        Change type;
+        int id = 0;
+        int value = 0;
+        int mapId = 0;
+    };
+    using ChangeListener = std::function<void(const ChangeEvent&)>;
+
+    GameState();
+    // Cópias compartilham as páginas e não levam o listener junto (inclusive
+    // a partir de temporários: não há operações de move separadas)
+    GameState(const GameState& other);
+    GameState& operator=(const GameState& other);
+
+    GameState snapshot() const { return *this; }
+    // Volta para um snapshot (rollback/replay); notifica Change::Reset
+    void restore(const GameState& snapshot);
+    // Estado inicial de um jogo novo; notifica Change::Reset
+    void reset();
+
+    static PlayerSaveData defaultPlayer();
+
+    // Switches e variáveis globais (IDs negativos são ignorados; escrever o
+    // valor atual não notifica o listener)
+    bool getSwitch(int id) const;
+    void setSwitch(int id, bool value);
+    int getVariable(int id) const;
+    void setVariable(int id, int value);
+
+    // Self switches por evento (index 0-3 = A-D)
+    bool getSelfSwitch(int mapId, int eventId, int index) const;
+    void setSelfSwitch(int mapId, int eventId, int index, bool value);
+    std::uint8_t getSelfSwitchMask(int mapId, int eventId) const;
+    void setSelfSwitchMask(int mapId, int eventId, std::uint8_t mask);
+
+    // Iteração em ordem crescente de ID, só valores diferentes do padrão
+    void forEachSwitch(const std::function<void(int id)>& fn) const;
+    void forEachVariable(const std::function<void(int id, int value)>& fn) const;
+    void forEachSelfSwitch(const std::function<void(int mapId, int eventId, std::uint8_t mask)>& fn) const;
+
+    // Jogador
+    const PlayerSaveData& player() const { return *player_; }
+    void setPlayer(const PlayerSaveData& player);
+    void setPosition(int mapId, float x, float y, int direction);
+    void setStats(int level, int exp, int gold);
+    void setParty(const std::vector<int>& party);
+    void setInventory(const std::vector<int>& inventory);
+    void setMapName(const std::string& mapName);
+    void addPlaytime(double seconds);
+
+    // Um único ouvinte (o SaveSystem usa para o journal)
+    void setChangeListener(ChangeListener listener);
+
+    // Quantas páginas de switches/variáveis são compartilhadas com `other`
+    std::size_t sharedPageCount(const GameState& other) const;
+
+private:
+    using SwitchPage = std::bitset<PageSize>;
+    using VariablePage = std::array<int, PageSize>;
+
+    template <typename Page>
+    struct PageTable {
+        std::vector<std::shared_ptr<Page>> pages;
+    };
+
+    template <typename Page>
+    static Page* writablePage(std::shared_ptr<PageTable<Page>>& table, std::size_t index);
+    template <typename Page>
+    static const Page* findPage(const std::shared_ptr<PageTable<Page>>& table, std::size_t index);
+
+    PlayerSaveData& writablePlayer();
+    void notify(const ChangeEvent& event) const;
+
+    std::shared_ptr<PageTable<SwitchPage>> switches_;
+    std::shared_ptr<PageTable<VariablePage>> variables_;
+    // Self switches são esparsos: um único bloco copy-on-write basta
+    std::shared_ptr<std::map<std::uint64_t, std::uint8_t>> selfSwitches_;
+    std::shared_ptr<PlayerSaveData> player_;
+    ChangeListener listener_;
+};
@@ -0,0 +1,282 @@
+#include "hud.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+void appendQuad(std::vector<sf::Vertex>& out, sf::FloatRect rect, sf::Color color, sf::FloatRect texture = {}) {
+    const sf::Vector2f a = rect.position;
+    const sf::Vector2f b = rect.position + rect.size;
+    const sf::Vector2f ta = texture.position;
+    const sf::Vector2f tb = texture.position + texture.size;
+    out.push_back({a, color, ta});
+    out.push_back({{b.x, a.y}, color, {tb.x, ta.y}});
+    out.push_back({b, color, tb});
+    out.push_back({a, color, ta});
+    out.push_back({b, color, tb});
+    out.push_back({{a.x, b.y}, color, {ta.x, tb.y}});
+}
+
+// Next code point of UTF-8 text; malformed bytes come out as '?'
+char32_t decodeUtf8(std::string_view text, std::size_t& i) {
+    const auto lead = static_cast<unsigned char>(text[i++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+    const int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+    if (extra < 0 || i + static_cast<std::size_t>(extra) > text.size()) {
+        return U'?';
+    }
+    char32_t code = lead & (0x3Fu >> extra);
+    for (int k = 0; k < extra; ++k) {
+        code = (code << 6) | (static_cast<unsigned char>(text[i++]) & 0x3Fu);
+    }
+    return code;
+}
+
+void decodeUtf8(std::string_view text, std::u32string& out) {
+    out.clear();
+    for (std::size_t i = 0; i < text.size();) {
+        out.push_back(decodeUtf8(text, i));
+    }
+}
+
+} // namespace
+
+WidgetId Hud::addPanel(sf::FloatRect rect, sf::Color color) {
+    Widget& widget = widgets_.emplace_back();
+    widget.kind = Kind::Panel;
+    widget.rect = rect;
+    widget.color = color;
+    dirty_ = true;
+    return static_cast<WidgetId>(widgets_.size() - 1);
+}
+
+WidgetId Hud::addGauge(sf::FloatRect rect, sf::Color back, sf::Color fill, float ratio) {
+    Widget& widget = widgets_.emplace_back();
+    widget.kind = Kind::Gauge;
+    widget.rect = rect;
+    widget.color = back;
+    widget.fill = fill;
+    widget.ratio = std::clamp(ratio, 0.f, 1.f);
+    dirty_ = true;
+    return static_cast<WidgetId>(widgets_.size() - 1);
+}
+
+WidgetId Hud::addLabel(const sf::Font& font, unsigned characterSize, sf::Vector2f position, std::string_view pattern,
+                       sf::Color color) {
+    Widget& widget = widgets_.emplace_back();
+    widget.kind = Kind::Label;
+    widget.rect.position = position;
+    widget.color = color;
+    widget.font = &font;
+    widget.characterSize = characterSize;
+    widget.pattern = pattern;
+    // Numeric fields then only need glyphs that are already there
+    decodeUtf8(widget.pattern + "0123456789-", codes_);
+    glyphs_.preload(font, characterSize, false, codes_);
+    dirty_ = true;
+    return static_cast<WidgetId>(widgets_.size() - 1);
+}
+
+Hud::Widget* Hud::find(WidgetId id, Kind kind) {
+    return id < widgets_.size() && widgets_[id].kind == kind ? &widgets_[id] : nullptr;
+}
+
+void Hud::touch(Widget& widget) {
+    widget.dirty = true;
+    dirty_ = true;
+}
+
+void Hud::setText(WidgetId label, std::string_view pattern) {
+    Widget* widget = find(label, Kind::Label);
+    if (widget && widget->pattern != pattern) {
+        widget->pattern = pattern;
+        touch(*widget);
+    }
+}
+
+void Hud::setField(WidgetId label, std::size_t field, std::string_view text) {
+    Widget* widget = find(label, Kind::Label);
+    if (!widget) {
+        return;
+    }
+    if (widget->fields.size() <= field) {
+        widget->fields.resize(field + 1);
+    } else if (widget->fields[field] == text) {
+        return;
+    }
+    widget->fields[field] = text;
+    touch(*widget);
+}
+
+void Hud::setField(WidgetId label, std::size_t field, int value) {
+    char buffer[16];
+    const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    setField(label, field, std::string_view(buffer, static_cast<std::size_t>(end - buffer)));
+}
+
+void Hud::setRatio(WidgetId gauge, float ratio) {
+    Widget* widget = find(gauge, Kind::Gauge);
+    ratio = std::clamp(ratio, 0.f, 1.f);
+    if (widget && widget->ratio != ratio) {
+        widget->ratio = ratio;
+        touch(*widget);
+    }
+}
+
+void Hud::setColor(WidgetId id, sf::Color color) {
+    if (id < widgets_.size() && widgets_[id].color != color) {
+        widgets_[id].color = color;
+        touch(widgets_[id]);
+    }
+}
+
+void Hud::setVisible(WidgetId id, bool visible) {
+    if (id < widgets_.size() && widgets_[id].visible != visible) {
+        widgets_[id].visible = visible;
+        dirty_ = true; // Vertices stay valid; only the batches change
+    }
+}
+
+void Hud::layout(Widget& widget) const {
+    widget.vertices.clear();
+    switch (widget.kind) {
+    case Kind::Panel:
+        appendQuad(widget.vertices, widget.rect, widget.color);
+        break;
+    case Kind::Gauge: {
+        appendQuad(widget.vertices, widget.rect, widget.color);
+        sf::FloatRect filled = widget.rect;
+        filled.size.x *= widget.ratio;
+        if (filled.size.x > 0.f) {
+            appendQuad(widget.vertices, filled, widget.fill);
+        }
+        break;
+    }
+    case Kind::Label:
+        layoutText(widget);
+        break;
+    }
+    widget.dirty = false;
+    ++layoutCount_;
+}
+
+void Hud::layoutText(Widget& widget) const {
+    // Pattern with the fields substituted, in the reused scratch string
+    text_.clear();
+    std::size_t field = 0;
+    for (std::size_t i = 0; i < widget.pattern.size(); ++i) {
+        if (widget.pattern.compare(i, 2, "{}") == 0) {
+            if (field < widget.fields.size()) {
+                text_ += widget.fields[field];
+            }
+            ++field;
+            ++i;
+        } else {
+            text_ += widget.pattern[i];
+        }
+    }
+
+    // Same placement as sf::Text: first baseline one character size down,
+    // glyphs on whole pixels so the atlas isn't sampled between texels
+    const sf::Font& font = *widget.font;
+    const unsigned size = widget.characterSize;
+    decodeUtf8(text_, codes_);
+    glyphs_.preload(font, size, false, codes_);
+    const float lineSpacing = font.getLineSpacing(size);
+    const sf::Vector2f origin = widget.rect.position;
+    float x = 0.f;
+    float y = static_cast<float>(size);
+    char32_t previous = 0;
+    for (const char32_t code : codes_) {
+        x += font.getKerning(previous, code, size);
+        previous = code;
+        if (code == U'\n') {
+            x = 0.f;
+            y += lineSpacing;
+            continue;
+        }
+        const sf::Glyph& glyph = font.getGlyph(code, size, false);
+        if (glyph.textureRect.size.x > 0 && glyph.textureRect.size.y > 0) {
+            const sf::FloatRect quad{{std::round(origin.x + x + glyph.bounds.position.x),
+                                      std::round(origin.y + y + glyph.bounds.position.y)},
+                                     glyph.bounds.size};
+            appendQuad(widget.vertices, quad, widget.color, sf::FloatRect(glyph.textureRect));
+        }
+        x += glyph.advance;
+    }
+}
+
+void Hud::refresh() const {
+    if (!dirty_) {
+        return;
+    }
+    LUMY_PROFILE_SCOPE("Hud::refresh");
+    for (Widget& widget : widgets_) {
+        if (widget.dirty) {
+            layout(widget);
+        }
+    }
+
+    // Untextured batch first, then one per font atlas in order of first use
+    std::vector<Batch> batches(1);
+    std::vector<std::vector<sf::Vertex>> vertices(1);
+    for (const Widget& widget : widgets_) {
+        if (!widget.visible || widget.vertices.empty()) {
+            continue;
+        }
+        std::size_t index = 0;
+        if (widget.font) {
+            const auto it = std::find_if(batches.begin() + 1, batches.end(), [&](const Batch& batch) {
+                return batch.font == widget.font && batch.characterSize == widget.characterSize;
+            });
+            index = static_cast<std::size_t>(it - batches.begin());
+            if (it == batches.end()) {
+                batches.push_back({widget.font, widget.characterSize, nullptr});
+                vertices.emplace_back();
+            }
+        }
+        vertices[index].insert(vertices[index].end(), widget.vertices.begin(), widget.vertices.end());
+    }
+    batches_.clear();
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        if (!vertices[i].empty()) {
+            batches[i].vertices = std::make_shared<const std::vector<sf::Vertex>>(std::move(vertices[i]));
+            batches_.push_back(std::move(batches[i]));
+        }
+    }
+    dirty_ = false;
+}
+
+std::size_t Hud::batchCount() const {
+    refresh();
+    return batches_.size();
+}
+
+const std::vector<sf::Vertex>& Hud::vertices(WidgetId widget) const {
+    refresh();
+    return widgets_.at(widget).vertices;
+}
+
+void Hud::draw(sf::RenderTarget& target) const {
+    refresh();
+    for (const Batch& batch : batches_) {
+        sf::RenderStates states;
+        states.texture = batch.font ? &batch.font->getTexture(batch.characterSize) : nullptr;
+        target.draw(batch.vertices->data(), batch.vertices->size(), sf::PrimitiveType::Triangles, states);
+    }
+}
+
+void Hud::record(RenderCommandList& commands) const {
+    refresh();
+    for (const Batch& batch : batches_) {
+        sf::RenderStates states;
+        states.texture = batch.font ? &batch.font->getTexture(batch.characterSize) : nullptr;
+        commands.draw(batch.vertices, sf::PrimitiveType::Triangles, states);
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "render_commands.hpp"
+
+using WidgetId = std::uint32_t;
+
+// Retained-mode HUD. Widgets keep their laid-out vertices and are laid out
+// again only when something they show changes, so a steady frame costs one
+// draw call per batch and no text layout at all.
+//
+// Labels hold a pattern where each "{}" is replaced by the field with the same
+// index. Setting a field (or a gauge ratio) to the value it already has does
+// nothing, so callers can push their state every frame.
+//
+// Panels and gauges share one untextured batch, drawn first; labels are
+// batched per font atlas (font and character size) and drawn on top.
+// Coordinates are in the target's current view (usually screen space).
+//
+// Glyphs are loaded on the thread that lays labels out, into font pages a
+// recorded list may be drawing: a label preloads its pattern and the digits
+// when added, and a layout that brings other code points runs the fence set
+// with setFence() first.
+class Hud {
+public:
+    // Called before glyphs are added to a font page (SceneStack::fenceRender).
+    void setFence(std::function<void()> fence) { glyphs_.setFence(std::move(fence)); }
+
+    WidgetId addPanel(sf::FloatRect rect, sf::Color color);
+    WidgetId addGauge(sf::FloatRect rect, sf::Color back, sf::Color fill, float ratio = 1.f);
+    // The font must outlive the Hud.
+    WidgetId addLabel(const sf::Font& font, unsigned characterSize, sf::Vector2f position, std::string_view pattern,
+                      sf::Color color = sf::Color::White);
+
+    void setText(WidgetId label, std::string_view pattern);
+    void setField(WidgetId label, std::size_t field, std::string_view text);
+    void setField(WidgetId label, std::size_t field, int value);
+    void setRatio(WidgetId gauge, float ratio); // Clamped to [0, 1]
+    void setColor(WidgetId widget, sf::Color color);
+    void setVisible(WidgetId widget, bool visible);
+
+    std::size_t size() const { return widgets_.size(); }
+    // Widgets laid out so far; stays put on frames where nothing changed.
+    std::uint64_t layoutCount() const { return layoutCount_; }
+    // Vertex batches the next draw() issues.
+    std::size_t batchCount() const;
+    // Laid-out quads of one widget, 6 vertices each.
+    const std::vector<sf::Vertex>& vertices(WidgetId widget) const;
+
+    void draw(sf::RenderTarget& target) const;
+    // Records the cached batches as-is: no copy of the vertices.
+    void record(RenderCommandList& commands) const;
+
+private:
+    enum class Kind : std::uint8_t { Panel, Gauge, Label };
+
+    struct Widget {
+        Kind kind = Kind::Panel;
+        bool visible = true;
+        bool dirty = true;
+        sf::FloatRect rect;  // Panel and gauge
+        sf::Color color;     // Panel, gauge background, label text
+        sf::Color fill;      // Gauge
+        float ratio = 1.f;   // Gauge
+        const sf::Font* font = nullptr;
+        unsigned characterSize = 0;
+        std::string pattern;
+        std::vector<std::string> fields;
+        std::vector<sf::Vertex> vertices; // Laid out, in HUD coordinates
+    };
+
+    struct Batch {
+        const sf::Font* font = nullptr; // Null: panels and gauges
+        unsigned characterSize = 0;
+        RenderCommandList::VertexSnapshot vertices;
+    };
+
+    Widget* find(WidgetId id, Kind kind);
+    void touch(Widget& widget);
+    void layout(Widget& widget) const;
+    void layoutText(Widget& widget) const;
+    // Lays out dirty widgets and rebuilds the batches when anything changed.
+    void refresh() const;
+
+    mutable std::vector<Widget> widgets_;
+    mutable std::vector<Batch> batches_;
+    mutable std::string text_; // Scratch for pattern + fields
+    mutable std::u32string codes_; // text_ decoded
+    mutable GlyphPreloader glyphs_;
+    mutable std::uint64_t layoutCount_ = 0;
+    mutable bool dirty_ = false;
+};
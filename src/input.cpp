@@ -0,0 +1,279 @@
+#include "input.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+
+#include "save_codec.hpp"
+
+namespace {
+constexpr std::uint8_t Magic[4] = {'L', 'I', 'N', 'P'};
+constexpr std::uint8_t FormatVersion = 1;
+constexpr std::size_t HeaderSize = 4 + 1 + 2 + 4;
+
+// Record tag: (count << 1) | kind
+constexpr std::uint64_t RunRecord = 0;  // count steps of the snapshot that follows
+constexpr std::uint64_t SeedRecord = 1; // a 4-byte seed follows, count is 0
+} // namespace
+
+InputMap::InputMap() {
+    using Key = sf::Keyboard::Key;
+    bind(InputAction::Up, Key::W);
+    bind(InputAction::Up, Key::Up);
+    bind(InputAction::Down, Key::S);
+    bind(InputAction::Down, Key::Down);
+    bind(InputAction::Left, Key::A);
+    bind(InputAction::Left, Key::Left);
+    bind(InputAction::Right, Key::D);
+    bind(InputAction::Right, Key::Right);
+    bind(InputAction::Confirm, Key::Enter);
+    bind(InputAction::Confirm, Key::Space);
+    bind(InputAction::Cancel, Key::Backspace);
+    bind(InputAction::Cancel, Key::X);
+    bind(InputAction::QuickSave, Key::F5);
+    bind(InputAction::QuickLoad, Key::F9);
+}
+
+void InputMap::bind(InputAction action, sf::Keyboard::Key key) {
+    keys_[static_cast<std::size_t>(action)].push_back(key);
+}
+
+void InputMap::unbind(InputAction action) {
+    keys_[static_cast<std::size_t>(action)].clear();
+}
+
+std::uint16_t InputMap::actionsFor(sf::Keyboard::Key key) const {
+    std::uint16_t actions = 0;
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+        for (const auto bound : keys_[i]) {
+            if (bound == key) {
+                actions |= InputSnapshot::bit(static_cast<InputAction>(i));
+            }
+        }
+    }
+    return actions;
+}
+
+std::uint16_t InputMap::sampleHeld() const {
+    std::uint16_t held = 0;
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+        for (const auto key : keys_[i]) {
+            if (sf::Keyboard::isKeyPressed(key)) {
+                held |= InputSnapshot::bit(static_cast<InputAction>(i));
+                break;
+            }
+        }
+    }
+    return held;
+}
+
+InputRecorder::~InputRecorder() {
+    close();
+}
+
+bool InputRecorder::open(const std::string& path, std::uint32_t seed, std::uint16_t stepHz) {
+    close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cerr << "[Input] Não foi possível criar " << path << "\n";
+        return false;
+    }
+    ByteBuffer header(std::begin(Magic), std::end(Magic));
+    header.push_back(FormatVersion);
+    writeLE(header, stepHz, 2);
+    writeLE(header, seed, 4);
+    file_.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    run_ = {};
+    runLength_ = 0;
+    return true;
+}
+
+void InputRecorder::write(const InputSnapshot& snapshot) {
+    if (runLength_ > 0 && snapshot != run_) {
+        flushRun();
+    }
+    run_ = snapshot;
+    runLength_++;
+}
+
+void InputRecorder::writeSeed(std::uint32_t seed) {
+    flushRun();
+    ByteBuffer out;
+    encodeVarint(out, SeedRecord);
+    writeLE(out, seed, 4);
+    file_.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+}
+
+void InputRecorder::close() {
+    if (!file_.is_open()) {
+        return;
+    }
+    flushRun();
+    file_.close();
+}
+
+void InputRecorder::flushRun() {
+    if (runLength_ == 0) {
+        return;
+    }
+    ByteBuffer out;
+    encodeVarint(out, (runLength_ << 1) | RunRecord);
+    encodeVarint(out, run_.held);
+    encodeVarint(out, run_.pressed);
+    file_.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    runLength_ = 0;
+}
+
+bool InputReplay::load(const std::string& path) {
+    steps_.clear();
+    seeds_.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "[Input] Replay não encontrado: " << path << "\n";
+        return false;
+    }
+    const ByteBuffer data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < HeaderSize || !std::equal(std::begin(Magic), std::end(Magic), data.begin()) ||
+        data[4] != FormatVersion) {
+        std::cerr << "[Input] Arquivo de replay inválido: " << path << "\n";
+        return false;
+    }
+    stepHz_ = static_cast<std::uint16_t>(readLE(&data[5], 2));
+    seeds_.emplace_back(0, static_cast<std::uint32_t>(readLE(&data[7], 4)));
+
+    std::size_t pos = HeaderSize;
+    while (pos < data.size()) {
+        std::uint64_t tag = 0;
+        if (!decodeVarint(data, pos, tag)) {
+            break;
+        }
+        if ((tag & 1) == SeedRecord) {
+            if (pos + 4 > data.size()) {
+                break;
+            }
+            seeds_.emplace_back(steps_.size(), static_cast<std::uint32_t>(readLE(&data[pos], 4)));
+            pos += 4;
+            continue;
+        }
+        std::uint64_t held = 0;
+        std::uint64_t pressed = 0;
+        if (!decodeVarint(data, pos, held) || !decodeVarint(data, pos, pressed)) {
+            break;
+        }
+        const std::uint64_t run = tag >> 1;
+        if (run > MaxSteps - steps_.size()) {
+            std::cerr << "[Input] Replay corrompido (mais de " << MaxSteps << " passos): " << path << "\n";
+            steps_.clear();
+            seeds_.clear();
+            return false;
+        }
+        const InputSnapshot snapshot{static_cast<std::uint16_t>(held), static_cast<std::uint16_t>(pressed)};
+        steps_.insert(steps_.end(), static_cast<std::size_t>(tag >> 1), snapshot);
+    }
+    if (pos < data.size()) {
+        std::cerr << "[Input] Replay truncado em " << steps_.size() << " passos: " << path << "\n";
+    }
+    return true;
+}
+
+Input& Input::instance() {
+    static Input input;
+    return input;
+}
+
+void Input::handleEvent(const sf::Event& event) {
+    if (mode_ == Mode::Replaying || mode_ == Mode::Idle) {
+        return;
+    }
+    if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
+        pendingPressed_ |= bindings_.actionsFor(key->code);
+    }
+}
+
+void Input::beginStep() {
+    if (mode_ == Mode::Replaying) {
+        // Reseeds made between steps (or not repeated by the game) catch up here
+        applyReplaySeeds(false);
+        current_ = step_ < replay_.size() ? replay_.step(step_) : InputSnapshot{};
+    } else if (mode_ == Mode::Idle) {
+        current_ = {};
+    } else {
+        current_.held = bindings_.sampleHeld();
+        current_.pressed = pendingPressed_;
+        pendingPressed_ = 0;
+        if (mode_ == Mode::Recording) {
+            recorder_.write(current_);
+        }
+    }
+    step_++;
+}
+
+void Input::reseed(std::uint32_t seed) {
+    if (mode_ == Mode::Replaying) {
+        // Same call, same point of the step: the recorded seed takes effect
+        // here, not at the next beginStep, or the rest of the step would
+        // draw from the old sequence
+        applyReplaySeeds(true);
+        return;
+    }
+    rng_.seed(seed);
+    if (mode_ == Mode::Recording) {
+        // The current step's snapshot is already written, so the seed lands
+        // after step_ snapshots, which is what the replay compares against
+        recorder_.writeSeed(seed);
+    }
+}
+
+void Input::applyReplaySeeds(bool onlyOne) {
+    const auto& seeds = replay_.seeds();
+    while (nextSeed_ < seeds.size() && seeds[nextSeed_].first <= step_) {
+        rng_.seed(seeds[nextSeed_].second);
+        nextSeed_++;
+        if (onlyOne) {
+            break;
+        }
+    }
+}
+
+bool Input::startRecording(const std::string& path, std::uint32_t seed, std::uint16_t stepHz) {
+    stop();
+    if (!recorder_.open(path, seed, stepHz)) {
+        return false;
+    }
+    rng_.seed(seed);
+    mode_ = Mode::Recording;
+    std::cout << "[Input] Gravando input em " << path << " (seed " << seed << ")\n";
+    return true;
+}
+
+bool Input::startReplay(const std::string& path) {
+    stop();
+    if (!replay_.load(path)) {
+        return false;
+    }
+    mode_ = Mode::Replaying;
+    applyReplaySeeds(false); // Header seed, as startRecording does
+    std::cout << "[Input] Replay de " << path << ": " << replay_.size() << " passos a "
+              << replay_.stepHz() << " Hz\n";
+    return true;
+}
+
+void Input::startIdle(std::uint32_t seed) {
+    stop();
+    rng_.seed(seed);
+    mode_ = Mode::Idle;
+}
+
+void Input::stop() {
+    recorder_.close();
+    mode_ = Mode::Live;
+    current_ = {};
+    pendingPressed_ = 0;
+    step_ = 0;
+    nextSeed_ = 0;
+}
+
+bool Input::replayFinished() const {
+    return mode_ == Mode::Replaying && step_ >= replay_.size();
+}
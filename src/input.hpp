@@ -0,0 +1,158 @@
+#pragma once
+
+#include <SFML/Window/Event.hpp>
+#include <SFML/Window/Keyboard.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Logical input. Scenes ask for actions instead of keys, once per fixed
+// step, so a session can be recorded and replayed bit for bit:
+//
+//   if (Input::instance().isHeld(InputAction::Up)) { ... }
+//   if (Input::instance().wasPressed(InputAction::Confirm)) { ... }
+
+enum class InputAction : std::uint8_t {
+    Up,
+    Down,
+    Left,
+    Right,
+    Confirm,
+    Cancel,
+    QuickSave,
+    QuickLoad,
+};
+constexpr std::size_t InputActionCount = 8;
+
+// Input for one fixed step: one bit per InputAction.
+struct InputSnapshot {
+    std::uint16_t held = 0;    // Down during this step
+    std::uint16_t pressed = 0; // Went down since the previous step
+
+    bool isHeld(InputAction action) const { return held & bit(action); }
+    bool wasPressed(InputAction action) const { return pressed & bit(action); }
+    static std::uint16_t bit(InputAction action) { return static_cast<std::uint16_t>(1u << static_cast<unsigned>(action)); }
+
+    bool operator==(const InputSnapshot&) const = default;
+};
+
+// Raw keys to actions. Several keys may map to one action and vice versa.
+class InputMap {
+public:
+    InputMap(); // WASD/arrows, Enter/Space, Backspace/X, F5, F9
+
+    void bind(InputAction action, sf::Keyboard::Key key);
+    void unbind(InputAction action);
+    // Bitmask of the actions bound to key.
+    std::uint16_t actionsFor(sf::Keyboard::Key key) const;
+    // Bitmask of the actions whose keys are currently down.
+    std::uint16_t sampleHeld() const;
+
+private:
+    std::array<std::vector<sf::Keyboard::Key>, InputActionCount> keys_;
+};
+
+// Writes .linp files: a header (magic, version, step rate, seed) followed by
+// run-length encoded snapshots and mid-session reseeds, all as varints.
+class InputRecorder {
+public:
+    ~InputRecorder();
+
+    bool open(const std::string& path, std::uint32_t seed, std::uint16_t stepHz);
+    void write(const InputSnapshot& snapshot);
+    void writeSeed(std::uint32_t seed);
+    void close();
+    bool isOpen() const { return file_.is_open(); }
+
+private:
+    void flushRun();
+
+    std::ofstream file_;
+    InputSnapshot run_;
+    std::uint64_t runLength_ = 0;
+};
+
+// Reads a .linp file back into one snapshot per step.
+class InputReplay {
+public:
+    // Upper bound on a session (~77 h at 60 Hz, 64 MiB of snapshots). Run
+    // lengths come straight from the file, so a corrupt one is rejected
+    // instead of being expanded.
+    static constexpr std::size_t MaxSteps = std::size_t{1} << 24;
+
+    // false for a missing, invalid or oversized file (nothing is kept).
+    bool load(const std::string& path);
+
+    std::uint16_t stepHz() const { return stepHz_; }
+    std::size_t size() const { return steps_.size(); }
+    const InputSnapshot& step(std::size_t index) const { return steps_[index]; }
+    // Reseeds in order, keyed by how many steps had begun when they happened
+    // (0 = header seed, before the first step; k + 1 = during step k).
+    const std::vector<std::pair<std::size_t, std::uint32_t>>& seeds() const { return seeds_; }
+
+private:
+    std::uint16_t stepHz_ = 0;
+    std::vector<InputSnapshot> steps_;
+    std::vector<std::pair<std::size_t, std::uint32_t>> seeds_;
+};
+
+class Input {
+public:
+    // Idle: no input device at all (headless runs without a replay); every
+    // step is empty and the keyboard is never polled.
+    enum class Mode { Live, Recording, Replaying, Idle };
+
+    static Input& instance();
+
+    InputMap& bindings() { return bindings_; }
+
+    // Forwarded by GameLoop before the scene sees the event. Key presses
+    // become `pressed` edges of the next step; ignored while replaying.
+    void handleEvent(const sf::Event& event);
+    // Once per fixed step, before Scene::update: samples the keyboard (or
+    // takes the next recorded snapshot) and records it if recording.
+    void beginStep();
+
+    const InputSnapshot& current() const { return current_; }
+    bool isHeld(InputAction action) const { return current_.isHeld(action); }
+    bool wasPressed(InputAction action) const { return current_.wasPressed(action); }
+
+    // Gameplay randomness must come from here so replays match.
+    std::mt19937& rng() { return rng_; }
+    // Recorded at the point of the step it happens in. While replaying, the
+    // argument is ignored and the recorded seed is applied at the same call.
+    void reseed(std::uint32_t seed);
+
+    bool startRecording(const std::string& path, std::uint32_t seed, std::uint16_t stepHz);
+    bool startReplay(const std::string& path);
+    void startIdle(std::uint32_t seed);
+    // Closes the recording or leaves replay; back to live keyboard input.
+    void stop();
+
+    Mode mode() const { return mode_; }
+    bool replayFinished() const;
+    std::size_t stepIndex() const { return step_; }
+    std::uint16_t replayStepHz() const { return replay_.stepHz(); }
+
+private:
+    Input() = default;
+
+    // Replay: applies the recorded seeds due by now (just the next one if onlyOne).
+    void applyReplaySeeds(bool onlyOne);
+
+    InputMap bindings_;
+    Mode mode_ = Mode::Live;
+    InputSnapshot current_;
+    std::uint16_t pendingPressed_ = 0;
+    std::size_t step_ = 0;
+    std::size_t nextSeed_ = 0;
+    std::mt19937 rng_;
+    InputRecorder recorder_;
+    InputReplay replay_;
+};
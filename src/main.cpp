@@ -2,17 +2,92 @@
 #include <SFML/Graphics.hpp>
 #include <sol/sol.hpp>
 #include <tmxlite/Map.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <random>
+#include <string>
+#include <string_view>
 #include "boot_scene.hpp"
+#include "database.hpp"
+#include "map.hpp"
 #include "scene_stack.hpp"
-#include "delta_time.hpp"
+#include "game_loop.hpp"
+#include "input.hpp"
 #include "texture_manager.hpp"
+#include "vfs.hpp"
+
+namespace {
+// O pacote tem prioridade no Vfs: avisa quando um arquivo solto em game/ é
+// mais novo que ele, porque essa edição não apareceria no jogo
+void warnIfPackIsStale(const std::filesystem::path& packPath) {
+    std::error_code error;
+    const auto packTime = std::filesystem::last_write_time(packPath, error);
+    if (error || !std::filesystem::is_directory("game", error)) {
+        return;
+    }
+    std::filesystem::recursive_directory_iterator it("game", error);
+    for (const std::filesystem::recursive_directory_iterator end; !error && it != end; it.increment(error)) {
+        // Saves e cache são escritos pelo jogo e não entram no pacote
+        const auto name = it->path().filename();
+        if (it.depth() == 0 && (name == "saves" || name == "cache")) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (it->is_regular_file(error) && it->last_write_time(error) > packTime) {
+            std::cerr << "[Vfs] " << packPath.string() << " é mais antigo que " << it->path().generic_string()
+                      << "; rode o alvo game-pack\n";
+            return;
+        }
+    }
+}
+} // namespace
 
-int main() {
+int main(int argc, char** argv) {
     std::cout << "Lumy: hello-town iniciando...\n";
 
+    // Simulação em passo fixo de 60 Hz, render interpolado e pacing de ~60 FPS
+    GameLoopConfig loopConfig;
+    std::string recordPath;
+    std::string replayPath;
+    bool headless = false;
+    HeadlessConfig headlessConfig;
+    std::filesystem::path packPath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--threaded-render") {
+            loopConfig.threadedRender = true; // Render em thread separada
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--headless") {
+            headless = true; // Sem janela: --replay e/ou --steps, --speed, --headless-record
+        } else if (arg == "--steps" && i + 1 < argc) {
+            headlessConfig.maxSteps = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--speed" && i + 1 < argc) {
+            headlessConfig.speed = std::max(0.f, std::strtof(argv[++i], nullptr)); // 0 = máximo
+        } else if (arg == "--headless-record") {
+            headlessConfig.recordFrames = true;
+        } else if (arg == "--pack") {
+            // Arquivo opcional; padrão game.lpak (alvo game-pack)
+            packPath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : "game.lpak";
+        }
+    }
+
+    // Build empacotada: --pack monta o pacote, que tem prioridade sobre os
+    // arquivos soltos. Sem a opção tudo vem de game/, então um pacote antigo
+    // nunca esconde edições nos assets
+    if (!packPath.empty()) {
+        if (!Vfs::instance().mount(packPath)) {
+            std::cerr << "[Vfs] Falha ao montar " << packPath.string() << "\n";
+            return 1;
+        }
+        warnIfPackIsStale(packPath);
+    }
+
     // Teste rápido do Lua/sol2 (só para validar includes/links)
     try {
         sol::state lua;
@@ -25,9 +100,9 @@ int main() {
     // Teste opcional de TMX (não é obrigatório ter o arquivo)
     try {
         const char* tmxPath = "game/assets/maps/hello.tmx"; // mapa de exemplo em assets/maps
-        if (std::filesystem::exists(tmxPath)) {
+        if (Vfs::instance().exists(tmxPath)) {
             tmx::Map map;
-            if (map.load(tmxPath)) {
+            if (Map::loadTmx(map, tmxPath)) {
                 std::cout << "TMX carregado: " << tmxPath << "\n";
 
                 const auto tileCount = map.getTileCount();
@@ -48,73 +123,80 @@ int main() {
         std::cerr << "[TMX] erro: " << e.what() << "\n";
     }
 
-    // Janela SFML
-    const unsigned W = 640, H = 360;
-    auto window = std::make_unique<sf::RenderWindow>(
-        sf::VideoMode(sf::Vector2u{W, H}), "Lumy — hello-town");
-
-    // Limita o framerate para ~60 FPS via SFML
-    window->setFramerateLimit(60);
-    // Relógio de frame e controle de deltaTime/FPS
-    sf::Clock frameClock;
-    std::size_t fpsFrameCount = 0;
-    sf::Time fpsAccumulated = sf::Time::Zero;
-    const float maxDeltaTime = 1.f / 30.f;
+    // Database do jogo: JSON de game/data na primeira vez, depois o cache binário
+    Database database;
+    if (database.load("game/data")) {
+        const auto rows = [](const auto& table) {
+            return std::ranges::count_if(table.rows(), [](const auto& row) { return row.id != 0; });
+        };
+        std::cout << "[Database] " << rows(database.actors()) << " atores, " << rows(database.items()) << " itens, "
+                  << rows(database.skills()) << " skills, " << rows(database.enemies()) << " inimigos ("
+                  << (database.loadedFromCache() ? "cache" : "JSON") << ")\n";
+    } else {
+        std::cerr << "[Database] Falha ao carregar game/data\n";
+    }
 
     // Pilha de cenas: inicia em BootScene
-    TextureManager textures;
+    TextureManager textures(headless); // Headless: sem contexto OpenGL
     SceneStack stack;
     auto bootScene = std::make_unique<BootScene>(stack, textures);
     stack.pushScene(std::move(bootScene));
 
-    while (window->isOpen()) {
-        sf::Time elapsed = frameClock.restart();
-        float deltaTime = clampDeltaTime(elapsed.asSeconds(), maxDeltaTime);
-
-        // Média de FPS a cada ~1 segundo
-        fpsFrameCount++;
-        fpsAccumulated += elapsed;
-        if (fpsAccumulated >= sf::seconds(1.f)) {
-            float avgFps = static_cast<float>(fpsFrameCount) / fpsAccumulated.asSeconds();
-            std::cout << "FPS médio: " << avgFps << "\n";
-            fpsFrameCount = 0;
-            fpsAccumulated = sf::Time::Zero;
+    // Gravação/replay de input: trocas de cena esperam a cena preparada para
+    // acontecer sempre no mesmo passo
+    Input& input = Input::instance();
+    if (!replayPath.empty()) {
+        if (!input.startReplay(replayPath)) {
+            return 1;
         }
-
-        while (auto event = window->pollEvent()) {
-            if (event->is<sf::Event::Closed>()) {
-                window->close();
-            }
-            if (const auto* key = event->getIf<sf::Event::KeyPressed>()) {
-                if (key->code == sf::Keyboard::Key::Escape) {
-                    window->close();
-                }
-            }
-            if (auto* current = stack.current()) {
-                current->handleEvent(*event);
-            }
+        if (input.replayStepHz() > 0) {
+            loopConfig.simulationHz = static_cast<float>(input.replayStepHz());
         }
-
-        stack.applyPending();
-
-        if (!window->isOpen()) {
-            break;
+        stack.setWaitForPreparedScenes(true);
+    } else if (!recordPath.empty()) {
+        const auto seed = static_cast<std::uint32_t>(std::random_device{}());
+        if (!input.startRecording(recordPath, seed, static_cast<std::uint16_t>(loopConfig.simulationHz))) {
+            return 1;
         }
+        stack.setWaitForPreparedScenes(true);
+    }
 
-        if (auto* current = stack.current()) {
-            current->update(deltaTime);
+    if (headless) {
+        if (replayPath.empty() && headlessConfig.maxSteps == 0) {
+            std::cerr << "--headless requer --replay <arquivo> ou --steps <n>\n";
+            return 1;
         }
-
-        // 1. Limpar a tela
-        window->clear(sf::Color::Black);
-        // 2. Desenhar objetos
-        if (auto* current = stack.current()) {
-            current->draw(*window);
+        if (replayPath.empty()) {
+            input.startIdle(0); // Sem teclado; seed fixa para repetir a execução
+            stack.setWaitForPreparedScenes(true);
         }
-        // 3. Exibir o frame
-        window->display();
+        headlessConfig.simulationHz = loopConfig.simulationHz;
+        const HeadlessReport report = runHeadless(stack, headlessConfig);
+        input.stop();
+        std::cout << "Headless: " << report.steps << " passos em " << report.totalSeconds << " s ("
+                  << report.ticksPerSecond << " passos/s)"
+                  << " | média " << report.meanStepMs << " ms, p99 " << report.p99StepMs
+                  << " ms, pior " << report.maxStepMs << " ms\n";
+        std::cout << "Headless: memória de pico " << report.peakMemoryBytes / (1024 * 1024) << " MB";
+#if defined(LUMY_PROFILER)
+        std::cout << " | " << report.heapAllocations << " alocações de heap (pior passo " << report.maxStepAllocations
+                  << ", " << report.allocationFreeSteps << " passos sem alocar)";
+#else
+        std::cout << " | alocações: compile com LUMY_PROFILER";
+#endif
+        std::cout << "\n";
+        return 0;
     }
 
+    // Janela SFML
+    const unsigned W = 640, H = 360;
+    auto window = std::make_unique<sf::RenderWindow>(
+        sf::VideoMode(sf::Vector2u{W, H}), "Lumy — hello-town");
+
+    GameLoop loop(*window, stack, loopConfig);
+    loop.run();
+    input.stop();
+
     window.reset();
 
     std::cout << "Lumy: bye!\n";
@@ -8,26 +8,48 @@
 #include <SFML/Graphics/Vertex.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
 
+#include "profiler.hpp"
+#include "vfs.hpp"
+
+namespace {
+constexpr std::size_t MaxCollisionChanges = 4096;
+} // namespace
+
 Map::Map(TextureManager &textures) : textures_(textures) {}
 
+bool Map::loadTmx(tmx::Map &tmxMap, const std::string &path) {
+  const FileData file = Vfs::instance().read(path);
+  if (!file)
+    return false;
+  // Tilesets and images are resolved relative to the map's directory
+  return tmxMap.loadFromString(std::string(file.text()),
+                               std::filesystem::path(path).parent_path().generic_string());
+}
+
 bool Map::load(const std::string &path) {
   tmx::Map tmxMap;
-  if (!tmxMap.load(path)) {
+  if (!loadTmx(tmxMap, path)) {
     std::cerr << "Failed to load TMX: " << path << '\n';
     return false;
   }
+  return load(tmxMap, path);
+}
 
+bool Map::load(const tmx::Map &tmxMap, const std::string &path) {
   const auto tileCount = tmxMap.getTileCount();
   std::cout << "TMX loaded: " << tileCount.x << "x" << tileCount.y
             << " tiles, layers: " << tmxMap.getLayers().size() << '\n';
 
   tilesetTextures_.clear();
+  texturePaths_.clear();
   layers_.clear();
   tilesets_.clear();
   mapWidth_ = tileCount.x;
@@ -35,10 +57,12 @@ bool Map::load(const std::string &path) {
   tileSize_ = {tmxMap.getTileSize().x, tmxMap.getTileSize().y};
   collision_.clear();
   collision_.resize(static_cast<std::size_t>(mapWidth_) * mapHeight_, false);
+  collidableTiles_.clear();
+  collisionChanges_.clear();
+  ++collisionEpoch_;
 
   std::filesystem::path base = std::filesystem::path(path).parent_path();
   std::vector<TilesetInfo> tilesets;
-  std::unordered_set<std::uint32_t> collidableTiles;
 
   for (const auto &ts : tmxMap.getTilesets()) {
     std::filesystem::path texPath{ts.getImagePath()};
@@ -47,6 +71,7 @@ bool Map::load(const std::string &path) {
     }
     texPath = texPath.lexically_normal();
     const sf::Texture &tex = textures_.acquire(texPath);
+    texturePaths_.push_back(texPath);
     int first = static_cast<int>(ts.getFirstGID());
     tilesetTextures_.emplace(first, &tex);
     TilesetInfo info;
@@ -59,7 +84,7 @@ bool Map::load(const std::string &path) {
     for (const auto &tile : ts.getTiles()) {
       for (const auto &prop : tile.properties) {
         if (prop.getName() == "collidable" && prop.getBoolValue()) {
-          collidableTiles.insert(static_cast<std::uint32_t>(first + tile.ID));
+          collidableTiles_.insert(static_cast<std::uint32_t>(first + tile.ID));
         }
       }
     }
@@ -83,7 +108,7 @@ bool Map::load(const std::string &path) {
       (void)prop;
     }
 
-    std::unordered_map<const sf::Texture *, sf::VertexArray> batches;
+    std::unordered_map<const sf::Texture *, std::vector<sf::Vertex>> batches;
     const auto &tiles = tmxLayer.getTiles();
     TileLayer baseLayer;
     baseLayer.ids.resize(tiles.size());
@@ -94,7 +119,7 @@ bool Map::load(const std::string &path) {
     for (std::size_t i = 0; i < tiles.size(); ++i) {
       const auto &tile = tiles[i];
       baseLayer.ids[i] = tile.ID;
-      if (collidableTiles.count(tile.ID)) {
+      if (collidableTiles_.count(tile.ID)) {
         collision_[i] = true;
       }
     }
@@ -114,8 +139,7 @@ bool Map::load(const std::string &path) {
       if (!tsInfo)
         continue;
 
-      sf::VertexArray &va = batches[tsInfo->texture];
-      va.setPrimitiveType(sf::PrimitiveType::Triangles);
+      std::vector<sf::Vertex> &va = batches[tsInfo->texture];
 
       std::uint32_t localID = id - tsInfo->firstGid;
       unsigned tu = localID % tsInfo->columns;
@@ -157,15 +181,16 @@ bool Map::load(const std::string &path) {
         quad[v].texCoords = uv[v];
       }
 
-      va.append(quad[0]);
-      va.append(quad[1]);
-      va.append(quad[2]);
-      va.append(quad[0]);
-      va.append(quad[2]);
-      va.append(quad[3]);
+      va.push_back(quad[0]);
+      va.push_back(quad[1]);
+      va.push_back(quad[2]);
+      va.push_back(quad[0]);
+      va.push_back(quad[2]);
+      va.push_back(quad[3]);
     }
 
     if (batches.empty()) {
+      buildRowIndex(baseLayer);
       layers_.push_back(std::move(baseLayer));
     } else {
       for (auto &[texPtr, vertices] : batches) {
@@ -174,6 +199,7 @@ bool Map::load(const std::string &path) {
         tl.ids = baseLayer.ids;
         tl.vertices = std::move(vertices);
         tl.name = layerName;
+        buildRowIndex(tl);
         layers_.push_back(std::move(tl));
       }
     }
@@ -182,6 +208,27 @@ bool Map::load(const std::string &path) {
   return true;
 }
 
+std::size_t Map::memoryUsage() const {
+  std::size_t bytes = collision_.size() / 8;
+  for (const auto &layer : layers_)
+    bytes += layer.ids.capacity() * sizeof(std::uint32_t) +
+             layer.vertices.capacity() * sizeof(sf::Vertex) +
+             layer.rowStart.capacity() * sizeof(std::uint32_t);
+  return bytes;
+}
+
+std::size_t Map::textureMemoryUsage() const {
+  std::vector<const sf::Texture *> seen;
+  std::size_t bytes = 0;
+  for (const auto &[first, texture] : tilesetTextures_) {
+    if (std::find(seen.begin(), seen.end(), texture) != seen.end())
+      continue;
+    seen.push_back(texture);
+    bytes += static_cast<std::size_t>(texture->getSize().x) * texture->getSize().y * 4;
+  }
+  return bytes;
+}
+
 std::uint32_t Map::getTileID(std::size_t layer, unsigned x, unsigned y) const {
   if (layer >= layers_.size())
     return 0;
@@ -193,36 +240,69 @@ std::uint32_t Map::getTileID(std::size_t layer, unsigned x, unsigned y) const {
 }
 
 void Map::setTileID(std::size_t layer, unsigned x, unsigned y, std::uint32_t id) {
-  if (layer >= layers_.size())
+  if (layer >= layers_.size() || x >= mapWidth_ || y >= mapHeight_)
     return;
+  if (editDepth_ > 0) {
+    storeTile(layer, x, y, id);
+    return;
+  }
   TileLayer &tl = layers_[layer];
   std::size_t idx = static_cast<std::size_t>(y) * mapWidth_ + x;
   if (idx >= tl.ids.size())
     return;
   tl.ids[idx] = id;
+  tl.snapshot.reset();
+  refreshCollision(idx);
+
+  const TilesetInfo *tsInfo = findTileset(id);
+
+  // Quads are kept in row-major order, so an empty tile that gets an id
+  // inserts one and a cleared tile removes its own
+  const std::size_t quadIndex = findQuad(tl, x, y);
+  const std::size_t vertexIndex = quadIndex * 6;
+  const bool present =
+      vertexIndex < tl.rowStart[y + 1] &&
+      static_cast<unsigned>(tl.vertices[vertexIndex].position.x / static_cast<float>(tileSize_.x)) == x;
+  if (!tsInfo) {
+    if (present) {
+      tl.vertices.erase(tl.vertices.begin() + static_cast<std::ptrdiff_t>(vertexIndex),
+                        tl.vertices.begin() + static_cast<std::ptrdiff_t>(vertexIndex + 6));
+      for (std::size_t row = y + 1; row < tl.rowStart.size(); ++row)
+        tl.rowStart[row] -= 6;
+    }
+    return;
+  }
+  if (!present) {
+    tl.vertices.insert(tl.vertices.begin() + static_cast<std::ptrdiff_t>(vertexIndex), 6, sf::Vertex{});
+    for (std::size_t row = y + 1; row < tl.rowStart.size(); ++row)
+      tl.rowStart[row] += 6;
+  }
 
-  const TilesetInfo *tsInfo = nullptr;
+  tl.texture = tsInfo->texture;
+  writeQuad(&tl.vertices[vertexIndex], *tsInfo, id, x, y);
+}
+
+const Map::TilesetInfo *Map::findTileset(std::uint32_t id) const {
+  const TilesetInfo *found = nullptr;
   for (const auto &info : tilesets_) {
     if (id >= static_cast<std::uint32_t>(info.firstGid))
-      tsInfo = &info;
+      found = &info;
     else
       break;
   }
-  if (!tsInfo)
-    return;
-
-  tl.texture = tsInfo->texture;
+  return found;
+}
 
-  std::uint32_t localID = id - tsInfo->firstGid;
-  unsigned tu = localID % tsInfo->columns;
-  unsigned tv = localID / tsInfo->columns;
-  float tx = static_cast<float>(tu * tsInfo->tileSize.x);
-  float ty = static_cast<float>(tv * tsInfo->tileSize.y);
+void Map::writeQuad(sf::Vertex *quad, const TilesetInfo &tsInfo, std::uint32_t id, unsigned x, unsigned y) const {
+  std::uint32_t localID = id - tsInfo.firstGid;
+  unsigned tu = localID % tsInfo.columns;
+  unsigned tv = localID / tsInfo.columns;
+  float tx = static_cast<float>(tu * tsInfo.tileSize.x);
+  float ty = static_cast<float>(tv * tsInfo.tileSize.y);
 
   float px = static_cast<float>(x * tileSize_.x);
   float py = static_cast<float>(y * tileSize_.y);
 
-  sf::Vertex *quad = &tl.vertices[idx * 6];
   quad[0].position = {px, py};
   quad[1].position = {px + tileSize_.x, py};
   quad[2].position = {px + tileSize_.x, py + tileSize_.y};
@@ -231,11 +311,237 @@ void Map::setTileID(std::size_t layer, unsigned x, unsigned y, std::uint32_t id)
   quad[5].position = {px, py + tileSize_.y};
 
   quad[0].texCoords = {tx, ty};
-  quad[1].texCoords = {tx + tsInfo->tileSize.x, ty};
-  quad[2].texCoords = {tx + tsInfo->tileSize.x, ty + tsInfo->tileSize.y};
+  quad[1].texCoords = {tx + tsInfo.tileSize.x, ty};
+  quad[2].texCoords = {tx + tsInfo.tileSize.x, ty + tsInfo.tileSize.y};
   quad[3].texCoords = {tx, ty};
-  quad[4].texCoords = {tx + tsInfo->tileSize.x, ty + tsInfo->tileSize.y};
-  quad[5].texCoords = {tx, ty + tsInfo->tileSize.y};
+  quad[4].texCoords = {tx + tsInfo.tileSize.x, ty + tsInfo.tileSize.y};
+  quad[5].texCoords = {tx, ty + tsInfo.tileSize.y};
+}
+
+void Map::refreshCollision(std::size_t idx) {
+  // Collision is the union of every layer at this tile
+  bool collidable = false;
+  for (const auto &other : layers_) {
+    if (idx < other.ids.size() && collidableTiles_.count(other.ids[idx])) {
+      collidable = true;
+      break;
+    }
+  }
+  if (idx < collision_.size() && collision_[idx] != collidable) {
+    collision_[idx] = collidable;
+    if (collisionChanges_.size() >= MaxCollisionChanges) {
+      collisionChanges_.clear();
+      ++collisionEpoch_;
+    }
+    collisionChanges_.push_back(static_cast<std::uint32_t>(idx));
+  }
+}
+
+// ===== Region access =====
+
+template <typename Fn>
+void Map::forEachInRegion(const sf::IntRect &region, Fn &&fn) const {
+  // fn(offset in the region buffer, tile x, tile y) for the cells inside the map
+  const int x0 = std::max(region.position.x, 0);
+  const int y0 = std::max(region.position.y, 0);
+  const int x1 = std::min(region.position.x + region.size.x, static_cast<int>(mapWidth_));
+  const int y1 = std::min(region.position.y + region.size.y, static_cast<int>(mapHeight_));
+  for (int y = y0; y < y1; ++y)
+    for (int x = x0; x < x1; ++x)
+      fn(static_cast<std::size_t>(y - region.position.y) * static_cast<std::size_t>(region.size.x) +
+             static_cast<std::size_t>(x - region.position.x),
+         static_cast<unsigned>(x), static_cast<unsigned>(y));
+}
+
+void Map::getRegion(std::size_t layer, const sf::IntRect &region, std::vector<std::uint32_t> &out) const {
+  out.assign(static_cast<std::size_t>(std::max(region.size.x, 0)) * static_cast<std::size_t>(std::max(region.size.y, 0)), 0);
+  if (layer >= layers_.size())
+    return;
+  const auto &ids = layers_[layer].ids;
+  forEachInRegion(region, [&](std::size_t offset, unsigned x, unsigned y) {
+    out[offset] = ids[static_cast<std::size_t>(y) * mapWidth_ + x];
+  });
+}
+
+bool Map::setRegion(std::size_t layer, const sf::IntRect &region, std::span<const std::uint32_t> ids) {
+  if (layer >= layers_.size() || region.size.x < 0 || region.size.y < 0 ||
+      ids.size() != static_cast<std::size_t>(region.size.x) * static_cast<std::size_t>(region.size.y))
+    return false;
+  beginEdit();
+  forEachInRegion(region, [&](std::size_t offset, unsigned x, unsigned y) { storeTile(layer, x, y, ids[offset]); });
+  endEdit();
+  return true;
+}
+
+void Map::fillRegion(std::size_t layer, const sf::IntRect &region, std::uint32_t id) {
+  if (layer >= layers_.size())
+    return;
+  beginEdit();
+  forEachInRegion(region, [&](std::size_t, unsigned x, unsigned y) { storeTile(layer, x, y, id); });
+  endEdit();
+}
+
+std::size_t Map::replaceInRegion(std::size_t layer, const sf::IntRect &region, std::uint32_t from, std::uint32_t to) {
+  if (layer >= layers_.size() || from == to)
+    return 0;
+  std::size_t replaced = 0;
+  beginEdit();
+  forEachInRegion(region, [&](std::size_t, unsigned x, unsigned y) {
+    if (layers_[layer].ids[static_cast<std::size_t>(y) * mapWidth_ + x] == from) {
+      storeTile(layer, x, y, to);
+      ++replaced;
+    }
+  });
+  endEdit();
+  return replaced;
+}
+
+void Map::getCollisionRegion(const sf::IntRect &region, std::vector<std::uint8_t> &out) const {
+  // Outside the map counts as blocked, like isCollidable()
+  out.assign(static_cast<std::size_t>(std::max(region.size.x, 0)) * static_cast<std::size_t>(std::max(region.size.y, 0)), 1);
+  forEachInRegion(region, [&](std::size_t offset, unsigned x, unsigned y) {
+    out[offset] = collision_[static_cast<std::size_t>(y) * mapWidth_ + x] ? 1 : 0;
+  });
+}
+
+std::size_t Map::countCollidable(const sf::IntRect &region) const {
+  std::size_t count = 0;
+  forEachInRegion(region, [&](std::size_t, unsigned x, unsigned y) {
+    count += collision_[static_cast<std::size_t>(y) * mapWidth_ + x] ? 1 : 0;
+  });
+  return count;
+}
+
+// ===== Batched edits =====
+
+void Map::beginEdit() {
+  ++editDepth_;
+}
+
+void Map::endEdit() {
+  if (editDepth_ == 0 || --editDepth_ > 0)
+    return;
+  for (auto &layer : layers_) {
+    if (layer.dirtyFirst < layer.dirtyLast)
+      rebuildRows(layer, layer.dirtyFirst, layer.dirtyLast);
+    layer.dirtyFirst = std::numeric_limits<unsigned>::max();
+    layer.dirtyLast = 0;
+    layer.touched.clear();
+  }
+}
+
+void Map::storeTile(std::size_t layer, unsigned x, unsigned y, std::uint32_t id) {
+  TileLayer &tl = layers_[layer];
+  const std::size_t idx = static_cast<std::size_t>(y) * mapWidth_ + x;
+  if (idx >= tl.ids.size() || tl.ids[idx] == id)
+    return;
+  tl.ids[idx] = id;
+  tl.snapshot.reset();
+  refreshCollision(idx);
+  if (tl.touched.empty())
+    tl.touched.assign(tl.ids.size(), false);
+  tl.touched[idx] = true;
+  tl.dirtyFirst = std::min(tl.dirtyFirst, y);
+  tl.dirtyLast = std::max(tl.dirtyLast, y + 1);
+}
+
+void Map::rebuildRows(TileLayer &layer, unsigned first, unsigned last) {
+  // Rows [first, last) are rebuilt in one pass: touched tiles get a fresh
+  // quad (or none), the others keep theirs (flip flags included)
+  const std::uint32_t begin = layer.rowStart[first];
+  const std::uint32_t end = layer.rowStart[last];
+  std::vector<sf::Vertex> rows;
+  rows.reserve(end - begin + 6u * mapWidth_);
+  std::vector<std::uint32_t> starts(last - first);
+  for (unsigned y = first; y < last; ++y) {
+    starts[y - first] = begin + static_cast<std::uint32_t>(rows.size());
+    std::uint32_t quad = layer.rowStart[y];
+    const std::uint32_t rowEnd = layer.rowStart[y + 1];
+    for (unsigned x = 0; x < mapWidth_; ++x) {
+      const bool present =
+          quad < rowEnd &&
+          static_cast<unsigned>(layer.vertices[quad].position.x / static_cast<float>(tileSize_.x)) == x;
+      const std::size_t idx = static_cast<std::size_t>(y) * mapWidth_ + x;
+      if (!layer.touched[idx]) {
+        if (present)
+          rows.insert(rows.end(), layer.vertices.begin() + quad, layer.vertices.begin() + quad + 6);
+      } else if (const TilesetInfo *tsInfo = findTileset(layer.ids[idx])) {
+        layer.texture = tsInfo->texture;
+        rows.resize(rows.size() + 6);
+        writeQuad(&rows[rows.size() - 6], *tsInfo, layer.ids[idx], x, y);
+      }
+      if (present)
+        quad += 6;
+    }
+  }
+
+  layer.vertices.erase(layer.vertices.begin() + begin, layer.vertices.begin() + end);
+  layer.vertices.insert(layer.vertices.begin() + begin, rows.begin(), rows.end());
+  for (unsigned y = first; y < last; ++y)
+    layer.rowStart[y] = starts[y - first];
+  const std::uint32_t newEnd = begin + static_cast<std::uint32_t>(rows.size());
+  for (std::size_t row = last; row < layer.rowStart.size(); ++row)
+    layer.rowStart[row] = layer.rowStart[row] - end + newEnd;
+  layer.snapshot.reset();
+}
+
+void Map::buildRowIndex(TileLayer &layer) const {
+  layer.rowStart.assign(static_cast<std::size_t>(mapHeight_) + 1, 0);
+  // Count quads per row, then prefix-sum into starting offsets
+  for (std::size_t v = 0; v < layer.vertices.size(); v += 6) {
+    const auto row = static_cast<std::size_t>(layer.vertices[v].position.y / static_cast<float>(tileSize_.y));
+    if (row < mapHeight_)
+      layer.rowStart[row + 1] += 6;
+  }
+  for (std::size_t row = 1; row < layer.rowStart.size(); ++row)
+    layer.rowStart[row] += layer.rowStart[row - 1];
+}
+
+std::size_t Map::findQuad(const TileLayer &layer, unsigned x, unsigned y) const {
+  // First quad of row y whose column is >= x
+  std::size_t lo = layer.rowStart[y] / 6;
+  std::size_t hi = layer.rowStart[y + 1] / 6;
+  while (lo < hi) {
+    const std::size_t mid = (lo + hi) / 2;
+    const auto column = static_cast<unsigned>(layer.vertices[mid * 6].position.x / static_cast<float>(tileSize_.x));
+    if (column < x)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+template <typename Fn>
+void Map::forEachVisibleSpan(const TileLayer &layer, const sf::FloatRect &visible, Fn &&fn) const {
+  if (layer.vertices.empty() || mapWidth_ == 0 || mapHeight_ == 0)
+    return;
+  const float tw = static_cast<float>(tileSize_.x);
+  const float th = static_cast<float>(tileSize_.y);
+  const auto toTile = [](float value, float size, unsigned limit) {
+    return static_cast<unsigned>(std::clamp(std::floor(value / size), 0.f, static_cast<float>(limit)));
+  };
+  const unsigned x0 = toTile(visible.position.x, tw, mapWidth_);
+  const unsigned x1 = toTile(visible.position.x + visible.size.x + tw, tw, mapWidth_);
+  const unsigned y0 = toTile(visible.position.y, th, mapHeight_);
+  const unsigned y1 = toTile(visible.position.y + visible.size.y + th, th, mapHeight_);
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  // Narrow views over wide maps draw a span per row; otherwise whole rows in
+  // one run are cheaper than the extra draw calls
+  if ((x1 - x0) * 2 >= mapWidth_) {
+    const std::size_t first = layer.rowStart[y0];
+    if (layer.rowStart[y1] > first)
+      fn(first, layer.rowStart[y1] - first);
+    return;
+  }
+  for (unsigned y = y0; y < y1; ++y) {
+    const std::size_t first = findQuad(layer, x0, y) * 6;
+    const std::size_t last = findQuad(layer, x1, y) * 6;
+    if (last > first)
+      fn(first, last - first);
+  }
 }
 
 bool Map::isCollidable(unsigned x, unsigned y) const {
@@ -255,28 +561,65 @@ void Map::drawLayer(std::size_t index, sf::RenderTarget &target) const {
   drawRange(index, index + 1, target);
 }
 
+namespace {
+// Axis-aligned area covered by a view (rotated views use their bounding box)
+sf::FloatRect visibleArea(const sf::View &view) {
+  sf::Vector2f size = view.getSize();
+  if (view.getRotation() != sf::Angle::Zero) {
+    const float diagonal = size.length();
+    size = {diagonal, diagonal};
+  }
+  return {view.getCenter() - size / 2.f, size};
+}
+} // namespace
+
 void Map::drawRange(std::size_t first, std::size_t last,
                      sf::RenderTarget &target) const {
+  LUMY_PROFILE_SCOPE("Map::drawRange");
   if (first >= layers_.size())
     return;
   if (last > layers_.size())
     last = layers_.size();
 
+  const sf::FloatRect visible = visibleArea(target.getView());
   sf::RenderStates states;
-  const sf::Texture *currentTexture = nullptr;
+  for (std::size_t i = first; i < last; ++i) {
+    const auto &layer = layers_[i];
+    states.texture = layer.texture;
+    forEachVisibleSpan(layer, visible, [&](std::size_t vertex, std::size_t count) {
+      target.draw(layer.vertices.data() + vertex, count, sf::PrimitiveType::Triangles, states);
+    });
+  }
+}
+
+void Map::recordRange(std::size_t first, std::size_t last,
+                      RenderCommandList &commands,
+                      const std::optional<sf::FloatRect> &visible) const {
+  LUMY_PROFILE_SCOPE("Map::recordRange");
+  if (last > layers_.size())
+    last = layers_.size();
 
   for (std::size_t i = first; i < last; ++i) {
     const auto &layer = layers_[i];
-    if (layer.vertices.getVertexCount() == 0)
+    if (layer.vertices.empty())
       continue;
 
-    if (layer.texture != currentTexture) {
-      currentTexture = layer.texture;
-      states.texture = currentTexture;
+    sf::RenderStates states;
+    states.texture = layer.texture;
+    if (visible) {
+      // Copy only what is on screen; the list owns it until it is replayed
+      auto vertices = snapshots_.acquire();
+      forEachVisibleSpan(layer, *visible, [&](std::size_t vertex, std::size_t count) {
+        const auto begin = layer.vertices.begin() + static_cast<std::ptrdiff_t>(vertex);
+        vertices->insert(vertices->end(), begin, begin + static_cast<std::ptrdiff_t>(count));
+      });
+      if (!vertices->empty())
+        commands.draw(std::move(vertices), sf::PrimitiveType::Triangles, states);
+      continue;
     }
 
-    // Future extension: perform view-based culling here to skip drawing tiles
-    // outside the visible area, reducing unnecessary draw calls.
-    target.draw(layer.vertices, states);
+    if (!layer.snapshot)
+      layer.snapshot = std::make_shared<const std::vector<sf::Vertex>>(layer.vertices);
+    commands.draw(layer.snapshot, sf::PrimitiveType::Triangles, states);
   }
 }
@@ -1,23 +1,38 @@
 #pragma once
 
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Vertex.hpp>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <cstdint>
 #include <cstddef>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <span>
 #include <vector>
 #include <string>
 
+#include "render_commands.hpp"
 #include "texture_manager.hpp"
 
+namespace tmx {
+class Map;
+}
+
 class Map {
 public:
     explicit Map(TextureManager& textures);
 
     // Loads a TMX map from the given path. Returns true on success.
     bool load(const std::string& path);
+    // Builds the map from an already parsed TMX; path locates its tilesets.
+    bool load(const tmx::Map& tmxMap, const std::string& path);
+    // Parses a TMX file read through the Vfs (archive or loose file).
+    static bool loadTmx(tmx::Map& tmxMap, const std::string& path);
 
     // Draws all loaded layers to the given render target.
     void draw(sf::RenderTarget& target) const;
@@ -26,28 +41,93 @@ public:
     void drawLayer(std::size_t index, sf::RenderTarget& target) const;
 
     // Draws layers in the range [first, last). If last exceeds the layer count,
-    // it is clamped to the end.
+    // it is clamped to the end. Only tiles inside the target's current view
+    // are drawn.
     void drawRange(std::size_t first, std::size_t last, sf::RenderTarget& target) const;
 
+    // Same as drawRange, for the threaded renderer. Without a visible rect,
+    // layers are shared as immutable snapshots that are only copied again
+    // after setTileID; with one, the visible tiles are copied.
+    void recordRange(std::size_t first, std::size_t last, RenderCommandList& commands,
+                     const std::optional<sf::FloatRect>& visible = std::nullopt) const;
+
     std::size_t getLayerCount() const { return layers_.size(); }
     const std::string& getLayerName(std::size_t index) const { return layers_[index].name; }
 
     std::uint32_t getTileID(std::size_t layer, unsigned x, unsigned y) const;
     void setTileID(std::size_t layer, unsigned x, unsigned y, std::uint32_t id);
 
+    // Region access for scripts and procedural edits. Regions are in tiles and
+    // buffers are row-major, region.size.x * region.size.y entries. Cells
+    // outside the map read as 0 and are skipped on write.
+    void getRegion(std::size_t layer, const sf::IntRect& region, std::vector<std::uint32_t>& out) const;
+    // False if ids doesn't match the region size or the layer doesn't exist.
+    bool setRegion(std::size_t layer, const sf::IntRect& region, std::span<const std::uint32_t> ids);
+    void fillRegion(std::size_t layer, const sf::IntRect& region, std::uint32_t id);
+    // Replaces every `from` inside region with `to`; returns the tiles changed.
+    std::size_t replaceInRegion(std::size_t layer, const sf::IntRect& region, std::uint32_t from, std::uint32_t to);
+    // 1 where the tile blocks movement (outside the map included), else 0.
+    void getCollisionRegion(const sf::IntRect& region, std::vector<std::uint8_t>& out) const;
+    std::size_t countCollidable(const sf::IntRect& region) const;
+
+    // Groups edits: between beginEdit() and the matching endEdit(), tile
+    // writes (setTileID and the region calls) only update ids and collision,
+    // and endEdit() rebuilds the touched rows of each layer in one pass. The
+    // region calls open their own group, so one call is one geometry update.
+    void beginEdit();
+    void endEdit();
+
     const sf::Vector2u& getTileSize() const { return tileSize_; }
+    sf::Vector2f getPixelSize() const {
+        return {static_cast<float>(mapWidth_ * tileSize_.x), static_cast<float>(mapHeight_ * tileSize_.y)};
+    }
     unsigned getWidth() const { return mapWidth_; }
     unsigned getHeight() const { return mapHeight_; }
     bool isCollidable(unsigned x, unsigned y) const;
+    // Approximate heap bytes held by tiles, vertices and collision (textures
+    // belong to the TextureManager and are not counted).
+    std::size_t memoryUsage() const;
+    // Tileset images acquired from the TextureManager by load(), and the
+    // bytes their pixels take (RGBA).
+    const std::vector<std::filesystem::path>& texturePaths() const { return texturePaths_; }
+    std::size_t textureMemoryUsage() const;
+
+    // Collision edits for incremental consumers (pathfinding). The epoch
+    // changes on every load(); within an epoch, collisionChanges() lists the
+    // tile indices (y * width + x) whose collision flipped through
+    // setTileID, oldest first. A long log is dropped for a new epoch, so
+    // consumers that fall behind rebuild instead.
+    std::uint32_t collisionEpoch() const { return collisionEpoch_; }
+    const std::vector<std::uint32_t>& collisionChanges() const { return collisionChanges_; }
 
 private:
     struct TileLayer {
         const sf::Texture* texture{};
         std::vector<std::uint32_t> ids;
-        sf::VertexArray vertices;
+        // One quad (6 vertices) per non-empty tile, in row-major order;
+        // rowStart[y] is the first vertex of row y (height + 1 entries).
+        std::vector<sf::Vertex> vertices;
+        std::vector<std::uint32_t> rowStart;
         std::string name;
+        mutable RenderCommandList::VertexSnapshot snapshot; // Built on demand by recordRange
+        // Pending batched edit: rows [dirtyFirst, dirtyLast) and the tiles written
+        unsigned dirtyFirst = std::numeric_limits<unsigned>::max();
+        unsigned dirtyLast = 0;
+        std::vector<bool> touched;
     };
 
+    // Calls fn(firstVertex, vertexCount) for each run of the layer's
+    // vertices that covers the tiles inside visible.
+    template <typename Fn>
+    void forEachVisibleSpan(const TileLayer& layer, const sf::FloatRect& visible, Fn&& fn) const;
+    template <typename Fn>
+    void forEachInRegion(const sf::IntRect& region, Fn&& fn) const;
+    std::size_t findQuad(const TileLayer& layer, unsigned x, unsigned y) const;
+    void buildRowIndex(TileLayer& layer) const;
+    void storeTile(std::size_t layer, unsigned x, unsigned y, std::uint32_t id);
+    void refreshCollision(std::size_t index);
+    void rebuildRows(TileLayer& layer, unsigned first, unsigned last);
+
     struct TilesetInfo {
         int firstGid{};
         sf::Vector2u tileSize;
@@ -55,13 +135,22 @@ private:
         const sf::Texture* texture{};
     };
 
+    const TilesetInfo* findTileset(std::uint32_t id) const;
+    void writeQuad(sf::Vertex* quad, const TilesetInfo& tileset, std::uint32_t id, unsigned x, unsigned y) const;
+
     TextureManager& textures_;
     std::unordered_map<int, const sf::Texture*> tilesetTextures_;
+    std::vector<std::filesystem::path> texturePaths_;
     std::vector<TileLayer> layers_;
     std::vector<TilesetInfo> tilesets_;
     unsigned mapWidth_{};
     unsigned mapHeight_{};
     sf::Vector2u tileSize_{};
     std::vector<bool> collision_;
+    std::unordered_set<std::uint32_t> collidableTiles_;
+    std::uint32_t collisionEpoch_{};
+    std::vector<std::uint32_t> collisionChanges_;
+    int editDepth_ = 0;
+    mutable VertexSnapshotPool snapshots_; // Visible spans recorded by recordRange
 };
 
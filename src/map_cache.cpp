@@ -0,0 +1,215 @@
+#include "map_cache.hpp"
+#include "profiler.hpp"
+
+#include <tmxlite/Layer.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+MapCache::MapCache(TextureManager& textures, std::size_t budgetBytes) : textures_(textures), budget_(budgetBytes) {}
+
+MapCache::~MapCache() {
+    std::lock_guard lock(mutex_);
+    for (auto& [path, entry] : entries_) {
+        if (entry.loading.valid()) {
+            entry.ready = entry.loading.get();
+        }
+        drop(std::move(entry.ready));
+    }
+}
+
+std::unique_ptr<PreparedMap> MapCache::load(TextureManager& textures, const std::string& path) {
+    LUMY_PROFILE_SCOPE("MapCache::load");
+    auto prepared = std::make_unique<PreparedMap>(textures);
+    prepared->path = path;
+    if (!Map::loadTmx(prepared->tmx, path) || !prepared->map.load(prepared->tmx, path)) {
+        return nullptr;
+    }
+    // The parsed tile layers stay alive with the TMX (the scene reads its objects)
+    std::size_t tiles = 0;
+    for (const auto& layer : prepared->tmx.getLayers()) {
+        if (layer->getType() == tmx::Layer::Type::Tile) {
+            tiles += layer->getLayerAs<tmx::TileLayer>().getTiles().size();
+        }
+    }
+    // Tilesets shared with the map on screen are charged too: the cache can't
+    // tell which of them would outlive an eviction
+    prepared->bytes = prepared->map.memoryUsage() + tiles * sizeof(tmx::TileLayer::Tile) +
+                      prepared->map.textureMemoryUsage();
+    return prepared;
+}
+
+void MapCache::prefetch(const std::vector<std::string>& paths) {
+    std::lock_guard lock(mutex_);
+    ++requests_;
+    for (const std::string& path : paths) {
+        Entry& entry = entries_[path];
+        entry.requested = requests_;
+        if (entry.ready || entry.loading.valid()) {
+            continue;
+        }
+        entry.queued = true;
+    }
+    startNext();
+}
+
+std::unique_ptr<PreparedMap> MapCache::take(const std::string& path) {
+    Entry entry;
+    bool inFlight = false;
+    {
+        std::lock_guard lock(mutex_);
+        const auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            entry = std::move(it->second);
+            entries_.erase(it);
+            if (entry.ready) {
+                bytes_ -= entry.ready->bytes;
+            }
+            inFlight = entry.loading.valid();
+        }
+    }
+    // Waiting happens outside the lock so update() keeps going meanwhile; the
+    // reservation stays until the load lands, so nothing else starts
+    if (inFlight) {
+        std::unique_ptr<PreparedMap> prepared = entry.loading.get();
+        std::lock_guard lock(mutex_);
+        loadingPath_.clear();
+        reserved_ = 0;
+        if (prepared) {
+            largestMap_ = std::max(largestMap_, prepared->bytes);
+        }
+        return prepared;
+    }
+    if (entry.ready) {
+        return std::move(entry.ready);
+    }
+    std::cout << "[MapCache] Mapa fora do cache, carregando agora: " << path << "\n";
+    return load(textures_, path);
+}
+
+void MapCache::update() {
+    std::lock_guard lock(mutex_);
+    collect();
+    evict();
+    startNext();
+}
+
+void MapCache::collect() {
+    if (loadingPath_.empty()) {
+        return;
+    }
+    const auto it = entries_.find(loadingPath_);
+    // Gone (or listed again) while take() waits: it clears the reservation
+    if (it == entries_.end() || !it->second.loading.valid() ||
+        it->second.loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    std::unique_ptr<PreparedMap> prepared = it->second.loading.get();
+    loadingPath_.clear();
+    reserved_ = 0;
+    if (!prepared) {
+        std::cerr << "[MapCache] Falha ao pré-carregar " << it->first << "\n";
+        entries_.erase(it);
+        return;
+    }
+    largestMap_ = std::max(largestMap_, prepared->bytes);
+    bytes_ += prepared->bytes;
+    it->second.ready = std::move(prepared);
+}
+
+void MapCache::evict() {
+    while (bytes_ + reserved_ > budget_) {
+        auto oldest = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->second.ready && (oldest == entries_.end() || it->second.requested < oldest->second.requested)) {
+                oldest = it;
+            }
+        }
+        if (oldest == entries_.end()) {
+            return;
+        }
+        std::cout << "[MapCache] Orçamento excedido, descartando " << oldest->first << "\n";
+        bytes_ -= oldest->second.ready->bytes;
+        drop(std::move(oldest->second.ready));
+        entries_.erase(oldest);
+    }
+}
+
+void MapCache::startNext() {
+    if (!loadingPath_.empty()) {
+        return;
+    }
+    auto next = entries_.end();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->second.queued && (next == entries_.end() || it->second.requested > next->second.requested)) {
+            next = it;
+        }
+    }
+    if (next == entries_.end()) {
+        return;
+    }
+    // Make room with maps requested before this one; ones listed by the same
+    // prefetch() are kept, and the load waits for take() to free space
+    const std::size_t estimate = largestMap_;
+    while (bytes_ + estimate > budget_) {
+        auto oldest = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->second.ready && it->second.requested < next->second.requested &&
+                (oldest == entries_.end() || it->second.requested < oldest->second.requested)) {
+                oldest = it;
+            }
+        }
+        if (oldest == entries_.end()) {
+            break;
+        }
+        std::cout << "[MapCache] Abrindo espaço, descartando " << oldest->first << "\n";
+        bytes_ -= oldest->second.ready->bytes;
+        drop(std::move(oldest->second.ready));
+        entries_.erase(oldest);
+    }
+    if (bytes_ > 0 && bytes_ + estimate > budget_) {
+        return;
+    }
+    next->second.queued = false;
+    loadingPath_ = next->first;
+    reserved_ = estimate;
+    next->second.loading =
+        std::async(std::launch::async, [&textures = textures_, path = next->first] { return load(textures, path); });
+}
+
+void MapCache::drop(std::unique_ptr<PreparedMap> prepared) {
+    if (!prepared) {
+        return;
+    }
+    // The geometry points at the textures, so it goes first
+    const std::vector<std::filesystem::path> texturePaths = prepared->map.texturePaths();
+    prepared.reset();
+    for (const std::filesystem::path& texturePath : texturePaths) {
+        textures_.release(texturePath);
+    }
+}
+
+bool MapCache::contains(const std::string& path) const {
+    std::lock_guard lock(mutex_);
+    return entries_.contains(path);
+}
+
+bool MapCache::isReady(const std::string& path) const {
+    std::lock_guard lock(mutex_);
+    const auto it = entries_.find(path);
+    return it != entries_.end() && it->second.ready != nullptr;
+}
+
+bool MapCache::isLoading(const std::string& path) const {
+    std::lock_guard lock(mutex_);
+    const auto it = entries_.find(path);
+    return it != entries_.end() && it->second.loading.valid();
+}
+
+std::size_t MapCache::bytes() const {
+    std::lock_guard lock(mutex_);
+    return bytes_ + reserved_;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <tmxlite/Map.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "map.hpp"
+
+class TextureManager;
+
+// A map ready to be shown: TMX parsed (objects and properties for the
+// scene), geometry built and tileset textures loaded.
+struct PreparedMap {
+    explicit PreparedMap(TextureManager& textures) : map(textures) {}
+
+    std::string path;
+    tmx::Map tmx;
+    Map map;
+    std::size_t bytes = 0; // Charged against the cache budget
+};
+
+// Maps loaded ahead of time for transfers. A scene lists the maps reachable
+// from it (doors, TransferPlayer commands) with prefetch(); they load on a
+// worker thread and wait here until take() hands one over, so the transfer
+// does not pay for parsing, geometry or textures.
+//
+// Prefetches are queued and loaded one at a time, most recently requested
+// first. Ready maps are kept within a byte budget (Map::memoryUsage, the
+// parsed tiles and the tileset pixels); the load in flight reserves the size
+// of the largest map seen so far. When a load would not fit, the maps
+// requested longest ago are dropped, and their textures are released.
+// Thread-safe: take() is usually called from a SceneStack::prepareScene
+// worker while the main thread keeps calling update().
+class MapCache {
+public:
+    static constexpr std::size_t DefaultBudget = 64u << 20;
+
+    explicit MapCache(TextureManager& textures, std::size_t budgetBytes = DefaultBudget);
+    // Waits for the load in flight and releases the textures of maps nobody took.
+    ~MapCache();
+
+    // Queues every path that is neither cached nor queued; the listed maps
+    // become the most recently requested ones.
+    void prefetch(const std::vector<std::string>& paths);
+    // Removes path from the cache and returns it, waiting for an in-flight
+    // load or loading it right away on a miss. Null if the map can't be read.
+    std::unique_ptr<PreparedMap> take(const std::string& path);
+    // Collects the finished load, enforces the budget and starts the next
+    // queued one; call once per step.
+    void update();
+
+    bool contains(const std::string& path) const; // Ready, loading or queued
+    bool isReady(const std::string& path) const;
+    bool isLoading(const std::string& path) const;
+    // Ready maps plus the reservation for the load in flight.
+    std::size_t bytes() const;
+    std::size_t budget() const { return budget_; }
+
+    // Parses and builds path on the calling thread.
+    static std::unique_ptr<PreparedMap> load(TextureManager& textures, const std::string& path);
+
+private:
+    struct Entry {
+        std::future<std::unique_ptr<PreparedMap>> loading;
+        std::unique_ptr<PreparedMap> ready;
+        std::uint64_t requested = 0; // prefetch() call that last listed it
+        bool queued = false;
+    };
+
+    void collect();
+    void evict();
+    void startNext();
+    void drop(std::unique_ptr<PreparedMap> prepared);
+
+    TextureManager& textures_;
+    std::size_t budget_;
+    std::size_t bytes_ = 0;
+    std::size_t reserved_ = 0;   // Charged for loadingPath_ until it lands
+    std::size_t largestMap_ = 0; // Estimate for a load that hasn't finished
+    std::string loadingPath_;    // Empty when nothing is in flight
+    std::uint64_t requests_ = 0;
+    std::unordered_map<std::string, Entry> entries_;
+    mutable std::mutex mutex_;
+};
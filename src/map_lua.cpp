@@ -0,0 +1,198 @@
+#include "map_lua.hpp"
+#include "map.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace {
+
+// Far edges are computed in 64 bits: Map walks [x, x + w) with ints.
+sf::IntRect region(int x, int y, int w, int h) {
+    if (w < 0 || h < 0) {
+        throw sol::error("map: region size must not be negative");
+    }
+    constexpr std::int64_t maxEdge = std::numeric_limits<int>::max();
+    if (std::int64_t{x} + w > maxEdge || std::int64_t{y} + h > maxEdge) {
+        throw sol::error("map: region out of range");
+    }
+    return {{x, y}, {w, h}};
+}
+
+// Same rect clipped to the map; for calls whose result doesn't depend on the
+// cells outside it.
+sf::IntRect clipped(const Map& map, int x, int y, int w, int h) {
+    const sf::IntRect area = region(x, y, w, h);
+    const int x0 = std::max(area.position.x, 0);
+    const int y0 = std::max(area.position.y, 0);
+    const int x1 = std::min(area.position.x + area.size.x, static_cast<int>(map.getWidth()));
+    const int y1 = std::min(area.position.y + area.size.y, static_cast<int>(map.getHeight()));
+    return {{x0, y0}, {std::max(x1 - x0, 0), std::max(y1 - y0, 0)}};
+}
+
+// For calls that allocate w * h entries: the rect must lie inside the map, so
+// a script can't ask for more than one layer's worth of memory.
+sf::IntRect bounded(const Map& map, int x, int y, int w, int h) {
+    const sf::IntRect area = region(x, y, w, h);
+    if (x < 0 || y < 0 || x + w > static_cast<int>(map.getWidth()) || y + h > static_cast<int>(map.getHeight())) {
+        throw sol::error("map: region must lie inside the map (use map.view to look past its edges)");
+    }
+    return area;
+}
+
+// TileBuffer.new allocates too: no dimension may exceed the map's.
+TileBuffer newBuffer(const Map& map, int w, int h, std::uint32_t fill) {
+    if (w < 0 || h < 0) {
+        throw sol::error("TileBuffer.new: size must not be negative");
+    }
+    if (w > static_cast<int>(map.getWidth()) || h > static_cast<int>(map.getHeight())) {
+        throw sol::error("TileBuffer.new: buffer must not be larger than the map");
+    }
+    return TileBuffer(w, h, fill);
+}
+
+std::size_t layerIndex(const Map& map, int layer) {
+    if (layer < 0 || static_cast<std::size_t>(layer) >= map.getLayerCount()) {
+        throw sol::error("map: no layer " + std::to_string(layer));
+    }
+    return static_cast<std::size_t>(layer);
+}
+
+} // namespace
+
+TileBuffer::TileBuffer(int w, int h, std::uint32_t fill)
+    : width(std::max(w, 0)), height(std::max(h, 0)),
+      ids(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), fill) {}
+
+std::uint32_t TileBuffer::get(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return 0;
+    }
+    return ids[static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x)];
+}
+
+void TileBuffer::set(int x, int y, std::uint32_t id) {
+    if (x >= 0 && y >= 0 && x < width && y < height) {
+        ids[static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x)] = id;
+    }
+}
+
+void TileBuffer::fill(std::uint32_t id) {
+    std::fill(ids.begin(), ids.end(), id);
+}
+
+TileLayerView::TileLayerView(const Map& map, std::size_t layer, const sf::IntRect& area)
+    : width(area.size.x), height(area.size.y), map_(&map), layer_(layer), origin_(area.position) {}
+
+std::uint32_t TileLayerView::get(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return 0;
+    }
+    const int mapX = origin_.x + x;
+    const int mapY = origin_.y + y;
+    if (mapX < 0 || mapY < 0 || mapX >= static_cast<int>(map_->getWidth()) || mapY >= static_cast<int>(map_->getHeight())) {
+        return 0;
+    }
+    return map_->getTileID(layer_, static_cast<unsigned>(mapX), static_cast<unsigned>(mapY));
+}
+
+void bindMapApi(sol::state& lua, Map& map) {
+    lua.new_usertype<TileBuffer>(
+        "TileBuffer", sol::no_constructor,
+        "new", sol::factories([&map](int w, int h) { return newBuffer(map, w, h, 0); },
+                              [&map](int w, int h, std::uint32_t fill) { return newBuffer(map, w, h, fill); }),
+        "width", sol::readonly(&TileBuffer::width),
+        "height", sol::readonly(&TileBuffer::height),
+        "get", &TileBuffer::get,
+        "set", &TileBuffer::set,
+        "fill", &TileBuffer::fill);
+
+    lua.new_usertype<TileLayerView>(
+        "TileLayerView", sol::no_constructor,
+        "width", sol::readonly(&TileLayerView::width),
+        "height", sol::readonly(&TileLayerView::height),
+        "get", &TileLayerView::get);
+
+    sol::table api = lua.create_table();
+    api.set_function("width", [&map] { return map.getWidth(); });
+    api.set_function("height", [&map] { return map.getHeight(); });
+    api.set_function("layer_count", [&map] { return map.getLayerCount(); });
+
+    api.set_function("get", [&map](int layer, unsigned x, unsigned y) {
+        return map.getTileID(layerIndex(map, layer), x, y);
+    });
+    api.set_function("set", [&map](int layer, unsigned x, unsigned y, std::uint32_t id) {
+        map.setTileID(layerIndex(map, layer), x, y, id);
+    });
+
+    api.set_function("read", [&map](int layer, int x, int y, int w, int h) {
+        LUMY_PROFILE_SCOPE("MapLua::read");
+        TileBuffer buffer;
+        buffer.width = w;
+        buffer.height = h;
+        map.getRegion(layerIndex(map, layer), bounded(map, x, y, w, h), buffer.ids);
+        return buffer;
+    });
+    api.set_function("read_table", [&map, &lua](int layer, int x, int y, int w, int h) {
+        LUMY_PROFILE_SCOPE("MapLua::read");
+        std::vector<std::uint32_t> ids;
+        map.getRegion(layerIndex(map, layer), bounded(map, x, y, w, h), ids);
+        sol::table out = lua.create_table(static_cast<int>(ids.size()), 0);
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            out[i + 1] = ids[i];
+        }
+        return out;
+    });
+    api.set_function("view", [&map](int layer, int x, int y, int w, int h) {
+        return TileLayerView(map, layerIndex(map, layer), region(x, y, w, h));
+    });
+
+    api.set_function("write", [&map](int layer, int x, int y, const TileBuffer& buffer) {
+        LUMY_PROFILE_SCOPE("MapLua::write");
+        map.setRegion(layerIndex(map, layer), region(x, y, buffer.width, buffer.height), buffer.ids);
+    });
+    api.set_function("write_table", [&map](int layer, int x, int y, int w, int h, const sol::table& ids) {
+        LUMY_PROFILE_SCOPE("MapLua::write");
+        const sf::IntRect area = bounded(map, x, y, w, h);
+        std::vector<std::uint32_t> values(static_cast<std::size_t>(w) * static_cast<std::size_t>(h));
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i] = ids.get_or<std::uint32_t>(i + 1, 0u); // Missing entries clear the tile
+        }
+        map.setRegion(layerIndex(map, layer), area, values);
+    });
+
+    api.set_function("fill", [&map](int layer, int x, int y, int w, int h, std::uint32_t id) {
+        map.fillRegion(layerIndex(map, layer), clipped(map, x, y, w, h), id);
+    });
+    api.set_function("replace", [&map](int layer, int x, int y, int w, int h, std::uint32_t from, std::uint32_t to) {
+        return map.replaceInRegion(layerIndex(map, layer), clipped(map, x, y, w, h), from, to);
+    });
+
+    api.set_function("collision", [&map](int x, int y, int w, int h) {
+        std::vector<std::uint8_t> blocked;
+        map.getCollisionRegion(bounded(map, x, y, w, h), blocked);
+        TileBuffer buffer;
+        buffer.width = w;
+        buffer.height = h;
+        buffer.ids.assign(blocked.begin(), blocked.end());
+        return buffer;
+    });
+    api.set_function("count_collidable", [&map](int x, int y, int w, int h) {
+        return map.countCollidable(clipped(map, x, y, w, h));
+    });
+
+    api.set_function("edit", [&map](const sol::protected_function& body) {
+        LUMY_PROFILE_SCOPE("MapLua::edit");
+        map.beginEdit();
+        const sol::protected_function_result result = body();
+        map.endEdit(); // Also when the script failed: what it wrote stays consistent
+        if (!result.valid()) {
+            const sol::error error = result;
+            throw sol::error(std::string("map.edit: ") + error.what());
+        }
+    });
+
+    lua["map"] = api;
+}
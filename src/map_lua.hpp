@@ -0,0 +1,69 @@
+#pragma once
+
+#include <sol/sol.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Map;
+
+// Tile ids of a rectangular region (row-major), owned by C++ and handed to
+// Lua as userdata. Scripts edit it in place with get/set, and map.write()
+// takes it as-is, so a whole region crosses between Lua and C++ once instead
+// of once per tile. Coordinates are 0-based, like the map's.
+struct TileBuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint32_t> ids;
+
+    TileBuffer() = default;
+    TileBuffer(int w, int h, std::uint32_t fill = 0);
+
+    // 0 outside the buffer; writes outside it are ignored.
+    std::uint32_t get(int x, int y) const;
+    void set(int x, int y, std::uint32_t id);
+    void fill(std::uint32_t id);
+};
+
+// Read-only window over a rectangle of one layer, without copying it: get()
+// reads the map's own rows, so later writes show through. 0 outside the
+// window or the map. Only valid while the map is, like the "map" table.
+class TileLayerView {
+public:
+    TileLayerView(const Map& map, std::size_t layer, const sf::IntRect& area);
+
+    std::uint32_t get(int x, int y) const;
+
+    int width = 0;
+    int height = 0;
+
+private:
+    const Map* map_;
+    std::size_t layer_;
+    sf::Vector2i origin_;
+};
+
+// Registers the TileBuffer type and a global "map" table bound to map, which
+// must outlive lua. Every region call is one geometry update; map.edit(fn)
+// groups everything fn does (single-tile sets included) into one. Regions
+// are checked before they reach Map: read, read_table, write_table and
+// collision allocate w * h entries, so their rect must lie inside the map
+// (and TileBuffer.new can't be wider or taller than it); fill, replace and
+// count_collidable clip it to the map instead.
+//
+//   map.width(), map.height(), map.layer_count()
+//   map.get(layer, x, y), map.set(layer, x, y, id)
+//   map.read(layer, x, y, w, h) -> TileBuffer (a copy)
+//   map.view(layer, x, y, w, h) -> TileLayerView (no copy, read-only)
+//   map.read_table(layer, x, y, w, h) -> array of w * h ids
+//   map.write(layer, x, y, buffer), map.write_table(layer, x, y, w, h, ids)
+//   map.fill(layer, x, y, w, h, id)
+//   map.replace(layer, x, y, w, h, from, to) -> tiles changed
+//   map.collision(x, y, w, h) -> TileBuffer of 0/1
+//   map.count_collidable(x, y, w, h)
+//   map.edit(function() ... end)
+//   TileBuffer.new(w, h [, id])
+void bindMapApi(sol::state& lua, Map& map);
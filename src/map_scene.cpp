@@ -1,5 +1,11 @@
 #include "map_scene.hpp"
 #include "scene_stack.hpp"
+#include "frame_arena.hpp"
+#include "render_commands.hpp"
+#include "input.hpp"
+#include "map_lua.hpp"
+#include "pause_scene.hpp"
+#include <random>
 #include <SFML/Window/Keyboard.hpp>
 #include <SFML/Window/Event.hpp>
 #include <tmxlite/Map.hpp>
@@ -7,18 +13,34 @@
 #include <tmxlite/Object.hpp>
 #include <tmxlite/ObjectGroup.hpp>
 #include <iostream>
+#include <filesystem>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 MapScene::MapScene(SceneStack& stack, TextureManager& textures, const std::string& tmxPath)
-    : sceneStack_(stack), textures_(textures), map_(textures_) {
-    map_.load(tmxPath);
+    : MapScene(stack, textures, MapTransfer{tmxPath}) {}
+
+MapScene::MapScene(SceneStack& stack, TextureManager& textures, MapTransfer transfer)
+    : sceneStack_(stack), textures_(textures), tmxPath_(std::move(transfer.tmxPath)), mapId_(transfer.mapId),
+      mapCache_(transfer.cache ? std::move(transfer.cache) : std::make_shared<MapCache>(textures)),
+      map_(transfer.prepared ? std::move(transfer.prepared->map) : Map(textures)) {
+    // Mapa vindo do cache já está pronto; senão, TMX lido uma vez para o Map e para os objetos
+    tmx::Map loadedTmx;
+    const tmx::Map* tmxMap = nullptr;
+    if (transfer.prepared) {
+        tmxMap = &transfer.prepared->tmx;
+    } else if (Map::loadTmx(loadedTmx, tmxPath_) && map_.load(loadedTmx, tmxPath_)) {
+        tmxMap = &loadedTmx;
+    } else {
+        std::cerr << "[MapScene] Falha ao carregar " << tmxPath_ << "\n";
+    }
 
     sf::Vector2f startPos{0.f, 0.f};
-    tmx::Map tmxMap;
-    if (tmxMap.load(tmxPath)) {
+    std::string script; // Propriedade "script": Lua executado ao entrar no mapa
+    if (tmxMap) {
         bool found = false;
-        for (const auto& layer : tmxMap.getLayers()) {
+        for (const auto& layer : tmxMap->getLayers()) {
             if (layer->getType() != tmx::Layer::Type::Object)
                 continue;
             const auto& group = layer->getLayerAs<tmx::ObjectGroup>();
@@ -35,25 +57,43 @@ MapScene::MapScene(SceneStack& stack, TextureManager& textures, const std::strin
             if (found)
                 break;
         }
-        if (!found) {
-            for (const auto& prop : tmxMap.getProperties()) {
-                if (prop.getName() == "spawn_x") {
-                    startPos.x = static_cast<float>(prop.getIntValue());
-                } else if (prop.getName() == "spawn_y") {
-                    startPos.y = static_cast<float>(prop.getIntValue());
-                }
+        for (const auto& prop : tmxMap->getProperties()) {
+            if (!found && prop.getName() == "spawn_x") {
+                startPos.x = static_cast<float>(prop.getIntValue());
+            } else if (!found && prop.getName() == "spawn_y") {
+                startPos.y = static_cast<float>(prop.getIntValue());
+            } else if (prop.getName() == "id") {
+                mapId_ = prop.getIntValue();
+            } else if (prop.getName() == "script") {
+                script = prop.getStringValue();
             }
         }
+        spawnNpcs(*tmxMap);
+        setupWeather(*tmxMap);
+        setupDoors(*tmxMap);
+    }
+    if (transfer.position) {
+        startPos = *transfer.position;
+    }
+    if (transfer.state) {
+        gameState_ = *transfer.state; // Antes de eventos e saves usarem o estado
     }
 
     hero_.setSize(sf::Vector2f{64.f, 64.f});
     hero_.setFillColor(sf::Color::White);
     hero_.setOrigin(sf::Vector2f{32.f, 32.f});
-    hero_.setPosition(startPos);
+    camera_.setWorldBounds({{0.f, 0.f}, map_.getPixelSize()});
+    camera_.setDeadzone({64.f, 48.f});
+    camera_.setSmoothing(0.12f);
+    teleportHero(startPos);
+    onDoor_ = std::any_of(doors_.begin(), doors_.end(), [&](const Door& door) { return door.area.contains(startPos); });
     
     // Inicializar sistemas
-    eventSystem_ = std::make_unique<EventSystem>(&sceneStack_, &textures_);
-    saveSystem_ = std::make_unique<SaveSystem>();
+    eventSystem_ = std::make_unique<EventSystem>(&sceneStack_, &textures_, &gameState_);
+    eventSystem_->setTextureAtlas(&atlas_);
+    atlas_.setFence([&stack = sceneStack_] { stack.fenceRender(); });
+    hud_.setFence([&stack = sceneStack_] { stack.fenceRender(); });
+    saveSystem_ = std::make_unique<SaveSystem>(gameState_);
     
     if (!eventSystem_->initialize()) {
         std::cerr << "[MapScene] Falha ao inicializar EventSystem\n";
@@ -62,57 +102,51 @@ MapScene::MapScene(SceneStack& stack, TextureManager& textures, const std::strin
     if (!saveSystem_->initialize("game")) {
         std::cerr << "[MapScene] Falha ao inicializar SaveSystem\n";
     }
+    saveSystem_->setMapName(std::filesystem::path(tmxPath_).stem().string());
+    eventSystem_->setTransferHandler([this](const TransferTarget& target) { transferTo(target); });
     
     // Tentar carregar fonte para UI
-    if (uiFont_.openFromFile("game/font.ttf")) {
-        uiText_.emplace(uiFont_);
-        uiText_->setCharacterSize(14);
-        uiText_->setFillColor(sf::Color::Yellow);
-        uiText_->setPosition({10, 10});
+    uiFontData_ = Vfs::instance().read("game/font.ttf");
+    if (uiFontData_ && uiFont_.openFromMemory(uiFontData_.data(), uiFontData_.size())) {
+        constexpr unsigned UiSize = 14;
+        const float line = uiFont_.getLineSpacing(UiSize);
+        positionLabel_ = hud_.addLabel(uiFont_, UiSize, {10.f, 10.f}, "Posição: ({}, {})", sf::Color::Yellow);
+        hud_.addLabel(uiFont_, UiSize, {10.f, 10.f + line},
+                      "Controles: WASD=Mover, Enter/Space=Interagir\n"
+                      "F5=QuickSave, F9=QuickLoad, AltGr+N=Save, Ctrl+AltGr+N=Load, Shift+AltGr+N=Delete",
+                      sf::Color::Yellow);
+        stateLabel_ = hud_.addLabel(uiFont_, UiSize, {10.f, 10.f + 3.f * line}, "Switches: 1={}, Variável 1={}",
+                                    sf::Color::Yellow);
     }
     
     setupExampleEvents();
+    
+    // Scripts editam o mapa por regiões (map.read/write/fill...), não tile a tile
+    bindMapApi(eventSystem_->luaState(), map_);
+    if (!script.empty()) {
+        eventSystem_->runScript((std::filesystem::path(tmxPath_).parent_path() / script).lexically_normal().generic_string());
+    }
+    prefetchNeighbors();
 }
 
 void MapScene::handleEvent(const sf::Event& event) {
-    // Se há um evento sendo executado, delegar para o sistema de eventos
+    // Confirm, movimento e quick save/load chegam como ações em update();
+    // aqui ficam só os atalhos de depuração, que não entram em replays
     if (eventSystem_ && eventSystem_->isEventRunning()) {
-        eventSystem_->handleInput(event);
         return;
     }
     
-    // Input normal do jogo
     if (const auto* mouse = event.getIf<sf::Event::MouseButtonPressed>()) {
         if (mouse->button == sf::Mouse::Button::Left) {
-            hero_.setPosition({static_cast<float>(mouse->position.x),
-                               static_cast<float>(mouse->position.y)});
+            // Janela -> resolução interna -> mundo
+            const sf::Vector2f internal = windowSize_.x > 0 ? world_.toInternal(mouse->position, windowSize_)
+                                                            : sf::Vector2f(mouse->position);
+            teleportHero(camera_.visibleRect().position + internal);
         }
     }
     
     // Teclas especiais
     if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
-        if (key->code == sf::Keyboard::Key::Enter || key->code == sf::Keyboard::Key::Space) {
-            checkEventTriggers();
-        } else if (key->code == sf::Keyboard::Key::F5) {
-            // Quick save
-            if (saveSystem_) {
-                sf::Vector2f pos = hero_.getPosition();
-                saveSystem_->setPlayerPosition(1, pos.x, pos.y, 2);
-                saveSystem_->saveGame(1);
-                std::cout << "[MapScene] Quick save realizado\n";
-            }
-        } else if (key->code == sf::Keyboard::Key::F9) {
-            // Quick load
-            if (saveSystem_ && saveSystem_->saveExists(1)) {
-                int mapId, direction;
-                float x, y;
-                saveSystem_->loadGame(1);
-                saveSystem_->getPlayerPosition(mapId, x, y, direction);
-                hero_.setPosition({x, y});
-                std::cout << "[MapScene] Quick load realizado\n";
-            }
-        }
-        
         // Atalhos AltGr + números (1-9) para saves
         if (key->alt && !key->control && !key->shift) {
             if (key->code >= sf::Keyboard::Key::Num1 && key->code <= sf::Keyboard::Key::Num9) {
@@ -120,7 +154,7 @@ void MapScene::handleEvent(const sf::Event& event) {
                 
                 if (saveSystem_) {
                     sf::Vector2f pos = hero_.getPosition();
-                    saveSystem_->setPlayerPosition(1, pos.x, pos.y, 2);
+                    saveSystem_->setPlayerPosition(mapId_, pos.x, pos.y, 2);
                     if (saveSystem_->saveGame(slotId)) {
                         std::cout << "[MapScene] Save realizado no slot " << slotId << std::endl;
                     }
@@ -138,7 +172,7 @@ void MapScene::handleEvent(const sf::Event& event) {
                     float x, y;
                     if (saveSystem_->loadGame(slotId)) {
                         saveSystem_->getPlayerPosition(mapId, x, y, direction);
-                        hero_.setPosition({x, y});
+                        teleportHero({x, y});
                         std::cout << "[MapScene] Load realizado do slot " << slotId << std::endl;
                     }
                 } else {
@@ -163,13 +197,84 @@ void MapScene::handleEvent(const sf::Event& event) {
 }
 
 void MapScene::update(float deltaTime) {
+    // Todo passo mexe em algo visível (câmera, NPCs, partículas, eventos,
+    // HUD, tiles editados por script): um overlay aberto depois dele refaz o fundo
+    markDirty();
+    previousHeroPos_ = hero_.getPosition();
+    const Input& input = Input::instance();
+    
+    if (input.wasPressed(InputAction::Confirm)) {
+        if (eventSystem_ && eventSystem_->isEventRunning()) {
+            eventSystem_->confirm();
+        } else {
+            checkEventTriggers();
+        }
+    }
+    
+    // Pausa: o mapa para e fica como fundo do menu até ele fechar
+    if (input.wasPressed(InputAction::Cancel) && !(eventSystem_ && eventSystem_->isEventRunning()) &&
+        !sceneStack_.isTransitioning()) {
+        sceneStack_.pushScene(std::make_unique<PauseScene>(sceneStack_));
+    }
+    
+    if (input.wasPressed(InputAction::QuickSave) && saveSystem_) {
+        sf::Vector2f pos = hero_.getPosition();
+        saveSystem_->setPlayerPosition(mapId_, pos.x, pos.y, 2);
+        saveSystem_->saveGame(1);
+        std::cout << "[MapScene] Quick save realizado\n";
+    } else if (input.wasPressed(InputAction::QuickLoad) && saveSystem_ && saveSystem_->saveExists(1)) {
+        int mapId, direction;
+        float x, y;
+        saveSystem_->loadGame(1);
+        saveSystem_->getPlayerPosition(mapId, x, y, direction);
+        teleportHero({x, y});
+        std::cout << "[MapScene] Quick load realizado\n";
+    }
+    
+    if (saveSystem_) {
+        saveSystem_->addPlaytime(deltaTime);
+        autosaveTimer_ += deltaTime;
+        if (autosaveTimer_ >= AutosaveInterval) {
+            autosaveTimer_ = 0.f;
+            sf::Vector2f pos = hero_.getPosition();
+            saveSystem_->setPlayerPosition(mapId_, pos.x, pos.y, 2);
+            saveSystem_->autosave();
+        }
+    }
+    
+    mapCache_->update();
+    
     // Atualizar sistema de eventos
     if (eventSystem_) {
         eventSystem_->update(deltaTime);
     }
     
+    // NPCs andam mesmo durante eventos
+    wanderTimer_ += deltaTime;
+    if (wanderTimer_ >= WanderInterval) {
+        wanderTimer_ = 0.f;
+        wanderNpcs();
+    }
+    if (Input::instance().mode() == Input::Mode::Live) {
+        pathfinder_.process(PathBudget);
+    } else {
+        // Gravação/replay: caminhos entregues no mesmo passo, independente do tempo de CPU
+        while (pathfinder_.pendingRequests() > 0) {
+            pathfinder_.process(PathBudget);
+        }
+    }
+    followNpcRoutes();
+    actors_.update(deltaTime, &map_);
+    
+    // Clima acompanha a câmera
+    if (weather_) {
+        particles_.setPosition(*weather_, camera_.center());
+    }
+    particles_.update(deltaTime);
+    
     // Se um evento está executando, não processar movimento
     if (eventSystem_ && eventSystem_->isEventRunning()) {
+        camera_.update(hero_.getPosition(), deltaTime);
         return;
     }
     
@@ -177,19 +282,19 @@ void MapScene::update(float deltaTime) {
     sf::Vector2f newPos = pos;
     bool moved = false;
     
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) {
+    if (input.isHeld(InputAction::Up)) {
         newPos.y -= moveSpeed_ * deltaTime;
         moved = true;
     }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) {
+    if (input.isHeld(InputAction::Down)) {
         newPos.y += moveSpeed_ * deltaTime;
         moved = true;
     }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
+    if (input.isHeld(InputAction::Left)) {
         newPos.x -= moveSpeed_ * deltaTime;
         moved = true;
     }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
+    if (input.isHeld(InputAction::Right)) {
         newPos.x += moveSpeed_ * deltaTime;
         moved = true;
     }
@@ -217,51 +322,365 @@ void MapScene::update(float deltaTime) {
             std::cout << "[Debug] Movimento: (" << newPos.x << ", " << newPos.y << ") Tile: (" << tileX << ", " << tileY << ")" << std::endl;
         }
     }
+    camera_.update(hero_.getPosition(), deltaTime);
     
-    // Atualizar UI
-    if (uiText_.has_value()) {
-        sf::Vector2f heroPos = hero_.getPosition();
-        std::string uiInfo = "Posição: (" + std::to_string(static_cast<int>(heroPos.x)) + ", " + std::to_string(static_cast<int>(heroPos.y)) + ")";
-        uiInfo += "\nControles: WASD=Mover, Enter/Space=Interagir";
-        uiInfo += "\nF5=QuickSave, F9=QuickLoad, AltGr+N=Save, Ctrl+AltGr+N=Load, Shift+AltGr+N=Delete";
-        
+    // Portas: transfere ao entrar na área
+    const sf::Vector2f heroCenter = hero_.getPosition();
+    const auto door = std::find_if(doors_.begin(), doors_.end(), [&](const Door& d) { return d.area.contains(heroCenter); });
+    if (door != doors_.end() && !onDoor_) {
+        transferTo(door->target);
+    }
+    onDoor_ = door != doors_.end();
+    
+    // Atualizar UI: campos iguais aos do passo anterior não mexem no layout
+    if (positionLabel_) {
+        const sf::Vector2f heroPos = hero_.getPosition();
+        hud_.setField(*positionLabel_, 0, static_cast<int>(heroPos.x));
+        hud_.setField(*positionLabel_, 1, static_cast<int>(heroPos.y));
+    }
+    if (stateLabel_) {
+        hud_.setVisible(*stateLabel_, eventSystem_ != nullptr);
         if (eventSystem_) {
-            uiInfo += "\nSwitches: 1=" + std::string(eventSystem_->getSwitch(1) ? "ON" : "OFF");
-            uiInfo += ", Variável 1=" + std::to_string(eventSystem_->getVariable(1));
+            hud_.setField(*stateLabel_, 0, eventSystem_->getSwitch(1) ? "ON" : "OFF");
+            hud_.setField(*stateLabel_, 1, eventSystem_->getVariable(1));
         }
-        
-        uiText_->setString(uiInfo);
     }
 }
 
-void MapScene::draw(sf::RenderWindow& window) const {
+void MapScene::draw(sf::RenderTarget& target) const {
+    drawInterpolated(target, 1.f);
+}
+
+void MapScene::drawInterpolated(sf::RenderTarget& target, float alpha) const {
+    // Mundo na textura de baixa resolução, depois ampliado para a janela
+    sf::RenderTexture& world = world_.begin();
+    world.setView(camera_.view(alpha));
+    drawWorld(world, alpha);
+    world.display();
+    windowSize_ = target.getSize();
+    world_.present(target);
+    
+    // Eventos e UI na resolução da janela
+    const sf::View previous = target.getView();
+    target.setView(target.getDefaultView());
+    
+    // Desenhar sistema de eventos (textos, imagens)
+    if (eventSystem_) {
+        eventSystem_->draw(target);
+    }
+    
+    // Desenhar UI
+    hud_.draw(target);
+    target.setView(previous);
+}
+
+void MapScene::drawWorld(sf::RenderTarget& target, float alpha) const {
     // Draw ground_* layers first
     for (std::size_t i = 0; i < map_.getLayerCount(); ++i) {
         const std::string& name = map_.getLayerName(i);
         if (name.rfind("ground_", 0) == 0) {
-            map_.drawLayer(i, window);
+            map_.drawLayer(i, target);
         }
     }
 
-    window.draw(hero_);
+    submitSprites(alpha);
+    worldSprites_.draw(target);
 
     // Draw object_* and remaining layers
     for (std::size_t i = 0; i < map_.getLayerCount(); ++i) {
         const std::string& name = map_.getLayerName(i);
         if (name.rfind("ground_", 0) != 0) {
-            map_.drawLayer(i, window);
+            map_.drawLayer(i, target);
         }
     }
     
-    // Desenhar sistema de eventos (textos, imagens)
+    particles_.draw(target, alpha);
+}
+
+void MapScene::record(RenderCommandList& commands, float alpha) const {
+    // Mesma ordem de drawInterpolated. Sem textura intermediária aqui: a view
+    // da câmera é esticada direto para a janela pelo render thread
+    const sf::FloatRect visible = camera_.visibleRect(alpha);
+    commands.setView(sf::View(visible));
+    for (std::size_t i = 0; i < map_.getLayerCount(); ++i) {
+        if (map_.getLayerName(i).rfind("ground_", 0) == 0) {
+            map_.recordRange(i, i + 1, commands, visible);
+        }
+    }
+
+    submitSprites(alpha);
+    worldSprites_.record(commands);
+
+    for (std::size_t i = 0; i < map_.getLayerCount(); ++i) {
+        if (map_.getLayerName(i).rfind("ground_", 0) != 0) {
+            map_.recordRange(i, i + 1, commands, visible);
+        }
+    }
+    particles_.record(commands, alpha);
+    commands.setView(std::nullopt);
+    
     if (eventSystem_) {
-        eventSystem_->draw(window);
+        eventSystem_->record(commands);
     }
     
-    // Desenhar UI
-    if (uiText_.has_value()) {
-        window.draw(*uiText_);
+    hud_.record(commands);
+}
+
+void MapScene::submitSprites(float alpha) const {
+    // Herói numa camada acima dos NPCs: dentro de uma camada o lote ordena
+    // por textura, não pela ordem de envio. Como quad do lote, gravar não
+    // copia o RectangleShape
+    const sf::RectangleShape& hero = interpolatedHero(alpha);
+    worldSprites_.clear();
+    actors_.submit(worldSprites_, alpha, 0);
+    worldSprites_.add(1, nullptr, hero.getGlobalBounds(), {}, hero.getFillColor());
+}
+
+const sf::RectangleShape& MapScene::interpolatedHero(float alpha) const {
+    // Herói entre a posição do passo anterior e a atual; a atribuição reusa os vetores de heroFrame_
+    heroFrame_ = hero_;
+    heroFrame_.setPosition(previousHeroPos_ + (hero_.getPosition() - previousHeroPos_) * alpha);
+    return heroFrame_;
+}
+
+void MapScene::spawnNpcs(const tmx::Map& tmxMap) {
+    ActorDesc desc;
+    if (npcSheet_.loadFromFile("game/assets/sprites/villager.json", textures_)) {
+        desc.sheet = &npcSheet_;
+    } else {
+        desc.color = sf::Color(120, 200, 255); // Sem folha: caixas coloridas
     }
+    for (const auto& layer : tmxMap.getLayers()) {
+        if (layer->getType() != tmx::Layer::Type::Object)
+            continue;
+        for (const auto& obj : layer->getLayerAs<tmx::ObjectGroup>().getObjects()) {
+            if (obj.getName() == "npc") {
+                desc.position = {obj.getPosition().x, obj.getPosition().y};
+                actors_.spawn(desc);
+            }
+        }
+    }
+    
+    // npc_count: multidão em tiles livres aleatórios (seed fixa, mesmo mapa = mesmas posições)
+    int npcCount = 0;
+    for (const auto& prop : tmxMap.getProperties()) {
+        if (prop.getName() == "npc_count") {
+            npcCount = prop.getIntValue();
+        }
+    }
+    const auto& ts = map_.getTileSize();
+    if (npcCount <= 0 || map_.getWidth() == 0 || map_.getHeight() == 0) {
+        return;
+    }
+    std::mt19937 rng(static_cast<std::uint32_t>(npcCount));
+    std::uniform_int_distribution<unsigned> col(0, map_.getWidth() - 1);
+    std::uniform_int_distribution<unsigned> row(0, map_.getHeight() - 1);
+    for (int spawned = 0, attempts = 0; spawned < npcCount && attempts < npcCount * 10; ++attempts) {
+        const unsigned tx = col(rng);
+        const unsigned ty = row(rng);
+        if (map_.isCollidable(tx, ty))
+            continue;
+        desc.position = {(static_cast<float>(tx) + 0.5f) * static_cast<float>(ts.x),
+                         (static_cast<float>(ty) + 0.5f) * static_cast<float>(ts.y)};
+        actors_.spawn(desc);
+        ++spawned;
+    }
+    std::cout << "[MapScene] " << actors_.size() << " NPCs criados\n";
+}
+
+void MapScene::setupWeather(const tmx::Map& tmxMap) {
+    // Área de emissão um pouco maior que a view, para não faltar partícula nas bordas
+    const sf::Vector2f area = sf::Vector2f(InternalResolution) + sf::Vector2f{64.f, 64.f};
+    for (const auto& prop : tmxMap.getProperties()) {
+        if (prop.getName() != "weather") {
+            continue;
+        }
+        const std::string& weather = prop.getStringValue();
+        if (weather == "rain") {
+            weather_ = particles_.addEmitter(EmitterDesc::rain(area));
+        } else if (weather == "snow") {
+            weather_ = particles_.addEmitter(EmitterDesc::snow(area));
+        } else {
+            std::cerr << "[MapScene] Clima desconhecido: " << weather << "\n";
+        }
+    }
+}
+
+void MapScene::setupDoors(const tmx::Map& tmxMap) {
+    for (const auto& layer : tmxMap.getLayers()) {
+        if (layer->getType() != tmx::Layer::Type::Object)
+            continue;
+        for (const auto& obj : layer->getLayerAs<tmx::ObjectGroup>().getObjects()) {
+            if (obj.getName() != "door")
+                continue;
+            const auto& box = obj.getAABB();
+            Door door{{{box.left, box.top}, {box.width, box.height}}, {}};
+            for (const auto& prop : obj.getProperties()) {
+                if (prop.getName() == "map") {
+                    door.target.mapFile = prop.getStringValue();
+                } else if (prop.getName() == "map_id") {
+                    door.target.mapId = prop.getIntValue();
+                } else if (prop.getName() == "x") {
+                    door.target.position.x = static_cast<float>(prop.getIntValue());
+                } else if (prop.getName() == "y") {
+                    door.target.position.y = static_cast<float>(prop.getIntValue());
+                }
+            }
+            if (door.target.mapFile.empty() && door.target.mapId == 0) {
+                std::cerr << "[MapScene] Porta sem destino (propriedade map ou map_id) ignorada\n";
+                continue;
+            }
+            doors_.push_back(door);
+        }
+    }
+}
+
+std::string MapScene::resolveMapPath(const TransferTarget& target) const {
+    // Arquivo explícito ao lado do mapa atual; senão mapNNN.tmx pelo ID
+    const std::filesystem::path base = std::filesystem::path(tmxPath_).parent_path();
+    if (!target.mapFile.empty()) {
+        return (base / target.mapFile).lexically_normal().generic_string();
+    }
+    std::string name = std::to_string(target.mapId);
+    name.insert(0, name.size() < 3 ? 3 - name.size() : 0, '0');
+    return (base / ("map" + name + ".tmx")).generic_string();
+}
+
+void MapScene::prefetchNeighbors() {
+    std::vector<std::string> paths;
+    for (const Door& door : doors_) {
+        paths.push_back(resolveMapPath(door.target));
+    }
+    if (eventSystem_) {
+        for (const TransferTarget& target : eventSystem_->transferTargets()) {
+            paths.push_back(resolveMapPath(target));
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    std::erase(paths, tmxPath_); // Transferência no mesmo mapa só move o herói
+    if (!paths.empty()) {
+        std::cout << "[MapScene] Pré-carregando " << paths.size() << " mapa(s) vizinho(s)\n";
+        mapCache_->prefetch(paths);
+    }
+}
+
+void MapScene::transferTo(const TransferTarget& target) {
+    if (sceneStack_.isTransitioning()) {
+        return;
+    }
+    auto transfer = std::make_shared<MapTransfer>();
+    transfer->tmxPath = resolveMapPath(target);
+    if (transfer->tmxPath == tmxPath_) {
+        teleportHero(target.position);
+        return;
+    }
+    if (target.mapId > 0) {
+        transfer->mapId = target.mapId; // Propriedade "id" do mapa de destino prevalece
+    }
+    transfer->position = target.position;
+    transfer->cache = mapCache_;
+    std::cout << "[MapScene] Transferindo para " << transfer->tmxPath
+              << (mapCache_->isReady(transfer->tmxPath) ? " (pré-carregado)" : "") << "\n";
+    
+    // O worker só pega o mapa do cache (ou o lê); com ele já pré-carregado
+    // isso é esperar o prefetch, sem ler o TMX nem montar geometria
+    sceneStack_.prepareScene([this, transfer]() -> SceneStack::SceneFactory {
+        transfer->prepared = transfer->cache->take(transfer->tmxPath);
+        if (!transfer->prepared) {
+            throw std::runtime_error("mapa não encontrado: " + transfer->tmxPath);
+        }
+        // No commit, na thread principal: Lua, textura de render e atlas da
+        // cena nova nascem aqui, e o estado vai como está no último passo
+        // desta cena (tempo de jogo e switches mudados durante o fade)
+        return [this, transfer] {
+            transfer->state = gameState_; // Snapshot O(1): páginas compartilhadas
+            return std::make_unique<MapScene>(sceneStack_, textures_, std::move(*transfer));
+        };
+    });
+}
+
+void MapScene::wanderNpcs() {
+    // Destinos vindos do RNG do Input para que replays repitam o trajeto
+    constexpr int WanderRadius = 6; // Tiles
+    std::uniform_int_distribution<int> offset(-WanderRadius, WanderRadius);
+    auto& rng = Input::instance().rng();
+    const auto& ts = map_.getTileSize();
+    for (std::size_t i = 0; i < actors_.size(); ++i) {
+        const ActorHandle npc = actors_.handleAt(i);
+        if (npcRoutes_.size() <= npc.slot) {
+            npcRoutes_.resize(npc.slot + 1);
+        }
+        NpcRoute& route = npcRoutes_[npc.slot];
+        if (route.generation != npc.generation) {
+            // Slot de um NPC destruído, talvez com pedido pendente que nunca
+            // será entregue a este
+            route = NpcRoute{};
+            route.generation = npc.generation;
+        }
+        if (route.pending || route.next < route.path.size()) {
+            continue; // Ainda andando
+        }
+        const sf::Vector2f pos = actors_.position(npc);
+        const GridPos from{static_cast<int>(pos.x) / static_cast<int>(ts.x), static_cast<int>(pos.y) / static_cast<int>(ts.y)};
+        const GridPos to{from.x + offset(rng), from.y + offset(rng)};
+        if (!pathfinder_.walkable(to)) {
+            continue;
+        }
+        route.pending = true;
+        pathfinder_.requestPath(from, to, [this, npc](const GridPath& path) {
+            if (!actors_.alive(npc)) {
+                return;
+            }
+            NpcRoute& done = npcRoutes_[npc.slot];
+            done.pending = false;
+            done.path = path;
+            done.next = 1; // path[0] é o tile atual
+        });
+    }
+}
+
+void MapScene::followNpcRoutes() {
+    constexpr float NpcSpeed = 48.f;
+    constexpr float ArriveDistance = 2.f;
+    
+    // Uma edição de tile pode ter bloqueado caminhos já entregues
+    if (routesRevision_ != pathfinder_.revision()) {
+        routesRevision_ = pathfinder_.revision();
+        for (auto& route : npcRoutes_) {
+            route.path.clear();
+            route.next = 0;
+        }
+    }
+    
+    const auto& ts = map_.getTileSize();
+    for (std::size_t i = 0; i < actors_.size(); ++i) {
+        const ActorHandle npc = actors_.handleAt(i);
+        if (npc.slot >= npcRoutes_.size() || npcRoutes_[npc.slot].generation != npc.generation) {
+            continue;
+        }
+        NpcRoute& route = npcRoutes_[npc.slot];
+        sf::Vector2f velocity;
+        while (route.next < route.path.size()) {
+            const GridPos tile = route.path[route.next];
+            const sf::Vector2f target{(static_cast<float>(tile.x) + 0.5f) * static_cast<float>(ts.x),
+                                      (static_cast<float>(tile.y) + 0.5f) * static_cast<float>(ts.y)};
+            const sf::Vector2f delta = target - actors_.position(npc);
+            if (delta.length() > ArriveDistance) {
+                velocity = delta.normalized() * NpcSpeed;
+                break;
+            }
+            ++route.next;
+        }
+        actors_.setVelocity(npc, velocity);
+    }
+}
+
+void MapScene::teleportHero(sf::Vector2f position) {
+    hero_.setPosition(position);
+    previousHeroPos_ = position; // Sem interpolação em saltos
+    camera_.snapTo(position);
+    markDirty(); // Também chamado fora de update (atalhos de depuração)
 }
 
 void MapScene::setupExampleEvents() {
@@ -274,30 +693,30 @@ void MapScene::setupExampleEvents() {
     // Comando 1: Mostrar texto
     EventCommandParams textParams;
     textParams.stringParams.push_back("Bem-vindo ao mundo de Lumy!");
-    welcomePage.commands.emplace_back(EventCommandType::ShowText, textParams);
+    welcomePage.commands.emplace_back(EventCommandType::ShowText, std::move(textParams));
     
     // Comando 2: Definir switch
     EventCommandParams switchParams;
     switchParams.intParams = {1, 1}; // Switch 1 = ON
-    welcomePage.commands.emplace_back(EventCommandType::SetSwitch, switchParams);
+    welcomePage.commands.emplace_back(EventCommandType::SetSwitch, std::move(switchParams));
     
     // Comando 3: Incrementar variável
     EventCommandParams varParams;
     varParams.intParams = {1, 100}; // Variável 1 = 100
-    welcomePage.commands.emplace_back(EventCommandType::SetVariable, varParams);
+    welcomePage.commands.emplace_back(EventCommandType::SetVariable, std::move(varParams));
     
     // Comando 4: Aguardar
     EventCommandParams waitParams;
     waitParams.intParams = {60}; // 60 frames = 1 segundo
-    welcomePage.commands.emplace_back(EventCommandType::Wait, waitParams);
+    welcomePage.commands.emplace_back(EventCommandType::Wait, std::move(waitParams));
     
     // Comando 5: Segundo texto
     EventCommandParams textParams2;
     textParams2.stringParams.push_back("Use WASD para se mover e Enter/Space para interagir.");
-    welcomePage.commands.emplace_back(EventCommandType::ShowText, textParams2);
+    welcomePage.commands.emplace_back(EventCommandType::ShowText, std::move(textParams2));
     
-    welcomeEvent.pages.push_back(welcomePage);
-    eventSystem_->addEvent(welcomeEvent);
+    welcomeEvent.pages.push_back(std::move(welcomePage));
+    eventSystem_->addEvent(std::move(welcomeEvent));
     
     // Evento 2: Demonstração condicional
     GameEvent conditionalEvent(2, "Conditional NPC", 300, 150);
@@ -306,18 +725,18 @@ void MapScene::setupExampleEvents() {
     // Condição: Se switch 1 está ON
     EventCommandParams condParams;
     condParams.intParams = {0, 1, 1}; // Tipo 0 (switch), Switch 1, valor esperado 1 (ON)
-    conditionalPage.commands.emplace_back(EventCommandType::ConditionalBranch, condParams);
+    conditionalPage.commands.emplace_back(EventCommandType::ConditionalBranch, std::move(condParams));
     
     // Se true: mostrar mensagem especial
     EventCommandParams trueTextParams;
     trueTextParams.stringParams.push_back("Você já falou com o primeiro NPC!");
-    conditionalPage.commands.emplace_back(EventCommandType::ShowText, trueTextParams);
+    conditionalPage.commands.emplace_back(EventCommandType::ShowText, std::move(trueTextParams));
     
     // Fim do if
     conditionalPage.commands.emplace_back(EventCommandType::EndConditional);
     
-    conditionalEvent.pages.push_back(conditionalPage);
-    eventSystem_->addEvent(conditionalEvent);
+    conditionalEvent.pages.push_back(std::move(conditionalPage));
+    eventSystem_->addEvent(std::move(conditionalEvent));
     
     std::cout << "[MapScene] Eventos de exemplo configurados\n";
 }
@@ -325,20 +744,10 @@ void MapScene::setupExampleEvents() {
 void MapScene::checkEventTriggers() {
     if (!eventSystem_) return;
     
-    sf::Vector2f heroPos = hero_.getPosition();
-    
-    // Verificar proximidade com eventos
-    // Evento 1 - próximo a (200, 200)
-    float dist1 = std::sqrt(std::pow(heroPos.x - 200, 2) + std::pow(heroPos.y - 200, 2));
-    if (dist1 < 80.0f) { // Dentro de 80 pixels
-        eventSystem_->triggerEvent(1);
-        return;
-    }
-    
-    // Evento 2 - próximo a (300, 150)
-    float dist2 = std::sqrt(std::pow(heroPos.x - 300, 2) + std::pow(heroPos.y - 150, 2));
-    if (dist2 < 80.0f) { // Dentro de 80 pixels
-        eventSystem_->triggerEvent(2);
+    // Evento mais próximo a até 80 pixels do herói (índice espacial do EventSystem)
+    const std::pmr::vector<int> nearby = eventSystem_->eventsNear(hero_.getPosition(), 80.f, &frameArena());
+    if (!nearby.empty()) {
+        eventSystem_->triggerEvent(nearby.front());
         return;
     }
     
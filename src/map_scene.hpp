@@ -2,36 +2,133 @@
 
 #include "scene.hpp"
 #include "map.hpp"
+#include "map_cache.hpp"
 #include "texture_manager.hpp"
 #include "event_system.hpp"
 #include "save_system.hpp"
+#include "game_state.hpp"
+#include "actor_system.hpp"
+#include "pathfinding.hpp"
+#include "camera.hpp"
+#include "hud.hpp"
+#include "particle_system.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
+#include "vfs.hpp"
 #include <SFML/Graphics.hpp>
 #include <string>
 #include <memory>
 #include <optional>
+#include <chrono>
+#include <vector>
+
+namespace tmx {
+class Map;
+}
+
+// Chegada em um mapa por TransferPlayer ou porta
+struct MapTransfer {
+    std::string tmxPath;
+    int mapId = 1;
+    std::optional<sf::Vector2f> position{}; // Sem posição: objeto player/spawn do mapa
+    std::shared_ptr<MapCache> cache{};      // Compartilhado pelos mapas visitados
+    std::unique_ptr<PreparedMap> prepared{}; // Já carregado pelo cache; sem ele, carrega na hora
+    std::optional<GameState> state{};       // Snapshot do mapa anterior (switches, variáveis)
+};
 
 class MapScene : public Scene {
 public:
-    explicit MapScene(SceneStack& stack, TextureManager& textures, const std::string& tmxPath = "game/assets/maps/hello.tmx");
+    static constexpr const char* StartMap = "game/assets/maps/hello.tmx";
+
+    explicit MapScene(SceneStack& stack, TextureManager& textures, const std::string& tmxPath = StartMap);
+    MapScene(SceneStack& stack, TextureManager& textures, MapTransfer transfer);
 
     void handleEvent(const sf::Event& event) override;
     void update(float deltaTime) override;
-    void draw(sf::RenderWindow& window) const override;
+    void draw(sf::RenderTarget& target) const override;
+    void drawInterpolated(sf::RenderTarget& target, float alpha) const override;
+    void record(RenderCommandList& commands, float alpha) const override;
 
 private:
     void setupExampleEvents();
     void checkEventTriggers();
+    void teleportHero(sf::Vector2f position);
+    // Reaproveita heroFrame_: sem cópia (e alocação) do RectangleShape a cada quadro
+    const sf::RectangleShape& interpolatedHero(float alpha) const;
+    void spawnNpcs(const tmx::Map& tmxMap);
+    void setupWeather(const tmx::Map& tmxMap);
+    void setupDoors(const tmx::Map& tmxMap);
+    // Mapas alcançáveis por portas e TransferPlayer começam a carregar em segundo plano
+    void prefetchNeighbors();
+    std::string resolveMapPath(const TransferTarget& target) const;
+    void transferTo(const TransferTarget& target);
+    void wanderNpcs();
+    void followNpcRoutes();
+    void drawWorld(sf::RenderTarget& target, float alpha) const;
+    // Refaz worldSprites_: NPCs e herói na posição interpolada
+    void submitSprites(float alpha) const;
     
     SceneStack& sceneStack_;
     TextureManager& textures_;
+    std::string tmxPath_;
+    int mapId_ = 1; // Propriedade "id" do TMX; vai para os saves
+    std::shared_ptr<MapCache> mapCache_;
     Map map_;
     sf::RectangleShape hero_;
+    sf::Vector2f previousHeroPos_; // Posição no passo fixo anterior (interpolação)
+    mutable sf::RectangleShape heroFrame_; // hero_ na posição interpolada do quadro
+    // NPCs e herói do quadro, numa chamada por textura (herói e NPCs sem folha juntos)
+    mutable SpriteBatch worldSprites_;
     float moveSpeed_ = 200.f;
     
+    // Mundo desenhado em resolução interna fixa e ampliado por fator inteiro
+    static constexpr sf::Vector2u InternalResolution{640, 360};
+    Camera camera_{sf::Vector2f(InternalResolution)};
+    mutable LowResTarget world_{InternalResolution};
+    mutable sf::Vector2u windowSize_; // Último tamanho apresentado (cliques do mouse)
+    
+    SpriteSheet npcSheet_; // Antes de actors_, que guarda ponteiros para ela
+    ActorSystem actors_; // NPCs: objetos "npc" do TMX e propriedade npc_count
+    ParticleSystem particles_;
+    std::optional<EmitterId> weather_; // Propriedade "weather" do TMX: rain ou snow
+    
+    // Objetos "door" do TMX: propriedades map (arquivo TMX ao lado deste) ou
+    // map_id, e x/y de chegada em pixels
+    struct Door {
+        sf::FloatRect area;
+        TransferTarget target;
+    };
+    std::vector<Door> doors_;
+    bool onDoor_ = false; // Só transfere ao entrar na porta, não ao chegar sobre ela
+    
+    float wanderTimer_ = 0.f;
+    static constexpr float WanderInterval = 1.5f; // Segundos entre novos destinos
+    
+    struct NpcRoute {
+        GridPath path;
+        std::size_t next = 0; // Próximo tile do caminho
+        bool pending = false; // Pedido na fila do pathfinder
+        std::uint32_t generation = 0; // Do ActorHandle dono da rota
+    };
+    Pathfinder pathfinder_{map_}; // Declarado depois de map_
+    // Indexado pelo slot do ActorHandle; um slot reaproveitado (outra geração)
+    // começa com a rota zerada
+    std::vector<NpcRoute> npcRoutes_;
+    std::uint32_t routesRevision_ = 0;
+    static constexpr std::chrono::microseconds PathBudget{1000}; // Por passo
+    
+    GameState gameState_; // Compartilhado por eventos e saves; declarado antes deles
+    TextureAtlas atlas_{textures_}; // Imagens dos eventos; declarado antes de eventSystem_
     std::unique_ptr<EventSystem> eventSystem_;
     std::unique_ptr<SaveSystem> saveSystem_;
+    float autosaveTimer_ = 0.f;
+    static constexpr float AutosaveInterval = 30.f; // Segundos; journal incremental
     
     bool showingUI_ = false;
+    FileData uiFontData_; // Mantido enquanto a fonte existir
     sf::Font uiFont_;
-    std::optional<sf::Text> uiText_;
+    // HUD retido: só refaz o layout de uma linha quando o valor dela muda
+    Hud hud_;
+    std::optional<WidgetId> positionLabel_;
+    std::optional<WidgetId> stateLabel_;
 };
@@ -0,0 +1,132 @@
+// src/pack_main.cpp
+// lumy-pack: empacota o diretório game/ em um único game.lpak.
+//   lumy-pack <diretório> <saída.lpak> [--exclude <subdiretório>]...
+#include "archive.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool readBytes(const std::filesystem::path& path, std::vector<std::uint8_t>& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// tmxlite lê tilesets externos (.tsx) direto do disco; dentro do pacote eles
+// são copiados para o próprio TMX, com o caminho da imagem relativo ao mapa
+std::string inlineTilesets(const std::string& tmx, const std::filesystem::path& tmxDir) {
+    static const std::regex external(R"re(<tileset\s+firstgid="(\d+)"\s+source="([^"]+)"\s*/>)re");
+    static const std::regex declaration(R"re(<\?xml[^>]*\?>\s*)re");
+    static const std::regex image(R"re((<image\b[^>]*\bsource=")([^"]+)("))re");
+
+    std::string result;
+    auto last = tmx.cbegin();
+    for (std::sregex_iterator it(tmx.begin(), tmx.end(), external), end; it != end; ++it) {
+        const std::smatch& match = *it;
+        const std::filesystem::path tsxPath = (tmxDir / match[2].str()).lexically_normal();
+        std::vector<std::uint8_t> bytes;
+        if (!readBytes(tsxPath, bytes)) {
+            std::cerr << "[lumy-pack] Tileset não encontrado, mantido externo: " << tsxPath.string() << "\n";
+            continue;
+        }
+        std::string tsx = std::regex_replace(std::string(bytes.begin(), bytes.end()), declaration, "");
+        const std::size_t open = tsx.find("<tileset");
+        if (open == std::string::npos) {
+            continue;
+        }
+        tsx.insert(open + 8, " firstgid=\"" + match[1].str() + "\"");
+
+        // Imagem relativa ao .tsx -> relativa ao .tmx
+        std::string rebased;
+        auto imageLast = tsx.cbegin();
+        for (std::sregex_iterator img(tsx.begin(), tsx.end(), image), imgEnd; img != imgEnd; ++img) {
+            const std::filesystem::path source = (tsxPath.parent_path() / (*img)[2].str()).lexically_normal();
+            rebased.append(imageLast, (*img)[0].first);
+            rebased += (*img)[1].str() + source.lexically_relative(tmxDir).generic_string() + (*img)[3].str();
+            imageLast = (*img)[0].second;
+        }
+        rebased.append(imageLast, tsx.cend());
+
+        result.append(last, match[0].first);
+        result += rebased;
+        last = match[0].second;
+    }
+    result.append(last, tmx.cend());
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Uso: lumy-pack <diretório> <saída.lpak> [--exclude <subdiretório>]...\n";
+        return 1;
+    }
+    const std::filesystem::path root = std::filesystem::path(argv[1]).lexically_normal();
+    const std::filesystem::path output = argv[2];
+    // Saves e caches são dados do jogador, não do jogo
+    std::set<std::string> excluded{"saves", "cache"};
+    for (int i = 3; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--exclude") {
+            excluded.insert(argv[++i]);
+        }
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) {
+        std::cerr << "[lumy-pack] Diretório não encontrado: " << root.string() << "\n";
+        return 1;
+    }
+    // Entradas ficam com o nome do diretório na frente ("game/..."), como os
+    // caminhos usados pelo runtime
+    const std::string prefix = (root.has_filename() ? root.filename() : root.parent_path().filename()).generic_string();
+
+    std::vector<Archive::Source> sources;
+    std::uint64_t totalBytes = 0;
+    for (auto it = std::filesystem::recursive_directory_iterator(root); it != std::filesystem::recursive_directory_iterator(); ++it) {
+        const std::filesystem::path relative = it->path().lexically_relative(root);
+        if (it->is_directory() && it.depth() == 0 && excluded.count(relative.generic_string())) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        Archive::Source source;
+        source.name = prefix + "/" + relative.generic_string();
+        // Fontes são abertas direto do mapeamento (zero-copy), então ficam sem compressão
+        const std::string extension = it->path().extension().string();
+        source.compress = extension != ".ttf" && extension != ".otf";
+        if (!readBytes(it->path(), source.bytes)) {
+            std::cerr << "[lumy-pack] Falha ao ler " << it->path().string() << "\n";
+            return 1;
+        }
+        if (it->path().extension() == ".tmx") {
+            const std::string tmx = inlineTilesets(std::string(source.bytes.begin(), source.bytes.end()),
+                                                   it->path().parent_path());
+            source.bytes.assign(tmx.begin(), tmx.end());
+        }
+        totalBytes += source.bytes.size();
+        sources.push_back(std::move(source));
+    }
+
+    const std::size_t count = sources.size();
+    if (!Archive::write(output, std::move(sources))) {
+        std::cerr << "[lumy-pack] Falha ao gravar " << output.string() << "\n";
+        return 1;
+    }
+    std::cout << "[lumy-pack] " << count << " arquivos (" << totalBytes << " bytes) -> " << output.string() << " ("
+              << std::filesystem::file_size(output, ec) << " bytes)\n";
+    return 0;
+}
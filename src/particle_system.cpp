@@ -0,0 +1,341 @@
+#include "particle_system.hpp"
+#include "profiler.hpp"
+#include "render_commands.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+// The update kernels run 4 particles at a time with SSE2 or NEON; other
+// targets get the plain loops, which the optimizer vectorizes at -O3
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LUMY_PARTICLES_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LUMY_PARTICLES_NEON 1
+#endif
+
+namespace {
+
+// xorshift32: particles don't need more, and it keeps Input's generator untouched
+float nextUnit(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state >> 8) * (1.f / 16777216.f);
+}
+
+float between(std::uint32_t& state, float min, float max) {
+    return min + (max - min) * nextUnit(state);
+}
+
+// ===== Update kernels: one field pair per pass, no branches =====
+
+void integrate(float* pos, float* prev, float* vel, std::size_t n, float acceleration, float dt) {
+    const float dv = acceleration * dt;
+    std::size_t i = 0;
+#if defined(LUMY_PARTICLES_SSE2)
+    const __m128 vdv = _mm_set1_ps(dv);
+    const __m128 vdt = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 p = _mm_loadu_ps(pos + i);
+        const __m128 v = _mm_add_ps(_mm_loadu_ps(vel + i), vdv);
+        _mm_storeu_ps(prev + i, p);
+        _mm_storeu_ps(vel + i, v);
+        _mm_storeu_ps(pos + i, _mm_add_ps(p, _mm_mul_ps(v, vdt)));
+    }
+#elif defined(LUMY_PARTICLES_NEON)
+    const float32x4_t vdv = vdupq_n_f32(dv);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t p = vld1q_f32(pos + i);
+        const float32x4_t v = vaddq_f32(vld1q_f32(vel + i), vdv);
+        vst1q_f32(prev + i, p);
+        vst1q_f32(vel + i, v);
+        vst1q_f32(pos + i, vmlaq_n_f32(p, v, dt));
+    }
+#endif
+    for (; i < n; ++i) {
+        prev[i] = pos[i];
+        vel[i] += dv;
+        pos[i] += vel[i] * dt;
+    }
+}
+
+void advanceAge(float* age, const float* rate, std::size_t n, float dt) {
+    std::size_t i = 0;
+#if defined(LUMY_PARTICLES_SSE2)
+    const __m128 vdt = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), _mm_mul_ps(_mm_loadu_ps(rate + i), vdt)));
+    }
+#elif defined(LUMY_PARTICLES_NEON)
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(age + i, vmlaq_n_f32(vld1q_f32(age + i), vld1q_f32(rate + i), dt));
+    }
+#endif
+    for (; i < n; ++i) {
+        age[i] += rate[i] * dt;
+    }
+}
+
+std::uint8_t lerpChannel(std::uint8_t a, std::uint8_t b, float t) {
+    return static_cast<std::uint8_t>(static_cast<float>(a) + (static_cast<float>(b) - static_cast<float>(a)) * t);
+}
+
+} // namespace
+
+EmitterDesc EmitterDesc::rain(sf::Vector2f area) {
+    EmitterDesc desc;
+    desc.capacity = 4096;
+    desc.rate = area.x * area.y / 400.f; // ~600 drops/s for a 640x360 view
+    desc.spawnArea = area * 0.5f;
+    desc.velocityMin = {-60.f, 420.f};
+    desc.velocityMax = {-40.f, 520.f};
+    desc.lifetimeMin = 0.5f;
+    desc.lifetimeMax = 0.8f;
+    desc.sizeStart = {1.f, 8.f};
+    desc.sizeEnd = {1.f, 10.f};
+    desc.colorStart = sf::Color(170, 190, 255, 170);
+    desc.colorEnd = sf::Color(170, 190, 255, 40);
+    return desc;
+}
+
+EmitterDesc EmitterDesc::snow(sf::Vector2f area) {
+    EmitterDesc desc;
+    desc.capacity = 2048;
+    desc.rate = area.x * area.y / 2000.f;
+    desc.spawnArea = area * 0.5f;
+    desc.velocityMin = {-20.f, 25.f};
+    desc.velocityMax = {20.f, 55.f};
+    desc.acceleration = {6.f, 0.f};
+    desc.lifetimeMin = 4.f;
+    desc.lifetimeMax = 7.f;
+    desc.sizeStart = {3.f, 3.f};
+    desc.sizeEnd = {2.f, 2.f};
+    desc.colorStart = sf::Color(255, 255, 255, 230);
+    desc.colorEnd = sf::Color(255, 255, 255, 0);
+    return desc;
+}
+
+EmitterDesc EmitterDesc::sparks(sf::Color color) {
+    EmitterDesc desc;
+    desc.capacity = 256;
+    desc.spawnArea = {4.f, 4.f};
+    desc.velocityMin = {-160.f, -220.f};
+    desc.velocityMax = {160.f, 40.f};
+    desc.acceleration = {0.f, 480.f};
+    desc.lifetimeMin = 0.25f;
+    desc.lifetimeMax = 0.6f;
+    desc.sizeStart = {4.f, 4.f};
+    desc.sizeEnd = {1.f, 1.f};
+    desc.colorStart = color;
+    desc.colorEnd = sf::Color(color.r, color.g, color.b, 0);
+    return desc;
+}
+
+EmitterId ParticleSystem::addEmitter(const EmitterDesc& desc) {
+    auto slot = std::find_if(emitters_.begin(), emitters_.end(), [](const Emitter& e) { return !e.active; });
+    if (slot == emitters_.end()) {
+        slot = emitters_.emplace(emitters_.end());
+    }
+    const auto id = static_cast<EmitterId>(slot - emitters_.begin());
+
+    Emitter& emitter = *slot;
+    emitter.desc = desc;
+    emitter.desc.lifetimeMin = std::max(desc.lifetimeMin, 1e-3f);
+    emitter.desc.lifetimeMax = std::max(desc.lifetimeMax, emitter.desc.lifetimeMin);
+    emitter.active = true;
+    emitter.batch = batchIndex(desc.texture);
+    emitter.rng = 0x9E3779B9u * (id + 1u);
+    emitter.pending = 0.f;
+    emitter.count = 0;
+    for (std::vector<float>* field : {&emitter.x, &emitter.y, &emitter.prevX, &emitter.prevY, &emitter.vx, &emitter.vy,
+                                      &emitter.age, &emitter.ageRate}) {
+        field->assign(desc.capacity, 0.f);
+    }
+    return id;
+}
+
+void ParticleSystem::removeEmitter(EmitterId id) {
+    if (Emitter* emitter = find(id)) {
+        *emitter = Emitter{};
+    }
+}
+
+void ParticleSystem::clear() {
+    emitters_.clear();
+}
+
+ParticleSystem::Emitter* ParticleSystem::find(EmitterId id) {
+    return id < emitters_.size() && emitters_[id].active ? &emitters_[id] : nullptr;
+}
+
+const ParticleSystem::Emitter* ParticleSystem::find(EmitterId id) const {
+    return id < emitters_.size() && emitters_[id].active ? &emitters_[id] : nullptr;
+}
+
+std::uint16_t ParticleSystem::batchIndex(const sf::Texture* texture) {
+    const auto it = std::find(textures_.begin(), textures_.end(), texture);
+    if (it != textures_.end()) {
+        return static_cast<std::uint16_t>(it - textures_.begin());
+    }
+    textures_.push_back(texture);
+    return static_cast<std::uint16_t>(textures_.size() - 1);
+}
+
+void ParticleSystem::setPosition(EmitterId id, sf::Vector2f position) {
+    if (Emitter* emitter = find(id)) {
+        emitter->desc.position = position;
+    }
+}
+
+void ParticleSystem::setRate(EmitterId id, float rate) {
+    if (Emitter* emitter = find(id)) {
+        emitter->desc.rate = std::max(rate, 0.f);
+    }
+}
+
+void ParticleSystem::burst(EmitterId id, std::size_t count) {
+    if (Emitter* emitter = find(id)) {
+        emit(*emitter, count);
+    }
+}
+
+std::size_t ParticleSystem::particleCount() const {
+    std::size_t total = 0;
+    for (const Emitter& emitter : emitters_) {
+        total += emitter.count;
+    }
+    return total;
+}
+
+std::size_t ParticleSystem::particleCount(EmitterId id) const {
+    const Emitter* emitter = find(id);
+    return emitter ? emitter->count : 0;
+}
+
+void ParticleSystem::emit(Emitter& e, std::size_t count) {
+    const EmitterDesc& d = e.desc;
+    const std::size_t first = e.count;
+    const std::size_t last = std::min(d.capacity, first + count);
+    for (std::size_t i = first; i < last; ++i) {
+        e.x[i] = e.prevX[i] = d.position.x + between(e.rng, -d.spawnArea.x, d.spawnArea.x);
+        e.y[i] = e.prevY[i] = d.position.y + between(e.rng, -d.spawnArea.y, d.spawnArea.y);
+        e.vx[i] = between(e.rng, d.velocityMin.x, d.velocityMax.x);
+        e.vy[i] = between(e.rng, d.velocityMin.y, d.velocityMax.y);
+        e.age[i] = 0.f;
+        e.ageRate[i] = 1.f / between(e.rng, d.lifetimeMin, d.lifetimeMax);
+    }
+    e.count = last;
+}
+
+void ParticleSystem::removeDead(Emitter& e) {
+    // Swap-remove: the last live particle fills the hole
+    std::size_t n = e.count;
+    for (std::size_t i = 0; i < n;) {
+        if (e.age[i] < 1.f) {
+            ++i;
+            continue;
+        }
+        --n;
+        e.x[i] = e.x[n];
+        e.y[i] = e.y[n];
+        e.prevX[i] = e.prevX[n];
+        e.prevY[i] = e.prevY[n];
+        e.vx[i] = e.vx[n];
+        e.vy[i] = e.vy[n];
+        e.age[i] = e.age[n];
+        e.ageRate[i] = e.ageRate[n];
+    }
+    e.count = n;
+}
+
+void ParticleSystem::update(float deltaTime) {
+    LUMY_PROFILE_SCOPE("ParticleSystem::update");
+    for (Emitter& e : emitters_) {
+        if (!e.active) {
+            continue;
+        }
+        const std::size_t n = e.count;
+        integrate(e.x.data(), e.prevX.data(), e.vx.data(), n, e.desc.acceleration.x, deltaTime);
+        integrate(e.y.data(), e.prevY.data(), e.vy.data(), n, e.desc.acceleration.y, deltaTime);
+        advanceAge(e.age.data(), e.ageRate.data(), n, deltaTime);
+        removeDead(e);
+
+        e.pending += e.desc.rate * deltaTime;
+        const float whole = std::floor(e.pending);
+        e.pending -= whole;
+        emit(e, static_cast<std::size_t>(whole));
+    }
+}
+
+const std::vector<std::vector<sf::Vertex>>& ParticleSystem::buildBatches(float alpha) const {
+    LUMY_PROFILE_SCOPE("ParticleSystem::buildBatches");
+    batches_.resize(textures_.size());
+    batchFill_.assign(textures_.size(), 0);
+    for (const Emitter& e : emitters_) {
+        batchFill_[e.batch] += e.count * 6;
+    }
+    // resize() keeps the capacity, so steady frames don't allocate
+    for (std::size_t b = 0; b < batches_.size(); ++b) {
+        batches_[b].resize(batchFill_[b]);
+        batchFill_[b] = 0;
+    }
+
+    for (const Emitter& e : emitters_) {
+        if (e.count == 0) {
+            continue;
+        }
+        const EmitterDesc& d = e.desc;
+        sf::Vertex* v = batches_[e.batch].data() + batchFill_[e.batch];
+        batchFill_[e.batch] += e.count * 6;
+
+        const float u0 = static_cast<float>(d.textureRect.position.x);
+        const float v0 = static_cast<float>(d.textureRect.position.y);
+        const float u1 = u0 + static_cast<float>(d.textureRect.size.x);
+        const float v1 = v0 + static_cast<float>(d.textureRect.size.y);
+        const sf::Vector2f sizeDelta = d.sizeEnd - d.sizeStart;
+        for (std::size_t i = 0; i < e.count; ++i, v += 6) {
+            const float t = std::min(e.age[i], 1.f);
+            const float px = e.prevX[i] + (e.x[i] - e.prevX[i]) * alpha;
+            const float py = e.prevY[i] + (e.y[i] - e.prevY[i]) * alpha;
+            const float hw = (d.sizeStart.x + sizeDelta.x * t) * 0.5f;
+            const float hh = (d.sizeStart.y + sizeDelta.y * t) * 0.5f;
+            const sf::Color color(lerpChannel(d.colorStart.r, d.colorEnd.r, t), lerpChannel(d.colorStart.g, d.colorEnd.g, t),
+                                  lerpChannel(d.colorStart.b, d.colorEnd.b, t), lerpChannel(d.colorStart.a, d.colorEnd.a, t));
+
+            v[0] = {{px - hw, py - hh}, color, {u0, v0}};
+            v[1] = {{px + hw, py - hh}, color, {u1, v0}};
+            v[2] = {{px + hw, py + hh}, color, {u1, v1}};
+            v[3] = v[0];
+            v[4] = v[2];
+            v[5] = {{px - hw, py + hh}, color, {u0, v1}};
+        }
+    }
+    return batches_;
+}
+
+void ParticleSystem::draw(sf::RenderTarget& target, float alpha) const {
+    const auto& batches = buildBatches(alpha);
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        if (batches[b].empty()) {
+            continue;
+        }
+        sf::RenderStates states;
+        states.texture = textures_[b];
+        target.draw(batches[b].data(), batches[b].size(), sf::PrimitiveType::Triangles, states);
+    }
+}
+
+void ParticleSystem::record(RenderCommandList& commands, float alpha) const {
+    const auto& batches = buildBatches(alpha);
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        if (batches[b].empty()) {
+            continue;
+        }
+        sf::RenderStates states;
+        states.texture = textures_[b];
+        commands.draw(snapshots_.share(batches[b]), sf::PrimitiveType::Triangles, states);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render_commands.hpp"
+
+using EmitterId = std::uint32_t;
+
+struct EmitterDesc {
+    const sf::Texture* texture = nullptr; // Null: plain colored quads. Must outlive the emitter.
+    sf::IntRect textureRect;              // Part of the texture every particle shows
+    std::size_t capacity = 1024;          // Fixed; emission pauses while the pool is full
+    float rate = 0.f;                     // Particles per second; 0 for bursts only
+    sf::Vector2f position;
+    sf::Vector2f spawnArea;               // Half size of the box particles start in
+    sf::Vector2f velocityMin;             // Pixels per second, picked per axis
+    sf::Vector2f velocityMax;
+    sf::Vector2f acceleration;            // Gravity and wind
+    float lifetimeMin = 1.f;              // Seconds
+    float lifetimeMax = 1.f;
+    sf::Vector2f sizeStart{4.f, 4.f};     // Faded to sizeEnd over the lifetime
+    sf::Vector2f sizeEnd{4.f, 4.f};
+    sf::Color colorStart = sf::Color::White;
+    sf::Color colorEnd = sf::Color::White;
+
+    // Weather that covers an area (usually the camera view) and follows it.
+    static EmitterDesc rain(sf::Vector2f area);
+    static EmitterDesc snow(sf::Vector2f area);
+    // Short burst for hits and spells; fire it with burst().
+    static EmitterDesc sparks(sf::Color color);
+};
+
+// Particles for weather and effects. Every emitter owns a fixed-size pool
+// stored as structure-of-arrays (one float array per field), and the update
+// runs as separate passes over those arrays (integrate, age), 4 particles at a
+// time with SSE2/NEON. Dead particles are swap-removed, so the live ones stay
+// packed at the front of each array.
+//
+// Particles are visual only: emitters draw from their own random generator,
+// never Input's, so recordings and replays stay in sync with or without them.
+// Drawing writes one vertex batch per texture, shared by all emitters using it.
+class ParticleSystem {
+public:
+    EmitterId addEmitter(const EmitterDesc& desc);
+    void removeEmitter(EmitterId id);
+    void clear();
+
+    void setPosition(EmitterId id, sf::Vector2f position);
+    void setRate(EmitterId id, float rate);
+    // Spawns count particles at once (limited by the free space in the pool).
+    void burst(EmitterId id, std::size_t count);
+
+    std::size_t particleCount() const;
+    std::size_t particleCount(EmitterId id) const;
+
+    // Emits, moves and ages every particle; fixed simulation step.
+    void update(float deltaTime);
+
+    // Writes 6 vertices (two triangles) per particle, interpolated between the
+    // previous and current step, with size and color faded by age. Batch 0
+    // holds untextured emitters; textures are numbered in order of first use.
+    const std::vector<std::vector<sf::Vertex>>& buildBatches(float alpha) const;
+    // One draw call per texture in use.
+    void draw(sf::RenderTarget& target, float alpha) const;
+    void record(RenderCommandList& commands, float alpha) const;
+
+private:
+    struct Emitter {
+        EmitterDesc desc;
+        bool active = false;
+        std::uint16_t batch = 0;
+        std::uint32_t rng = 0;
+        float pending = 0.f; // Fraction of a particle carried to the next step
+        std::size_t count = 0;
+        // Pool, desc.capacity entries per array
+        std::vector<float> x, y;
+        std::vector<float> prevX, prevY;
+        std::vector<float> vx, vy;
+        std::vector<float> age;      // 0 at birth, 1 at death
+        std::vector<float> ageRate;  // 1 / lifetime
+    };
+
+    Emitter* find(EmitterId id);
+    const Emitter* find(EmitterId id) const;
+    std::uint16_t batchIndex(const sf::Texture* texture);
+    static void emit(Emitter& emitter, std::size_t count);
+    static void removeDead(Emitter& emitter);
+
+    std::vector<Emitter> emitters_; // Indexed by EmitterId; removed slots are reused
+    std::vector<const sf::Texture*> textures_{nullptr};
+    mutable std::vector<std::vector<sf::Vertex>> batches_; // Per texture, reused by buildBatches()
+    mutable std::vector<std::size_t> batchFill_;
+    mutable VertexSnapshotPool snapshots_; // Recorded copies of batches_
+};
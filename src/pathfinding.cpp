@@ -0,0 +1,918 @@
+#include "pathfinding.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include "map.hpp"
+#include "profiler.hpp"
+
+namespace {
+constexpr float Infinity = std::numeric_limits<float>::infinity();
+constexpr float Sqrt2 = 1.41421356f;
+
+// Orthogonal directions first, then diagonals
+constexpr int Dx[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+constexpr int Dy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+constexpr std::int8_t Opposite[8] = {1, 0, 3, 2, 7, 6, 5, 4};
+
+// Expansions (tiles, for cluster queries) between budget checks in process()
+constexpr int SliceExpansions = 256;
+// Runs of free border tiles at least this long get an entrance at each end
+constexpr int LongEntrance = 6;
+constexpr std::size_t MaxCachedFlowFields = 8;
+
+float stepCost(int direction) {
+    return direction < 4 ? 1.f : Sqrt2;
+}
+
+float octile(GridPos a, GridPos b) {
+    const int dx = std::abs(a.x - b.x);
+    const int dy = std::abs(a.y - b.y);
+    return static_cast<float>(std::max(dx, dy)) + (Sqrt2 - 1.f) * static_cast<float>(std::min(dx, dy));
+}
+
+int sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+struct OpenEntry {
+    float f;
+    std::uint32_t tile;
+};
+
+struct OpenGreater {
+    bool operator()(const OpenEntry& a, const OpenEntry& b) const { return a.f > b.f; }
+};
+
+void pushOpen(std::vector<OpenEntry>& open, float f, std::uint32_t tile) {
+    open.push_back({f, tile});
+    std::push_heap(open.begin(), open.end(), OpenGreater{});
+}
+
+OpenEntry popOpen(std::vector<OpenEntry>& open) {
+    std::pop_heap(open.begin(), open.end(), OpenGreater{});
+    const OpenEntry entry = open.back();
+    open.pop_back();
+    return entry;
+}
+} // namespace
+
+bool FlowField::reachable(GridPos pos) const {
+    return distance(pos) < Infinity;
+}
+
+float FlowField::distance(GridPos pos) const {
+    if (pos.x < 0 || pos.y < 0 || pos.x >= width_ || pos.y >= height_) {
+        return Infinity;
+    }
+    return distance_[static_cast<std::size_t>(pos.y) * width_ + pos.x];
+}
+
+GridPos FlowField::next(GridPos pos) const {
+    if (pos.x < 0 || pos.y < 0 || pos.x >= width_ || pos.y >= height_) {
+        return pos;
+    }
+    const std::int8_t direction = direction_[static_cast<std::size_t>(pos.y) * width_ + pos.x];
+    return direction < 0 ? pos : GridPos{pos.x + Dx[direction], pos.y + Dy[direction]};
+}
+
+// Per-search node data. Stamps mark which entries belong to the current
+// search, so starting a new one never clears the whole grid.
+struct Pathfinder::Scratch {
+    std::vector<float> g;
+    std::vector<std::uint32_t> parent;
+    std::vector<std::uint32_t> seen;
+    std::vector<std::uint32_t> closed;
+    std::uint32_t stamp = 0;
+    std::vector<OpenEntry> open;
+    GridPos start;
+    GridPos goal;
+    SearchState state = SearchState::NotFound;
+
+    void reset(std::size_t tiles) {
+        if (seen.size() != tiles) {
+            g.assign(tiles, 0.f);
+            parent.assign(tiles, 0);
+            seen.assign(tiles, 0);
+            closed.assign(tiles, 0);
+            stamp = 0;
+        }
+        if (++stamp == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            std::fill(closed.begin(), closed.end(), 0);
+            stamp = 1;
+        }
+        open.clear();
+    }
+};
+
+struct Pathfinder::Cluster {
+    int x0 = 0;
+    int y0 = 0;
+    int w = 0;
+    int h = 0;
+    bool dirty = true;
+    std::vector<std::uint32_t> nodes;              // Entrance tiles on this side of a border
+    std::vector<std::vector<std::uint32_t>> links; // Per node, the tiles across the border
+    std::vector<float> cost;                       // nodes x nodes, moving inside the cluster
+
+    int find(std::uint32_t tile) const {
+        const auto it = std::find(nodes.begin(), nodes.end(), tile);
+        return it == nodes.end() ? -1 : static_cast<int>(it - nodes.begin());
+    }
+    std::uint32_t local(int x, int y) const {
+        return static_cast<std::uint32_t>((y - y0) * w + (x - x0));
+    }
+};
+
+// HPA* query in three stages, each resumable between slices: Dijkstra from
+// start and goal inside their clusters, A* over the entrance graph, then each
+// abstract hop refined into tiles.
+struct Pathfinder::HierarchicalSearch {
+    enum class Stage { Endpoints, Abstract, Refine };
+    struct NodeState {
+        float g = Infinity;
+        std::uint32_t parent = 0;
+        bool closed = false;
+    };
+
+    GridPos start;
+    GridPos goal;
+    std::uint32_t startTile = 0;
+    std::uint32_t goalTile = 0;
+    int startCluster = 0;
+    int goalCluster = 0;
+    Stage stage = Stage::Endpoints;
+    SearchState state = SearchState::NotFound;
+
+    std::vector<float> startDistance;
+    std::vector<std::int8_t> startParent;
+    std::vector<float> goalDistance;
+    std::vector<std::int8_t> goalParent;
+    std::unordered_map<std::uint32_t, NodeState> states;
+    std::vector<OpenEntry> open;
+
+    std::vector<std::uint32_t> abstractPath;
+    std::size_t nextHop = 1;
+    std::vector<float> distance;
+    std::vector<std::int8_t> parent;
+    GridPath path;
+};
+
+struct Pathfinder::FlowBuild {
+    std::shared_ptr<FlowField> field;
+    std::vector<OpenEntry> open;
+};
+
+struct Pathfinder::Request {
+    RequestId id = 0;
+    GridPos start;
+    GridPos goal;
+    PathCallback onPath;
+    FlowFieldCallback onFlow;
+    bool started = false;
+    FlowBuild flow;
+    GridPath path;
+    std::shared_ptr<const FlowField> field;
+};
+
+Pathfinder::Pathfinder(const Map& map, int clusterSize)
+    : map_(map)
+    , clusterSize_(std::max(clusterSize, 4))
+    , syncScratch_(std::make_unique<Scratch>())
+    , queueScratch_(std::make_unique<Scratch>())
+    , syncSearch_(std::make_unique<HierarchicalSearch>())
+    , queueSearch_(std::make_unique<HierarchicalSearch>()) {
+    rebuildAll();
+}
+
+Pathfinder::~Pathfinder() = default;
+
+bool Pathfinder::free(int x, int y) const {
+    return x >= 0 && y >= 0 && x < width_ && y < height_ &&
+           walkable_[static_cast<std::size_t>(y) * width_ + x] != 0;
+}
+
+bool Pathfinder::canStep(int x, int y, int dx, int dy) const {
+    if (!free(x + dx, y + dy)) {
+        return false;
+    }
+    // No cutting corners: a diagonal needs both orthogonal tiles free
+    return dx == 0 || dy == 0 || (free(x + dx, y) && free(x, y + dy));
+}
+
+std::uint32_t Pathfinder::indexOf(GridPos pos) const {
+    return static_cast<std::uint32_t>(pos.y * width_ + pos.x);
+}
+
+GridPos Pathfinder::posOf(std::uint32_t index) const {
+    return {static_cast<int>(index % static_cast<std::uint32_t>(width_)),
+            static_cast<int>(index / static_cast<std::uint32_t>(width_))};
+}
+
+bool Pathfinder::walkable(GridPos pos) const {
+    return free(pos.x, pos.y);
+}
+
+bool Pathfinder::useHierarchy() const {
+    return static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) >= HierarchicalMinTiles;
+}
+
+void Pathfinder::rebuildAll() {
+    width_ = static_cast<int>(map_.getWidth());
+    height_ = static_cast<int>(map_.getHeight());
+    walkable_.assign(static_cast<std::size_t>(width_) * height_, 0);
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            walkable_[static_cast<std::size_t>(y) * width_ + x] =
+                map_.isCollidable(static_cast<unsigned>(x), static_cast<unsigned>(y)) ? 0 : 1;
+        }
+    }
+    mapEpoch_ = map_.collisionEpoch();
+    changesSeen_ = map_.collisionChanges().size();
+
+    // Clusters are built lazily, the first time a query reaches them
+    clusterCols_ = (width_ + clusterSize_ - 1) / clusterSize_;
+    clusterRows_ = (height_ + clusterSize_ - 1) / clusterSize_;
+    clusters_.assign(static_cast<std::size_t>(clusterCols_) * clusterRows_, Cluster{});
+    for (int row = 0; row < clusterRows_; ++row) {
+        for (int col = 0; col < clusterCols_; ++col) {
+            Cluster& c = clusters_[static_cast<std::size_t>(row) * clusterCols_ + col];
+            c.x0 = col * clusterSize_;
+            c.y0 = row * clusterSize_;
+            c.w = std::min(clusterSize_, width_ - c.x0);
+            c.h = std::min(clusterSize_, height_ - c.y0);
+        }
+    }
+    invalidate();
+}
+
+void Pathfinder::invalidate() {
+    ++revision_;
+    flowCache_.clear();
+    for (auto& request : queue_) {
+        request->started = false;
+        request->flow = {};
+    }
+}
+
+void Pathfinder::sync() {
+    if (map_.collisionEpoch() != mapEpoch_ || static_cast<int>(map_.getWidth()) != width_ ||
+        static_cast<int>(map_.getHeight()) != height_) {
+        rebuildAll();
+        return;
+    }
+
+    const auto& changes = map_.collisionChanges();
+    bool changed = false;
+    for (; changesSeen_ < changes.size(); ++changesSeen_) {
+        const std::uint32_t index = changes[changesSeen_];
+        if (index >= walkable_.size()) {
+            continue;
+        }
+        const GridPos pos = posOf(index);
+        const std::uint8_t now =
+            map_.isCollidable(static_cast<unsigned>(pos.x), static_cast<unsigned>(pos.y)) ? 0 : 1;
+        if (walkable_[index] == now) {
+            continue; // Flipped back and forth since the last sync
+        }
+        walkable_[index] = now;
+        changed = true;
+
+        // Entrances on a border belong to both clusters next to it
+        clusters_[clusterOf(pos.x, pos.y)].dirty = true;
+        for (int d = 0; d < 4; ++d) {
+            const int nx = pos.x + Dx[d];
+            const int ny = pos.y + Dy[d];
+            if (nx >= 0 && ny >= 0 && nx < width_ && ny < height_) {
+                clusters_[clusterOf(nx, ny)].dirty = true;
+            }
+        }
+    }
+    if (changed) {
+        invalidate();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Jump Point Search
+
+void Pathfinder::beginJps(Scratch& scratch, GridPos start, GridPos goal) const {
+    scratch.reset(walkable_.size());
+    scratch.start = start;
+    scratch.goal = goal;
+    if (!free(start.x, start.y) || !free(goal.x, goal.y)) {
+        scratch.state = SearchState::NotFound;
+        return;
+    }
+    const std::uint32_t s = indexOf(start);
+    scratch.g[s] = 0.f;
+    scratch.parent[s] = s;
+    scratch.seen[s] = scratch.stamp;
+    pushOpen(scratch.open, octile(start, goal), s);
+    scratch.state = SearchState::Running;
+}
+
+std::int64_t Pathfinder::jump(int x, int y, int dx, int dy, GridPos goal) const {
+    while (canStep(x, y, dx, dy)) {
+        x += dx;
+        y += dy;
+        const std::int64_t here = static_cast<std::int64_t>(y) * width_ + x;
+        if (x == goal.x && y == goal.y) {
+            return here;
+        }
+        if (dx != 0 && dy != 0) {
+            // A diagonal stops where one of its straight components finds something
+            if (jump(x, y, dx, 0, goal) >= 0 || jump(x, y, 0, dy, goal) >= 0) {
+                return here;
+            }
+        } else if (dx != 0) {
+            if ((free(x, y - 1) && !free(x - dx, y - 1)) || (free(x, y + 1) && !free(x - dx, y + 1))) {
+                return here; // Forced neighbour above or below
+            }
+        } else {
+            if ((free(x - 1, y) && !free(x - 1, y - dy)) || (free(x + 1, y) && !free(x + 1, y - dy))) {
+                return here;
+            }
+        }
+    }
+    return -1;
+}
+
+Pathfinder::SearchState Pathfinder::stepJps(Scratch& scratch, int maxExpansions) const {
+    const std::uint32_t goal = indexOf(scratch.goal);
+    for (int expansions = 0; scratch.state == SearchState::Running && expansions < maxExpansions; ++expansions) {
+        if (scratch.open.empty()) {
+            scratch.state = SearchState::NotFound;
+            break;
+        }
+        const std::uint32_t node = popOpen(scratch.open).tile;
+        if (scratch.closed[node] == scratch.stamp) {
+            continue;
+        }
+        scratch.closed[node] = scratch.stamp;
+        if (node == goal) {
+            scratch.state = SearchState::Found;
+            break;
+        }
+
+        // Pruned directions: everything at the start, otherwise the travel
+        // direction plus the neighbours that only this node can reach well
+        const GridPos p = posOf(node);
+        int dirs[8][2];
+        int dirCount = 0;
+        const auto add = [&dirs, &dirCount](int dx, int dy) {
+            dirs[dirCount][0] = dx;
+            dirs[dirCount][1] = dy;
+            ++dirCount;
+        };
+        if (scratch.parent[node] == node) {
+            for (int d = 0; d < 8; ++d) {
+                add(Dx[d], Dy[d]);
+            }
+        } else {
+            const GridPos from = posOf(scratch.parent[node]);
+            const int dx = sign(p.x - from.x);
+            const int dy = sign(p.y - from.y);
+            if (dx != 0 && dy != 0) {
+                add(dx, 0);
+                add(0, dy);
+                add(dx, dy);
+            } else if (dx != 0) {
+                add(dx, 0);
+                add(0, 1);
+                add(0, -1);
+                add(dx, 1);
+                add(dx, -1);
+            } else {
+                add(0, dy);
+                add(1, 0);
+                add(-1, 0);
+                add(1, dy);
+                add(-1, dy);
+            }
+        }
+
+        for (int i = 0; i < dirCount; ++i) {
+            const std::int64_t found = jump(p.x, p.y, dirs[i][0], dirs[i][1], scratch.goal);
+            if (found < 0) {
+                continue;
+            }
+            const auto next = static_cast<std::uint32_t>(found);
+            if (scratch.closed[next] == scratch.stamp) {
+                continue;
+            }
+            const GridPos q = posOf(next);
+            const float g = scratch.g[node] + octile(p, q);
+            if (scratch.seen[next] != scratch.stamp || g < scratch.g[next]) {
+                scratch.seen[next] = scratch.stamp;
+                scratch.g[next] = g;
+                scratch.parent[next] = node;
+                pushOpen(scratch.open, g + octile(q, scratch.goal), next);
+            }
+        }
+    }
+    return scratch.state;
+}
+
+GridPath Pathfinder::jpsPath(const Scratch& scratch) const {
+    std::vector<std::uint32_t> jumpPoints;
+    for (std::uint32_t node = indexOf(scratch.goal);; node = scratch.parent[node]) {
+        jumpPoints.push_back(node);
+        if (scratch.parent[node] == node) {
+            break;
+        }
+    }
+    std::reverse(jumpPoints.begin(), jumpPoints.end());
+
+    // Jump points are joined by straight or diagonal runs; fill in the tiles
+    GridPath path{posOf(jumpPoints.front())};
+    for (std::size_t i = 1; i < jumpPoints.size(); ++i) {
+        const GridPos to = posOf(jumpPoints[i]);
+        GridPos at = path.back();
+        const int dx = sign(to.x - at.x);
+        const int dy = sign(to.y - at.y);
+        while (!(at == to)) {
+            at.x += at.x != to.x ? dx : 0;
+            at.y += at.y != to.y ? dy : 0;
+            path.push_back(at);
+        }
+    }
+    return path;
+}
+
+GridPath Pathfinder::findPathJps(GridPos start, GridPos goal) {
+    LUMY_PROFILE_SCOPE("Pathfinder::findPathJps");
+    sync();
+    beginJps(*syncScratch_, start, goal);
+    stepJps(*syncScratch_, INT_MAX);
+    return syncScratch_->state == SearchState::Found ? jpsPath(*syncScratch_) : GridPath{};
+}
+
+GridPath Pathfinder::findPath(GridPos start, GridPos goal) {
+    return useHierarchy() ? findPathHierarchical(start, goal) : findPathJps(start, goal);
+}
+
+// ---------------------------------------------------------------------------
+// Flow fields
+
+void Pathfinder::beginFlow(FlowBuild& build, GridPos goal) const {
+    build.field = std::make_shared<FlowField>();
+    FlowField& field = *build.field;
+    field.width_ = width_;
+    field.height_ = height_;
+    field.goal_ = goal;
+    field.distance_.assign(walkable_.size(), Infinity);
+    field.direction_.assign(walkable_.size(), -1);
+    build.open.clear();
+    if (free(goal.x, goal.y)) {
+        field.distance_[indexOf(goal)] = 0.f;
+        pushOpen(build.open, 0.f, indexOf(goal));
+    }
+}
+
+bool Pathfinder::stepFlow(FlowBuild& build, int maxExpansions) const {
+    FlowField& field = *build.field;
+    for (int expansions = 0; expansions < maxExpansions && !build.open.empty(); ++expansions) {
+        const OpenEntry entry = popOpen(build.open);
+        if (entry.f > field.distance_[entry.tile]) {
+            continue; // Stale entry, a shorter one was already expanded
+        }
+        const GridPos p = posOf(entry.tile);
+        for (int d = 0; d < 8; ++d) {
+            if (!canStep(p.x, p.y, Dx[d], Dy[d])) {
+                continue;
+            }
+            const std::uint32_t next = indexOf({p.x + Dx[d], p.y + Dy[d]});
+            const float distance = entry.f + stepCost(d);
+            if (distance < field.distance_[next]) {
+                field.distance_[next] = distance;
+                field.direction_[next] = Opposite[d];
+                pushOpen(build.open, distance, next);
+            }
+        }
+    }
+    return build.open.empty();
+}
+
+std::shared_ptr<const FlowField> Pathfinder::cachedFlowField(GridPos goal) const {
+    for (const auto& field : flowCache_) {
+        if (field->goal() == goal) {
+            return field;
+        }
+    }
+    return nullptr;
+}
+
+void Pathfinder::cacheFlowField(std::shared_ptr<const FlowField> field) {
+    if (flowCache_.size() >= MaxCachedFlowFields) {
+        flowCache_.erase(flowCache_.begin());
+    }
+    flowCache_.push_back(std::move(field));
+}
+
+std::shared_ptr<const FlowField> Pathfinder::flowField(GridPos goal) {
+    LUMY_PROFILE_SCOPE("Pathfinder::flowField");
+    sync();
+    if (auto cached = cachedFlowField(goal)) {
+        return cached;
+    }
+    FlowBuild build;
+    beginFlow(build, goal);
+    stepFlow(build, INT_MAX);
+    cacheFlowField(build.field);
+    return build.field;
+}
+
+// ---------------------------------------------------------------------------
+// Cluster graph (HPA*)
+
+int Pathfinder::clusterOf(int x, int y) const {
+    return (y / clusterSize_) * clusterCols_ + (x / clusterSize_);
+}
+
+Pathfinder::Cluster& Pathfinder::cluster(int index, int& work) {
+    Cluster& c = clusters_[static_cast<std::size_t>(index)];
+    if (c.dirty) {
+        rebuildCluster(c);
+        // One Dijkstra over the cluster per entrance
+        work += static_cast<int>(std::max<std::size_t>(c.nodes.size(), 1)) * c.w * c.h;
+    }
+    return c;
+}
+
+void Pathfinder::rebuildCluster(Cluster& c) {
+    c.nodes.clear();
+    c.links.clear();
+
+    // Entrances are picked from runs of tile pairs that are free on both
+    // sides of a border. The cluster across the border scans the same pairs
+    // in the same order, so both sides agree on them.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    const auto scanSide = [this, &c, &pairs](int x, int y, int stepX, int stepY, int outX, int outY, int length) {
+        pairs.clear();
+        for (int i = 0; i <= length; ++i, x += stepX, y += stepY) {
+            const bool open = i < length && free(x, y) && free(x + outX, y + outY);
+            if (open) {
+                pairs.emplace_back(indexOf({x, y}), indexOf({x + outX, y + outY}));
+                continue;
+            }
+            const int run = static_cast<int>(pairs.size());
+            if (run == 0) {
+                continue;
+            }
+            const auto addEntrance = [&c](std::pair<std::uint32_t, std::uint32_t> entrance) {
+                int node = c.find(entrance.first);
+                if (node < 0) {
+                    node = static_cast<int>(c.nodes.size());
+                    c.nodes.push_back(entrance.first);
+                    c.links.emplace_back();
+                }
+                c.links[static_cast<std::size_t>(node)].push_back(entrance.second);
+            };
+            if (run < LongEntrance) {
+                addEntrance(pairs[static_cast<std::size_t>(run / 2)]);
+            } else {
+                addEntrance(pairs.front());
+                addEntrance(pairs.back());
+            }
+            pairs.clear();
+        }
+    };
+    if (c.y0 > 0) {
+        scanSide(c.x0, c.y0, 1, 0, 0, -1, c.w);
+    }
+    if (c.y0 + c.h < height_) {
+        scanSide(c.x0, c.y0 + c.h - 1, 1, 0, 0, 1, c.w);
+    }
+    if (c.x0 > 0) {
+        scanSide(c.x0, c.y0, 0, 1, -1, 0, c.h);
+    }
+    if (c.x0 + c.w < width_) {
+        scanSide(c.x0 + c.w - 1, c.y0, 0, 1, 1, 0, c.h);
+    }
+
+    const std::size_t n = c.nodes.size();
+    c.cost.assign(n * n, Infinity);
+    std::vector<float> distance;
+    std::vector<std::int8_t> parent;
+    for (std::size_t i = 0; i < n; ++i) {
+        clusterDijkstra(c, c.nodes[i], distance, parent);
+        for (std::size_t j = 0; j < n; ++j) {
+            const GridPos target = posOf(c.nodes[j]);
+            c.cost[i * n + j] = distance[c.local(target.x, target.y)];
+        }
+    }
+    c.dirty = false;
+}
+
+void Pathfinder::clusterDijkstra(const Cluster& c, std::uint32_t source,
+                                 std::vector<float>& distance, std::vector<std::int8_t>& parent) const {
+    const std::size_t tiles = static_cast<std::size_t>(c.w) * c.h;
+    distance.assign(tiles, Infinity);
+    parent.assign(tiles, -1);
+    const GridPos start = posOf(source);
+    if (!free(start.x, start.y)) {
+        return;
+    }
+
+    std::vector<OpenEntry> open;
+    distance[c.local(start.x, start.y)] = 0.f;
+    pushOpen(open, 0.f, c.local(start.x, start.y));
+    while (!open.empty()) {
+        const OpenEntry entry = popOpen(open);
+        if (entry.f > distance[entry.tile]) {
+            continue;
+        }
+        const int x = c.x0 + static_cast<int>(entry.tile) % c.w;
+        const int y = c.y0 + static_cast<int>(entry.tile) / c.w;
+        for (int d = 0; d < 8; ++d) {
+            const int nx = x + Dx[d];
+            const int ny = y + Dy[d];
+            if (nx < c.x0 || ny < c.y0 || nx >= c.x0 + c.w || ny >= c.y0 + c.h || !canStep(x, y, Dx[d], Dy[d])) {
+                continue;
+            }
+            const std::uint32_t next = c.local(nx, ny);
+            const float nd = entry.f + stepCost(d);
+            if (nd < distance[next]) {
+                distance[next] = nd;
+                parent[next] = Opposite[d];
+                pushOpen(open, nd, next);
+            }
+        }
+    }
+}
+
+void Pathfinder::appendClusterPath(const Cluster& c, const std::vector<std::int8_t>& parent,
+                                   std::uint32_t target, GridPath& out) const {
+    GridPath segment;
+    GridPos at = posOf(target);
+    segment.push_back(at);
+    for (std::int8_t d = parent[c.local(at.x, at.y)]; d >= 0; d = parent[c.local(at.x, at.y)]) {
+        at = {at.x + Dx[d], at.y + Dy[d]};
+        segment.push_back(at);
+    }
+    std::reverse(segment.begin(), segment.end());
+    const std::size_t skip = !out.empty() && out.back() == segment.front() ? 1 : 0;
+    out.insert(out.end(), segment.begin() + static_cast<std::ptrdiff_t>(skip), segment.end());
+}
+
+void Pathfinder::beginHierarchical(HierarchicalSearch& search, GridPos start, GridPos goal) const {
+    search.start = start;
+    search.goal = goal;
+    search.stage = HierarchicalSearch::Stage::Endpoints;
+    search.states.clear();
+    search.open.clear();
+    search.abstractPath.clear();
+    search.nextHop = 1;
+    search.path.clear();
+    if (!free(start.x, start.y) || !free(goal.x, goal.y)) {
+        search.state = SearchState::NotFound;
+        return;
+    }
+    if (start == goal) {
+        search.path.push_back(start);
+        search.state = SearchState::Found;
+        return;
+    }
+    search.startTile = indexOf(start);
+    search.goalTile = indexOf(goal);
+    search.startCluster = clusterOf(start.x, start.y);
+    search.goalCluster = clusterOf(goal.x, goal.y);
+    search.state = SearchState::Running;
+}
+
+Pathfinder::SearchState Pathfinder::stepHierarchical(HierarchicalSearch& s, int maxWork) {
+    using Stage = HierarchicalSearch::Stage;
+    const auto relax = [this, &s](std::uint32_t from, std::uint32_t to, float cost) {
+        const float g = s.states[from].g + cost;
+        HierarchicalSearch::NodeState& state = s.states[to];
+        if (!state.closed && g < state.g) {
+            state.g = g;
+            state.parent = from;
+            pushOpen(s.open, g + octile(posOf(to), s.goal), to);
+        }
+    };
+
+    int work = 0;
+    while (s.state == SearchState::Running && work < maxWork) {
+        if (s.stage == Stage::Endpoints) {
+            const Cluster& startCluster = cluster(s.startCluster, work);
+            clusterDijkstra(startCluster, s.startTile, s.startDistance, s.startParent);
+            work += startCluster.w * startCluster.h;
+            if (s.startCluster == s.goalCluster &&
+                s.startDistance[startCluster.local(s.goal.x, s.goal.y)] < Infinity) {
+                appendClusterPath(startCluster, s.startParent, s.goalTile, s.path);
+                s.state = SearchState::Found;
+                break;
+            }
+            const Cluster& goalCluster = cluster(s.goalCluster, work);
+            clusterDijkstra(goalCluster, s.goalTile, s.goalDistance, s.goalParent);
+            work += goalCluster.w * goalCluster.h;
+
+            // A* over entrance tiles, with start and goal wired to the
+            // entrances of their own clusters
+            s.states[s.startTile] = {0.f, s.startTile, false};
+            pushOpen(s.open, octile(s.start, s.goal), s.startTile);
+            s.stage = Stage::Abstract;
+            continue;
+        }
+
+        if (s.stage == Stage::Abstract) {
+            if (s.open.empty()) {
+                s.state = SearchState::NotFound;
+                break;
+            }
+            const std::uint32_t tile = popOpen(s.open).tile;
+            ++work;
+            if (s.states[tile].closed) {
+                continue;
+            }
+            s.states[tile].closed = true;
+            if (tile == s.goalTile) {
+                for (std::uint32_t at = s.goalTile;; at = s.states[at].parent) {
+                    s.abstractPath.push_back(at);
+                    if (at == s.startTile) {
+                        break;
+                    }
+                }
+                std::reverse(s.abstractPath.begin(), s.abstractPath.end());
+                s.path.push_back(s.start);
+                s.stage = Stage::Refine;
+                continue;
+            }
+            if (tile == s.startTile) {
+                const Cluster& c = cluster(s.startCluster, work);
+                for (std::uint32_t node : c.nodes) {
+                    const GridPos p = posOf(node);
+                    const float d = s.startDistance[c.local(p.x, p.y)];
+                    if (d < Infinity && node != s.startTile) {
+                        relax(s.startTile, node, d);
+                    }
+                }
+            }
+            const GridPos p = posOf(tile);
+            const int k = clusterOf(p.x, p.y);
+            const Cluster& c = cluster(k, work);
+            const int i = c.find(tile);
+            if (i < 0) {
+                continue;
+            }
+            const std::size_t n = c.nodes.size();
+            for (std::size_t j = 0; j < n; ++j) {
+                const float cost = c.cost[static_cast<std::size_t>(i) * n + j];
+                if (cost < Infinity && static_cast<int>(j) != i) {
+                    relax(tile, c.nodes[j], cost);
+                }
+            }
+            for (std::uint32_t across : c.links[static_cast<std::size_t>(i)]) {
+                relax(tile, across, 1.f);
+            }
+            if (k == s.goalCluster) {
+                const float d = s.goalDistance[c.local(p.x, p.y)];
+                if (d < Infinity) {
+                    relax(tile, s.goalTile, d);
+                }
+            }
+            continue;
+        }
+
+        // Refine one abstract hop into tiles
+        if (s.nextHop >= s.abstractPath.size()) {
+            s.state = SearchState::Found;
+            break;
+        }
+        const std::uint32_t from = s.abstractPath[s.nextHop - 1];
+        const std::uint32_t to = s.abstractPath[s.nextHop];
+        ++s.nextHop;
+        const GridPos a = posOf(from);
+        const GridPos b = posOf(to);
+        const int k = clusterOf(a.x, a.y);
+        if (k != clusterOf(b.x, b.y)) {
+            s.path.push_back(b); // Crossing a border between neighbouring tiles
+            ++work;
+            continue;
+        }
+        const Cluster& c = cluster(k, work);
+        if (from == s.startTile) {
+            appendClusterPath(c, s.startParent, to, s.path);
+        } else if (to == s.goalTile) {
+            GridPath back;
+            appendClusterPath(c, s.goalParent, from, back);
+            s.path.insert(s.path.end(), back.rbegin() + 1, back.rend());
+        } else {
+            clusterDijkstra(c, from, s.distance, s.parent);
+            appendClusterPath(c, s.parent, to, s.path);
+            work += c.w * c.h;
+        }
+    }
+    return s.state;
+}
+
+GridPath Pathfinder::findPathHierarchical(GridPos start, GridPos goal) {
+    LUMY_PROFILE_SCOPE("Pathfinder::findPathHierarchical");
+    sync();
+    beginHierarchical(*syncSearch_, start, goal);
+    stepHierarchical(*syncSearch_, INT_MAX);
+    return syncSearch_->state == SearchState::Found ? std::move(syncSearch_->path) : GridPath{};
+}
+
+// ---------------------------------------------------------------------------
+// Request queue
+
+Pathfinder::RequestId Pathfinder::requestPath(GridPos start, GridPos goal, PathCallback done) {
+    auto request = std::make_unique<Request>();
+    request->id = nextId_++;
+    request->start = start;
+    request->goal = goal;
+    request->onPath = std::move(done);
+    queue_.push_back(std::move(request));
+    return queue_.back()->id;
+}
+
+Pathfinder::RequestId Pathfinder::requestFlowField(GridPos goal, FlowFieldCallback done) {
+    auto request = std::make_unique<Request>();
+    request->id = nextId_++;
+    request->goal = goal;
+    request->onFlow = std::move(done);
+    queue_.push_back(std::move(request));
+    return queue_.back()->id;
+}
+
+bool Pathfinder::cancel(RequestId id) {
+    const auto it = std::find_if(queue_.begin(), queue_.end(),
+                                 [id](const std::unique_ptr<Request>& request) { return request->id == id; });
+    if (it == queue_.end()) {
+        return false;
+    }
+    queue_.erase(it);
+    return true;
+}
+
+bool Pathfinder::runSlice(Request& request) {
+    if (request.onFlow) {
+        if (!request.started) {
+            request.started = true;
+            if ((request.field = cachedFlowField(request.goal))) {
+                return true;
+            }
+            beginFlow(request.flow, request.goal);
+        }
+        if (!stepFlow(request.flow, SliceExpansions)) {
+            return false;
+        }
+        request.field = request.flow.field;
+        cacheFlowField(request.field);
+        request.flow = {};
+        return true;
+    }
+
+    if (useHierarchy()) {
+        // The entrance graph spans the whole map and may need cluster
+        // rebuilds on the way: resumed like JPS
+        if (!request.started) {
+            request.started = true;
+            beginHierarchical(*queueSearch_, request.start, request.goal);
+        }
+        const SearchState state = stepHierarchical(*queueSearch_, SliceExpansions);
+        if (state == SearchState::Running) {
+            return false;
+        }
+        request.path = state == SearchState::Found ? std::move(queueSearch_->path) : GridPath{};
+        return true;
+    }
+    if (!request.started) {
+        request.started = true;
+        beginJps(*queueScratch_, request.start, request.goal);
+    }
+    const SearchState state = stepJps(*queueScratch_, SliceExpansions);
+    if (state == SearchState::Running) {
+        return false;
+    }
+    request.path = state == SearchState::Found ? jpsPath(*queueScratch_) : GridPath{};
+    return true;
+}
+
+void Pathfinder::process(std::chrono::microseconds budget) {
+    LUMY_PROFILE_SCOPE("Pathfinder::process");
+    sync();
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    while (!queue_.empty()) {
+        if (runSlice(*queue_.front())) {
+            // Pop before the callback, which may queue or cancel requests
+            const std::unique_ptr<Request> done = std::move(queue_.front());
+            queue_.pop_front();
+            if (done->onFlow) {
+                done->onFlow(done->field);
+            } else if (done->onPath) {
+                done->onPath(done->path);
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class Map;
+
+struct GridPos {
+    int x = 0;
+    int y = 0;
+
+    bool operator==(const GridPos&) const = default;
+};
+
+// Tiles from start to goal, both included. Empty when the goal is unreachable.
+using GridPath = std::vector<GridPos>;
+
+// Distance to one goal from every tile, plus the neighbour to step to. Many
+// agents heading to the same place share a single field.
+class FlowField {
+public:
+    GridPos goal() const { return goal_; }
+    bool reachable(GridPos pos) const;
+    float distance(GridPos pos) const; // Infinity when unreachable
+    // Next tile towards the goal; pos itself at the goal or when unreachable.
+    GridPos next(GridPos pos) const;
+
+private:
+    friend class Pathfinder;
+
+    int width_ = 0;
+    int height_ = 0;
+    GridPos goal_;
+    std::vector<float> distance_;
+    std::vector<std::int8_t> direction_; // Neighbour index, -1 for none
+};
+
+// Pathfinding over a Map's collision grid with 8-way movement (diagonals only
+// when both orthogonal tiles are free):
+// - Jump Point Search for single paths;
+// - flow fields (Dijkstra from the goal) shared by many agents;
+// - a cluster graph (HPA*) that keeps queries on large maps cheap.
+// The pathfinder keeps its own copy of the walkable grid and picks up
+// setTileID edits in sync(), rebuilding only the clusters they touch.
+//
+// Requests can be queued and are worked through by process() under a time
+// budget; long searches (JPS, flow fields, and cluster graph queries with the
+// cluster rebuilds they trigger) are resumed on the next call, so a burst of
+// requests spreads over several frames. Callbacks run inside process().
+class Pathfinder {
+public:
+    using RequestId = std::uint32_t;
+    using PathCallback = std::function<void(const GridPath&)>;
+    using FlowFieldCallback = std::function<void(std::shared_ptr<const FlowField>)>;
+
+    // Maps with at least this many tiles answer queued and findPath() queries
+    // through the cluster graph.
+    static constexpr std::size_t HierarchicalMinTiles = 128 * 128;
+
+    explicit Pathfinder(const Map& map, int clusterSize = 16);
+    ~Pathfinder();
+
+    Pathfinder(const Pathfinder&) = delete;
+    Pathfinder& operator=(const Pathfinder&) = delete;
+
+    // Applies collision changes made to the map since the last call. Queued
+    // requests restart and cached flow fields are dropped when anything
+    // changed. Called by every query, so explicit calls are optional.
+    void sync();
+    // Bumped whenever sync() applies a change; paths handed out earlier may
+    // cross tiles that are now blocked.
+    std::uint32_t revision() const { return revision_; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    bool walkable(GridPos pos) const;
+
+    GridPath findPath(GridPos start, GridPos goal);
+    GridPath findPathJps(GridPos start, GridPos goal);
+    GridPath findPathHierarchical(GridPos start, GridPos goal);
+    // Cached per goal (a few at a time).
+    std::shared_ptr<const FlowField> flowField(GridPos goal);
+
+    RequestId requestPath(GridPos start, GridPos goal, PathCallback done);
+    RequestId requestFlowField(GridPos goal, FlowFieldCallback done);
+    bool cancel(RequestId id);
+    std::size_t pendingRequests() const { return queue_.size(); }
+    // Works through queued requests until the budget runs out.
+    void process(std::chrono::microseconds budget);
+
+private:
+    struct Scratch;
+    struct HierarchicalSearch;
+    struct Cluster;
+    struct FlowBuild;
+    struct Request;
+
+    enum class SearchState { Running, Found, NotFound };
+
+    bool free(int x, int y) const;
+    bool canStep(int x, int y, int dx, int dy) const;
+    std::uint32_t indexOf(GridPos pos) const;
+    GridPos posOf(std::uint32_t index) const;
+    bool useHierarchy() const;
+
+    void rebuildAll();
+    void invalidate();
+    bool runSlice(Request& request);
+
+    // Jump Point Search
+    void beginJps(Scratch& scratch, GridPos start, GridPos goal) const;
+    SearchState stepJps(Scratch& scratch, int maxExpansions) const;
+    std::int64_t jump(int x, int y, int dx, int dy, GridPos goal) const;
+    GridPath jpsPath(const Scratch& scratch) const;
+
+    // Flow fields
+    void beginFlow(FlowBuild& build, GridPos goal) const;
+    bool stepFlow(FlowBuild& build, int maxExpansions) const;
+    std::shared_ptr<const FlowField> cachedFlowField(GridPos goal) const;
+    void cacheFlowField(std::shared_ptr<const FlowField> field);
+
+    // Cluster graph
+    void beginHierarchical(HierarchicalSearch& search, GridPos start, GridPos goal) const;
+    // maxWork counts tiles expanded, cluster rebuilds included
+    SearchState stepHierarchical(HierarchicalSearch& search, int maxWork);
+    int clusterOf(int x, int y) const;
+    // Rebuilt first if a tile edit touched it; the rebuild is added to work
+    Cluster& cluster(int index, int& work);
+    void rebuildCluster(Cluster& cluster);
+    void clusterDijkstra(const Cluster& cluster, std::uint32_t source,
+                         std::vector<float>& distance, std::vector<std::int8_t>& parent) const;
+    void appendClusterPath(const Cluster& cluster, const std::vector<std::int8_t>& parent,
+                           std::uint32_t target, GridPath& out) const;
+
+    const Map& map_;
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<std::uint8_t> walkable_;
+    std::uint32_t mapEpoch_ = 0;
+    std::size_t changesSeen_ = 0;
+    std::uint32_t revision_ = 0;
+
+    int clusterSize_;
+    int clusterCols_ = 0;
+    int clusterRows_ = 0;
+    std::vector<Cluster> clusters_;
+
+    std::unique_ptr<Scratch> syncScratch_;  // findPathJps
+    std::unique_ptr<Scratch> queueScratch_; // Search resumed by process()
+    std::unique_ptr<HierarchicalSearch> syncSearch_;  // findPathHierarchical
+    std::unique_ptr<HierarchicalSearch> queueSearch_; // Same, resumed by process()
+    std::vector<std::shared_ptr<const FlowField>> flowCache_; // Oldest first
+
+    std::deque<std::unique_ptr<Request>> queue_;
+    RequestId nextId_ = 1;
+};
@@ -0,0 +1,32 @@
+#include "pause_scene.hpp"
+#include "render_commands.hpp"
+#include "input.hpp"
+#include <stdexcept>
+
+PauseScene::PauseScene(SceneStack& stack)
+    : stack_(stack), titleText_(font_, "Pausado", 32) {
+    fontData_ = Vfs::instance().read("game/font.ttf");
+    if (!fontData_ || !font_.openFromMemory(fontData_.data(), fontData_.size())) {
+        throw std::runtime_error("failed to load font game/font.ttf");
+    }
+    titleText_.setPosition({200.f, 150.f});
+}
+
+void PauseScene::handleEvent(const sf::Event&) {}
+
+void PauseScene::update(float) {
+    // Confirm ou Cancel voltam ao mapa; o Cancel que abriu o menu já foi
+    // consumido no passo anterior
+    const Input& input = Input::instance();
+    if (input.wasPressed(InputAction::Confirm) || input.wasPressed(InputAction::Cancel)) {
+        stack_.popScene();
+    }
+}
+
+void PauseScene::draw(sf::RenderTarget& target) const {
+    target.draw(titleText_);
+}
+
+void PauseScene::record(RenderCommandList& commands, float) const {
+    commands.draw(titleText_);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "scene.hpp"
+#include "scene_stack.hpp"
+#include "vfs.hpp"
+#include <SFML/Graphics.hpp>
+
+// Menu de pausa aberto pela MapScene (Cancel). É um overlay: o mapa fica
+// parado no fundo, desfocado, e só é redesenhado se chamar markDirty().
+class PauseScene : public Scene {
+public:
+    explicit PauseScene(SceneStack& stack);
+
+    void handleEvent(const sf::Event& event) override;
+    void update(float deltaTime) override;
+    void draw(sf::RenderTarget& target) const override;
+    void record(RenderCommandList& commands, float alpha) const override;
+
+    bool isOverlay() const override { return true; }
+    bool blurBackdrop() const override { return true; }
+
+private:
+    SceneStack& stack_;
+    FileData fontData_; // SFML lê os glifos sob demanda; vive mais que font_
+    sf::Font font_;
+    sf::Text titleText_;
+};
@@ -0,0 +1,315 @@
+#include "profiler.hpp"
+
+#if defined(LUMY_PROFILER)
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <unordered_map>
+
+#include "frame_arena.hpp"
+
+namespace {
+const auto profilerEpoch = std::chrono::steady_clock::now();
+
+// Plain integers: constant-initialized, safe to touch from operator new
+thread_local std::uint64_t allocationCount = 0;
+thread_local std::uint64_t allocatedBytes = 0;
+
+void* countedAlloc(std::size_t size, std::size_t alignment) {
+    ++allocationCount;
+    allocatedBytes += size;
+    size = std::max<std::size_t>(size, 1);
+    for (;;) {
+#if defined(_WIN32)
+        void* memory = alignment > alignof(std::max_align_t) ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+        void* memory = alignment > alignof(std::max_align_t)
+                           ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                           : std::malloc(size);
+#endif
+        if (memory) {
+            return memory;
+        }
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+// GCC sees these free() calls inlined next to operator new and flags them as
+// mismatched; here operator new is malloc, so the pairing is correct
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void countedFree(void* memory, std::size_t alignment) noexcept {
+#if defined(_WIN32)
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(memory);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(memory);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+} // namespace
+
+// Every replaceable form, so none of them falls back to an allocator that
+// the others don't match (sanitizers interpose the ones left out).
+void* operator new(std::size_t size) {
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+void* operator new[](std::size_t size) {
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAlloc(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size, alignof(std::max_align_t));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size, static_cast<std::size_t>(alignment));
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    countedFree(memory, alignof(std::max_align_t));
+}
+void operator delete[](void* memory) noexcept {
+    countedFree(memory, alignof(std::max_align_t));
+}
+void operator delete(void* memory, std::size_t) noexcept {
+    countedFree(memory, alignof(std::max_align_t));
+}
+void operator delete[](void* memory, std::size_t) noexcept {
+    countedFree(memory, alignof(std::max_align_t));
+}
+void operator delete(void* memory, std::align_val_t alignment) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    countedFree(memory, alignof(std::max_align_t));
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    countedFree(memory, alignof(std::max_align_t));
+}
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    countedFree(memory, static_cast<std::size_t>(alignment));
+}
+
+std::uint64_t Profiler::threadAllocations() {
+    return allocationCount;
+}
+
+std::uint64_t Profiler::threadAllocatedBytes() {
+    return allocatedBytes;
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+std::int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - profilerEpoch)
+        .count();
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer() {
+    // Handed back when the thread exits, so short-lived threads (scene
+    // preparation, battle workers) reuse buffers instead of adding ~400 KB each
+    struct Lease {
+        ThreadBuffer* buffer = nullptr;
+        ~Lease() {
+            if (buffer) {
+                Profiler& profiler = Profiler::instance();
+                std::lock_guard<std::mutex> lock(profiler.buffersMutex_);
+                buffer->inUse = false;
+            }
+        }
+    };
+    thread_local Lease lease;
+    if (!lease.buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        for (auto& candidate : buffers_) {
+            // Only once drained: records still unread belong to the old thread id
+            if (!candidate->inUse && candidate->readIndex.load(std::memory_order_acquire) ==
+                                         candidate->writeIndex.load(std::memory_order_relaxed)) {
+                lease.buffer = candidate.get();
+                break;
+            }
+        }
+        if (!lease.buffer) {
+            buffers_.push_back(std::make_unique<ThreadBuffer>());
+            lease.buffer = buffers_.back().get();
+        }
+        lease.buffer->inUse = true;
+        lease.buffer->threadId = ++nextThreadId_;
+    }
+    return *lease.buffer;
+}
+
+void Profiler::record(const char* name, std::int64_t start, std::int64_t end) {
+    ThreadBuffer& buffer = threadBuffer();
+    const std::uint64_t write = buffer.writeIndex.load(std::memory_order_relaxed);
+    if (write - buffer.readIndex.load(std::memory_order_acquire) >= BufferCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.records[write % BufferCapacity] = ZoneRecord{name, start, end};
+    buffer.writeIndex.store(write + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+    const std::int64_t frameEnd = now();
+    lastFrameMemory_.heapAllocations = allocationCount - frameAllocations_;
+    lastFrameMemory_.heapBytes = allocatedBytes - frameBytes_;
+    lastFrameMemory_.arenaBytes = frameArena().used();
+    lastFrameMemory_.arenaOverflows = frameArena().overflows();
+
+    std::vector<CapturedZone> zones;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        for (auto& buffer : buffers_) {
+            const std::uint64_t write = buffer->writeIndex.load(std::memory_order_acquire);
+            std::uint64_t read = buffer->readIndex.load(std::memory_order_relaxed);
+            for (; read < write; ++read) {
+                const ZoneRecord& record = buffer->records[read % BufferCapacity];
+                zones.push_back(CapturedZone{record.name, record.start, record.end, buffer->threadId});
+            }
+            buffer->readIndex.store(read, std::memory_order_release);
+        }
+    }
+
+    std::unordered_map<std::string_view, ZoneStats> totals;
+    for (const auto& zone : zones) {
+        ZoneStats& stats = totals[zone.name];
+        stats.name = zone.name;
+        stats.totalMs += static_cast<double>(zone.end - zone.start) / 1e6;
+        stats.calls++;
+    }
+    lastFrameZones_.clear();
+    for (const auto& [name, stats] : totals) {
+        lastFrameZones_.push_back(stats);
+    }
+    std::sort(lastFrameZones_.begin(), lastFrameZones_.end(),
+              [](const ZoneStats& a, const ZoneStats& b) { return a.totalMs > b.totalMs; });
+
+    if (frameStart_ != 0) {
+        frameHistory_.push_back(static_cast<float>(frameEnd - frameStart_) / 1e6f);
+        if (frameHistory_.size() > HistoryFrames) {
+            frameHistory_.pop_front();
+        }
+    }
+    frameStart_ = frameEnd;
+
+    capture_.push_back(std::move(zones));
+    if (capture_.size() > CaptureFrames) {
+        capture_.pop_front();
+    }
+    frameAllocations_ = allocationCount;
+    frameBytes_ = allocatedBytes;
+}
+
+std::uint64_t Profiler::droppedZones() const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    std::uint64_t dropped = 0;
+    for (const auto& buffer : buffers_) {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+std::size_t Profiler::threadBufferCount() const {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    return buffers_.size();
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const {
+    nlohmann::json events = nlohmann::json::array();
+    for (const auto& frame : capture_) {
+        for (const auto& zone : frame) {
+            // Complete events ("X"); timestamps in microseconds
+            events.push_back({
+                {"name", zone.name},
+                {"cat", "lumy"},
+                {"ph", "X"},
+                {"ts", static_cast<double>(zone.start) / 1e3},
+                {"dur", static_cast<double>(zone.end - zone.start) / 1e3},
+                {"pid", 1},
+                {"tid", zone.threadId},
+            });
+        }
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        std::cerr << "[Profiler] Erro ao criar " << path << "\n";
+        return false;
+    }
+    file << nlohmann::json{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}}.dump();
+    std::cout << "[Profiler] Trace exportado (" << capture_.size() << " frames): " << path << "\n";
+    return static_cast<bool>(file);
+}
+
+void Profiler::reset() {
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        for (auto& buffer : buffers_) {
+            buffer->readIndex.store(buffer->writeIndex.load(std::memory_order_acquire),
+                                    std::memory_order_release);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+    frameStart_ = 0;
+    frameAllocations_ = allocationCount;
+    frameBytes_ = allocatedBytes;
+    lastFrameMemory_ = {};
+    lastFrameZones_.clear();
+    frameHistory_.clear();
+    capture_.clear();
+}
+
+#endif
@@ -0,0 +1,147 @@
+#pragma once
+
+// CPU frame profiler. Everything here is compiled out unless LUMY_PROFILER is
+// defined (CMake: -DLUMY_PROFILER=ON, always on in Debug builds).
+//
+//   void Map::drawRange(...) const {
+//       LUMY_PROFILE_SCOPE("Map::drawRange");
+//       ...
+//   }
+//
+// Zones are written to a per-thread single-producer ring buffer without
+// locking; the main thread drains every buffer once per frame in endFrame().
+//
+// Profiler builds also replace the global operator new to count heap
+// allocations per thread, so every frame reports how often the main thread
+// hit the heap (lastFrameMemory()); a steady frame should report zero.
+
+#if defined(LUMY_PROFILER)
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Profiler {
+public:
+    static constexpr std::size_t HistoryFrames = 240; // Frame-time graph
+    static constexpr std::size_t CaptureFrames = 300; // Frames kept for trace export
+    static constexpr std::size_t BufferCapacity = 16384; // Zones per thread between drains
+
+    struct ZoneStats {
+        std::string_view name;
+        double totalMs = 0.0;
+        std::uint32_t calls = 0;
+    };
+
+    // Memory traffic of the thread that calls endFrame(), between two calls.
+    // The profiler's own bookkeeping in endFrame() is left out.
+    struct FrameMemory {
+        std::uint64_t heapAllocations = 0;
+        std::uint64_t heapBytes = 0;
+        std::size_t arenaBytes = 0;        // frameArena() in use at endFrame()
+        std::uint32_t arenaOverflows = 0;  // Arena allocations that went to the heap
+    };
+
+    static Profiler& instance();
+    // Nanoseconds since the profiler was created.
+    static std::int64_t now();
+
+    // Called by ProfileZone from any thread; never blocks after the thread's
+    // first zone (which takes a buffer: a drained one left by an exited
+    // thread, or a new one).
+    void record(const char* name, std::int64_t start, std::int64_t end);
+
+    // Main thread, once per frame: drains thread buffers and updates stats.
+    void endFrame();
+
+    // Zones of the last frame, sorted by total time (descending).
+    const std::vector<ZoneStats>& lastFrameZones() const { return lastFrameZones_; }
+    // Frame times in milliseconds, oldest first.
+    const std::deque<float>& frameHistory() const { return frameHistory_; }
+    // Zones lost because a thread filled its buffer before the next drain.
+    std::uint64_t droppedZones() const;
+    // Buffers ever allocated; threads that exited hand theirs back for reuse.
+    std::size_t threadBufferCount() const;
+
+    const FrameMemory& lastFrameMemory() const { return lastFrameMemory_; }
+    // operator new calls (and bytes) on the calling thread so far.
+    static std::uint64_t threadAllocations();
+    static std::uint64_t threadAllocatedBytes();
+
+    // Writes the last CaptureFrames frames as Chrome trace-event JSON
+    // (chrome://tracing, https://ui.perfetto.dev).
+    bool exportChromeTrace(const std::string& path) const;
+
+    // Discards all collected data (buffers stay registered).
+    void reset();
+
+private:
+    struct ZoneRecord {
+        const char* name;
+        std::int64_t start;
+        std::int64_t end;
+    };
+
+    struct ThreadBuffer {
+        std::uint32_t threadId = 0; // Trace tid; a new one each time the buffer is taken
+        bool inUse = false;         // Guarded by buffersMutex_
+        std::array<ZoneRecord, BufferCapacity> records{};
+        std::atomic<std::uint64_t> writeIndex{0};
+        std::atomic<std::uint64_t> readIndex{0};
+        std::atomic<std::uint64_t> dropped{0};
+    };
+
+    struct CapturedZone {
+        const char* name;
+        std::int64_t start;
+        std::int64_t end;
+        std::uint32_t threadId;
+    };
+
+    Profiler() = default;
+    ThreadBuffer& threadBuffer();
+
+    mutable std::mutex buffersMutex_; // Guards registration and release only
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+    std::uint32_t nextThreadId_ = 0;
+
+    std::int64_t frameStart_ = 0;
+    std::uint64_t frameAllocations_ = 0; // threadAllocations() when the frame began
+    std::uint64_t frameBytes_ = 0;
+    FrameMemory lastFrameMemory_;
+    std::vector<ZoneStats> lastFrameZones_;
+    std::deque<float> frameHistory_;
+    std::deque<std::vector<CapturedZone>> capture_;
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : name_(name), start_(Profiler::now()) {}
+    ~ProfileZone() { Profiler::instance().record(name_, start_, Profiler::now()); }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name_;
+    std::int64_t start_;
+};
+
+#define LUMY_PROFILE_CONCAT_IMPL(a, b) a##b
+#define LUMY_PROFILE_CONCAT(a, b) LUMY_PROFILE_CONCAT_IMPL(a, b)
+// `name` must be a string literal (or otherwise outlive the profiler).
+#define LUMY_PROFILE_SCOPE(name) ProfileZone LUMY_PROFILE_CONCAT(lumyProfileZone_, __LINE__){name}
+#define LUMY_PROFILE_FRAME() Profiler::instance().endFrame()
+
+#else
+
+#define LUMY_PROFILE_SCOPE(name) ((void)0)
+#define LUMY_PROFILE_FRAME() ((void)0)
+
+#endif
@@ -0,0 +1,98 @@
+#include "profiler_overlay.hpp"
+
+#if defined(LUMY_PROFILER)
+
+#include <algorithm>
+#include <cstdio>
+
+#include "profiler.hpp"
+#include "vfs.hpp"
+
+namespace {
+constexpr float GraphWidth = 240.f;
+constexpr float GraphHeight = 60.f;
+constexpr float BudgetMs = 1000.f / 60.f; // Reference line: 60 FPS
+constexpr float Margin = 8.f;
+} // namespace
+
+bool ProfilerOverlay::loadFont(const std::string& path) {
+    fontData_ = Vfs::instance().read(path);
+    if (!fontData_ || !font_.openFromMemory(fontData_.data(), fontData_.size())) {
+        return false;
+    }
+    text_.emplace(font_);
+    text_->setCharacterSize(12);
+    text_->setFillColor(sf::Color::White);
+    return true;
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target) const {
+    if (!visible_) {
+        return;
+    }
+
+    const Profiler& profiler = Profiler::instance();
+    const auto& history = profiler.frameHistory();
+    const sf::View previousView = target.getView();
+    target.setView(target.getDefaultView());
+
+    sf::RectangleShape background({GraphWidth + Margin * 2.f, GraphHeight + 150.f});
+    background.setPosition({Margin, Margin});
+    background.setFillColor(sf::Color(0, 0, 0, 180));
+    target.draw(background);
+
+    // One bar per frame, scaled so 2x the budget fills the graph
+    const sf::Vector2f origin{Margin * 2.f, Margin * 2.f};
+    const float barWidth = GraphWidth / static_cast<float>(Profiler::HistoryFrames);
+    const float scale = GraphHeight / (BudgetMs * 2.f);
+    sf::VertexArray bars(sf::PrimitiveType::Triangles, history.size() * 6 + 6);
+    std::size_t v = 0;
+    const auto addQuad = [&](float x, float y, float w, float h, sf::Color color) {
+        const sf::Vector2f corners[6] = {{x, y}, {x + w, y}, {x + w, y + h}, {x, y}, {x + w, y + h}, {x, y + h}};
+        for (const auto& corner : corners) {
+            bars[v].position = origin + corner;
+            bars[v].color = color;
+            ++v;
+        }
+    };
+    float x = GraphWidth - barWidth * static_cast<float>(history.size());
+    for (float ms : history) {
+        const float h = std::min(ms * scale, GraphHeight);
+        const sf::Color color = ms > BudgetMs * 1.5f ? sf::Color(230, 60, 60)
+                              : ms > BudgetMs        ? sf::Color(230, 200, 60)
+                                                     : sf::Color(80, 200, 120);
+        addQuad(x, GraphHeight - h, barWidth, h, color);
+        x += barWidth;
+    }
+    addQuad(0.f, GraphHeight - BudgetMs * scale, GraphWidth, 1.f, sf::Color(255, 255, 255, 120));
+    target.draw(bars);
+
+    if (text_) {
+        char line[96];
+        std::string content;
+        const float lastMs = history.empty() ? 0.f : history.back();
+        std::snprintf(line, sizeof(line), "frame %.2f ms  [F3] overlay  [F4] trace\n", lastMs);
+        content += line;
+        // Previous frame, including what this overlay allocated while visible
+        const Profiler::FrameMemory& memory = profiler.lastFrameMemory();
+        std::snprintf(line, sizeof(line), "heap %llu allocs  arena %.1f KB%s\n",
+                      static_cast<unsigned long long>(memory.heapAllocations),
+                      static_cast<double>(memory.arenaBytes) / 1024.0, memory.arenaOverflows > 0 ? " (overflow)" : "");
+        content += line;
+        const auto& zones = profiler.lastFrameZones();
+        for (std::size_t i = 0; i < zones.size() && i < TopZoneCount; ++i) {
+            std::snprintf(line, sizeof(line), "%6.2f ms %3ux  %.*s\n", zones[i].totalMs, zones[i].calls,
+                          static_cast<int>(zones[i].name.size()), zones[i].name.data());
+            content += line;
+        }
+
+        sf::Text text = *text_;
+        text.setString(content);
+        text.setPosition({origin.x, origin.y + GraphHeight + 6.f});
+        target.draw(text);
+    }
+
+    target.setView(previousView);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#if defined(LUMY_PROFILER)
+
+#include <SFML/Graphics.hpp>
+
+#include "vfs.hpp"
+
+#include <optional>
+#include <string>
+
+// In-game view of Profiler data: frame-time graph plus the slowest zones of
+// the last frame. Drawn in screen space on top of the current scene.
+class ProfilerOverlay {
+public:
+    static constexpr std::size_t TopZoneCount = 8;
+
+    // Returns false if the font can't be loaded (overlay stays text-less).
+    bool loadFont(const std::string& path);
+
+    void toggle() { visible_ = !visible_; }
+    bool isVisible() const { return visible_; }
+
+    void draw(sf::RenderTarget& target) const;
+
+private:
+    bool visible_ = false;
+    FileData fontData_; // Must outlive font_
+    sf::Font font_;
+    std::optional<sf::Text> text_;
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include "render_commands.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "profiler.hpp"
+
+namespace {
+
+// Fill geometry of text, placed the way sf::Text places it (outline,
+// underline and strike-through aren't recorded).
+void appendText(std::vector<sf::Vertex>& out, const sf::Text& text) {
+    const sf::Font& font = text.getFont();
+    const unsigned size = text.getCharacterSize();
+    const bool bold = (text.getStyle() & sf::Text::Bold) != 0;
+    const float italicShear = (text.getStyle() & sf::Text::Italic) != 0 ? 0.209f : 0.f; // 12 degrees
+    float whitespaceWidth = font.getGlyph(U' ', size, bold).advance;
+    const float letterSpacing = whitespaceWidth / 3.f * (text.getLetterSpacing() - 1.f);
+    whitespaceWidth += letterSpacing;
+    const float lineSpacing = font.getLineSpacing(size) * text.getLineSpacing();
+    const sf::Color color = text.getFillColor();
+
+    float x = 0.f;
+    float y = static_cast<float>(size);
+    char32_t previous = 0;
+    for (const char32_t code : text.getString()) {
+        if (code == U'\r') {
+            continue;
+        }
+        x += font.getKerning(previous, code, size, bold);
+        previous = code;
+        if (code == U' ' || code == U'\t') {
+            x += code == U' ' ? whitespaceWidth : whitespaceWidth * 4.f;
+            continue;
+        }
+        if (code == U'\n') {
+            x = 0.f;
+            y += lineSpacing;
+            continue;
+        }
+
+        // One texel of padding around the glyph, as sf::Text does
+        const sf::Glyph& glyph = font.getGlyph(code, size, bold);
+        const sf::FloatRect bounds = glyph.bounds;
+        const sf::FloatRect texture(glyph.textureRect);
+        const float left = bounds.position.x - 1.f;
+        const float top = bounds.position.y - 1.f;
+        const float right = bounds.position.x + bounds.size.x + 1.f;
+        const float bottom = bounds.position.y + bounds.size.y + 1.f;
+        const float u0 = texture.position.x - 1.f;
+        const float v0 = texture.position.y - 1.f;
+        const float u1 = texture.position.x + texture.size.x + 1.f;
+        const float v1 = texture.position.y + texture.size.y + 1.f;
+        out.push_back({{x + left - italicShear * top, y + top}, color, {u0, v0}});
+        out.push_back({{x + right - italicShear * top, y + top}, color, {u1, v0}});
+        out.push_back({{x + left - italicShear * bottom, y + bottom}, color, {u0, v1}});
+        out.push_back({{x + left - italicShear * bottom, y + bottom}, color, {u0, v1}});
+        out.push_back({{x + right - italicShear * top, y + top}, color, {u1, v0}});
+        out.push_back({{x + right - italicShear * bottom, y + bottom}, color, {u1, v1}});
+        x += glyph.advance + letterSpacing;
+    }
+}
+
+} // namespace
+
+void RenderCommandList::setView(const std::optional<sf::View>& view) {
+    commands_.emplace_back(ViewCommand{view});
+}
+
+void RenderCommandList::draw(const sf::Sprite& sprite) {
+    commands_.emplace_back(sprite);
+}
+
+void RenderCommandList::draw(const sf::RectangleShape& shape) {
+    commands_.emplace_back(shape);
+}
+
+void RenderCommandList::draw(const sf::Text& text) {
+    if (text.getString().isEmpty()) {
+        return;
+    }
+    auto vertices = textVertices_.acquire();
+    appendText(*vertices, text);
+    if (vertices->empty()) {
+        return;
+    }
+    sf::RenderStates states;
+    states.transform = text.getTransform();
+    states.texture = &text.getFont().getTexture(text.getCharacterSize());
+    draw(std::move(vertices), sf::PrimitiveType::Triangles, states);
+}
+
+void RenderCommandList::draw(VertexSnapshot vertices, sf::PrimitiveType type, const sf::RenderStates& states) {
+    if (!vertices || vertices->empty()) {
+        return;
+    }
+    commands_.emplace_back(VertexCommand{std::move(vertices), type, states});
+}
+
+void RenderCommandList::fillScreen(sf::Color color) {
+    commands_.emplace_back(FillCommand{color});
+}
+
+void RenderCommandList::replay(sf::RenderTarget& target) const {
+    LUMY_PROFILE_SCOPE("RenderCommandList::replay");
+    for (const auto& command : commands_) {
+        std::visit([&target](const auto& cmd) {
+            using T = std::decay_t<decltype(cmd)>;
+            if constexpr (std::is_same_v<T, ViewCommand>) {
+                target.setView(cmd.view ? *cmd.view : target.getDefaultView());
+            } else if constexpr (std::is_same_v<T, VertexCommand>) {
+                target.draw(cmd.vertices->data(), cmd.vertices->size(), cmd.type, cmd.states);
+            } else if constexpr (std::is_same_v<T, FillCommand>) {
+                const sf::View previousView = target.getView();
+                target.setView(target.getDefaultView());
+                sf::RectangleShape fill(sf::Vector2f(target.getSize()));
+                fill.setFillColor(cmd.color);
+                target.draw(fill);
+                target.setView(previousView);
+            } else {
+                target.draw(cmd);
+            }
+        }, command);
+    }
+}
+
+std::shared_ptr<std::vector<sf::Vertex>> VertexSnapshotPool::acquire() {
+    for (std::size_t i = 0; i < buffers_.size(); ++i) {
+        auto& buffer = buffers_[(next_ + i) % buffers_.size()];
+        if (buffer.use_count() == 1) {
+            next_ = (next_ + i + 1) % buffers_.size();
+            buffer->clear();
+            return buffer;
+        }
+    }
+    return buffers_.emplace_back(std::make_shared<std::vector<sf::Vertex>>());
+}
+
+RenderCommandList::VertexSnapshot VertexSnapshotPool::share(const sf::Vertex* first, std::size_t count) {
+    auto buffer = acquire();
+    buffer->assign(first, first + count);
+    return buffer;
+}
+
+void GlyphPreloader::preload(const sf::Font& font, unsigned characterSize, bool bold, std::u32string_view text) {
+    auto page = std::find_if(pages_.begin(), pages_.end(), [&](const Page& candidate) {
+        return candidate.font == &font && candidate.characterSize == characterSize && candidate.bold == bold;
+    });
+    if (page == pages_.end()) {
+        pages_.push_back({&font, characterSize, bold, {}});
+        page = pages_.end() - 1;
+    }
+
+    missing_.clear();
+    const auto need = [&](char32_t code) {
+        if (!page->loaded.contains(code) && std::find(missing_.begin(), missing_.end(), code) == missing_.end()) {
+            missing_.push_back(code);
+        }
+    };
+    need(U' '); // sf::Text measures whitespace with it
+    for (const char32_t code : text) {
+        need(code); // Line breaks too: kerning looks their glyph up
+    }
+    if (missing_.empty()) {
+        return;
+    }
+    if (fence_) {
+        fence_();
+    }
+    for (const char32_t code : missing_) {
+        font.getGlyph(code, characterSize, bold);
+        page->loaded.insert(code);
+    }
+}
+
+void GlyphPreloader::preload(const sf::Text& text) {
+    const sf::String& string = text.getString();
+    preload(text.getFont(), text.getCharacterSize(), (text.getStyle() & sf::Text::Bold) != 0,
+            std::u32string_view(string.getData(), string.getSize()));
+}
+
+void RenderQueue::publish() {
+    {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this] { return ready_ == None || stopped_; });
+        if (stopped_) {
+            lists_[back_].clear();
+            return;
+        }
+        ready_ = back_;
+        // Of three lists, one is always neither ready nor on the render thread
+        for (int i = 0; i < static_cast<int>(lists_.size()); ++i) {
+            if (i != ready_ && i != front_) {
+                back_ = i;
+                break;
+            }
+        }
+    }
+    changed_.notify_all();
+    lists_[back_].clear();
+}
+
+void RenderQueue::drain() {
+    std::unique_lock lock(mutex_);
+    ready_ = None;
+    changed_.wait(lock, [this] { return front_ == None || stopped_; });
+}
+
+const RenderCommandList* RenderQueue::acquire() {
+    const RenderCommandList* list = nullptr;
+    {
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this] { return ready_ != None || stopped_; });
+        if (stopped_) {
+            return nullptr;
+        }
+        front_ = ready_;
+        ready_ = None;
+        list = &lists_[front_];
+    }
+    changed_.notify_all();
+    return list;
+}
+
+void RenderQueue::release() {
+    {
+        std::lock_guard lock(mutex_);
+        front_ = None;
+    }
+    changed_.notify_all();
+}
+
+void RenderQueue::stop() {
+    {
+        std::lock_guard lock(mutex_);
+        stopped_ = true;
+    }
+    changed_.notify_all();
+}
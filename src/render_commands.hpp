@@ -0,0 +1,144 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+// Vertex buffers recycled across frames for RenderCommandList snapshots. A
+// buffer is handed out again once no list holds it any more, which the
+// simulation thread sees on its own (lists are cleared there, in publish()),
+// so after the first few frames recording copies vertices without allocating.
+// One pool per call site that records every frame.
+class VertexSnapshotPool {
+public:
+    // Copy of vertices [first, first + count) as a snapshot.
+    std::shared_ptr<const std::vector<sf::Vertex>> share(const sf::Vertex* first, std::size_t count);
+    std::shared_ptr<const std::vector<sf::Vertex>> share(const std::vector<sf::Vertex>& vertices) {
+        return share(vertices.data(), vertices.size());
+    }
+    // Empty buffer to fill before recording; its capacity is kept.
+    std::shared_ptr<std::vector<sf::Vertex>> acquire();
+
+    std::size_t size() const { return buffers_.size(); }
+
+private:
+    std::vector<std::shared_ptr<std::vector<sf::Vertex>>> buffers_;
+    std::size_t next_ = 0; // Where the search for a free buffer starts
+};
+
+// Immutable snapshot of one frame, recorded by the simulation thread and
+// replayed by the render thread (GameLoopConfig::threadedRender).
+//
+// Sprites and shapes are copied by value; they keep pointers to textures,
+// which must outlive the list (TextureManager entries and fonts owned by
+// scenes; GameLoop drains the queue before scenes change). Texts are laid out
+// when recorded, into vertices bound to the font's page texture, so the render
+// thread never touches an sf::Font (which isn't thread-safe). Glyphs the text
+// still lacks are loaded right there: preload them (GlyphPreloader) when the
+// font may already be in a published list. Tile geometry is shared through
+// immutable vertex snapshots, so recording a map costs one pointer copy per
+// layer.
+class RenderCommandList {
+public:
+    using VertexSnapshot = std::shared_ptr<const std::vector<sf::Vertex>>;
+
+    // nullopt switches back to the target's default view.
+    void setView(const std::optional<sf::View>& view);
+    void draw(const sf::Sprite& sprite);
+    void draw(const sf::RectangleShape& shape);
+    void draw(const sf::Text& text);
+    void draw(VertexSnapshot vertices, sf::PrimitiveType type, const sf::RenderStates& states = sf::RenderStates::Default);
+    // Covers the whole target in screen space (fades, overlay dimming).
+    void fillScreen(sf::Color color);
+
+    void clear() { commands_.clear(); }
+    std::size_t size() const { return commands_.size(); }
+    bool empty() const { return commands_.empty(); }
+
+    void replay(sf::RenderTarget& target) const;
+
+private:
+    struct ViewCommand {
+        std::optional<sf::View> view;
+    };
+    struct VertexCommand {
+        VertexSnapshot vertices;
+        sf::PrimitiveType type;
+        sf::RenderStates states;
+    };
+    struct FillCommand {
+        sf::Color color;
+    };
+    using Command = std::variant<ViewCommand, sf::Sprite, sf::RectangleShape, VertexCommand, FillCommand>;
+
+    std::vector<Command> commands_;
+    VertexSnapshotPool textVertices_; // Free again once clear() drops the commands
+};
+
+// sf::Font rasterizes a glyph on first use, writing (and sometimes growing)
+// the page texture of that character size, which a list the render thread is
+// replaying may bind. preload() loads every glyph of a text up front and runs
+// the fence (SceneStack::fenceRender) first, but only when the text has a code
+// point this preloader hasn't loaded yet; laying the text out afterwards only
+// reads the font. One preloader per owner of the fonts, which must outlive it.
+class GlyphPreloader {
+public:
+    void setFence(std::function<void()> fence) { fence_ = std::move(fence); }
+
+    void preload(const sf::Font& font, unsigned characterSize, bool bold, std::u32string_view text);
+    void preload(const sf::Text& text);
+
+private:
+    struct Page {
+        const sf::Font* font;
+        unsigned characterSize;
+        bool bold;
+        std::unordered_set<char32_t> loaded;
+    };
+
+    std::vector<Page> pages_;
+    std::vector<char32_t> missing_; // Scratch
+    std::function<void()> fence_;
+};
+
+// Triple buffer between the simulation thread (records into back(), then
+// publish()) and the render thread (acquire(), replay, release()). publish()
+// waits while the previous list has not been picked up, so the simulation is
+// never more than one frame ahead of what is on screen.
+class RenderQueue {
+public:
+    // Simulation thread
+    RenderCommandList& back() { return lists_[back_]; }
+    void publish();
+    // Drops the unconsumed list and waits until the render thread holds none.
+    // Call before destroying anything a published list may reference.
+    void drain();
+
+    // Render thread. acquire() blocks until a list is published and returns
+    // nullptr once stop() was called.
+    const RenderCommandList* acquire();
+    void release();
+
+    void stop();
+
+private:
+    static constexpr int None = -1;
+
+    std::array<RenderCommandList, 3> lists_;
+    int back_ = 0;
+    int ready_ = None;
+    int front_ = None;
+    bool stopped_ = false;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+};
@@ -0,0 +1,176 @@
+// src/save_codec.cpp
+#include "save_codec.hpp"
+
+#include <algorithm>
+#include <limits>
+
+void encodeVarint(ByteBuffer& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool decodeVarint(const ByteBuffer& in, std::size_t& pos, std::uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) {
+            return false;
+        }
+        const std::uint8_t byte = in[pos++];
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false; // Mais de 10 bytes: dado corrompido
+}
+
+void writeLE(ByteBuffer& out, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+std::uint64_t readLE(const std::uint8_t* in, std::size_t bytes) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+std::uint64_t zigzagEncode(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t zigzagDecode(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+ByteBuffer encodeVarintArray(const std::vector<int>& values) {
+    ByteBuffer out;
+    out.reserve(values.size() + 1);
+    encodeVarint(out, values.size());
+    for (int v : values) {
+        encodeVarint(out, zigzagEncode(v));
+    }
+    return out;
+}
+
+bool decodeVarintArray(const ByteBuffer& in, std::vector<int>& values) {
+    std::size_t pos = 0;
+    std::uint64_t count = 0;
+    if (!decodeVarint(in, pos, count) || count > in.size()) {
+        return false;
+    }
+    values.clear();
+    values.reserve(static_cast<std::size_t>(count));
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t raw = 0;
+        if (!decodeVarint(in, pos, raw)) {
+            return false;
+        }
+        values.push_back(static_cast<int>(zigzagDecode(raw)));
+    }
+    return pos == in.size();
+}
+
+ByteBuffer packSwitchBits(const std::unordered_map<int, bool>& switches) {
+    std::vector<int> onIds;
+    for (const auto& [id, value] : switches) {
+        if (value) {
+            onIds.push_back(id);
+        }
+    }
+    return packSwitchIds(onIds);
+}
+
+ByteBuffer packSwitchIds(const std::vector<int>& onIds) {
+    int maxId = -1;
+    for (int id : onIds) {
+        maxId = std::max(maxId, id);
+    }
+    if (maxId < 0) {
+        return {};
+    }
+
+    ByteBuffer bits(static_cast<std::size_t>(maxId / 8 + 1), 0);
+    for (int id : onIds) {
+        if (id >= 0) {
+            bits[static_cast<std::size_t>(id) / 8] |= static_cast<std::uint8_t>(1u << (id % 8));
+        }
+    }
+    return bits;
+}
+
+std::unordered_map<int, bool> unpackSwitchBits(const ByteBuffer& bits) {
+    std::unordered_map<int, bool> switches;
+    for (std::size_t byte = 0; byte < bits.size(); ++byte) {
+        if (bits[byte] == 0) {
+            continue;
+        }
+        for (int bit = 0; bit < 8; ++bit) {
+            if (bits[byte] & (1u << bit)) {
+                switches[static_cast<int>(byte * 8) + bit] = true;
+            }
+        }
+    }
+    return switches;
+}
+
+ByteBuffer packVariables(const std::unordered_map<int, int>& variables) {
+    std::vector<std::pair<int, int>> sorted;
+    sorted.reserve(variables.size());
+    for (const auto& [id, value] : variables) {
+        sorted.emplace_back(id, value);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    return packVariables(sorted);
+}
+
+ByteBuffer packVariables(const std::vector<std::pair<int, int>>& sortedVariables) {
+    std::size_t count = 0;
+    for (const auto& [id, value] : sortedVariables) {
+        if (value != 0 && id >= 0) {
+            ++count;
+        }
+    }
+
+    ByteBuffer out;
+    encodeVarint(out, count);
+    int previousId = 0;
+    for (const auto& [id, value] : sortedVariables) {
+        if (value == 0 || id < 0) {
+            continue;
+        }
+        encodeVarint(out, static_cast<std::uint64_t>(id - previousId));
+        encodeVarint(out, zigzagEncode(value));
+        previousId = id;
+    }
+    return out;
+}
+
+bool unpackVariables(const ByteBuffer& in, std::unordered_map<int, int>& variables) {
+    std::size_t pos = 0;
+    std::uint64_t count = 0;
+    if (!decodeVarint(in, pos, count) || count > in.size()) {
+        return false;
+    }
+    variables.clear();
+    std::int64_t id = 0;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t delta = 0;
+        std::uint64_t raw = 0;
+        if (!decodeVarint(in, pos, delta) || !decodeVarint(in, pos, raw)) {
+            return false;
+        }
+        id += static_cast<std::int64_t>(delta);
+        if (id > std::numeric_limits<int>::max()) {
+            return false;
+        }
+        variables[static_cast<int>(id)] = static_cast<int>(zigzagDecode(raw));
+    }
+    return pos == in.size();
+}
@@ -0,0 +1,43 @@
+// src/save_codec.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Primitivas de codificação compacta usadas pelo formato binário de save.
+// Todas as funções de leitura avançam `pos` e retornam false se os dados
+// estiverem truncados ou corrompidos.
+
+using ByteBuffer = std::vector<std::uint8_t>;
+
+// Inteiros sem sinal em LEB128 (7 bits por byte).
+void encodeVarint(ByteBuffer& out, std::uint64_t value);
+bool decodeVarint(const ByteBuffer& in, std::size_t& pos, std::uint64_t& value);
+
+// Inteiros little-endian de tamanho fixo (1 a 8 bytes), usados no cabeçalho.
+void writeLE(ByteBuffer& out, std::uint64_t value, std::size_t bytes);
+std::uint64_t readLE(const std::uint8_t* in, std::size_t bytes);
+
+// Zigzag mapeia inteiros com sinal para sem sinal (0,-1,1,-2 -> 0,1,2,3).
+std::uint64_t zigzagEncode(std::int64_t value);
+std::int64_t zigzagDecode(std::uint64_t value);
+
+// Listas de inteiros (party, inventário) como varints com sinal.
+ByteBuffer encodeVarintArray(const std::vector<int>& values);
+bool decodeVarintArray(const ByteBuffer& in, std::vector<int>& values);
+
+// Switches: apenas os que estão ON viram bits (OFF é o padrão).
+// O bit N corresponde ao switch de ID N.
+ByteBuffer packSwitchBits(const std::unordered_map<int, bool>& switches);
+ByteBuffer packSwitchIds(const std::vector<int>& onIds);
+std::unordered_map<int, bool> unpackSwitchBits(const ByteBuffer& bits);
+
+// Variáveis: apenas as diferentes de zero, como pares (delta de ID, valor).
+// Os IDs são ordenados para que os deltas fiquem pequenos.
+ByteBuffer packVariables(const std::unordered_map<int, int>& variables);
+// Variante já ordenada por ID (ex.: GameState::forEachVariable)
+ByteBuffer packVariables(const std::vector<std::pair<int, int>>& sortedVariables);
+bool unpackVariables(const ByteBuffer& in, std::unordered_map<int, int>& variables);
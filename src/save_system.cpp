@@ -1,16 +1,264 @@
 // src/save_system.cpp
 #include "save_system.hpp"
+#include "save_codec.hpp"
+#include "profiler.hpp"
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
 
 using json = nlohmann::json;
 
-SaveSystem::SaveSystem() {
+namespace {
+
+constexpr std::uint8_t SaveMagic[4] = {'L', 'S', 'A', 'V'};
+constexpr std::size_t VersionOffset = 4; // u16 LE, presente em todas as versões binárias
+constexpr std::size_t V2HeaderSize = 6;  // v2: magic + versão, CBOR logo em seguida
+
+// Cabeçalho fixo (v3+), little-endian, lido em uma única leitura pelo listSlots():
+//   0 magic[4] | 4 versão u16 | 6 tamanho do cabeçalho u16 | 8 timestamp i64
+//  16 playtime u32 | 20 mapId i32 | 24 level i32 | 28 party count u8 + 3 reservados
+//  32 party i32[4] | 48 nome do mapa char[32] | 80 tamanho da miniatura u32
+//  84 offset do documento CBOR u32 | 88 reservado até 96
+constexpr std::size_t SaveHeaderSize = 96;
+constexpr std::size_t MapNameOffset = 48;
+constexpr std::size_t MapNameBytes = 32;
+constexpr std::size_t ThumbnailSizeOffset = 80;
+constexpr std::size_t PayloadOffsetOffset = 84;
+
+json binaryField(const ByteBuffer& bytes) {
+    return json::binary(bytes);
+}
+
+// Documento v2: chaves curtas e apenas o que difere dos padrões.
+//   sw = bitset de switches ON, va = pares varint (ID delta, valor),
+//   p  = campos do jogador diferentes de PlayerSaveData + party/inventário em varint.
+json migrateV1ToV2(const json& v1) {
+    json v2 = json::object();
+    if (v1.contains("timestamp")) {
+        v2["t"] = v1["timestamp"];
+    }
+    
+    if (v1.contains("switches") && v1["switches"].is_object()) {
+        std::unordered_map<int, bool> switches;
+        for (const auto& [key, value] : v1["switches"].items()) {
+            switches[std::stoi(key)] = value.get<bool>();
+        }
+        ByteBuffer bits = packSwitchBits(switches);
+        if (!bits.empty()) {
+            v2["sw"] = binaryField(bits);
+        }
+    }
+    
+    if (v1.contains("variables") && v1["variables"].is_object()) {
+        std::unordered_map<int, int> variables;
+        for (const auto& [key, value] : v1["variables"].items()) {
+            variables[std::stoi(key)] = value.get<int>();
+        }
+        if (!variables.empty()) {
+            v2["va"] = binaryField(packVariables(variables));
+        }
+    }
+    
+    if (v1.contains("player") && v1["player"].is_object()) {
+        const json& playerJson = v1["player"];
+        json p = json::object();
+        const std::pair<const char*, const char*> renames[] = {
+            {"mapId", "m"}, {"x", "x"}, {"y", "y"}, {"direction", "d"},
+            {"level", "l"}, {"exp", "e"}, {"gold", "g"}};
+        for (const auto& [from, to] : renames) {
+            if (playerJson.contains(from)) {
+                p[to] = playerJson[from];
+            }
+        }
+        if (playerJson.contains("party")) {
+            p["pa"] = binaryField(encodeVarintArray(playerJson["party"].get<std::vector<int>>()));
+        }
+        if (playerJson.contains("inventory")) {
+            p["in"] = binaryField(encodeVarintArray(playerJson["inventory"].get<std::vector<int>>()));
+        }
+        v2["p"] = p;
+    }
+    
+    return v2;
+}
+
+// Migrações encadeadas: Migrations[n] converte um documento da versão n+1 para n+2.
+using SaveMigration = json (*)(const json&);
+// v3 só acrescenta campos opcionais ("mn", "pt") e o cabeçalho fixo do arquivo
+json migrateV2ToV3(const json& v2) {
+    return v2;
+}
+
+// v4 acrescenta self switches opcionais ("ss")
+json migrateV3ToV4(const json& v3) {
+    return v3;
+}
+
+constexpr SaveMigration Migrations[] = {migrateV1ToV2, migrateV2ToV3, migrateV3ToV4};
+
+bool migrateToCurrent(json& document, int version) {
+    if (version < 1 || version > SaveSystem::SchemaVersion) {
+        std::cerr << "[SaveSystem] Versão do save não suportada: " << version << "\n";
+        return false;
+    }
+    for (; version < SaveSystem::SchemaVersion; ++version) {
+        document = Migrations[version - 1](document);
+        std::cout << "[SaveSystem] Save migrado da versão " << version << " para " << version + 1 << "\n";
+    }
+    return true;
+}
+
+bool hasSaveMagic(const std::uint8_t* data, std::size_t size) {
+    return size >= V2HeaderSize && std::equal(std::begin(SaveMagic), std::end(SaveMagic), data);
+}
+
+// Preenche `info` a partir do cabeçalho fixo; falha para arquivos v2 (sem cabeçalho).
+bool parseSlotHeader(const std::uint8_t* data, std::size_t size, SaveSlotInfo& info,
+                     std::size_t& headerSize, std::size_t& payloadOffset) {
+    if (!hasSaveMagic(data, size) || size < SaveHeaderSize) {
+        return false;
+    }
+    const auto version = static_cast<int>(readLE(data + VersionOffset, 2));
+    if (version < 3) {
+        return false;
+    }
+    headerSize = static_cast<std::size_t>(readLE(data + 6, 2));
+    if (headerSize < SaveHeaderSize) {
+        return false;
+    }
+
+    info.timestamp = static_cast<std::int64_t>(readLE(data + 8, 8));
+    info.playtimeSeconds = static_cast<std::uint32_t>(readLE(data + 16, 4));
+    info.mapId = static_cast<std::int32_t>(readLE(data + 20, 4));
+    info.level = static_cast<std::int32_t>(readLE(data + 24, 4));
+    const std::size_t partyCount = std::min<std::size_t>(data[28], SaveSlotInfo::MaxPartySummary);
+    info.party.clear();
+    for (std::size_t i = 0; i < partyCount; ++i) {
+        info.party.push_back(static_cast<std::int32_t>(readLE(data + 32 + i * 4, 4)));
+    }
+    const char* name = reinterpret_cast<const char*>(data + MapNameOffset);
+    info.mapName.assign(name, std::find(name, name + MapNameBytes, '\0'));
+    info.thumbnailSize = static_cast<std::uint32_t>(readLE(data + ThumbnailSizeOffset, 4));
+    payloadOffset = static_cast<std::size_t>(readLE(data + PayloadOffsetOffset, 4));
+    info.legacy = false;
+    return true;
+}
+
+// Monta o cabeçalho fixo descrito acima no início de `data` (que deve estar vazio).
+void writeSlotHeader(std::vector<std::uint8_t>& data, const PlayerSaveData& player,
+                     std::int64_t timestamp, std::size_t thumbnailSize) {
+    data.insert(data.end(), std::begin(SaveMagic), std::end(SaveMagic));
+    writeLE(data, SaveSystem::SchemaVersion, 2);
+    writeLE(data, SaveHeaderSize, 2);
+    writeLE(data, static_cast<std::uint64_t>(timestamp), 8);
+    writeLE(data, static_cast<std::uint32_t>(player.playtimeSeconds), 4);
+    writeLE(data, static_cast<std::uint32_t>(player.mapId), 4);
+    writeLE(data, static_cast<std::uint32_t>(player.level), 4);
+    const std::size_t partyCount = std::min(player.party.size(), SaveSlotInfo::MaxPartySummary);
+    writeLE(data, partyCount, 4); // count (u8) + 3 bytes reservados
+    for (std::size_t i = 0; i < SaveSlotInfo::MaxPartySummary; ++i) {
+        writeLE(data, i < partyCount ? static_cast<std::uint32_t>(player.party[i]) : 0u, 4);
+    }
+    const std::size_t nameLength = std::min(player.mapName.size(), MapNameBytes - 1);
+    data.insert(data.end(), player.mapName.begin(), player.mapName.begin() + static_cast<std::ptrdiff_t>(nameLength));
+    data.resize(MapNameOffset + MapNameBytes, 0);
+    writeLE(data, thumbnailSize, 4);
+    writeLE(data, SaveHeaderSize + thumbnailSize, 4);
+    data.resize(SaveHeaderSize, 0);
+}
+
+// Journal incremental (saveN.ljnl). Cada registro:
+//   tipo u8 | tamanho varint | payload | checksum u8 (soma de tipo + payload)
+// A reprodução para no primeiro registro truncado ou inválido (escrita interrompida).
+constexpr std::uint8_t JournalMagic[4] = {'L', 'J', 'N', 'L'};
+constexpr std::size_t JournalHeaderSize = sizeof(JournalMagic) + 2 + 4;
+constexpr int JournalVersion = 1;
+
+enum class JournalRecord : std::uint8_t {
+    Switch = 1,    // id zigzag, valor u8
+    Variable = 2,  // id zigzag, valor zigzag
+    Position = 3,  // mapId zigzag, x f32, y f32, direção u8
+    Stats = 4,     // level, exp, gold (zigzag)
+    Party = 5,     // array varint
+    Inventory = 6, // array varint
+    Meta = 7,      // playtime f64, nome do mapa (resto do payload)
+    SelfSwitch = 8 // mapId zigzag, evento zigzag, máscara A-D u8
+};
+
+void writeFloatBits(ByteBuffer& out, float value) {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeLE(out, bits, 4);
+}
+
+float readFloatBits(const std::uint8_t* in) {
+    const auto bits = static_cast<std::uint32_t>(readLE(in, 4));
+    float value = 0.f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::uint8_t journalChecksum(std::uint8_t type, const ByteBuffer& payload) {
+    unsigned sum = type;
+    for (std::uint8_t byte : payload) {
+        sum += byte;
+    }
+    return static_cast<std::uint8_t>(sum & 0xFF);
+}
+
+bool readZigzag(const ByteBuffer& in, std::size_t& pos, int& value) {
+    std::uint64_t raw = 0;
+    if (!decodeVarint(in, pos, raw)) {
+        return false;
+    }
+    value = static_cast<int>(zigzagDecode(raw));
+    return true;
+}
+
+bool writeFileAtomically(const std::string& filePath, const ByteBuffer& data) {
+    const std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, filePath, ec);
+    return !ec;
+}
+
+} // namespace
+
+SaveSystem::SaveSystem()
+    : ownedGameState(std::make_unique<GameState>()), gameState(ownedGameState.get()) {
+    gameState->setChangeListener([this](const GameState::ChangeEvent& event) { onStateChanged(event); });
     resetToDefaults();
 }
 
+SaveSystem::SaveSystem(GameState& state) : gameState(&state) {
+    // Estado compartilhado: não zera o que o jogo já tem, só o journal
+    gameState->setChangeListener([this](const GameState::ChangeEvent& event) { onStateChanged(event); });
+    resetJournal();
+}
+
+SaveSystem::~SaveSystem() {
+    gameState->setChangeListener(nullptr);
+}
+
 bool SaveSystem::initialize(const std::string& gameDirectory) {
     saveDirectory = gameDirectory + "/saves";
     
@@ -24,83 +272,132 @@ bool SaveSystem::initialize(const std::string& gameDirectory) {
 }
 
 void SaveSystem::setSwitch(int id, bool value) {
-    globalSwitches[id] = value;
+    gameState->setSwitch(id, value);
     std::cout << "[SaveSystem] Switch global " << id << " = " << (value ? "ON" : "OFF") << "\n";
 }
 
 bool SaveSystem::getSwitch(int id) const {
-    auto it = globalSwitches.find(id);
-    return it != globalSwitches.end() ? it->second : false;
+    return gameState->getSwitch(id);
 }
 
 void SaveSystem::setVariable(int id, int value) {
-    globalVariables[id] = value;
+    gameState->setVariable(id, value);
     std::cout << "[SaveSystem] Variável global " << id << " = " << value << "\n";
 }
 
 int SaveSystem::getVariable(int id) const {
-    auto it = globalVariables.find(id);
-    return it != globalVariables.end() ? it->second : 0;
+    return gameState->getVariable(id);
 }
 
 void SaveSystem::setPlayerPosition(int mapId, float x, float y, int direction) {
-    playerData.mapId = mapId;
-    playerData.x = x;
-    playerData.y = y;
-    playerData.direction = direction;
+    gameState->setPosition(mapId, x, y, direction);
 }
 
 void SaveSystem::getPlayerPosition(int& mapId, float& x, float& y, int& direction) const {
-    mapId = playerData.mapId;
-    x = playerData.x;
-    y = playerData.y;
-    direction = playerData.direction;
+    const PlayerSaveData& player = gameState->player();
+    mapId = player.mapId;
+    x = player.x;
+    y = player.y;
+    direction = player.direction;
 }
 
 void SaveSystem::setPlayerStats(int level, int exp, int gold) {
-    playerData.level = level;
-    playerData.exp = exp;
-    playerData.gold = gold;
+    gameState->setStats(level, exp, gold);
 }
 
 void SaveSystem::getPlayerStats(int& level, int& exp, int& gold) const {
-    level = playerData.level;
-    exp = playerData.exp;
-    gold = playerData.gold;
+    const PlayerSaveData& player = gameState->player();
+    level = player.level;
+    exp = player.exp;
+    gold = player.gold;
 }
 
 void SaveSystem::setParty(const std::vector<int>& party) {
-    playerData.party = party;
+    gameState->setParty(party);
 }
 
 std::vector<int> SaveSystem::getParty() const {
-    return playerData.party;
+    return gameState->player().party;
 }
 
 void SaveSystem::setInventory(const std::vector<int>& inventory) {
-    playerData.inventory = inventory;
+    gameState->setInventory(inventory);
 }
 
 std::vector<int> SaveSystem::getInventory() const {
-    return playerData.inventory;
+    return gameState->player().inventory;
 }
 
-bool SaveSystem::saveGame(int slotId) const {
+void SaveSystem::setMapName(const std::string& mapName) {
+    gameState->setMapName(mapName);
+}
+
+void SaveSystem::addPlaytime(float deltaTime) {
+    gameState->addPlaytime(deltaTime);
+}
+
+double SaveSystem::getPlaytime() const {
+    return gameState->player().playtimeSeconds;
+}
+
+void SaveSystem::setThumbnail(std::vector<std::uint8_t> encodedImage) {
+    thumbnail = std::move(encodedImage);
+}
+
+std::vector<std::uint8_t> SaveSystem::loadThumbnail(int slotId) const {
+    SaveSlotInfo info;
+    std::vector<std::uint8_t> image;
+    if (!readSlotHeader(slotId, info) || info.legacy || info.thumbnailSize == 0) {
+        return image;
+    }
+
+    std::ifstream file(getSaveFilePath(slotId), std::ios::binary);
+    std::uint8_t header[SaveHeaderSize];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return image;
+    }
+    // O cabeçalho pode crescer em versões futuras: a miniatura começa logo após ele
+    file.seekg(static_cast<std::streamoff>(readLE(header + 6, 2)));
+    image.resize(info.thumbnailSize);
+    if (!file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()))) {
+        image.clear();
+    }
+    return image;
+}
+
+bool SaveSystem::saveGame(int slotId) {
+    LUMY_PROFILE_SCOPE("SaveSystem::saveGame");
     std::string filePath = getSaveFilePath(slotId);
     
     try {
-        std::string jsonData = serializeToJson();
+        // Nova geração: um journal antigo que sobreviva a uma queda entre as
+        // duas escritas abaixo não casa com o snapshot novo e é ignorado.
+        journalGeneration = std::random_device{}();
+        const std::vector<std::uint8_t> data = serializeToBinary();
         
-        std::ofstream file(filePath);
-        if (!file.is_open()) {
+        if (!writeFileAtomically(filePath, data)) {
             std::cerr << "[SaveSystem] Erro: não foi possível abrir arquivo para escrita: " << filePath << "\n";
+            journalSlot = -1;
             return false;
         }
         
-        file << jsonData;
-        file.close();
+        // Compacta: o snapshot já contém tudo, o journal recomeça vazio
+        ByteBuffer journalHeader(std::begin(JournalMagic), std::end(JournalMagic));
+        writeLE(journalHeader, JournalVersion, 2);
+        writeLE(journalHeader, journalGeneration, 4);
+        pendingJournal.clear();
+        if (writeFileAtomically(getJournalFilePath(slotId), journalHeader)) {
+            journalSlot = slotId;
+        } else {
+            // O journal antigo ficou com a geração anterior: anexar a ele
+            // produziria registros que o replay descarta. O próximo autosave
+            // grava um snapshot completo.
+            std::cerr << "[SaveSystem] Aviso: não foi possível reiniciar o journal do slot " << slotId << "\n";
+            journalSlot = -1;
+        }
         
-        std::cout << "[SaveSystem] Jogo salvo no slot " << slotId << ": " << filePath << "\n";
+        std::cout << "[SaveSystem] Jogo salvo no slot " << slotId << ": " << filePath
+                  << " (" << data.size() << " bytes)\n";
         return true;
         
     } catch (const std::exception& e) {
@@ -109,8 +406,59 @@ bool SaveSystem::saveGame(int slotId) const {
     }
 }
 
+bool SaveSystem::autosave(int slotId) {
+    LUMY_PROFILE_SCOPE("SaveSystem::autosave");
+    if (slotId != journalSlot || !std::filesystem::exists(getSaveFilePath(slotId))) {
+        return saveGame(slotId);
+    }
+    
+    std::error_code ec;
+    const std::string journalPath = getJournalFilePath(slotId);
+    const auto journalSize = std::filesystem::file_size(journalPath, ec);
+    if (ec || journalSize < JournalHeaderSize || journalSize + pendingJournal.size() > JournalCompactBytes) {
+        return saveGame(slotId);
+    }
+    
+    // Tempo de jogo e mapa mudam todo frame: vão num único registro por autosave
+    ByteBuffer meta;
+    std::uint64_t playtimeBits = 0;
+    const PlayerSaveData& player = gameState->player();
+    std::memcpy(&playtimeBits, &player.playtimeSeconds, sizeof(playtimeBits));
+    writeLE(meta, playtimeBits, 8);
+    meta.insert(meta.end(), player.mapName.begin(), player.mapName.end());
+    if (!appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Meta), meta)) {
+        // O journal foi descartado ao passar do limite: só um snapshot guarda as mudanças
+        return saveGame(slotId);
+    }
+    
+    std::ofstream file(journalPath, std::ios::binary | std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "[SaveSystem] Erro: não foi possível abrir journal: " << journalPath << "\n";
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(pendingJournal.data()),
+               static_cast<std::streamsize>(pendingJournal.size()));
+    file.close();
+    if (!file) {
+        std::cerr << "[SaveSystem] Erro ao anexar ao journal: " << journalPath << "\n";
+        return false;
+    }
+    
+    std::cout << "[SaveSystem] Autosave incremental no slot " << slotId << " (+"
+              << pendingJournal.size() << " bytes)\n";
+    pendingJournal.clear();
+    rewriteSlotHeader(slotId);
+    return true;
+}
+
 bool SaveSystem::loadGame(int slotId) {
+    LUMY_PROFILE_SCOPE("SaveSystem::loadGame");
     std::string filePath = getSaveFilePath(slotId);
+    const bool binary = std::filesystem::exists(filePath);
+    if (!binary) {
+        // Saves antigos (JSON 1.0) continuam legíveis e são migrados ao carregar
+        filePath = getLegacySaveFilePath(slotId);
+    }
     
     if (!std::filesystem::exists(filePath)) {
         std::cerr << "[SaveSystem] Arquivo de save não encontrado: " << filePath << "\n";
@@ -118,20 +466,26 @@ bool SaveSystem::loadGame(int slotId) {
     }
     
     try {
-        std::ifstream file(filePath);
+        std::ifstream file(filePath, std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "[SaveSystem] Erro: não foi possível abrir arquivo para leitura: " << filePath << "\n";
             return false;
         }
         
-        std::string jsonData;
-        std::string line;
-        while (std::getline(file, line)) {
-            jsonData += line + "\n";
-        }
+        std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                       std::istreambuf_iterator<char>());
         file.close();
         
-        if (deserializeFromJson(jsonData)) {
+        const bool ok = binary
+            ? deserializeFromBinary(data)
+            : deserializeFromJson(std::string(data.begin(), data.end()));
+        
+        if (ok) {
+            pendingJournal.clear();
+            journalSlot = binary ? slotId : -1;
+            if (binary) {
+                replayJournal(slotId);
+            }
             std::cout << "[SaveSystem] Jogo carregado do slot " << slotId << ": " << filePath << "\n";
             return true;
         } else {
@@ -146,20 +500,22 @@ bool SaveSystem::loadGame(int slotId) {
 }
 
 bool SaveSystem::saveExists(int slotId) const {
-    std::string filePath = getSaveFilePath(slotId);
-    return std::filesystem::exists(filePath);
+    return std::filesystem::exists(getSaveFilePath(slotId)) ||
+           std::filesystem::exists(getLegacySaveFilePath(slotId));
 }
 
 bool SaveSystem::deleteSave(int slotId) {
-    std::string filePath = getSaveFilePath(slotId);
-    
-    if (!std::filesystem::exists(filePath)) {
+    if (!saveExists(slotId)) {
         return true; // Já não existe
     }
     
     try {
-        std::filesystem::remove(filePath);
-        std::cout << "[SaveSystem] Save removido: " << filePath << "\n";
+        for (const std::string& filePath : {getSaveFilePath(slotId), getLegacySaveFilePath(slotId),
+                                            getJournalFilePath(slotId)}) {
+            if (std::filesystem::remove(filePath)) {
+                std::cout << "[SaveSystem] Save removido: " << filePath << "\n";
+            }
+        }
         return true;
     } catch (const std::exception& e) {
         std::cerr << "[SaveSystem] Erro ao remover save: " << e.what() << "\n";
@@ -168,32 +524,110 @@ bool SaveSystem::deleteSave(int slotId) {
 }
 
 void SaveSystem::resetToDefaults() {
-    globalSwitches.clear();
-    globalVariables.clear();
-    
-    playerData = PlayerSaveData();
-    playerData.party.push_back(1); // Hero por padrão
+    replaying = true;
+    gameState->reset();
+    replaying = false;
+    thumbnail.clear();
+    resetJournal();
     
     std::cout << "[SaveSystem] Dados resetados para padrões\n";
 }
 
 std::vector<int> SaveSystem::getAvailableSaveSlots() const {
-    std::vector<int> slots;
+    std::set<int> slots;
+    
+    // Uma listagem do diretório em vez de testar a existência de cada slot
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(saveDirectory, ec)) {
+        const std::string stem = entry.path().stem().string();
+        const std::string ext = entry.path().extension().string();
+        if (stem.rfind("save", 0) != 0 || (ext != ".lsav" && ext != ".json")) {
+            continue;
+        }
+        const std::string digits = stem.substr(4);
+        if (digits.empty() || digits.size() > 2 ||
+            !std::all_of(digits.begin(), digits.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            continue;
+        }
+        const int slotId = std::stoi(digits);
+        if (slotId >= AutosaveSlot && slotId <= MaxSaveSlots) {
+            slots.insert(slotId);
+        }
+    }
+    
+    return {slots.begin(), slots.end()};
+}
+
+std::vector<SaveSlotInfo> SaveSystem::listSlots() const {
+    LUMY_PROFILE_SCOPE("SaveSystem::listSlots");
+    std::vector<SaveSlotInfo> result;
+    for (int slotId : getAvailableSaveSlots()) {
+        SaveSlotInfo info;
+        if (readSlotHeader(slotId, info)) {
+            result.push_back(std::move(info));
+        }
+    }
+    return result;
+}
+
+bool SaveSystem::readSlotHeader(int slotId, SaveSlotInfo& info) const {
+    info = SaveSlotInfo();
+    info.slotId = slotId;
     
-    for (int i = 1; i <= 10; ++i) { // Até 10 slots
-        if (saveExists(i)) {
-            slots.push_back(i);
+    std::ifstream file(getSaveFilePath(slotId), std::ios::binary);
+    if (file.is_open()) {
+        std::uint8_t header[SaveHeaderSize];
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        std::size_t headerSize = 0;
+        std::size_t payloadOffset = 0;
+        if (parseSlotHeader(header, static_cast<std::size_t>(file.gcount()), info, headerSize, payloadOffset)) {
+            return true;
         }
     }
     
-    return slots;
+    // Saves JSON 1.0 ou binários v2 não têm cabeçalho: exige carregar o save inteiro
+    SaveSystem probe;
+    probe.saveDirectory = saveDirectory;
+    if (!probe.loadGame(slotId)) {
+        return false;
+    }
+    const PlayerSaveData& player = probe.gameState->player();
+    info.legacy = true;
+    info.mapId = player.mapId;
+    info.mapName = player.mapName;
+    info.level = player.level;
+    info.playtimeSeconds = static_cast<std::uint32_t>(player.playtimeSeconds);
+    info.party.assign(player.party.begin(),
+                      player.party.begin() + std::min(player.party.size(), SaveSlotInfo::MaxPartySummary));
+    std::error_code ec;
+    const auto path = std::filesystem::exists(getSaveFilePath(slotId)) ? getSaveFilePath(slotId)
+                                                                        : getLegacySaveFilePath(slotId);
+    const auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (!ec) {
+        // file_clock -> system_clock sem clock_cast (ainda ausente em alguns compiladores)
+        const auto systemTime = std::chrono::system_clock::now() +
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                writeTime - std::filesystem::file_time_type::clock::now());
+        info.timestamp = std::chrono::duration_cast<std::chrono::seconds>(systemTime.time_since_epoch()).count();
+    }
+    return true;
 }
 
 std::string SaveSystem::getSaveFilePath(int slotId) const {
+    return saveDirectory + "/save" + std::to_string(slotId) + ".lsav";
+}
+
+std::string SaveSystem::getLegacySaveFilePath(int slotId) const {
     return saveDirectory + "/save" + std::to_string(slotId) + ".json";
 }
 
-std::string SaveSystem::serializeToJson() const {
+std::string SaveSystem::getJournalFilePath(int slotId) const {
+    return saveDirectory + "/save" + std::to_string(slotId) + ".ljnl";
+}
+
+std::string SaveSystem::exportJson() const {
+    const GameState snapshot = gameState->snapshot();
+    const PlayerSaveData& player = snapshot.player();
     json saveData;
     
     // Metadados
@@ -201,36 +635,140 @@ std::string SaveSystem::serializeToJson() const {
     saveData["timestamp"] = std::time(nullptr);
     
     // Switches globais
-    json switchesJson;
-    for (const auto& [id, value] : globalSwitches) {
-        switchesJson[std::to_string(id)] = value;
-    }
+    json switchesJson = json::object();
+    snapshot.forEachSwitch([&switchesJson](int id) { switchesJson[std::to_string(id)] = true; });
     saveData["switches"] = switchesJson;
     
     // Variáveis globais
-    json variablesJson;
-    for (const auto& [id, value] : globalVariables) {
-        variablesJson[std::to_string(id)] = value;
-    }
+    json variablesJson = json::object();
+    snapshot.forEachVariable([&variablesJson](int id, int value) { variablesJson[std::to_string(id)] = value; });
     saveData["variables"] = variablesJson;
     
+    // Self switches ("mapa:evento" -> máscara A-D)
+    json selfSwitchesJson = json::object();
+    snapshot.forEachSelfSwitch([&selfSwitchesJson](int mapId, int eventId, std::uint8_t mask) {
+        selfSwitchesJson[std::to_string(mapId) + ":" + std::to_string(eventId)] = mask;
+    });
+    saveData["selfSwitches"] = selfSwitchesJson;
+    
     // Dados do jogador
     json playerJson;
-    playerJson["mapId"] = playerData.mapId;
-    playerJson["x"] = playerData.x;
-    playerJson["y"] = playerData.y;
-    playerJson["direction"] = playerData.direction;
-    playerJson["level"] = playerData.level;
-    playerJson["exp"] = playerData.exp;
-    playerJson["gold"] = playerData.gold;
-    playerJson["party"] = playerData.party;
-    playerJson["inventory"] = playerData.inventory;
+    playerJson["mapId"] = player.mapId;
+    playerJson["x"] = player.x;
+    playerJson["y"] = player.y;
+    playerJson["direction"] = player.direction;
+    playerJson["level"] = player.level;
+    playerJson["exp"] = player.exp;
+    playerJson["gold"] = player.gold;
+    playerJson["party"] = player.party;
+    playerJson["inventory"] = player.inventory;
+    playerJson["mapName"] = player.mapName;
     
     saveData["player"] = playerJson;
+    saveData["playtime"] = player.playtimeSeconds;
     
     return saveData.dump(4); // Pretty print com indentação de 4 espaços
 }
 
+std::vector<std::uint8_t> SaveSystem::serializeToBinary() const {
+    // Snapshot O(1): o estado vivo pode continuar mudando enquanto serializamos
+    const GameState snapshot = gameState->snapshot();
+    const PlayerSaveData& player = snapshot.player();
+    
+    json document = json::object();
+    document["t"] = std::time(nullptr);
+    
+    std::vector<int> onSwitches;
+    snapshot.forEachSwitch([&onSwitches](int id) { onSwitches.push_back(id); });
+    ByteBuffer bits = packSwitchIds(onSwitches);
+    if (!bits.empty()) {
+        document["sw"] = binaryField(bits);
+    }
+    
+    std::vector<std::pair<int, int>> variables;
+    snapshot.forEachVariable([&variables](int id, int value) { variables.emplace_back(id, value); });
+    if (!variables.empty()) {
+        document["va"] = binaryField(packVariables(variables));
+    }
+    
+    ByteBuffer selfSwitches;
+    std::size_t selfSwitchCount = 0;
+    snapshot.forEachSelfSwitch([&](int mapId, int eventId, std::uint8_t mask) {
+        encodeVarint(selfSwitches, zigzagEncode(mapId));
+        encodeVarint(selfSwitches, zigzagEncode(eventId));
+        selfSwitches.push_back(mask);
+        ++selfSwitchCount;
+    });
+    if (selfSwitchCount > 0) {
+        ByteBuffer ss;
+        encodeVarint(ss, selfSwitchCount);
+        ss.insert(ss.end(), selfSwitches.begin(), selfSwitches.end());
+        document["ss"] = binaryField(ss);
+    }
+    
+    // Delta em relação aos padrões: campos iguais ao padrão não são gravados
+    const PlayerSaveData defaults = GameState::defaultPlayer();
+    json p = json::object();
+    if (player.mapId != defaults.mapId) p["m"] = player.mapId;
+    if (player.x != defaults.x) p["x"] = player.x;
+    if (player.y != defaults.y) p["y"] = player.y;
+    if (player.direction != defaults.direction) p["d"] = player.direction;
+    if (player.level != defaults.level) p["l"] = player.level;
+    if (player.exp != defaults.exp) p["e"] = player.exp;
+    if (player.gold != defaults.gold) p["g"] = player.gold;
+    if (player.party != defaults.party) p["pa"] = binaryField(encodeVarintArray(player.party));
+    if (player.inventory != defaults.inventory) p["in"] = binaryField(encodeVarintArray(player.inventory));
+    if (!player.mapName.empty()) p["mn"] = player.mapName;
+    if (player.playtimeSeconds > 0.0) p["pt"] = player.playtimeSeconds;
+    if (!p.empty()) {
+        document["p"] = p;
+    }
+    document["jg"] = journalGeneration;
+    
+    // Cabeçalho fixo: tudo o que a lista de slots precisa, sem decodificar o CBOR
+    std::vector<std::uint8_t> data;
+    data.reserve(SaveHeaderSize + thumbnail.size() + 64);
+    writeSlotHeader(data, player, document["t"].get<std::int64_t>(), thumbnail.size());
+    
+    data.insert(data.end(), thumbnail.begin(), thumbnail.end());
+    json::to_cbor(document, data);
+    return data;
+}
+
+bool SaveSystem::deserializeFromBinary(const std::vector<std::uint8_t>& data) {
+    if (!hasSaveMagic(data.data(), data.size())) {
+        std::cerr << "[SaveSystem] Arquivo de save inválido (cabeçalho)\n";
+        return false;
+    }
+    
+    const auto version = static_cast<int>(readLE(data.data() + VersionOffset, 2));
+    std::size_t payloadOffset = V2HeaderSize;
+    std::vector<std::uint8_t> storedThumbnail;
+    if (version >= 3) {
+        SaveSlotInfo info;
+        std::size_t headerSize = 0;
+        if (!parseSlotHeader(data.data(), data.size(), info, headerSize, payloadOffset) ||
+            payloadOffset > data.size() || headerSize + info.thumbnailSize > payloadOffset) {
+            std::cerr << "[SaveSystem] Arquivo de save inválido (cabeçalho)\n";
+            return false;
+        }
+        storedThumbnail.assign(data.begin() + static_cast<std::ptrdiff_t>(headerSize),
+                               data.begin() + static_cast<std::ptrdiff_t>(headerSize + info.thumbnailSize));
+    }
+    
+    try {
+        json document = json::from_cbor(data.begin() + static_cast<std::ptrdiff_t>(payloadOffset), data.end());
+        if (!migrateToCurrent(document, version) || !applySaveDocument(document)) {
+            return false;
+        }
+        thumbnail = std::move(storedThumbnail);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[SaveSystem] Erro ao decodificar CBOR: " << e.what() << "\n";
+        return false;
+    }
+}
+
 bool SaveSystem::deserializeFromJson(const std::string& jsonData) {
     try {
         json saveData = json::parse(jsonData);
@@ -247,51 +785,277 @@ bool SaveSystem::deserializeFromJson(const std::string& jsonData) {
             return false;
         }
         
-        // Carregar switches
-        if (saveData.contains("switches")) {
-            globalSwitches.clear();
-            for (const auto& [key, value] : saveData["switches"].items()) {
-                int id = std::stoi(key);
-                globalSwitches[id] = value.get<bool>();
-            }
+        if (!migrateToCurrent(saveData, 1)) {
+            return false;
         }
+        return applySaveDocument(saveData);
         
-        // Carregar variáveis
-        if (saveData.contains("variables")) {
-            globalVariables.clear();
-            for (const auto& [key, value] : saveData["variables"].items()) {
-                int id = std::stoi(key);
-                globalVariables[id] = value.get<int>();
-            }
+    } catch (const std::exception& e) {
+        std::cerr << "[SaveSystem] Erro ao fazer parse do JSON: " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool SaveSystem::applySaveDocument(const json& document) {
+    // Monta um GameState separado e só o publica depois de validar tudo
+    GameState loaded;
+    PlayerSaveData player = GameState::defaultPlayer();
+    
+    if (document.contains("sw")) {
+        for (const auto& [id, value] : unpackSwitchBits(document["sw"].get_binary())) {
+            loaded.setSwitch(id, value);
         }
-        
-        // Carregar dados do jogador
-        if (saveData.contains("player")) {
-            const json& playerJson = saveData["player"];
-            
-            if (playerJson.contains("mapId")) playerData.mapId = playerJson["mapId"];
-            if (playerJson.contains("x")) playerData.x = playerJson["x"];
-            if (playerJson.contains("y")) playerData.y = playerJson["y"];
-            if (playerJson.contains("direction")) playerData.direction = playerJson["direction"];
-            if (playerJson.contains("level")) playerData.level = playerJson["level"];
-            if (playerJson.contains("exp")) playerData.exp = playerJson["exp"];
-            if (playerJson.contains("gold")) playerData.gold = playerJson["gold"];
-            
-            if (playerJson.contains("party")) {
-                playerData.party = playerJson["party"].get<std::vector<int>>();
-            }
-            
-            if (playerJson.contains("inventory")) {
-                playerData.inventory = playerJson["inventory"].get<std::vector<int>>();
+    }
+    if (document.contains("va")) {
+        std::unordered_map<int, int> variables;
+        if (!unpackVariables(document["va"].get_binary(), variables)) {
+            std::cerr << "[SaveSystem] Variáveis corrompidas no save\n";
+            return false;
+        }
+        for (const auto& [id, value] : variables) {
+            loaded.setVariable(id, value);
+        }
+    }
+    if (document.contains("ss")) {
+        const ByteBuffer& ss = document["ss"].get_binary();
+        std::size_t pos = 0;
+        std::uint64_t count = 0;
+        bool ok = decodeVarint(ss, pos, count);
+        for (std::uint64_t i = 0; ok && i < count; ++i) {
+            int mapId = 0;
+            int eventId = 0;
+            ok = readZigzag(ss, pos, mapId) && readZigzag(ss, pos, eventId) && pos < ss.size();
+            if (ok) {
+                loaded.setSelfSwitchMask(mapId, eventId, ss[pos++]);
             }
         }
-        
+        if (!ok || pos != ss.size()) {
+            std::cerr << "[SaveSystem] Self switches corrompidos no save\n";
+            return false;
+        }
+    }
+    
+    if (document.contains("p")) {
+        const json& p = document["p"];
+        if (p.contains("m")) player.mapId = p["m"];
+        if (p.contains("x")) player.x = p["x"];
+        if (p.contains("y")) player.y = p["y"];
+        if (p.contains("d")) player.direction = p["d"];
+        if (p.contains("l")) player.level = p["l"];
+        if (p.contains("e")) player.exp = p["e"];
+        if (p.contains("g")) player.gold = p["g"];
+        if (p.contains("mn")) player.mapName = p["mn"];
+        if (p.contains("pt")) player.playtimeSeconds = p["pt"];
+        if ((p.contains("pa") && !decodeVarintArray(p["pa"].get_binary(), player.party)) ||
+            (p.contains("in") && !decodeVarintArray(p["in"].get_binary(), player.inventory))) {
+            std::cerr << "[SaveSystem] Party/inventário corrompidos no save\n";
+            return false;
+        }
+    }
+    loaded.setPlayer(player);
+    
+    journalGeneration = document.contains("jg") ? document["jg"].get<std::uint32_t>() : 0;
+    replaying = true;
+    gameState->restore(loaded);
+    replaying = false;
+    return true;
+}
+
+bool SaveSystem::appendJournalRecord(std::uint8_t type, const std::vector<std::uint8_t>& payload) {
+    if (pendingJournal.size() + payload.size() > JournalCompactBytes) {
+        // Mudanças demais sem autosave: o próximo autosave grava um snapshot completo
+        pendingJournal.clear();
+        journalSlot = -1;
+        return false;
+    }
+    pendingJournal.push_back(type);
+    encodeVarint(pendingJournal, payload.size());
+    pendingJournal.insert(pendingJournal.end(), payload.begin(), payload.end());
+    pendingJournal.push_back(journalChecksum(type, payload));
+    return true;
+}
+
+void SaveSystem::onStateChanged(const GameState::ChangeEvent& event) {
+    if (replaying) {
+        return;
+    }
+    
+    const PlayerSaveData& player = gameState->player();
+    ByteBuffer payload;
+    switch (event.type) {
+    case GameState::Change::Switch:
+        encodeVarint(payload, zigzagEncode(event.id));
+        payload.push_back(event.value ? 1 : 0);
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Switch), payload);
+        break;
+    case GameState::Change::Variable:
+        encodeVarint(payload, zigzagEncode(event.id));
+        encodeVarint(payload, zigzagEncode(event.value));
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Variable), payload);
+        break;
+    case GameState::Change::SelfSwitch:
+        encodeVarint(payload, zigzagEncode(event.mapId));
+        encodeVarint(payload, zigzagEncode(event.id));
+        payload.push_back(static_cast<std::uint8_t>(event.value));
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::SelfSwitch), payload);
+        break;
+    case GameState::Change::Position:
+        encodeVarint(payload, zigzagEncode(player.mapId));
+        writeFloatBits(payload, player.x);
+        writeFloatBits(payload, player.y);
+        payload.push_back(static_cast<std::uint8_t>(player.direction));
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Position), payload);
+        break;
+    case GameState::Change::Stats:
+        encodeVarint(payload, zigzagEncode(player.level));
+        encodeVarint(payload, zigzagEncode(player.exp));
+        encodeVarint(payload, zigzagEncode(player.gold));
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Stats), payload);
+        break;
+    case GameState::Change::Party:
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Party), encodeVarintArray(player.party));
+        break;
+    case GameState::Change::Inventory:
+        appendJournalRecord(static_cast<std::uint8_t>(JournalRecord::Inventory), encodeVarintArray(player.inventory));
+        break;
+    case GameState::Change::Reset:
+        // Rollback/restore externo: o journal não descreve mais o estado
+        resetJournal();
+        break;
+    }
+}
+
+void SaveSystem::resetJournal() {
+    pendingJournal.clear();
+    journalSlot = -1;
+}
+
+bool SaveSystem::replayJournal(int slotId) {
+    std::ifstream file(getJournalFilePath(slotId), std::ios::binary);
+    if (!file.is_open()) {
+        return true; // Sem journal: o snapshot é o estado completo
+    }
+    const ByteBuffer data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    
+    if (data.size() < JournalHeaderSize ||
+        !std::equal(std::begin(JournalMagic), std::end(JournalMagic), data.begin()) ||
+        readLE(data.data() + 6, 4) != journalGeneration) {
+        std::cerr << "[SaveSystem] Journal do slot " << slotId << " não corresponde ao snapshot; ignorado\n";
+        journalSlot = -1; // Força snapshot completo no próximo autosave
+        return false;
+    }
+    
+    std::size_t pos = JournalHeaderSize;
+    std::size_t applied = 0;
+    replaying = true;
+    while (pos < data.size()) {
+        const std::uint8_t type = data[pos++];
+        std::uint64_t length = 0;
+        if (!decodeVarint(data, pos, length) || length + 1 > data.size() - pos) {
+            break;
+        }
+        const ByteBuffer payload(data.begin() + static_cast<std::ptrdiff_t>(pos),
+                                 data.begin() + static_cast<std::ptrdiff_t>(pos + length));
+        pos += static_cast<std::size_t>(length);
+        if (data[pos++] != journalChecksum(type, payload) || !applyJournalRecord(type, payload)) {
+            pos = data.size() + 1; // Registro inválido: descarta o restante
+            break;
+        }
+        ++applied;
+    }
+    replaying = false;
+    
+    if (pos != data.size()) {
+        std::cerr << "[SaveSystem] Journal do slot " << slotId << " truncado após " << applied << " registros\n";
+        journalSlot = -1;
+    }
+    if (applied > 0) {
+        std::cout << "[SaveSystem] Journal reproduzido: " << applied << " registros\n";
+    }
+    return pos == data.size();
+}
+
+bool SaveSystem::applyJournalRecord(std::uint8_t type, const std::vector<std::uint8_t>& payload) {
+    std::size_t pos = 0;
+    switch (static_cast<JournalRecord>(type)) {
+    case JournalRecord::Switch: {
+        int id = 0;
+        if (!readZigzag(payload, pos, id) || pos + 1 != payload.size()) return false;
+        gameState->setSwitch(id, payload[pos] != 0);
         return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "[SaveSystem] Erro ao fazer parse do JSON: " << e.what() << "\n";
+    }
+    case JournalRecord::Variable: {
+        int id = 0;
+        int value = 0;
+        if (!readZigzag(payload, pos, id) || !readZigzag(payload, pos, value)) return false;
+        gameState->setVariable(id, value);
+        return pos == payload.size();
+    }
+    case JournalRecord::Position: {
+        int mapId = 0;
+        if (!readZigzag(payload, pos, mapId) || pos + 9 != payload.size()) return false;
+        gameState->setPosition(mapId, readFloatBits(payload.data() + pos),
+                               readFloatBits(payload.data() + pos + 4), payload[pos + 8]);
+        return true;
+    }
+    case JournalRecord::Stats: {
+        int level = 0, exp = 0, gold = 0;
+        if (!readZigzag(payload, pos, level) || !readZigzag(payload, pos, exp) ||
+            !readZigzag(payload, pos, gold)) return false;
+        gameState->setStats(level, exp, gold);
+        return pos == payload.size();
+    }
+    case JournalRecord::Party:
+    case JournalRecord::Inventory: {
+        std::vector<int> values;
+        if (!decodeVarintArray(payload, values)) return false;
+        if (static_cast<JournalRecord>(type) == JournalRecord::Party) {
+            gameState->setParty(values);
+        } else {
+            gameState->setInventory(values);
+        }
+        return true;
+    }
+    case JournalRecord::Meta: {
+        if (payload.size() < 8) return false;
+        const std::uint64_t bits = readLE(payload.data(), 8);
+        double playtime = 0.0;
+        std::memcpy(&playtime, &bits, sizeof(bits));
+        gameState->addPlaytime(playtime - gameState->player().playtimeSeconds);
+        gameState->setMapName(std::string(payload.begin() + 8, payload.end()));
+        return true;
+    }
+    case JournalRecord::SelfSwitch: {
+        int mapId = 0;
+        int eventId = 0;
+        if (!readZigzag(payload, pos, mapId) || !readZigzag(payload, pos, eventId) ||
+            pos + 1 != payload.size()) return false;
+        gameState->setSelfSwitchMask(mapId, eventId, payload[pos]);
+        return true;
+    }
+    }
+    return false;
+}
+
+bool SaveSystem::rewriteSlotHeader(int slotId) const {
+    // Mantém o cabeçalho do .lsav em dia sem reescrever o documento
+    std::fstream file(getSaveFilePath(slotId), std::ios::binary | std::ios::in | std::ios::out);
+    std::uint8_t header[SaveHeaderSize];
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    SaveSlotInfo info;
+    std::size_t headerSize = 0;
+    std::size_t payloadOffset = 0;
+    if (!parseSlotHeader(header, sizeof(header), info, headerSize, payloadOffset) ||
+        headerSize != SaveHeaderSize) {
         return false;
     }
+    ByteBuffer updated;
+    writeSlotHeader(updated, gameState->player(), std::time(nullptr), info.thumbnailSize);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(updated.data()), static_cast<std::streamsize>(updated.size()));
+    return static_cast<bool>(file);
 }
 
 bool SaveSystem::ensureSaveDirectoryExists() const {
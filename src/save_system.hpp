@@ -1,33 +1,52 @@
 // src/save_system.hpp
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
+#include <nlohmann/json_fwd.hpp>
+#include "game_state.hpp"
 
-// Estrutura para salvar dados do jogador
-struct PlayerSaveData {
-    int mapId = 1;
-    float x = 5.0f;
-    float y = 5.0f;
-    int direction = 2; // 0=up, 1=right, 2=down, 3=left
-    int level = 1;
-    int exp = 0;
-    int gold = 0;
-    std::vector<int> party; // IDs dos membros do grupo
-    std::vector<int> inventory; // IDs dos itens no inventário
+// Resumo de um slot lido apenas do cabeçalho fixo do arquivo .lsav
+struct SaveSlotInfo {
+    int slotId = 0;
+    std::int64_t timestamp = 0;
+    std::uint32_t playtimeSeconds = 0;
+    int mapId = 0;
+    std::string mapName;
+    int level = 0;
+    std::vector<int> party; // Até SaveSlotInfo::MaxPartySummary membros
+    std::uint32_t thumbnailSize = 0; // 0 = sem miniatura
+    bool legacy = false; // Save JSON 1.0 (sem cabeçalho; exige parse completo)
+
+    static constexpr std::size_t MaxPartySummary = 4;
 };
 
-// Sistema principal de Save/Load
+// Sistema principal de Save/Load. Lê e escreve no GameState compartilhado;
+// sem GameState externo, usa um próprio.
 class SaveSystem {
 private:
-    std::unordered_map<int, bool> globalSwitches;
-    std::unordered_map<int, int> globalVariables;
-    PlayerSaveData playerData;
+    std::unique_ptr<GameState> ownedGameState;
+    GameState* gameState = nullptr;
+    bool replaying = false; // Escritas de load/replay não entram no journal
+    std::vector<std::uint8_t> thumbnail;
     std::string saveDirectory;
     
+    // Journal: registros pendentes desde a última sincronização com journalSlot
+    std::vector<std::uint8_t> pendingJournal;
+    int journalSlot = -1; // Slot cujo snapshot + journal == estado sincronizado
+    std::uint32_t journalGeneration = 0; // Casa o journal com o snapshot atual
+    
 public:
     SaveSystem();
+    explicit SaveSystem(GameState& state);
+    ~SaveSystem();
+    SaveSystem(const SaveSystem&) = delete;
+    SaveSystem& operator=(const SaveSystem&) = delete;
+    
+    GameState& state() { return *gameState; }
+    const GameState& state() const { return *gameState; }
     
     // Inicialização
     bool initialize(const std::string& gameDirectory);
@@ -53,21 +72,61 @@ public:
     void setInventory(const std::vector<int>& inventory);
     std::vector<int> getInventory() const;
     
+    // Metadados exibidos no menu de load
+    void setMapName(const std::string& mapName);
+    void addPlaytime(float deltaTime);
+    double getPlaytime() const;
+    
+    // Miniatura opcional (ex.: PNG de sf::Image::saveToMemory), gravada após o cabeçalho
+    void setThumbnail(std::vector<std::uint8_t> encodedImage);
+    std::vector<std::uint8_t> loadThumbnail(int slotId) const;
+    
     // Operações de arquivo
-    bool saveGame(int slotId = 1) const;
+    // saveGame grava um snapshot completo e compacta o journal do slot
+    bool saveGame(int slotId = 1);
     bool loadGame(int slotId = 1);
+    // Autosave incremental: anexa ao journal do slot só as mudanças desde a
+    // última sincronização. Cai para saveGame quando não há snapshot base
+    // compatível ou quando o journal passa de JournalCompactBytes.
+    bool autosave(int slotId = AutosaveSlot);
     bool saveExists(int slotId = 1) const;
     bool deleteSave(int slotId = 1);
     
     // Utilitários
     void resetToDefaults();
     std::vector<int> getAvailableSaveSlots() const;
+    // Lista slots lendo só o cabeçalho fixo de cada arquivo (uma leitura pequena por slot)
+    std::vector<SaveSlotInfo> listSlots() const;
+    bool readSlotHeader(int slotId, SaveSlotInfo& info) const;
     std::string getSaveFilePath(int slotId) const;
+    std::string getLegacySaveFilePath(int slotId) const;
+    std::string getJournalFilePath(int slotId) const;
+    
+    // Depuração: estado atual como JSON legível (formato 1.0)
+    std::string exportJson() const;
+    
+    // Versão atual do esquema binário (.lsav)
+    static constexpr int SchemaVersion = 4;
+    static constexpr int MaxSaveSlots = 99;
+    static constexpr int AutosaveSlot = 0; // Listado junto com os slots manuais
+    static constexpr std::size_t JournalCompactBytes = 64 * 1024;
     
 private:
-    // Serialização
-    std::string serializeToJson() const;
+    // Serialização binária: cabeçalho fixo + miniatura + documento CBOR
+    std::vector<std::uint8_t> serializeToBinary() const;
+    bool deserializeFromBinary(const std::vector<std::uint8_t>& data);
     bool deserializeFromJson(const std::string& jsonData);
+    bool applySaveDocument(const nlohmann::json& document);
+    
+    // Journal (saveN.ljnl): "LJNL" | versão u16 | geração u32 | registros
+    // false quando o registro passaria de JournalCompactBytes: o journal
+    // pendente é descartado e só um snapshot completo sincroniza o slot
+    bool appendJournalRecord(std::uint8_t type, const std::vector<std::uint8_t>& payload);
+    bool replayJournal(int slotId);
+    bool applyJournalRecord(std::uint8_t type, const std::vector<std::uint8_t>& payload);
+    bool rewriteSlotHeader(int slotId) const;
+    void onStateChanged(const GameState::ChangeEvent& event);
+    void resetJournal();
     
     // Utilitários de arquivo
     bool ensureSaveDirectoryExists() const;
@@ -1,3 +1,9 @@
 #include "scene.hpp"
 
 Scene::~Scene() = default;
+
+void Scene::drawInterpolated(sf::RenderTarget& target, float) const {
+    draw(target);
+}
+
+void Scene::record(RenderCommandList&, float) const {}
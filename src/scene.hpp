@@ -2,13 +2,40 @@
 
 #include <SFML/Graphics.hpp>
 
+#include <cstdint>
+
+class RenderCommandList;
+
 class Scene {
 public:
     Scene() = default;
     virtual ~Scene();
 
     virtual void handleEvent(const sf::Event& event) = 0;
+    // Called by GameLoop with a fixed step (GameLoopConfig::simulationHz).
     virtual void update(float deltaTime) = 0;
-    virtual void draw(sf::RenderWindow& window) const = 0;
-};
+    virtual void draw(sf::RenderTarget& target) const = 0;
+    // alpha in [0, 1) is how far real time is between the last two updates.
+    // Scenes that keep their previous state blend with it; default ignores it.
+    virtual void drawInterpolated(sf::RenderTarget& target, float alpha) const;
+    // Threaded renderer: records what drawInterpolated would draw into an
+    // immutable command list. Scenes that don't override it draw nothing there.
+    virtual void record(RenderCommandList& commands, float alpha) const;
 
+    // Overlay scenes (pause menu, dialog) are drawn on top of the scenes below
+    // them. SceneStack renders those once into a cached texture and reuses it
+    // while the overlay is on top; only the overlay itself is updated.
+    virtual bool isOverlay() const { return false; }
+    // Color multiplied into the cached backdrop; white leaves it untouched.
+    virtual sf::Color backdropTint() const { return sf::Color(128, 128, 128); }
+    virtual bool blurBackdrop() const { return false; }
+
+    // Flags the scene's visuals as changed so a cached backdrop is redrawn.
+    void markDirty() { dirty_ = true; }
+    bool isDirty() const { return dirty_; }
+
+private:
+    friend class SceneStack;
+    bool dirty_ = true;
+    std::uint64_t stackId_ = 0; // Set by SceneStack when it enters the stack
+};
@@ -1,5 +1,44 @@
 #include "scene_stack.hpp"
 
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Shader.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+#include "frame_arena.hpp"
+#include "profiler.hpp"
+#include "render_commands.hpp"
+
+namespace {
+// 5x5 box blur, applied once when the backdrop is cached
+constexpr const char* BlurFragmentShader = R"(
+uniform sampler2D texture;
+uniform vec2 texel;
+
+void main() {
+    vec4 sum = vec4(0.0);
+    for (int x = -2; x <= 2; ++x) {
+        for (int y = -2; y <= 2; ++y) {
+            sum += texture2D(texture, gl_TexCoord[0].xy + vec2(float(x), float(y)) * texel);
+        }
+    }
+    gl_FragColor = gl_Color * (sum / 25.0);
+}
+)";
+} // namespace
+
+SceneStack::~SceneStack() {
+    // A scene still being built may reference objects owned by the caller
+    if (preparing_.valid()) {
+        preparing_.wait();
+    }
+}
+
 void SceneStack::pushScene(std::unique_ptr<Scene> scene) {
     pendingActions_.push_back(PendingAction{ActionType::Push, std::move(scene)});
 }
@@ -13,18 +52,53 @@ void SceneStack::switchScene(std::unique_ptr<Scene> scene) {
 }
 
 void SceneStack::applyPending() {
+    LUMY_PROFILE_SCOPE("SceneStack::applyPending");
+    pollPreparedScene();
+    if (phase_ == TransitionPhase::Commit) {
+        // Built here, on the main thread, before any queued action can remove
+        // the scene that asked for it
+        std::unique_ptr<Scene> scene;
+        if (currentId() != requesterId_) {
+            std::cerr << "[SceneStack] Cena preparada descartada: quem a pediu saiu do topo\n";
+        } else {
+            try {
+                scene = prepared_();
+            } catch (const std::exception& e) {
+                std::cerr << "[SceneStack] Falha ao montar cena: " << e.what() << "\n";
+            }
+        }
+        prepared_ = nullptr;
+        if (scene) {
+            pendingActions_.push_back(PendingAction{preparedAction_, std::move(scene)});
+        }
+        phase_ = fadeHalf_ > 0.f ? TransitionPhase::FadingIn : TransitionPhase::Idle;
+        fadeTimer_ = 0.f;
+    }
+    // Decided here, not by the caller: a prepared scene polled above may have
+    // just turned into a Switch
+    bool fenced = false;
+    const auto fenceOnce = [&] {
+        if (!fenced) {
+            fenceRender();
+            fenced = true;
+        }
+    };
     for (auto& action : pendingActions_) {
         switch (action.type) {
         case ActionType::Push:
+            action.scene->stackId_ = ++lastSceneId_;
             stack_.push_back(std::move(action.scene));
             break;
         case ActionType::Pop:
             if (!stack_.empty()) {
+                fenceOnce();
                 stack_.pop_back();
             }
             break;
         case ActionType::Switch:
+            action.scene->stackId_ = ++lastSceneId_;
             if (!stack_.empty()) {
+                fenceOnce();
                 stack_.back() = std::move(action.scene);
             } else {
                 stack_.push_back(std::move(action.scene));
@@ -32,10 +106,204 @@ void SceneStack::applyPending() {
             break;
         }
     }
+    if (!pendingActions_.empty()) {
+        backdropValid_ = false;
+    }
     pendingActions_.clear();
 }
 
+void SceneStack::fenceRender() const {
+    if (renderFence_) {
+        LUMY_PROFILE_SCOPE("SceneStack::fenceRender");
+        renderFence_();
+    }
+}
+
 Scene* SceneStack::current() const {
     return stack_.empty() ? nullptr : stack_.back().get();
 }
 
+std::uint64_t SceneStack::currentId() const {
+    return stack_.empty() ? 0 : stack_.back()->stackId_;
+}
+
+
+bool SceneStack::prepareScene(SceneLoader load, ActionType type, float fadeSeconds) {
+    if (phase_ != TransitionPhase::Idle || type == ActionType::Pop) {
+        std::cerr << "[SceneStack] prepareScene ignorado: transição em andamento\n";
+        return false;
+    }
+    preparing_ = std::async(std::launch::async, std::move(load));
+    requesterId_ = currentId();
+    preparedAction_ = type;
+    fadeHalf_ = std::max(0.f, fadeSeconds * 0.5f);
+    fadeTimer_ = 0.f;
+    phase_ = TransitionPhase::Loading;
+    return true;
+}
+
+void SceneStack::pollPreparedScene() {
+    if (phase_ != TransitionPhase::Loading) {
+        return;
+    }
+    if (!waitForPrepared_ && preparing_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    try {
+        prepared_ = preparing_.get();
+    } catch (const std::exception& e) {
+        std::cerr << "[SceneStack] Falha ao preparar cena: " << e.what() << "\n";
+    }
+    if (!prepared_) {
+        phase_ = TransitionPhase::Idle;
+        return;
+    }
+    phase_ = fadeHalf_ > 0.f ? TransitionPhase::FadingOut : TransitionPhase::Commit;
+}
+
+void SceneStack::update(float deltaTime) {
+    if (phase_ != TransitionPhase::FadingOut && phase_ != TransitionPhase::FadingIn) {
+        return;
+    }
+    fadeTimer_ += deltaTime;
+    if (fadeTimer_ < fadeHalf_) {
+        return;
+    }
+    phase_ = phase_ == TransitionPhase::FadingOut ? TransitionPhase::Commit : TransitionPhase::Idle;
+    fadeTimer_ = 0.f;
+}
+
+float SceneStack::transitionAlpha() const {
+    switch (phase_) {
+    case TransitionPhase::FadingOut:
+        return std::min(fadeTimer_ / fadeHalf_, 1.f);
+    case TransitionPhase::Commit:
+        return 1.f;
+    case TransitionPhase::FadingIn:
+        return 1.f - std::min(fadeTimer_ / fadeHalf_, 1.f);
+    default:
+        return 0.f;
+    }
+}
+
+void SceneStack::drawTransition(sf::RenderTarget& target) const {
+    const float alpha = transitionAlpha();
+    if (alpha <= 0.f) {
+        return;
+    }
+    const sf::View previousView = target.getView();
+    target.setView(target.getDefaultView());
+    sf::RectangleShape fade(sf::Vector2f(target.getSize()));
+    fade.setFillColor(sf::Color(0, 0, 0, static_cast<std::uint8_t>(alpha * 255.f)));
+    target.draw(fade);
+    target.setView(previousView);
+}
+
+void SceneStack::draw(sf::RenderTarget& target, float alpha) {
+    if (stack_.empty()) {
+        return;
+    }
+    const Scene& top = *stack_.back();
+    if (!top.isOverlay() || stack_.size() == 1) {
+        top.drawInterpolated(target, alpha);
+        return;
+    }
+
+    refreshBackdrop(target.getSize(), backdropStart(), top.blurBackdrop());
+
+    const sf::View previousView = target.getView();
+    target.setView(target.getDefaultView());
+    sf::Sprite backdrop(backdrop_.getTexture());
+    backdrop.setColor(top.backdropTint());
+    target.draw(backdrop);
+    target.setView(previousView);
+
+    top.drawInterpolated(target, alpha);
+}
+
+void SceneStack::record(RenderCommandList& commands, float alpha) const {
+    if (stack_.empty()) {
+        return;
+    }
+    const Scene& top = *stack_.back();
+    if (top.isOverlay() && stack_.size() > 1) {
+        for (std::size_t i = backdropStart(); i + 1 < stack_.size(); ++i) {
+            stack_[i]->record(commands, 1.f);
+        }
+        const sf::Color tint = top.backdropTint();
+        const int brightness = (tint.r + tint.g + tint.b) / 3;
+        if (brightness < 255) {
+            commands.fillScreen(sf::Color(0, 0, 0, static_cast<std::uint8_t>(255 - brightness)));
+        }
+    }
+    top.record(commands, alpha);
+
+    const float fade = transitionAlpha();
+    if (fade > 0.f) {
+        commands.fillScreen(sf::Color(0, 0, 0, static_cast<std::uint8_t>(fade * 255.f)));
+    }
+}
+
+std::size_t SceneStack::backdropStart() const {
+    // Overlays stacked on overlays all go into the backdrop, down to the
+    // nearest opaque scene
+    std::size_t first = stack_.size() - 2;
+    while (first > 0 && stack_[first]->isOverlay()) {
+        --first;
+    }
+    return first;
+}
+
+void SceneStack::refreshBackdrop(sf::Vector2u size, std::size_t first, bool blur) {
+    std::pmr::vector<const Scene*> scenes(&frameArena()); // Runs every frame while an overlay is open
+    bool dirty = false;
+    for (std::size_t i = first; i + 1 < stack_.size(); ++i) {
+        scenes.push_back(stack_[i].get());
+        dirty = dirty || stack_[i]->dirty_;
+    }
+    if (backdropValid_ && !dirty && std::ranges::equal(scenes, backdropScenes_) && backdrop_.getSize() == size &&
+        backdropBlurred_ == blur) {
+        return;
+    }
+    LUMY_PROFILE_SCOPE("SceneStack::refreshBackdrop");
+
+    if (blur && !blurShader_ && !blurUnavailable_) {
+        auto shader = std::make_unique<sf::Shader>();
+        if (sf::Shader::isAvailable() && shader->loadFromMemory(BlurFragmentShader, sf::Shader::Type::Fragment)) {
+            blurShader_ = std::move(shader);
+        } else {
+            std::cerr << "[SceneStack] Blur indisponível, usando apenas o tint\n";
+            blurUnavailable_ = true;
+        }
+    }
+    const bool useBlur = blur && blurShader_;
+
+    sf::RenderTexture& pass = useBlur ? backdropScratch_ : backdrop_;
+    if ((backdrop_.getSize() != size && !backdrop_.resize(size)) ||
+        (useBlur && pass.getSize() != size && !pass.resize(size))) {
+        std::cerr << "[SceneStack] Falha ao criar textura do fundo " << size.x << "x" << size.y << "\n";
+        return;
+    }
+
+    pass.clear(sf::Color::Black);
+    for (const Scene* scene : scenes) {
+        scene->draw(pass);
+    }
+    pass.display();
+
+    if (useBlur) {
+        blurShader_->setUniform("texture", sf::Shader::CurrentTexture);
+        blurShader_->setUniform("texel", sf::Vector2f(1.f / static_cast<float>(size.x),
+                                                      1.f / static_cast<float>(size.y)));
+        backdrop_.clear(sf::Color::Black);
+        backdrop_.draw(sf::Sprite(pass.getTexture()), blurShader_.get());
+        backdrop_.display();
+    }
+
+    for (std::size_t i = first; i + 1 < stack_.size(); ++i) {
+        stack_[i]->dirty_ = false;
+    }
+    backdropScenes_.assign(scenes.begin(), scenes.end());
+    backdropBlurred_ = blur;
+    backdropValid_ = true;
+}
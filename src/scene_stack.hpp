@@ -1,10 +1,14 @@
 #pragma once
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 
 #include "scene.hpp"
 
+class RenderCommandList;
+
 class SceneStack {
 public:
     enum class ActionType { Push, Pop, Switch };
@@ -14,14 +18,89 @@ public:
         std::unique_ptr<Scene> scene;
     };
 
+    // Builds a scene. Called on the main thread (prepareScene: at commit).
+    using SceneFactory = std::function<std::unique_ptr<Scene>()>;
+    // Runs on a worker thread and does the file loading only (no GL objects,
+    // no Lua states, no SceneStack calls); returns the factory that builds the
+    // scene from what it loaded.
+    using SceneLoader = std::function<SceneFactory()>;
+
+    ~SceneStack();
+
     void pushScene(std::unique_ptr<Scene> scene);
     void popScene();
     void switchScene(std::unique_ptr<Scene> scene);
     Scene* current() const;
     void applyPending();
 
+    // Threaded renderer: called inside applyPending() right before a scene is
+    // popped or replaced, so no recorded list still reads its resources.
+    // GameLoop drains its RenderQueue here.
+    void setRenderFence(std::function<void()> fence) { renderFence_ = std::move(fence); }
+    // Runs the fence, if any. Scenes call it before changing GPU resources a
+    // recorded list may be reading (atlas pages updated in place).
+    void fenceRender() const;
+
+    // Runs load on a worker thread while the current scene keeps running.
+    // Once it is done the screen fades out over half of fadeSeconds, then
+    // applyPending builds the scene with the returned factory on the main
+    // thread and commits it (Switch or Push), and the screen fades back in.
+    // The factory runs while the requesting scene is still on top, so it can
+    // read that scene's latest state; if another scene took its place, the
+    // preparation is dropped. Returns false if another one is in progress.
+    bool prepareScene(SceneLoader load, ActionType type = ActionType::Switch, float fadeSeconds = 0.5f);
+    bool isTransitioning() const { return phase_ != TransitionPhase::Idle; }
+    // Makes applyPending() block until a prepared scene is built, so the
+    // switch always lands on the same step (input replays).
+    void setWaitForPreparedScenes(bool wait) { waitForPrepared_ = wait; }
+    // Advances the fade; call once per fixed update.
+    void update(float deltaTime);
+    // 0 = scene fully visible, 1 = fully covered by the fade.
+    float transitionAlpha() const;
+    // Draws the fade overlay in screen space (no-op when idle).
+    void drawTransition(sf::RenderTarget& target) const;
+
+    // Draws current(). When it is an overlay, the scenes below it (down to the
+    // nearest opaque one) come from a cached texture that is re-rendered only
+    // when the stack changes, the target is resized, or one of them is dirty.
+    void draw(sf::RenderTarget& target, float alpha);
+    // Forces the cached backdrop to be re-rendered on the next draw.
+    void invalidateBackdrop() { backdropValid_ = false; }
+    // Threaded renderer: records what draw() and drawTransition() would draw.
+    // There is no cached backdrop here; scenes under an overlay are recorded
+    // every frame and dimmed with backdropTint() (no blur).
+    void record(RenderCommandList& commands, float alpha) const;
+
 private:
+    enum class TransitionPhase { Idle, Loading, FadingOut, Commit, FadingIn };
+
+    void pollPreparedScene();
+    std::uint64_t currentId() const;
+    // Index of the lowest scene drawn under an overlay on top.
+    std::size_t backdropStart() const;
+    void refreshBackdrop(sf::Vector2u size, std::size_t first, bool blur);
+
     std::vector<std::unique_ptr<Scene>> stack_;
     std::vector<PendingAction> pendingActions_;
-};
 
+    TransitionPhase phase_ = TransitionPhase::Idle;
+    std::future<SceneFactory> preparing_;
+    SceneFactory prepared_;
+    // Id of current() when prepareScene was called. Ids are never reused, so a
+    // new scene allocated where the requester was can't pass for it.
+    std::uint64_t requesterId_ = 0;
+    std::uint64_t lastSceneId_ = 0;
+    ActionType preparedAction_ = ActionType::Switch;
+    float fadeHalf_ = 0.f;
+    float fadeTimer_ = 0.f;
+    bool waitForPrepared_ = false;
+    std::function<void()> renderFence_;
+
+    sf::RenderTexture backdrop_;
+    sf::RenderTexture backdropScratch_; // Unblurred pass when blurring
+    std::unique_ptr<sf::Shader> blurShader_;
+    bool blurUnavailable_ = false;
+    bool backdropValid_ = false;
+    bool backdropBlurred_ = false;
+    std::vector<const Scene*> backdropScenes_;
+};
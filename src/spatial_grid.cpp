@@ -0,0 +1,51 @@
+#include "spatial_grid.hpp"
+
+namespace {
+constexpr int MaxCellsPerAxis = 1024;
+} // namespace
+
+void SpatialGrid::build(const float* xs, const float* ys, std::size_t count) {
+    points_.resize(count);
+    entries_.resize(count);
+    if (count == 0) {
+        cols_ = rows_ = 0;
+        cellStart_.assign(1, 0);
+        return;
+    }
+
+    float minX = xs[0], maxX = xs[0], minY = ys[0], maxY = ys[0];
+    for (std::size_t i = 0; i < count; ++i) {
+        points_[i] = {xs[i], ys[i]};
+        minX = std::min(minX, xs[i]);
+        maxX = std::max(maxX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+    originX_ = minX;
+    originY_ = minY;
+    effectiveCell_ = std::max({cellSize_, (maxX - minX) / MaxCellsPerAxis, (maxY - minY) / MaxCellsPerAxis});
+    cols_ = cellCoord(maxX, originX_) + 1;
+    rows_ = cellCoord(maxY, originY_) + 1;
+
+    // Counting sort: per-cell counts, inclusive prefix sum (cell ends), then
+    // scatter backwards so each cell end walks down to its start
+    const std::size_t cellCount = static_cast<std::size_t>(cols_) * rows_;
+    cellStart_.assign(cellCount + 1, 0);
+    cellOf_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        cellOf_[i] = static_cast<std::uint32_t>(cellCoord(ys[i], originY_) * cols_ + cellCoord(xs[i], originX_));
+        cellStart_[cellOf_[i]]++;
+    }
+    for (std::size_t c = 1; c <= cellCount; ++c) {
+        cellStart_[c] += cellStart_[c - 1];
+    }
+    for (std::size_t i = count; i-- > 0;) {
+        entries_[--cellStart_[cellOf_[i]]] = static_cast<std::uint32_t>(i);
+    }
+}
+
+std::vector<std::uint32_t> SpatialGrid::queryRadius(sf::Vector2f center, float radius) const {
+    std::vector<std::uint32_t> result;
+    forEachInRadius(center, radius, [&result](std::uint32_t index) { result.push_back(index); });
+    return result;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over a set of points for radius queries. It is rebuilt in
+// bulk with a counting sort by cell, which is cheap enough to redo every
+// frame for moving actors. Indices refer to the arrays passed to build().
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cellSize = 64.f) : cellSize_(cellSize) {}
+
+    void build(const float* xs, const float* ys, std::size_t count);
+    void clear() { build(nullptr, nullptr, 0); }
+
+    // Calls fn(index) for every point within radius of center.
+    template <typename Fn>
+    void forEachInRadius(sf::Vector2f center, float radius, Fn&& fn) const {
+        if (points_.empty()) {
+            return;
+        }
+        const int minCol = std::max(0, cellCoord(center.x - radius, originX_));
+        const int maxCol = std::min(cols_ - 1, cellCoord(center.x + radius, originX_));
+        const int minRow = std::max(0, cellCoord(center.y - radius, originY_));
+        const int maxRow = std::min(rows_ - 1, cellCoord(center.y + radius, originY_));
+        const float radiusSq = radius * radius;
+        for (int row = minRow; row <= maxRow; ++row) {
+            for (int col = minCol; col <= maxCol; ++col) {
+                const std::size_t cell = static_cast<std::size_t>(row) * cols_ + col;
+                for (std::uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+                    const std::uint32_t index = entries_[i];
+                    const sf::Vector2f d = points_[index] - center;
+                    if (d.x * d.x + d.y * d.y <= radiusSq) {
+                        fn(index);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> queryRadius(sf::Vector2f center, float radius) const;
+
+    std::size_t size() const { return points_.size(); }
+    float cellSize() const { return effectiveCell_; }
+
+private:
+    int cellCoord(float value, float origin) const {
+        return static_cast<int>((value - origin) / effectiveCell_);
+    }
+
+    float cellSize_;
+    float effectiveCell_ = 0.f; // Grown when the points are spread too far apart
+    float originX_ = 0.f;
+    float originY_ = 0.f;
+    int cols_ = 0;
+    int rows_ = 0;
+    std::vector<std::uint32_t> cellStart_; // Per cell, offset into entries_ (+1 sentinel)
+    std::vector<std::uint32_t> entries_;   // Point indices sorted by cell
+    std::vector<std::uint32_t> cellOf_;    // Scratch for build()
+    std::vector<sf::Vector2f> points_;
+};
@@ -0,0 +1,131 @@
+#include "sprite_batch.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <limits>
+
+void SpriteBatch::add(int layer, const sf::Texture* texture, const sf::FloatRect& rect, const sf::IntRect& source,
+                      sf::Color color) {
+    const sf::Vector2f a = rect.position;
+    const sf::Vector2f b = rect.position + rect.size;
+    sf::Vector2f t0, t1;
+    if (texture) {
+        t0 = sf::Vector2f(source.position);
+        t1 = sf::Vector2f(source.position + source.size);
+    }
+    const sf::Vertex quad[6] = {
+        {a, color, t0},
+        {{b.x, a.y}, color, {t1.x, t0.y}},
+        {b, color, t1},
+        {a, color, t0},
+        {b, color, t1},
+        {{a.x, b.y}, color, {t0.x, t1.y}},
+    };
+    add(layer, texture, quad, 6);
+}
+
+void SpriteBatch::add(int layer, const AtlasRegion& region, sf::Vector2f position, sf::Color color) {
+    add(layer, region.texture, sf::FloatRect{position, sf::Vector2f(region.rect.size)}, region.rect, color);
+}
+
+void SpriteBatch::add(int layer, const sf::Sprite& sprite) {
+    const sf::IntRect source = sprite.getTextureRect();
+    const sf::Transform& transform = sprite.getTransform();
+    const sf::Vector2f size(source.size);
+    const sf::Vector2f a = transform.transformPoint({0.f, 0.f});
+    const sf::Vector2f b = transform.transformPoint({size.x, 0.f});
+    const sf::Vector2f c = transform.transformPoint(size);
+    const sf::Vector2f d = transform.transformPoint({0.f, size.y});
+    const sf::Vector2f t0(source.position);
+    const sf::Vector2f t1(source.position + source.size);
+    const sf::Color color = sprite.getColor();
+    const sf::Vertex quad[6] = {
+        {a, color, t0},
+        {b, color, {t1.x, t0.y}},
+        {c, color, t1},
+        {a, color, t0},
+        {c, color, t1},
+        {d, color, {t0.x, t1.y}},
+    };
+    add(layer, &sprite.getTexture(), quad, 6);
+}
+
+void SpriteBatch::add(int layer, const sf::Texture* texture, const sf::Vertex* triangles, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    items_.push_back({key(layer, texture), static_cast<std::uint32_t>(staging_.size()),
+                      static_cast<std::uint32_t>(count)});
+    staging_.insert(staging_.end(), triangles, triangles + count);
+    built_ = false;
+}
+
+std::uint64_t SpriteBatch::key(int layer, const sf::Texture* texture) {
+    // Few distinct textures per frame: a linear search beats hashing here
+    auto it = std::find(textures_.begin(), textures_.end(), texture);
+    if (it == textures_.end()) {
+        it = textures_.insert(textures_.end(), texture);
+    }
+    const auto id = static_cast<std::uint64_t>(it - textures_.begin());
+    // Layer in the top 16 bits, biased so negative layers sort first; the
+    // submission index at the bottom keeps equal layer/texture in order
+    const int clamped = std::clamp(layer, int{std::numeric_limits<std::int16_t>::min()},
+                                   int{std::numeric_limits<std::int16_t>::max()});
+    const auto biased = static_cast<std::uint64_t>(clamped + 32768);
+    return (biased << 48) | ((id & 0xFFFF) << 32) | static_cast<std::uint64_t>(items_.size());
+}
+
+void SpriteBatch::clear() {
+    staging_.clear();
+    items_.clear();
+    textures_.clear();
+    built_ = false;
+}
+
+std::size_t SpriteBatch::batchCount() const {
+    build();
+    return batches_.size();
+}
+
+void SpriteBatch::build() const {
+    if (built_) {
+        return;
+    }
+    LUMY_PROFILE_SCOPE("SpriteBatch::build");
+    // Keys are unique, so the unstable sort is deterministic (and, unlike
+    // stable_sort, never asks for a temporary buffer)
+    sorted_.assign(items_.begin(), items_.end());
+    std::sort(sorted_.begin(), sorted_.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+
+    vertices_.clear();
+    batches_.clear();
+    for (const Item& item : sorted_) {
+        const sf::Texture* texture = textures_[(item.key >> 32) & 0xFFFF];
+        if (batches_.empty() || batches_.back().texture != texture) {
+            batches_.push_back({texture, vertices_.size(), 0});
+        }
+        vertices_.insert(vertices_.end(), staging_.begin() + item.first, staging_.begin() + item.first + item.count);
+        batches_.back().count += item.count;
+    }
+    built_ = true;
+}
+
+void SpriteBatch::draw(sf::RenderTarget& target) const {
+    LUMY_PROFILE_SCOPE("SpriteBatch::draw");
+    build();
+    for (const Batch& batch : batches_) {
+        sf::RenderStates states;
+        states.texture = batch.texture;
+        target.draw(vertices_.data() + batch.first, batch.count, sf::PrimitiveType::Triangles, states);
+    }
+}
+
+void SpriteBatch::record(RenderCommandList& commands) const {
+    build();
+    for (const Batch& batch : batches_) {
+        sf::RenderStates states;
+        states.texture = batch.texture;
+        commands.draw(snapshots_.share(vertices_.data() + batch.first, batch.count), sf::PrimitiveType::Triangles,
+                      states);
+    }
+}
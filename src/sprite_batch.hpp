@@ -0,0 +1,66 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render_commands.hpp"
+#include "texture_atlas.hpp"
+
+// Collects textured quads for a frame and draws them with as few draw calls
+// as possible: everything is ordered by layer, then by texture, and each run
+// of one texture becomes a single triangle list. Within a layer and texture,
+// submission order is kept. Sprites packed into a TextureAtlas share a
+// texture, so they collapse into one draw call.
+//
+// Textures are referenced by pointer and must outlive the draw (recorded
+// lists: TextureManager entries and atlas pages, see RenderCommandList).
+// Storage is kept across clear(), so a steady frame doesn't allocate.
+class SpriteBatch {
+public:
+    // Quad covering rect (target coordinates), textured with source (pixels).
+    // Without texture, source is ignored and the quad is a solid color.
+    void add(int layer, const sf::Texture* texture, const sf::FloatRect& rect, const sf::IntRect& source,
+             sf::Color color = sf::Color::White);
+    // An atlas region at its natural size.
+    void add(int layer, const AtlasRegion& region, sf::Vector2f position, sf::Color color = sf::Color::White);
+    void add(int layer, const sf::Sprite& sprite);
+    // Prebuilt triangles (count a multiple of 3) kept together as one item.
+    void add(int layer, const sf::Texture* texture, const sf::Vertex* triangles, std::size_t count);
+
+    void clear();
+    bool empty() const { return items_.empty(); }
+    // Items added since clear(): quads, sprites and triangle runs.
+    std::size_t size() const { return items_.size(); }
+    // Draw calls the current contents take.
+    std::size_t batchCount() const;
+
+    void draw(sf::RenderTarget& target) const;
+    void record(RenderCommandList& commands) const;
+
+private:
+    struct Item {
+        std::uint64_t key; // Layer, texture id, submission index: see add()
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+    struct Batch {
+        const sf::Texture* texture;
+        std::size_t first;
+        std::size_t count;
+    };
+
+    std::uint64_t key(int layer, const sf::Texture* texture);
+    void build() const;
+
+    std::vector<sf::Vertex> staging_;          // Vertices in submission order
+    std::vector<Item> items_;
+    std::vector<const sf::Texture*> textures_; // Id = index, in first-use order
+    mutable std::vector<Item> sorted_;
+    mutable std::vector<sf::Vertex> vertices_; // Sorted, what gets drawn
+    mutable std::vector<Batch> batches_;
+    mutable bool built_ = true;
+    mutable VertexSnapshotPool snapshots_; // Recorded copies of batches
+};
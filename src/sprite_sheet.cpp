@@ -0,0 +1,103 @@
+#include "sprite_sheet.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include "texture_manager.hpp"
+#include "vfs.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+constexpr float DefaultFps = 6.f;
+
+int facingIndex(const std::string& name) {
+    if (name == "down") return static_cast<int>(Facing::Down);
+    if (name == "left") return static_cast<int>(Facing::Left);
+    if (name == "right") return static_cast<int>(Facing::Right);
+    if (name == "up") return static_cast<int>(Facing::Up);
+    return -1;
+}
+} // namespace
+
+bool SpriteSheet::loadFromFile(const std::filesystem::path& path, TextureManager& textures) {
+    const FileData file = Vfs::instance().read(path);
+    if (!file) {
+        std::cerr << "[SpriteSheet] Arquivo não encontrado: " << path.string() << "\n";
+        return false;
+    }
+    try {
+        const json data = json::parse(file.text());
+        const auto texturePath = path.parent_path() / data.at("texture").get<std::string>();
+        return loadFromJson(data, &textures.acquire(texturePath));
+    } catch (const std::exception& e) {
+        std::cerr << "[SpriteSheet] Erro ao carregar " << path.string() << ": " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool SpriteSheet::loadFromJson(const json& data, const sf::Texture* texture) {
+    try {
+        SpriteSheet sheet;
+        sheet.texture_ = texture;
+        sheet.frameSize_ = {data.at("frameWidth").get<unsigned>(), data.at("frameHeight").get<unsigned>()};
+        if (sheet.frameSize_.x == 0 || sheet.frameSize_.y == 0) {
+            std::cerr << "[SpriteSheet] Tamanho de frame inválido\n";
+            return false;
+        }
+
+        if (data.contains("directions")) {
+            const auto& directions = data.at("directions");
+            for (std::size_t row = 0; row < directions.size(); ++row) {
+                const int facing = facingIndex(directions[row].get<std::string>());
+                if (facing < 0) {
+                    std::cerr << "[SpriteSheet] Direção desconhecida: " << directions[row] << "\n";
+                    return false;
+                }
+                sheet.rows_[static_cast<std::size_t>(facing)] = static_cast<std::uint16_t>(row);
+            }
+        }
+
+        for (const auto& [name, definition] : data.at("clips").items()) {
+            const auto& frames = definition.at("frames");
+            if (frames.empty()) {
+                std::cerr << "[SpriteSheet] Clip sem frames: " << name << "\n";
+                return false;
+            }
+            AnimationClip clip;
+            clip.name = name;
+            clip.firstFrame = static_cast<std::uint16_t>(sheet.frames_.size());
+            clip.frameCount = static_cast<std::uint16_t>(frames.size());
+            clip.frameSeconds = 1.f / std::max(definition.value("fps", DefaultFps), 0.001f);
+            clip.loop = definition.value("loop", true);
+            for (const auto& frame : frames) {
+                sheet.frames_.push_back(frame.get<std::uint16_t>());
+            }
+            sheet.clips_.push_back(std::move(clip));
+        }
+        sheet.idleClip_ = sheet.findClip("idle");
+        sheet.walkClip_ = sheet.findClip("walk");
+        *this = std::move(sheet);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[SpriteSheet] Definição inválida: " << e.what() << "\n";
+        return false;
+    }
+}
+
+std::uint16_t SpriteSheet::findClip(std::string_view name) const {
+    for (std::size_t i = 0; i < clips_.size(); ++i) {
+        if (clips_[i].name == name) {
+            return static_cast<std::uint16_t>(i);
+        }
+    }
+    return NoClip;
+}
+
+std::uint16_t SpriteSheet::column(const AnimationClip& clip, float elapsed) const {
+    auto step = static_cast<std::uint32_t>(std::max(elapsed, 0.f) / clip.frameSeconds);
+    step = clip.loop ? step % clip.frameCount : std::min<std::uint32_t>(step, clip.frameCount - 1u);
+    return frames_[clip.firstFrame + step];
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TextureManager;
+
+enum class Facing : std::uint8_t { Down, Left, Right, Up };
+
+// One named animation: a run of sheet columns played on the row of the
+// actor's facing.
+struct AnimationClip {
+    std::string name;
+    std::uint16_t firstFrame = 0; // Into SpriteSheet's flattened frame list
+    std::uint16_t frameCount = 1;
+    float frameSeconds = 0.15f;
+    bool loop = true;
+};
+
+// Character sheet in the usual RPG layout: one row per direction, N frame
+// columns, with clips described in JSON next to the texture:
+//
+//   {
+//     "texture": "villager.png",
+//     "frameWidth": 24, "frameHeight": 32,
+//     "directions": ["down", "left", "right", "up"],
+//     "clips": {
+//       "idle": {"frames": [1]},
+//       "walk": {"frames": [0, 1, 2, 1], "fps": 8}
+//     }
+//   }
+//
+// "directions" is optional (that order is the default) and clips default to
+// 6 fps and looping ("loop": false holds the last frame).
+class SpriteSheet {
+public:
+    static constexpr std::uint16_t NoClip = 0xFFFF;
+
+    bool loadFromFile(const std::filesystem::path& path, TextureManager& textures);
+    // texture may be null (tests, headless); frames then only drive UVs.
+    bool loadFromJson(const nlohmann::json& data, const sf::Texture* texture);
+
+    const sf::Texture* texture() const { return texture_; }
+    sf::Vector2u frameSize() const { return frameSize_; }
+    std::uint16_t row(Facing facing) const { return rows_[static_cast<std::size_t>(facing)]; }
+
+    std::uint16_t findClip(std::string_view name) const; // NoClip if missing
+    const AnimationClip& clip(std::uint16_t index) const { return clips_[index]; }
+    std::size_t clipCount() const { return clips_.size(); }
+    // Clips played automatically by ActorSystem while standing / moving.
+    std::uint16_t idleClip() const { return idleClip_; }
+    std::uint16_t walkClip() const { return walkClip_; }
+
+    // Column shown after elapsed seconds of the clip.
+    std::uint16_t column(const AnimationClip& clip, float elapsed) const;
+
+private:
+    const sf::Texture* texture_ = nullptr;
+    sf::Vector2u frameSize_{};
+    std::array<std::uint16_t, 4> rows_{0, 1, 2, 3};
+    std::vector<AnimationClip> clips_;
+    std::vector<std::uint16_t> frames_; // Columns of every clip, back to back
+    std::uint16_t idleClip_ = NoClip;
+    std::uint16_t walkClip_ = NoClip;
+};
@@ -0,0 +1,139 @@
+#include "texture_atlas.hpp"
+#include "profiler.hpp"
+#include "texture_manager.hpp"
+#include "vfs.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+ShelfPacker::ShelfPacker(sf::Vector2u size, unsigned padding) : size_(size), padding_(padding) {}
+
+std::optional<sf::Vector2u> ShelfPacker::insert(sf::Vector2u size) {
+    if (size.x == 0 || size.y == 0 || size.x > size_.x || size.y > size_.y) {
+        return std::nullopt;
+    }
+    const unsigned height = size.y + padding_;
+
+    // Best fit: the shelf with room whose height is closest above the rectangle's
+    Shelf* best = nullptr;
+    for (Shelf& shelf : shelves_) {
+        if (shelf.height >= height && shelf.x + size.x <= size_.x &&
+            (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+    // A much taller shelf would waste more than the rectangle itself: open a
+    // new one while the page still has room
+    const bool roomBelow = nextY_ + size.y <= size_.y;
+    if (!best || (best->height >= 2 * height && roomBelow)) {
+        if (!roomBelow) {
+            return std::nullopt;
+        }
+        shelves_.push_back({nextY_, height, 0});
+        nextY_ += height;
+        best = &shelves_.back();
+    }
+
+    const sf::Vector2u position{best->x, best->y};
+    best->x += size.x + padding_;
+    usedArea_ += static_cast<std::uint64_t>(size.x) * size.y;
+    return position;
+}
+
+void ShelfPacker::clear() {
+    shelves_.clear();
+    nextY_ = 0;
+    usedArea_ = 0;
+}
+
+float ShelfPacker::occupancy() const {
+    const std::uint64_t area = static_cast<std::uint64_t>(size_.x) * size_.y;
+    return area > 0 ? static_cast<float>(usedArea_) / static_cast<float>(area) : 0.f;
+}
+
+TextureAtlas::TextureAtlas(TextureManager& textures, unsigned pageSize, unsigned maxImageSize)
+    : textures_(textures), pageSize_(pageSize), maxImageSize_(std::min(maxImageSize, pageSize)) {}
+
+AtlasRegion TextureAtlas::acquire(const std::filesystem::path& path) {
+    std::string key = std::filesystem::weakly_canonical(path).generic_string();
+    if (auto it = regions_.find(key); it != regions_.end()) {
+        return it->second;
+    }
+
+    LUMY_PROFILE_SCOPE("TextureAtlas::acquire");
+    AtlasRegion region;
+    if (!textures_.headless()) {
+        const FileData file = Vfs::instance().read(path);
+        sf::Image image;
+        if (!file || !image.loadFromMemory(file.data(), file.size())) {
+            throw std::runtime_error("Failed to load image: " + key);
+        }
+        if (auto packed = pack(image)) {
+            region = *packed;
+        }
+    }
+    if (!region.texture) {
+        // Too large for a page (or headless): the file as its own texture
+        const sf::Texture& texture = textures_.acquire(path);
+        region = {&texture, {{0, 0}, sf::Vector2i(texture.getSize())}};
+    }
+    return regions_.emplace(std::move(key), region).first->second;
+}
+
+AtlasRegion TextureAtlas::add(const std::string& key, const sf::Image& image) {
+    if (auto it = regions_.find(key); it != regions_.end()) {
+        return it->second;
+    }
+
+    AtlasRegion region{nullptr, {{0, 0}, sf::Vector2i(image.getSize())}}; // Headless: size only
+    if (!textures_.headless()) {
+        if (auto packed = pack(image)) {
+            region = *packed;
+        } else {
+            // Too large for a page: a texture of its own
+            auto texture = std::make_unique<sf::Texture>();
+            if (!texture->loadFromImage(image)) {
+                throw std::runtime_error("Failed to create texture: " + key);
+            }
+            region.texture = texture.get();
+            loose_.push_back(std::move(texture));
+        }
+    }
+    return regions_.emplace(key, region).first->second;
+}
+
+void TextureAtlas::clear() {
+    regions_.clear();
+    pages_.clear();
+    loose_.clear();
+}
+
+std::optional<AtlasRegion> TextureAtlas::pack(const sf::Image& image) {
+    const sf::Vector2u size = image.getSize();
+    if (size.x == 0 || size.y == 0 || size.x > maxImageSize_ || size.y > maxImageSize_) {
+        return std::nullopt;
+    }
+
+    const auto place = [&](Page& page, sf::Vector2u position) {
+        page.texture->update(image, position);
+        return AtlasRegion{page.texture.get(), {sf::Vector2i(position), sf::Vector2i(size)}};
+    };
+    for (Page& page : pages_) {
+        if (auto position = page.packer.insert(size)) {
+            // The page already holds regions a recorded list may be drawing
+            if (fence_) {
+                fence_();
+            }
+            return place(page, *position);
+        }
+    }
+
+    // Every page is full: start another one
+    Page page{std::make_unique<sf::Texture>(), ShelfPacker({pageSize_, pageSize_})};
+    if (!page.texture->resize({pageSize_, pageSize_})) {
+        return std::nullopt;
+    }
+    const std::optional<sf::Vector2u> position = page.packer.insert(size); // Fits: size <= maxImageSize_ <= pageSize_
+    pages_.push_back(std::move(page));
+    return place(pages_.back(), *position);
+}
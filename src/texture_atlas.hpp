@@ -0,0 +1,103 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TextureManager;
+
+// Where an image ended up: the texture to bind and the area inside it.
+struct AtlasRegion {
+    const sf::Texture* texture = nullptr;
+    sf::IntRect rect;
+};
+
+// Shelf (row) rectangle packer. Rectangles go on the shelf that wastes the
+// least height, and a new shelf opens below the last one when none fits.
+// Nothing is ever freed; clear() starts over. Pure bookkeeping, no GL.
+class ShelfPacker {
+public:
+    // padding: empty pixels kept to the right of and below every rectangle,
+    // so filtering never samples a neighbour.
+    explicit ShelfPacker(sf::Vector2u size, unsigned padding = 1);
+
+    // Top-left corner for a rectangle of this size, or nullopt when full.
+    std::optional<sf::Vector2u> insert(sf::Vector2u size);
+    void clear();
+
+    sf::Vector2u size() const { return size_; }
+    // Fraction of the area handed out, padding excluded.
+    float occupancy() const;
+
+private:
+    struct Shelf {
+        unsigned y;
+        unsigned height; // Padding included
+        unsigned x;      // Next free column
+    };
+
+    sf::Vector2u size_;
+    unsigned padding_;
+    std::vector<Shelf> shelves_;
+    unsigned nextY_ = 0;
+    std::uint64_t usedArea_ = 0;
+};
+
+// Runtime atlas for small images (pictures, icons): the first acquire() of a
+// file decodes it and copies it into a shared page texture, so sprites from
+// different files can be drawn with one texture bind (see SpriteBatch).
+// Images larger than maxImageSize, and everything in headless mode, come back
+// as the whole TextureManager texture instead.
+//
+// Main thread only: pages are GL textures updated in place. A page that
+// already handed out regions may be bound by a list the render thread is
+// replaying, so the fence set with setFence() runs before such a page is
+// written; a page that was just opened is written without it. Regions stay
+// valid for the atlas' lifetime.
+class TextureAtlas {
+public:
+    static constexpr unsigned DefaultPageSize = 1024;
+    static constexpr unsigned DefaultMaxImageSize = 256;
+
+    explicit TextureAtlas(TextureManager& textures, unsigned pageSize = DefaultPageSize,
+                          unsigned maxImageSize = DefaultMaxImageSize);
+
+    // Throws std::runtime_error when the file can't be loaded, like
+    // TextureManager::acquire().
+    AtlasRegion acquire(const std::filesystem::path& path);
+    // Same for an image built at runtime, cached under key.
+    AtlasRegion add(const std::string& key, const sf::Image& image);
+
+    // Called before a published page is updated (SceneStack::fenceRender).
+    void setFence(std::function<void()> fence) { fence_ = std::move(fence); }
+
+    std::size_t pageCount() const { return pages_.size(); }
+    std::size_t regionCount() const { return regions_.size(); }
+    const sf::Texture& page(std::size_t index) const { return *pages_[index].texture; }
+
+    // Drops every page and region. Regions handed out before become invalid.
+    void clear();
+
+private:
+    struct Page {
+        std::unique_ptr<sf::Texture> texture; // Stable address for AtlasRegion
+        ShelfPacker packer;
+    };
+
+    std::optional<AtlasRegion> pack(const sf::Image& image);
+
+    TextureManager& textures_;
+    unsigned pageSize_;
+    unsigned maxImageSize_;
+    std::vector<Page> pages_;
+    std::vector<std::unique_ptr<sf::Texture>> loose_; // add() images too large for a page
+    std::unordered_map<std::string, AtlasRegion> regions_;
+    std::function<void()> fence_;
+};
@@ -1,26 +1,62 @@
 #include "texture_manager.hpp"
+#include "vfs.hpp"
 
 #include <stdexcept>
 
+std::string TextureManager::keyOf(const std::filesystem::path& path) {
+    return std::filesystem::weakly_canonical(path).generic_string();
+}
+
 const sf::Texture& TextureManager::acquire(const std::filesystem::path& path) {
-    auto normalized = std::filesystem::weakly_canonical(path);
-    std::string key = normalized.generic_string();
+    std::string key = keyOf(path);
 
-    auto it = textures_.find(key);
-    if (it != textures_.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = textures_.find(key);
+        if (it != textures_.end()) {
+            ++it->second.uses;
+            return it->second.texture;
+        }
     }
 
+    // Load outside the lock so other threads aren't blocked on disk I/O.
     sf::Texture texture;
-    if (!texture.loadFromFile(key)) {
-        throw std::runtime_error("Failed to load texture: " + key);
+    if (headless_) {
+        if (!Vfs::instance().exists(path)) {
+            throw std::runtime_error("Failed to load texture: " + key);
+        }
+    } else {
+        const FileData file = Vfs::instance().read(path);
+        if (!file || !texture.loadFromMemory(file.data(), file.size())) {
+            throw std::runtime_error("Failed to load texture: " + key);
+        }
     }
 
-    auto [insertIt, inserted] = textures_.emplace(std::move(key), std::move(texture));
-    return insertIt->second;
+    // If another thread loaded the same file meanwhile, keep its texture.
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [insertIt, inserted] = textures_.emplace(std::move(key), Entry{std::move(texture), 0});
+    ++insertIt->second.uses;
+    return insertIt->second.texture;
+}
+
+std::size_t TextureManager::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return textures_.size();
+}
+
+bool TextureManager::release(const std::filesystem::path& path) {
+    const std::string key = keyOf(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = textures_.find(key);
+    if (it == textures_.end() || --it->second.uses > 0) {
+        return false;
+    }
+    textures_.erase(it);
+    return true;
 }
 
 void TextureManager::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
     textures_.clear();
 }
 
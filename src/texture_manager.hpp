@@ -2,21 +2,48 @@
 
 #include <SFML/Graphics/Texture.hpp>
 
+#include <cstddef>
 #include <unordered_map>
 #include <string>
 #include <filesystem>
+#include <mutex>
 
-// Manages loading and caching of textures.
+// Manages loading and caching of textures. acquire() may be called from
+// scene-preparation worker threads (see SceneStack::prepareScene).
 class TextureManager {
 public:
+    TextureManager() = default;
+    // Headless: files are still looked up (a missing one still throws), but
+    // nothing is decoded or uploaded, so no GL context is needed. Textures
+    // come back empty (size 0x0).
+    explicit TextureManager(bool headless) : headless_(headless) {}
+
     // Returns a reference to the texture located at the given path.
-    // Loads the texture from disk if it isn't already cached.
+    // Loads the texture through the Vfs if it isn't already cached.
+    // Every call counts as one use of the texture.
     const sf::Texture& acquire(const std::filesystem::path& path);
+    // Gives one use back; the texture is dropped when none is left. Only for
+    // callers that know the texture is no longer drawn (MapCache evicting a
+    // map nobody took). Returns true when it was dropped.
+    bool release(const std::filesystem::path& path);
+
+    bool headless() const { return headless_; }
+    // Number of textures currently cached.
+    std::size_t size() const;
 
     // Clears all cached textures.
     void clear();
 
 private:
-    std::unordered_map<std::string, sf::Texture> textures_;
+    struct Entry {
+        sf::Texture texture;
+        std::size_t uses = 0;
+    };
+
+    static std::string keyOf(const std::filesystem::path& path);
+
+    std::unordered_map<std::string, Entry> textures_;
+    mutable std::mutex mutex_;
+    bool headless_ = false;
 };
 
@@ -1,26 +1,42 @@
 #include "title_scene.hpp"
 #include "map_scene.hpp"
+#include "render_commands.hpp"
+#include "input.hpp"
 #include <memory>
 #include <stdexcept>
 
 TitleScene::TitleScene(SceneStack& stack, TextureManager& textures)
     : stack_(stack), textures_(textures), startText_(font_, "Start", 32) {
-    if (!font_.openFromFile("game/font.ttf")) {
+    fontData_ = Vfs::instance().read("game/font.ttf");
+    if (!fontData_ || !font_.openFromMemory(fontData_.data(), fontData_.size())) {
         throw std::runtime_error("failed to load font game/font.ttf");
     }
     startText_.setPosition({200.f, 150.f});
 }
 
-void TitleScene::handleEvent(const sf::Event& event) {
-    if (const auto* key = event.getIf<sf::Event::KeyPressed>();
-        key && key->code == sf::Keyboard::Key::Enter) {
-        stack_.switchScene(std::make_unique<MapScene>(stack_, textures_));
+void TitleScene::handleEvent(const sf::Event&) {}
+
+void TitleScene::update(float) {
+    // Confirm (Enter/Space) vem do Input para entrar em gravações e replays
+    if (Input::instance().wasPressed(InputAction::Confirm) && !stack_.isTransitioning()) {
+        // O mapa é lido em segundo plano com o título na tela; a MapScene
+        // (Lua, textura de render) é montada na thread principal no commit
+        stack_.prepareScene([&stack = stack_, &textures = textures_]() -> SceneStack::SceneFactory {
+            auto transfer = std::make_shared<MapTransfer>();
+            transfer->tmxPath = MapScene::StartMap;
+            transfer->prepared = MapCache::load(textures, transfer->tmxPath);
+            return [&stack, &textures, transfer] {
+                return std::make_unique<MapScene>(stack, textures, std::move(*transfer));
+            };
+        });
     }
 }
 
-void TitleScene::update(float) {}
+void TitleScene::draw(sf::RenderTarget& target) const {
+    target.draw(startText_);
+}
 
-void TitleScene::draw(sf::RenderWindow& window) const {
-    window.draw(startText_);
+void TitleScene::record(RenderCommandList& commands, float) const {
+    commands.draw(startText_);
 }
 
@@ -3,6 +3,7 @@
 #include "scene.hpp"
 #include "scene_stack.hpp"
 #include "texture_manager.hpp"
+#include "vfs.hpp"
 #include <SFML/Graphics.hpp>
 
 class TitleScene : public Scene {
@@ -11,11 +12,13 @@ public:
 
     void handleEvent(const sf::Event& event) override;
     void update(float deltaTime) override;
-    void draw(sf::RenderWindow& window) const override;
+    void draw(sf::RenderTarget& target) const override;
+    void record(RenderCommandList& commands, float alpha) const override;
 
 private:
     SceneStack& stack_;
     TextureManager& textures_;
+    FileData fontData_; // SFML lê os glifos sob demanda; vive mais que font_
     sf::Font font_;
     sf::Text startText_;
 };
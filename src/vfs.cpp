@@ -0,0 +1,68 @@
+#include "vfs.hpp"
+#include "profiler.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+Vfs& Vfs::instance() {
+    static Vfs vfs;
+    return vfs;
+}
+
+bool Vfs::mount(const std::filesystem::path& archivePath) {
+    auto archive = std::make_unique<Archive>();
+    if (!archive->open(archivePath)) {
+        return false;
+    }
+    std::cout << "[Vfs] " << archivePath.string() << " montado (" << archive->entryCount() << " arquivos)\n";
+    archives_.push_back(std::move(archive));
+    return true;
+}
+
+void Vfs::unmountAll() {
+    archives_.clear();
+}
+
+std::string Vfs::normalize(const std::filesystem::path& path) {
+    std::filesystem::path relative = path;
+    if (relative.is_absolute()) {
+        std::error_code ec;
+        relative = relative.lexically_relative(std::filesystem::current_path(ec));
+    }
+    std::string name = relative.lexically_normal().generic_string();
+    if (name.rfind("./", 0) == 0) {
+        name.erase(0, 2);
+    }
+    return name;
+}
+
+bool Vfs::exists(const std::filesystem::path& path) const {
+    const std::string name = normalize(path);
+    for (auto it = archives_.rbegin(); it != archives_.rend(); ++it) {
+        if ((*it)->find(name)) {
+            return true;
+        }
+    }
+    std::error_code ec;
+    return std::filesystem::is_regular_file(path, ec);
+}
+
+FileData Vfs::read(const std::filesystem::path& path) const {
+    LUMY_PROFILE_SCOPE("Vfs::read");
+    if (!archives_.empty()) {
+        const std::string name = normalize(path);
+        for (auto it = archives_.rbegin(); it != archives_.rend(); ++it) {
+            if (const Archive::Entry* entry = (*it)->find(name)) {
+                return (*it)->read(*entry);
+            }
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return FileData::owned(std::move(bytes));
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "archive.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read access to game data. Paths are looked up in the mounted archives
+// (last mounted first) and then on disk, so a build can ship one game.lpak
+// while development keeps working with the loose game/ directory.
+//
+// Mount archives at startup, before scenes or worker threads read anything;
+// reads are const and safe from several threads at once.
+class Vfs {
+public:
+    static Vfs& instance();
+
+    bool mount(const std::filesystem::path& archivePath);
+    void unmountAll();
+
+    bool exists(const std::filesystem::path& path) const;
+    // Invalid FileData when the file is nowhere to be found.
+    FileData read(const std::filesystem::path& path) const;
+
+    // Archive key for a path: relative to the working directory, '/'
+    // separated, without "." or "..".
+    static std::string normalize(const std::filesystem::path& path);
+
+private:
+    std::vector<std::unique_ptr<Archive>> archives_;
+};
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <nlohmann/json.hpp>
+
+#include "actor_system.hpp"
+#include "map.hpp"
+#include "spatial_grid.hpp"
+#include "texture_manager.hpp"
+
+namespace {
+ActorDesc actorAt(float x, float y, sf::Vector2f velocity = {}) {
+    ActorDesc desc;
+    desc.position = {x, y};
+    desc.velocity = velocity;
+    return desc;
+}
+
+// Folha 24x32 com walk de 3 frames a 10 fps e idle parado no frame 1
+SpriteSheet makeSheet(const char* directions = R"(["down", "left", "right", "up"])") {
+    SpriteSheet sheet;
+    const auto data = nlohmann::json::parse(std::string(R"({
+        "frameWidth": 24, "frameHeight": 32,
+        "directions": )") + directions + R"(,
+        "clips": {
+            "idle": {"frames": [1]},
+            "walk": {"frames": [0, 1, 2], "fps": 10},
+            "wave": {"frames": [3, 4], "fps": 10, "loop": false}
+        }
+    })");
+    EXPECT_TRUE(sheet.loadFromJson(data, nullptr));
+    return sheet;
+}
+} // namespace
+
+TEST(ActorSystem, HandlesSurviveSwapRemoval) {
+    ActorSystem actors;
+    const ActorHandle a = actors.spawn(actorAt(10.f, 10.f));
+    const ActorHandle b = actors.spawn(actorAt(20.f, 20.f));
+    const ActorHandle c = actors.spawn(actorAt(30.f, 30.f));
+
+    EXPECT_TRUE(actors.destroy(a)); // c passa para o índice de a
+    EXPECT_FALSE(actors.alive(a));
+    EXPECT_FALSE(actors.destroy(a));
+    EXPECT_EQ(actors.size(), 2u);
+    EXPECT_EQ(actors.position(b), sf::Vector2f(20.f, 20.f));
+    EXPECT_EQ(actors.position(c), sf::Vector2f(30.f, 30.f));
+
+    // O slot é reutilizado, mas o handle antigo continua inválido
+    const ActorHandle d = actors.spawn(actorAt(40.f, 40.f));
+    EXPECT_EQ(d.slot, a.slot);
+    EXPECT_FALSE(actors.alive(a));
+    EXPECT_TRUE(actors.alive(d));
+
+    actors.clear();
+    EXPECT_EQ(actors.size(), 0u);
+    EXPECT_FALSE(actors.alive(b));
+}
+
+TEST(ActorSystem, MovesAnimatesAndFaces) {
+    ActorSystem actors;
+    const SpriteSheet sheet = makeSheet();
+    ActorDesc desc = actorAt(100.f, 100.f, {-50.f, 10.f});
+    desc.sheet = &sheet;
+    const ActorHandle walker = actors.spawn(desc);
+    const ActorHandle idle = actors.spawn(actorAt(0.f, 0.f));
+
+    for (int i = 0; i < 25; ++i) {
+        actors.update(0.01f);
+    }
+    EXPECT_NEAR(actors.position(walker).x, 87.5f, 1e-3f);
+    EXPECT_NEAR(actors.position(walker).y, 102.5f, 1e-3f);
+    EXPECT_EQ(actors.facing(walker), Facing::Left);
+    EXPECT_EQ(actors.frame(walker), 2); // 0.25 s / 0.1 s
+    EXPECT_EQ(actors.clip(walker), sheet.walkClip());
+    EXPECT_EQ(actors.frame(idle), 0);
+    EXPECT_EQ(actors.facing(idle), Facing::Down);
+
+    actors.setVelocity(walker, {0.f, -30.f});
+    actors.update(0.01f);
+    EXPECT_EQ(actors.facing(walker), Facing::Up);
+}
+
+TEST(ActorSystem, ClipsSwitchWithMovementAndPlay) {
+    const SpriteSheet sheet = makeSheet(R"(["up", "right", "down", "left"])");
+    EXPECT_EQ(sheet.row(Facing::Down), 2);
+    EXPECT_EQ(sheet.row(Facing::Left), 3);
+    ASSERT_NE(sheet.findClip("wave"), SpriteSheet::NoClip);
+    EXPECT_EQ(sheet.findClip("dance"), SpriteSheet::NoClip);
+
+    ActorSystem actors;
+    ActorDesc desc = actorAt(50.f, 50.f);
+    desc.sheet = &sheet;
+    const ActorHandle actor = actors.spawn(desc);
+    EXPECT_EQ(actors.clip(actor), sheet.idleClip());
+    EXPECT_EQ(actors.frame(actor), 1);
+
+    actors.setVelocity(actor, {10.f, 0.f});
+    actors.update(0.05f);
+    EXPECT_EQ(actors.clip(actor), sheet.walkClip());
+    actors.setVelocity(actor, {});
+    actors.update(0.05f);
+    EXPECT_EQ(actors.clip(actor), sheet.idleClip());
+
+    // Clip não-looping segura o último frame e não volta sozinho para idle
+    actors.play(actor, sheet.findClip("wave"));
+    EXPECT_EQ(actors.frame(actor), 3);
+    actors.setVelocity(actor, {10.f, 0.f});
+    for (int i = 0; i < 10; ++i) {
+        actors.update(0.1f);
+    }
+    EXPECT_EQ(actors.clip(actor), sheet.findClip("wave"));
+    EXPECT_EQ(actors.frame(actor), 4);
+    actors.play(actor, sheet.walkClip());
+    actors.setVelocity(actor, {});
+    actors.update(0.1f);
+    EXPECT_EQ(actors.clip(actor), sheet.idleClip());
+}
+
+TEST(ActorSystem, BatchesOnePerSheetWithoutReallocating) {
+    const SpriteSheet villager = makeSheet();
+    const SpriteSheet guard = makeSheet();
+    ActorSystem actors;
+    for (int i = 0; i < 300; ++i) {
+        ActorDesc desc = actorAt(static_cast<float>(i), 10.f, {5.f, 0.f});
+        desc.sheet = i % 3 == 0 ? nullptr : (i % 3 == 1 ? &villager : &guard);
+        actors.spawn(desc);
+    }
+    actors.update(0.25f);
+
+    const auto& batches = actors.buildBatches(1.f);
+    ASSERT_EQ(batches.size(), 3u); // Caixas + duas folhas
+    for (const auto& batch : batches) {
+        EXPECT_EQ(batch.size(), 100u * 6);
+    }
+    // Ator 1: walk frame 2, virado para a direita (linha 2), pés em y = 22
+    const sf::Vertex& topLeft = batches[1][0];
+    EXPECT_EQ(topLeft.texCoords, sf::Vector2f(48.f, 64.f));
+    EXPECT_FLOAT_EQ(batches[1][2].position.y, 10.f + 12.f);
+    EXPECT_FLOAT_EQ(batches[1][2].position.y - topLeft.position.y, 32.f);
+
+    const sf::Vertex* storage[3] = {batches[0].data(), batches[1].data(), batches[2].data()};
+    actors.update(0.1f);
+    actors.buildBatches(0.5f);
+    for (std::size_t s = 0; s < 3; ++s) {
+        EXPECT_EQ(batches[s].data(), storage[s]);
+    }
+}
+
+TEST(ActorSystem, SlidesAlongMapWalls) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    // Coluna 0 é parede: o X para na borda e o Y continua andando
+    ActorSystem actors;
+    const ActorHandle actor = actors.spawn(actorAt(48.f, 64.f, {-100.f, 100.f}));
+    for (int i = 0; i < 10; ++i) {
+        actors.update(0.01f, &map);
+    }
+    EXPECT_GE(actors.position(actor).x - 12.f, 32.f);
+    EXPECT_GT(actors.position(actor).y, 64.f);
+}
+
+TEST(ActorSystem, QueryRadiusUsesCurrentPositions) {
+    ActorSystem actors;
+    const ActorHandle near = actors.spawn(actorAt(100.f, 100.f));
+    const ActorHandle far = actors.spawn(actorAt(500.f, 500.f, {-1000.f, -1000.f}));
+    actors.update(0.f);
+
+    auto found = actors.queryRadius({110.f, 100.f}, 20.f);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0], near);
+
+    actors.update(0.4f); // far chega em (100, 100)
+    found = actors.queryRadius({110.f, 100.f}, 20.f);
+    EXPECT_EQ(found.size(), 2u);
+    EXPECT_NE(std::find(found.begin(), found.end(), far), found.end());
+}
+
+TEST(ActorSystem, QueryRadiusSeesChangesSinceLastUpdate) {
+    ActorSystem actors;
+    const ActorHandle a = actors.spawn(actorAt(100.f, 100.f));
+    const ActorHandle b = actors.spawn(actorAt(300.f, 300.f));
+    actors.update(0.f);
+
+    // b passa para o índice de a, mas continua em (300, 300)
+    ASSERT_TRUE(actors.destroy(a));
+    EXPECT_TRUE(actors.queryRadius({100.f, 100.f}, 20.f).empty());
+    auto found = actors.queryRadius({300.f, 300.f}, 20.f);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0], b);
+
+    // Atores novos e teleportados aparecem sem esperar o próximo update
+    const ActorHandle c = actors.spawn(actorAt(100.f, 100.f));
+    actors.setPosition(b, {110.f, 100.f});
+    found = actors.queryRadius({100.f, 100.f}, 20.f);
+    EXPECT_EQ(found.size(), 2u);
+    EXPECT_NE(std::find(found.begin(), found.end(), b), found.end());
+    EXPECT_NE(std::find(found.begin(), found.end(), c), found.end());
+    EXPECT_TRUE(actors.queryRadius({300.f, 300.f}, 20.f).empty());
+}
+
+TEST(SpatialGrid, MatchesBruteForce) {
+    std::vector<float> xs, ys;
+    for (int i = 0; i < 500; ++i) {
+        xs.push_back(static_cast<float>((i * 37) % 1000));
+        ys.push_back(static_cast<float>((i * 91) % 700));
+    }
+    SpatialGrid grid(32.f);
+    grid.build(xs.data(), ys.data(), xs.size());
+
+    const sf::Vector2f center{400.f, 300.f};
+    const float radius = 90.f;
+    auto found = grid.queryRadius(center, radius);
+    std::sort(found.begin(), found.end());
+
+    std::vector<std::uint32_t> expected;
+    for (std::uint32_t i = 0; i < xs.size(); ++i) {
+        const float dx = xs[i] - center.x;
+        const float dy = ys[i] - center.y;
+        if (dx * dx + dy * dy <= radius * radius) {
+            expected.push_back(i);
+        }
+    }
+    EXPECT_EQ(found, expected);
+    EXPECT_FALSE(expected.empty());
+}
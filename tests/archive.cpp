@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "archive.hpp"
+#include "vfs.hpp"
+
+namespace {
+std::vector<std::uint8_t> bytesOf(const std::string& text) {
+    return {text.begin(), text.end()};
+}
+
+struct TempDir {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "lumy_archive_test";
+
+    TempDir() {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+    ~TempDir() {
+        Vfs::instance().unmountAll();
+        std::filesystem::remove_all(dir);
+    }
+};
+} // namespace
+
+TEST(Archive, RoundTripsCompressedAndRawEntries) {
+    TempDir temp;
+    const std::string repeated(4096, 'a');
+    const std::string noise = "xq9!Lz";
+    std::vector<Archive::Source> sources;
+    sources.push_back({"game/maps/a.tmx", bytesOf(repeated), true});
+    sources.push_back({"game/fonts/f.ttf", bytesOf(repeated), false});
+    sources.push_back({"game/data/n.json", bytesOf(noise), true});
+    sources.push_back({"game/empty.txt", {}, true});
+    ASSERT_TRUE(Archive::write(temp.dir / "test.lpak", std::move(sources)));
+
+    Archive archive;
+    ASSERT_TRUE(archive.open(temp.dir / "test.lpak"));
+    EXPECT_EQ(archive.entryCount(), 4u);
+
+    const Archive::Entry* packed = archive.find("game/maps/a.tmx");
+    ASSERT_NE(packed, nullptr);
+    EXPECT_EQ(packed->compression, Archive::Compression::Lz4);
+    EXPECT_LT(packed->storedSize, packed->size);
+    EXPECT_EQ(archive.read(*packed).text(), repeated);
+
+    // Sem compressão: a leitura aponta direto para o mapeamento
+    const Archive::Entry* raw = archive.find("game/fonts/f.ttf");
+    ASSERT_NE(raw, nullptr);
+    EXPECT_EQ(raw->compression, Archive::Compression::None);
+    EXPECT_EQ(archive.read(*raw).text(), repeated);
+
+    // LZ4 não compensa em poucos bytes: fica cru
+    const Archive::Entry* small = archive.find("game/data/n.json");
+    ASSERT_NE(small, nullptr);
+    EXPECT_EQ(small->compression, Archive::Compression::None);
+    EXPECT_EQ(archive.read(*small).text(), noise);
+
+    const Archive::Entry* empty = archive.find("game/empty.txt");
+    ASSERT_NE(empty, nullptr);
+    FileData emptyData = archive.read(*empty);
+    EXPECT_TRUE(emptyData.valid());
+    EXPECT_EQ(emptyData.size(), 0u);
+
+    EXPECT_EQ(archive.find("game/maps/b.tmx"), nullptr);
+    EXPECT_EQ(archive.find("game/maps"), nullptr);
+}
+
+TEST(Archive, EntriesAreAlignedAndSortedByHash) {
+    TempDir temp;
+    std::vector<Archive::Source> sources;
+    for (int i = 0; i < 32; ++i) {
+        sources.push_back({"game/file" + std::to_string(i), bytesOf(std::string(static_cast<std::size_t>(i) * 7 + 1, 'x')), false});
+    }
+    ASSERT_TRUE(Archive::write(temp.dir / "test.lpak", std::move(sources)));
+
+    Archive archive;
+    ASSERT_TRUE(archive.open(temp.dir / "test.lpak"));
+    ASSERT_EQ(archive.entryCount(), 32u);
+    for (std::size_t i = 0; i < archive.entryCount(); ++i) {
+        const Archive::Entry& entry = archive.entryAt(i);
+        EXPECT_EQ(entry.offset % Archive::Alignment, 0u);
+        EXPECT_EQ(entry.hash, Archive::hashName(archive.nameOf(entry)));
+        if (i > 0) {
+            EXPECT_LE(archive.entryAt(i - 1).hash, entry.hash);
+        }
+        EXPECT_EQ(archive.find(archive.nameOf(entry)), &entry);
+    }
+}
+
+TEST(Archive, RejectsDuplicatesAndCorruptFiles) {
+    TempDir temp;
+    std::vector<Archive::Source> sources;
+    sources.push_back({"game/a", bytesOf("1"), true});
+    sources.push_back({"game/a", bytesOf("2"), true});
+    EXPECT_FALSE(Archive::write(temp.dir / "dup.lpak", std::move(sources)));
+
+    std::ofstream(temp.dir / "bad.lpak", std::ios::binary) << "LPAK isto não é um índice";
+    Archive archive;
+    EXPECT_FALSE(archive.open(temp.dir / "bad.lpak"));
+    EXPECT_FALSE(archive.isOpen());
+    EXPECT_FALSE(archive.open(temp.dir / "missing.lpak"));
+}
+
+TEST(Vfs, NormalizesPaths) {
+    EXPECT_EQ(Vfs::normalize("game/maps/../data/x.json"), "game/data/x.json");
+    EXPECT_EQ(Vfs::normalize("./game/x.png"), "game/x.png");
+    EXPECT_EQ(Vfs::normalize(std::filesystem::current_path() / "game" / "x.png"), "game/x.png");
+}
+
+TEST(Vfs, ArchiveWinsOverDiskAndDiskIsTheFallback) {
+    TempDir temp;
+    const std::filesystem::path loose = temp.dir / "loose.txt";
+    std::ofstream(loose) << "disco";
+    const std::string packedName = Vfs::normalize(loose);
+
+    std::vector<Archive::Source> sources;
+    sources.push_back({packedName, bytesOf("pacote"), true});
+    sources.push_back({"game/only_packed.txt", bytesOf("só no pacote"), true});
+    ASSERT_TRUE(Archive::write(temp.dir / "test.lpak", std::move(sources)));
+
+    Vfs& vfs = Vfs::instance();
+    EXPECT_EQ(vfs.read(loose).text(), "disco");
+    EXPECT_FALSE(vfs.exists("game/only_packed.txt"));
+
+    ASSERT_TRUE(vfs.mount(temp.dir / "test.lpak"));
+    EXPECT_EQ(vfs.read(loose).text(), "pacote");
+    EXPECT_TRUE(vfs.exists("game/only_packed.txt"));
+    EXPECT_EQ(vfs.read("./game/maps/../only_packed.txt").text(), "só no pacote");
+    // Fora do pacote continua vindo do disco
+    EXPECT_TRUE(vfs.read("game/data/system.json").valid());
+    EXPECT_FALSE(vfs.read("game/nao_existe.txt").valid());
+
+    vfs.unmountAll();
+    EXPECT_EQ(vfs.read(loose).text(), "disco");
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "battle.hpp"
+
+namespace {
+// Database de game/data, com o cache fora do projeto
+const Database& gameDatabase() {
+    static Database db = [] {
+        Database loaded;
+        loaded.load("game/data", std::filesystem::temp_directory_path() / "lumy_battle_test.ldb");
+        return loaded;
+    }();
+    return db;
+}
+
+DamageFormula::Fields makeFields(float atk, float def, float mat, float hp) {
+    DamageFormula::Fields fields{};
+    fields[static_cast<std::size_t>(DamageFormula::Field::Atk)] = atk;
+    fields[static_cast<std::size_t>(DamageFormula::Field::Def)] = def;
+    fields[static_cast<std::size_t>(DamageFormula::Field::Mat)] = mat;
+    fields[static_cast<std::size_t>(DamageFormula::Field::Hp)] = hp;
+    return fields;
+}
+
+BattleSetup heroAgainst(std::vector<std::int32_t> troop, std::int32_t level) {
+    BattleSetup setup;
+    setup.party.push_back({1, level});
+    setup.troop = std::move(troop);
+    return setup;
+}
+} // namespace
+
+TEST(DamageFormula, EvaluatesArithmeticOnBothBattlers) {
+    const auto a = makeFields(20.f, 5.f, 8.f, 40.f);
+    const auto b = makeFields(10.f, 6.f, 3.f, 25.f);
+
+    EXPECT_FLOAT_EQ(DamageFormula::compile("a.atk * 4 - b.def * 2").evaluate(a, b), 68.f);
+    EXPECT_FLOAT_EQ(DamageFormula::compile("(a.mat + 2) * -2 / 4").evaluate(a, b), -5.f);
+    EXPECT_FLOAT_EQ(DamageFormula::compile("Math.max(a.atk - b.atk * 3, 1)").evaluate(a, b), 1.f);
+    EXPECT_FLOAT_EQ(DamageFormula::compile("floor(b.hp / 2) + min(a.def, b.def)").evaluate(a, b), 17.f);
+    EXPECT_FLOAT_EQ(DamageFormula::compile("a.atk / 0").evaluate(a, b), 0.f);
+
+    // Fórmulas inválidas viram vazias (dano 0) e dizem o motivo
+    for (const char* text : {"a.foo * 2", "a.atk *", "(a.atk", "c.atk", "rand(3)", "a.atk 2"}) {
+        std::string error;
+        const DamageFormula formula = DamageFormula::compile(text, &error);
+        EXPECT_TRUE(formula.empty()) << text;
+        EXPECT_FALSE(error.empty()) << text;
+        EXPECT_FLOAT_EQ(formula.evaluate(a, b), 0.f);
+    }
+}
+
+TEST(Battle, SameSeedPlaysTheSameBattle) {
+    const BattleRules rules(gameDatabase());
+    const BattleSetup setup = heroAgainst({1, 2}, 5);
+
+    std::vector<BattleEvent> first;
+    std::vector<BattleEvent> second;
+    Battle battle(rules);
+    battle.setLog(&first);
+    battle.reset(setup, 1234);
+    const BattleOutcome outcome = battle.run();
+    const int turns = battle.turn();
+    EXPECT_NE(outcome, BattleOutcome::Ongoing);
+    ASSERT_FALSE(first.empty());
+
+    battle.setLog(&second);
+    battle.reset(setup, 1234);
+    EXPECT_EQ(battle.run(), outcome);
+    EXPECT_EQ(battle.turn(), turns);
+    ASSERT_EQ(second.size(), first.size());
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(second[i].user, first[i].user);
+        EXPECT_EQ(second[i].target, first[i].target);
+        EXPECT_EQ(second[i].skillId, first[i].skillId);
+        EXPECT_EQ(second[i].value, first[i].value);
+    }
+}
+
+TEST(Battle, ChosenActionAndElementRates) {
+    const Database& db = gameDatabase();
+    const BattleRules rules(db);
+    Battle battle(rules);
+    std::vector<BattleEvent> log;
+    battle.setLog(&log);
+
+    // Herói nível 99 contra o Mago Sombrio (resiste a fogo): Bola de Fogo
+    // drena todo o MP do mago quando acerta
+    battle.reset(heroAgainst({3}, 99), 7);
+    ASSERT_EQ(battle.partySize(), 1u);
+    ASSERT_EQ(battle.troopSize(), 1u);
+    battle.setAction(0, 3, 1);
+    battle.playTurn();
+    ASSERT_FALSE(log.empty());
+    const auto fireball = log.begin(); // Herói com AGI muito maior age primeiro
+    EXPECT_EQ(fireball->skillId, 3);
+    EXPECT_EQ(fireball->user, 0);
+    EXPECT_EQ(fireball->target, 1);
+    if (fireball->hit) {
+        EXPECT_EQ(battle.mp(1), 0);
+        EXPECT_EQ(fireball->value, db.enemies()[3].params[1]);
+    }
+
+    // Sem escolha, o herói ataca sozinho e vence
+    EXPECT_EQ(battle.run(), BattleOutcome::Victory);
+    EXPECT_FALSE(battle.alive(1));
+    EXPECT_TRUE(battle.hasState(1, DeathStateId));
+    EXPECT_EQ(battle.hp(1), 0);
+}
+
+TEST(Battle, TimeoutAfterMaxTurns) {
+    const BattleRules rules(gameDatabase());
+    BattleSetup setup = heroAgainst({2, 2, 2}, 1);
+    setup.maxTurns = 1;
+    Battle battle(rules);
+    battle.reset(setup, 99);
+    EXPECT_FALSE(battle.playTurn());
+    EXPECT_EQ(battle.turn(), 1);
+    EXPECT_NE(battle.outcome(), BattleOutcome::Ongoing);
+    EXPECT_NE(battle.outcome(), BattleOutcome::Victory);
+    EXPECT_FALSE(battle.playTurn());
+
+    // Lados vazios decidem na hora
+    battle.reset(heroAgainst({}, 1), 1);
+    EXPECT_EQ(battle.outcome(), BattleOutcome::Victory);
+    battle.reset(heroAgainst({1}, 1000), 1);
+    EXPECT_EQ(battle.partySize(), 1u); // Nível limitado ao maxLevel
+    battle.reset(BattleSetup{{}, {1}, 100}, 1);
+    EXPECT_EQ(battle.outcome(), BattleOutcome::Defeat);
+}
+
+TEST(Battle, HugeFormulaIsCappedBeforeVariance) {
+    // Cópia de game/data em que o ataque dá um dano fora de qualquer inteiro
+    const auto dir = std::filesystem::temp_directory_path() / "lumy_battle_huge";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    for (const auto& entry : std::filesystem::directory_iterator("game/data")) {
+        std::filesystem::copy_file(entry.path(), dir / entry.path().filename());
+    }
+    nlohmann::json skills;
+    std::ifstream("game/data/skills.json") >> skills;
+    for (auto& skill : skills["skills"]) {
+        if (skill["id"] == 1) {
+            skill["damage"]["formula"] = "a.mhp * 1000000000000";
+        }
+    }
+    std::ofstream(dir / "skills.json") << skills.dump();
+
+    Database db;
+    ASSERT_TRUE(db.load(dir));
+    const BattleRules rules(db);
+    Battle battle(rules);
+    std::vector<BattleEvent> log;
+    battle.setLog(&log);
+    battle.reset(heroAgainst({1}, 99), 3);
+    battle.setAction(0, 1, 1);
+    battle.playTurn();
+    const auto attack = std::find_if(log.begin(), log.end(),
+                                     [](const BattleEvent& event) { return event.user == 0 && event.hit; });
+    if (attack != log.end()) {
+        EXPECT_GT(attack->value, 0);
+        EXPECT_LE(attack->value, 9999);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(BattleSimulation, ReportDoesNotDependOnThreadCount) {
+    const Database& db = gameDatabase();
+    const BattleRules rules(db);
+    const BattleSetup setup = heroAgainst({1, 3}, 4);
+
+    SimulationOptions options;
+    options.battles = 2000;
+    options.seed = 42;
+    options.threads = 1;
+    const BattleReport single = simulateBattles(rules, setup, options);
+    options.threads = 4;
+    const BattleReport parallel = simulateBattles(rules, setup, options);
+
+    EXPECT_EQ(single.battles, 2000u);
+    EXPECT_EQ(single.victories + single.defeats + single.timeouts, single.battles);
+    EXPECT_EQ(parallel.victories, single.victories);
+    EXPECT_EQ(parallel.defeats, single.defeats);
+    EXPECT_EQ(parallel.turns.counts(), single.turns.counts());
+    EXPECT_EQ(parallel.partyHpLeft.counts(), single.partyHpLeft.counts());
+
+    const SkillStats& attack = single.partySkills.at(static_cast<std::size_t>(db.system().attackSkillId));
+    EXPECT_GT(attack.uses, 0u);
+    EXPECT_EQ(attack.damage.count() + attack.misses, parallel.partySkills[1].damage.count() + parallel.partySkills[1].misses);
+    EXPECT_EQ(attack.damage.counts(), parallel.partySkills[1].damage.counts());
+    EXPECT_GT(single.troopSkills.at(3).uses, 0u); // Bola de Fogo do mago
+
+    // Outra semente, outras batalhas
+    options.seed = 43;
+    const BattleReport other = simulateBattles(rules, setup, options);
+    EXPECT_NE(other.turns.counts(), single.turns.counts());
+}
+
+TEST(BattleSimulation, StrongPartyAlwaysWins) {
+    const BattleRules rules(gameDatabase());
+    SimulationOptions options;
+    options.battles = 500;
+    const BattleReport report = simulateBattles(rules, heroAgainst({1, 2, 3}, 99), options);
+    EXPECT_EQ(report.victories, 500u);
+    EXPECT_DOUBLE_EQ(report.winRate(), 1.0);
+    EXPECT_GE(report.turns.min(), 1u);
+    EXPECT_LE(report.turns.percentile(0.5), report.turns.max());
+}
+
+TEST(Histogram, PercentilesAndMerge) {
+    Histogram a;
+    Histogram b;
+    for (std::uint32_t v : {1u, 2u, 2u, 3u}) {
+        a.add(v);
+    }
+    b.add(10);
+    a.merge(b);
+    EXPECT_EQ(a.count(), 5u);
+    EXPECT_EQ(a.min(), 1u);
+    EXPECT_EQ(a.max(), 10u);
+    EXPECT_DOUBLE_EQ(a.mean(), 18.0 / 5.0);
+    EXPECT_EQ(a.percentile(0.5), 2u);
+    EXPECT_EQ(a.percentile(0.8), 3u);
+    EXPECT_EQ(a.percentile(1.0), 10u);
+    EXPECT_EQ(Histogram{}.percentile(0.5), 0u);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "camera.hpp"
+
+namespace {
+const sf::FloatRect World{{0.f, 0.f}, {1600.f, 960.f}};
+} // namespace
+
+TEST(Camera, TargetInsideDeadzoneDoesNotMoveCamera) {
+    Camera camera({640.f, 360.f});
+    camera.setWorldBounds(World);
+    camera.setDeadzone({64.f, 48.f});
+    camera.snapTo({800.f, 480.f});
+
+    camera.update({830.f, 500.f}, 1.f / 60.f);
+    EXPECT_FLOAT_EQ(camera.center().x, 800.f);
+    EXPECT_FLOAT_EQ(camera.center().y, 480.f);
+
+    // Saindo da zona morta, a câmera anda só o que passou da borda
+    camera.update({900.f, 480.f}, 1.f / 60.f);
+    EXPECT_FLOAT_EQ(camera.center().x, 900.f - 32.f);
+    EXPECT_FLOAT_EQ(camera.center().y, 480.f);
+}
+
+TEST(Camera, ClampsToWorldBounds) {
+    Camera camera({640.f, 360.f});
+    camera.setWorldBounds(World);
+
+    camera.snapTo({0.f, 0.f});
+    EXPECT_FLOAT_EQ(camera.center().x, 320.f);
+    EXPECT_FLOAT_EQ(camera.center().y, 180.f);
+
+    camera.snapTo({5000.f, 5000.f});
+    const sf::FloatRect visible = camera.visibleRect();
+    EXPECT_FLOAT_EQ(visible.position.x + visible.size.x, World.size.x);
+    EXPECT_FLOAT_EQ(visible.position.y + visible.size.y, World.size.y);
+
+    // Mundo menor que a view: centralizado
+    camera.setWorldBounds({{0.f, 0.f}, {400.f, 200.f}});
+    camera.snapTo({0.f, 0.f});
+    EXPECT_FLOAT_EQ(camera.center().x, 200.f);
+    EXPECT_FLOAT_EQ(camera.center().y, 100.f);
+}
+
+TEST(Camera, SmoothingIsFrameRateIndependent) {
+    Camera a({640.f, 360.f});
+    Camera b({640.f, 360.f});
+    for (Camera* camera : {&a, &b}) {
+        camera->setWorldBounds(World);
+        camera->setSmoothing(0.1f);
+        camera->snapTo({400.f, 300.f});
+    }
+
+    // Meia-vida: depois de 0,1 s falta metade do caminho
+    a.update({800.f, 300.f}, 0.1f);
+    EXPECT_NEAR(a.center().x, 600.f, 0.01f);
+
+    for (int i = 0; i < 2; ++i) {
+        b.update({800.f, 300.f}, 0.05f);
+    }
+    EXPECT_NEAR(a.center().x, b.center().x, 0.01f);
+
+    for (int i = 0; i < 120; ++i) {
+        a.update({800.f, 300.f}, 1.f / 60.f);
+    }
+    EXPECT_NEAR(a.center().x, 800.f, 0.1f);
+}
+
+TEST(Camera, ViewIsInterpolatedAndPixelAligned) {
+    Camera camera({640.f, 360.f});
+    camera.setWorldBounds(World);
+    camera.snapTo({400.f, 300.f});
+    camera.update({500.3f, 300.f}, 1.f / 60.f);
+
+    const sf::FloatRect half = camera.visibleRect(0.5f);
+    EXPECT_FLOAT_EQ(half.position.x, std::round(450.15f - 320.f));
+    EXPECT_FLOAT_EQ(half.position.x, std::floor(half.position.x));
+    EXPECT_FLOAT_EQ(half.size.x, 640.f);
+
+    const sf::View view = camera.view(1.f);
+    EXPECT_FLOAT_EQ(view.getCenter().x - view.getSize().x / 2.f, std::round(500.3f - 320.f));
+}
+
+TEST(LowResTarget, IntegerScaleWithLetterbox) {
+    const sf::Vector2u internal{640, 360};
+    EXPECT_FLOAT_EQ(LowResTarget::scaleFor(internal, {640, 360}), 1.f);
+    EXPECT_FLOAT_EQ(LowResTarget::scaleFor(internal, {1920, 1080}), 3.f);
+    EXPECT_FLOAT_EQ(LowResTarget::scaleFor(internal, {3840, 2160}), 6.f);
+    // 1600x900 daria 2,5: fica 2 com bordas
+    EXPECT_FLOAT_EQ(LowResTarget::scaleFor(internal, {1600, 900}), 2.f);
+    // Janela menor que a resolução interna: reduz para caber
+    EXPECT_FLOAT_EQ(LowResTarget::scaleFor(internal, {320, 180}), 0.5f);
+
+    const sf::FloatRect area = LowResTarget::viewportFor(internal, {1600, 900});
+    EXPECT_FLOAT_EQ(area.position.x, 160.f);
+    EXPECT_FLOAT_EQ(area.position.y, 90.f);
+    EXPECT_FLOAT_EQ(area.size.x, 1280.f);
+
+    const LowResTarget target(internal);
+    const sf::Vector2f pixel = target.toInternal({160 + 200, 90 + 100}, {1600, 900});
+    EXPECT_FLOAT_EQ(pixel.x, 100.f);
+    EXPECT_FLOAT_EQ(pixel.y, 50.f);
+}
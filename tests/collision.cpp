@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "map.hpp"
+#include "render_commands.hpp"
 #include "texture_manager.hpp"
 
 TEST(Collision, BlocksMovementIntoWall) {
@@ -21,3 +22,32 @@ TEST(Collision, BlocksMovementIntoWall) {
     EXPECT_FLOAT_EQ(pos.x, 0.f);
     EXPECT_FLOAT_EQ(pos.y, 0.f);
 }
+
+TEST(Collision, SetTileIdOnEmptyTileUpdatesVisibleQuads) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    // Interior do mapa está vazio: nada a gravar numa área só de chão
+    const sf::FloatRect interior{{160.f, 160.f}, {96.f, 96.f}};
+    RenderCommandList commands;
+    map.recordRange(0, map.getLayerCount(), commands, interior);
+    EXPECT_TRUE(commands.empty());
+
+    // Tile novo numa posição vazia ganha um quad (e colisão)
+    map.setTileID(0, 6, 6, 1);
+    EXPECT_TRUE(map.isCollidable(6, 6));
+    map.recordRange(0, map.getLayerCount(), commands, interior);
+    EXPECT_EQ(commands.size(), 1u);
+
+    // Apagar remove o quad de novo
+    commands.clear();
+    map.setTileID(0, 6, 6, 0);
+    EXPECT_FALSE(map.isCollidable(6, 6));
+    map.recordRange(0, map.getLayerCount(), commands, interior);
+    EXPECT_TRUE(commands.empty());
+
+    // Borda continua visível
+    map.recordRange(0, map.getLayerCount(), commands, sf::FloatRect{{0.f, 0.f}, {64.f, 64.f}});
+    EXPECT_EQ(commands.size(), 1u);
+}
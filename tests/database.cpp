@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "database.hpp"
+
+namespace {
+// Cópia de game/data em um diretório temporário, com o cache ao lado
+struct DataCopy {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "lumy_database_test";
+    std::filesystem::path data = dir / "data";
+    std::filesystem::path cache = dir / "cache" / "database.ldb";
+
+    DataCopy() {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(data);
+        for (const auto& entry : std::filesystem::directory_iterator("game/data")) {
+            std::filesystem::copy_file(entry.path(), data / entry.path().filename());
+        }
+    }
+    ~DataCopy() { std::filesystem::remove_all(dir); }
+};
+
+void expectGameData(const Database& db) {
+    const ActorData* hero = db.actors().find(1);
+    ASSERT_NE(hero, nullptr);
+    EXPECT_EQ(db.text(hero->name), "Hero");
+    EXPECT_EQ(hero->maxLevel, 99);
+    EXPECT_EQ(db.actorParams(*hero, 1)[0], 10);
+    EXPECT_EQ(db.actorParams(*hero, 5)[0], 16);
+    EXPECT_EQ(db.actorParams(*hero, 6)[0], 18); // Último passo (+2) repetido
+    EXPECT_EQ(db.expForLevel(*hero, 5), 300);
+    EXPECT_EQ(db.expForLevel(*hero, 6), 450); // Passos 30, 60, 90, 120 -> 150
+    EXPECT_EQ(db.actorParams(*hero, 500), db.actorParams(*hero, 99));
+    EXPECT_EQ(db.actors().find(2), nullptr);
+
+    const ItemData* sword = db.items().find(2);
+    ASSERT_NE(sword, nullptr);
+    EXPECT_EQ(sword->type, ItemType::Weapon);
+    EXPECT_EQ(sword->params[1], 10);
+    const ItemData* potion = db.items().find(1);
+    ASSERT_NE(potion, nullptr);
+    ASSERT_EQ(db.effects(potion->effects).size(), 1u);
+    EXPECT_EQ(db.effects(potion->effects)[0].code, 11);
+
+    const SkillData* attack = db.skills().find(db.system().attackSkillId);
+    ASSERT_NE(attack, nullptr);
+    EXPECT_EQ(db.text(attack->damage.formula), "a.atk * 4 - b.def * 2");
+
+    const EnemyData* mage = db.enemies().find(3);
+    ASSERT_NE(mage, nullptr);
+    EXPECT_EQ(db.actions(mage->actions).size(), 2u);
+    EXPECT_EQ(db.actions(mage->actions)[1].skillId, 3);
+    EXPECT_EQ(db.drops(mage->drops)[0].denominator, 2);
+
+    const StateData* poison = db.states().find(2);
+    ASSERT_NE(poison, nullptr);
+    EXPECT_EQ(db.text(poison->messages[2]), "%1 se recuperou do veneno.");
+    EXPECT_FLOAT_EQ(db.traits(poison->traits)[0].value, -10.f);
+
+    const auto switches = db.texts(db.system().switchNames);
+    ASSERT_EQ(switches.size(), 6u); // Id 0 vazio
+    EXPECT_EQ(db.text(switches[5]), "Boss Derrotado");
+    EXPECT_EQ(db.text(db.system().gameTitle), "Lumy - Hello Town");
+    EXPECT_EQ(db.ids(db.system().partyMembers)[0], 1);
+}
+} // namespace
+
+TEST(Database, LoadsJsonIntoTables) {
+    DataCopy copy;
+    Database db;
+    ASSERT_TRUE(db.load(copy.data, copy.cache));
+    EXPECT_FALSE(db.loadedFromCache());
+    expectGameData(db);
+}
+
+TEST(Database, SecondLoadComesFromCache) {
+    DataCopy copy;
+    Database first;
+    ASSERT_TRUE(first.load(copy.data, copy.cache));
+    ASSERT_TRUE(std::filesystem::exists(copy.cache));
+
+    Database second;
+    ASSERT_TRUE(second.load(copy.data, copy.cache));
+    EXPECT_TRUE(second.loadedFromCache());
+    EXPECT_EQ(second.sourceHash(), first.sourceHash());
+    expectGameData(second);
+}
+
+TEST(Database, EditedSourceInvalidatesCache) {
+    DataCopy copy;
+    Database db;
+    ASSERT_TRUE(db.load(copy.data, copy.cache));
+
+    std::ofstream(copy.data / "items.json", std::ios::app) << "\n";
+    ASSERT_TRUE(db.load(copy.data, copy.cache));
+    EXPECT_FALSE(db.loadedFromCache());
+
+    // Cache truncado: volta ao JSON em vez de ler lixo
+    std::filesystem::resize_file(copy.cache, std::filesystem::file_size(copy.cache) / 2);
+    ASSERT_TRUE(db.load(copy.data, copy.cache));
+    EXPECT_FALSE(db.loadedFromCache());
+    expectGameData(db);
+}
+
+TEST(Database, RejectsIdsAboveTheTableLimit) {
+    DataCopy copy;
+    Database db;
+    // Um id digitado errado não pode virar uma alocação de gigabytes
+    std::ofstream(copy.data / "states.json") << R"({"states": [{"id": 2000000000, "name": "x"}]})";
+    EXPECT_FALSE(db.load(copy.data, copy.cache));
+
+    std::filesystem::copy_file("game/data/states.json", copy.data / "states.json",
+                               std::filesystem::copy_options::overwrite_existing);
+    ASSERT_TRUE(db.load(copy.data, copy.cache));
+    std::ofstream(copy.data / "system.json") << R"({"system": {"switches": {"1": "a", "2000000000": "b"}}})";
+    EXPECT_FALSE(db.load(copy.data, copy.cache));
+}
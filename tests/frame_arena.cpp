@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_arena.hpp"
+#include "profiler.hpp"
+#include "render_commands.hpp"
+
+TEST(FrameArena, BumpsUntilResetAndGrowsAfterOverflow) {
+    FrameArena arena(1024);
+    {
+        std::pmr::vector<std::uint64_t> values(&arena);
+        values.reserve(16);
+        for (std::uint64_t i = 0; i < 16; ++i) {
+            values.push_back(i);
+        }
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(values.data()) % alignof(std::uint64_t), 0u);
+    }
+    EXPECT_EQ(arena.used(), 16 * sizeof(std::uint64_t)); // Desalocar não devolve nada
+    EXPECT_EQ(arena.overflows(), 0u);
+
+    // Passa do bloco: o excesso vem do heap até o reset
+    void* big = arena.allocate(4096, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big) % 64, 0u);
+    EXPECT_EQ(arena.overflows(), 1u);
+
+    // No frame seguinte o bloco já comporta o pico
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_GE(arena.capacity(), arena.peak());
+    EXPECT_NE(arena.allocate(4096, 64), nullptr);
+    EXPECT_NE(arena.allocate(128, 8), nullptr);
+    EXPECT_EQ(arena.overflows(), 0u);
+}
+
+#if defined(LUMY_PROFILER)
+
+TEST(FrameArena, SteadyFrameDoesNotTouchTheHeap) {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+
+    const auto frame = [] {
+        frameArena().reset();
+        std::pmr::vector<int> scratch(&frameArena());
+        for (int i = 0; i < 256; ++i) {
+            scratch.push_back(i);
+        }
+        std::pmr::string label("texto longo o bastante para não caber no SSO", &frameArena());
+        LUMY_PROFILE_FRAME();
+    };
+    frame();
+    frame(); // Arena já do tamanho do pico
+    const Profiler::FrameMemory steady = profiler.lastFrameMemory();
+    EXPECT_EQ(steady.heapAllocations, 0u);
+    EXPECT_GT(steady.arenaBytes, 256 * sizeof(int));
+    EXPECT_EQ(steady.arenaOverflows, 0u);
+
+    // Alocações comuns aparecem na contagem. Guardadas fora do bloco: um par
+    // new/delete que não escapa pode ser removido pelo otimizador (-O3)
+    std::vector<std::unique_ptr<int>> kept;
+    kept.reserve(2);
+    frameArena().reset();
+    LUMY_PROFILE_FRAME();
+    kept.push_back(std::make_unique<int>(1));
+    kept.push_back(std::make_unique<int>(2));
+    void* volatile raw = ::operator new(64 * sizeof(int));
+    ::operator delete(raw);
+    LUMY_PROFILE_FRAME();
+    EXPECT_EQ(profiler.lastFrameMemory().heapAllocations, 3u);
+    EXPECT_GE(profiler.lastFrameMemory().heapBytes, 2 * sizeof(int) + 64 * sizeof(int));
+    EXPECT_EQ(*kept[1], 2);
+}
+
+TEST(FrameArena, DestroyingAfterOverflowDoesNotGrow) {
+    auto arena = std::make_unique<FrameArena>(64);
+    void* volatile big = arena->allocate(1 << 20, 16);
+    ASSERT_NE(big, nullptr);
+    EXPECT_EQ(arena->overflows(), 1u);
+
+    // Só libera o excesso: nada de bloco novo do tamanho do pico na saída
+    const std::uint64_t before = Profiler::threadAllocations();
+    arena.reset();
+    EXPECT_EQ(Profiler::threadAllocations(), before);
+}
+
+#endif
+
+TEST(FrameArena, SnapshotPoolRecyclesReleasedBuffers) {
+    VertexSnapshotPool pool;
+    const std::vector<sf::Vertex> quad(6);
+    RenderCommandList list;
+    list.draw(pool.share(quad), sf::PrimitiveType::Triangles);
+    list.draw(pool.share(quad), sf::PrimitiveType::Triangles);
+    EXPECT_EQ(pool.size(), 2u); // Os dois ainda estão na lista
+
+    // Lista consumida: os mesmos buffers voltam, sem alocar
+    list.clear();
+    list.draw(pool.share(quad), sf::PrimitiveType::Triangles);
+    list.draw(pool.share(quad), sf::PrimitiveType::Triangles);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(list.size(), 2u);
+}
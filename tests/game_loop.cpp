@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "game_loop.hpp"
+#include "input.hpp"
+#include "render_commands.hpp"
+#include "scene_stack.hpp"
+
+TEST(FixedTimestep, AccumulatesPartialFrames) {
+    FixedTimestep timestep(0.01f, 5);
+
+    EXPECT_EQ(timestep.advance(0.004f), 0);
+    EXPECT_NEAR(timestep.alpha(), 0.4f, 1e-4f);
+
+    EXPECT_EQ(timestep.advance(0.017f), 2);
+    EXPECT_NEAR(timestep.alpha(), 0.1f, 1e-4f);
+    EXPECT_EQ(timestep.droppedSteps(), 0);
+}
+
+TEST(FixedTimestep, DropsBacklogBeyondMaxSteps) {
+    FixedTimestep timestep(0.01f, 3);
+
+    // A 1 s hitch must not make the next frames run 100 updates
+    EXPECT_EQ(timestep.advance(1.0f), 3);
+    EXPECT_EQ(timestep.droppedSteps(), 97);
+    EXPECT_LT(timestep.alpha(), 1.f);
+
+    EXPECT_EQ(timestep.advance(0.01f), 1);
+    EXPECT_EQ(timestep.droppedSteps(), 0);
+}
+
+namespace {
+class CountingScene : public Scene {
+public:
+    void handleEvent(const sf::Event&) override {}
+    void update(float) override { ++updates; }
+    void draw(sf::RenderTarget&) const override {}
+    void record(RenderCommandList& commands, float) const override {
+        ++records;
+        commands.fillScreen(sf::Color::Black);
+    }
+
+    int updates = 0;
+    mutable int records = 0;
+};
+} // namespace
+
+TEST(Headless, RunsFixedStepsIntoNullTarget) {
+    SceneStack stack;
+    auto scene = std::make_unique<CountingScene>();
+    const CountingScene* counting = scene.get();
+    stack.pushScene(std::move(scene));
+    Input::instance().startIdle(0);
+
+    HeadlessConfig config;
+    config.maxSteps = 30;
+    config.recordFrames = true; // Gravado e descartado, sem GPU
+    const HeadlessReport report = runHeadless(stack, config);
+    Input::instance().stop();
+
+    EXPECT_EQ(report.steps, 30u);
+    EXPECT_EQ(counting->updates, 30);
+    EXPECT_EQ(counting->records, 30);
+    EXPECT_GT(report.ticksPerSecond, 0.f);
+    EXPECT_GT(report.peakMemoryBytes, 0u);
+    EXPECT_GT(report.maxStepMs, 0.f);
+    EXPECT_LE(report.meanStepMs, report.maxStepMs);
+    EXPECT_LE(report.p99StepMs, report.maxStepMs);
+#if defined(LUMY_PROFILER)
+    // A lista gravada reaproveita a memória depois do primeiro passo
+    EXPECT_GT(report.allocationFreeSteps, 0u);
+#endif
+}
+
+TEST(Headless, PacesStepsAtMultipleOfRealTime) {
+    SceneStack stack;
+    stack.pushScene(std::make_unique<CountingScene>());
+    Input::instance().startIdle(0);
+
+    HeadlessConfig config;
+    config.maxSteps = 7;
+    config.speed = 10.f; // 6 intervalos de 1/60 s a 10x: ao menos 10 ms
+    const HeadlessReport report = runHeadless(stack, config);
+    Input::instance().stop();
+
+    EXPECT_EQ(report.steps, 7u);
+    EXPECT_GE(report.totalSeconds, 0.009f);
+}
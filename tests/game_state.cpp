@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+
+#include "game_state.hpp"
+#include "save_system.hpp"
+
+TEST(GameState, SnapshotIsIsolatedAndSharesUntouchedPages) {
+    GameState state;
+    state.setSwitch(3, true);
+    state.setVariable(10, 42);
+    state.setVariable(GameState::PageSize * 4 + 1, 7);
+
+    GameState snapshot = state.snapshot();
+    EXPECT_EQ(state.sharedPageCount(snapshot), 3u);
+
+    state.setVariable(10, 99);
+    state.setSelfSwitch(1, 5, 0, true);
+
+    EXPECT_EQ(snapshot.getVariable(10), 42);
+    EXPECT_EQ(state.getVariable(10), 99);
+    EXPECT_FALSE(snapshot.getSelfSwitch(1, 5, 0));
+    EXPECT_TRUE(state.getSelfSwitch(1, 5, 0));
+    // Só a página da variável 10 foi copiada
+    EXPECT_EQ(state.sharedPageCount(snapshot), 2u);
+
+    state.restore(snapshot);
+    EXPECT_EQ(state.getVariable(10), 42);
+    EXPECT_FALSE(state.getSelfSwitch(1, 5, 0));
+}
+
+TEST(GameState, SaveSystemReadsAndWritesSharedState) {
+    auto dir = std::filesystem::temp_directory_path() / "lumy_game_state";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    GameState state;
+    SaveSystem saves(state);
+    ASSERT_TRUE(saves.initialize(dir.string()));
+
+    // Escritas feitas por outro sistema (ex.: EventSystem) aparecem no save
+    state.setSwitch(2, true);
+    state.setSelfSwitch(3, 7, 1, true);
+    saves.setVariable(4, -12);
+    EXPECT_EQ(state.getVariable(4), -12);
+    ASSERT_TRUE(saves.saveGame(1));
+
+    state.reset();
+    EXPECT_FALSE(state.getSwitch(2));
+    ASSERT_TRUE(saves.loadGame(1));
+    EXPECT_TRUE(state.getSwitch(2));
+    EXPECT_TRUE(state.getSelfSwitch(3, 7, 1));
+    EXPECT_EQ(state.getVariable(4), -12);
+
+    // Self switches também entram no journal do autosave
+    ASSERT_TRUE(saves.autosave());
+    state.setSelfSwitch(3, 8, 3, true);
+    ASSERT_TRUE(saves.autosave());
+
+    GameState other;
+    SaveSystem reader(other);
+    ASSERT_TRUE(reader.initialize(dir.string()));
+    ASSERT_TRUE(reader.loadGame(SaveSystem::AutosaveSlot));
+    EXPECT_TRUE(other.getSelfSwitch(3, 8, 3));
+    EXPECT_EQ(other.getVariable(4), -12);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(GameState, UnchangedWritesDoNotNotify) {
+    GameState state;
+    int changes = 0;
+    state.setChangeListener([&](const GameState::ChangeEvent&) { ++changes; });
+
+    state.setSwitch(1, false);
+    state.setVariable(2, 0);
+    state.setSelfSwitch(1, 3, 0, false);
+    EXPECT_EQ(changes, 0);
+
+    state.setSwitch(1, true);
+    state.setVariable(2, 5);
+    state.setSelfSwitch(1, 3, 0, true);
+    EXPECT_EQ(changes, 3);
+
+    state.setSwitch(1, true);
+    state.setVariable(2, 5);
+    state.setSelfSwitch(1, 3, 0, true);
+    EXPECT_EQ(changes, 3);
+}
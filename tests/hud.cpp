@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "hud.hpp"
+#include "render_commands.hpp"
+
+namespace {
+sf::Font& uiFont() {
+    static sf::Font font;
+    static const bool loaded = font.openFromFile("game/font.ttf");
+    EXPECT_TRUE(loaded);
+    return font;
+}
+} // namespace
+
+TEST(Hud, FieldsReLayoutOnlyWhenTheyChange) {
+    Hud hud;
+    const WidgetId label = hud.addLabel(uiFont(), 14, {10.f, 10.f}, "X={} Y={}");
+    hud.setField(label, 0, 12);
+    hud.setField(label, 1, 34);
+    EXPECT_EQ(hud.vertices(label).size(), 8u * 6u); // "X=12", "Y=34": o espaço não gera quad
+    EXPECT_EQ(hud.layoutCount(), 1u);
+
+    // Passos sem mudança: nenhum layout novo
+    for (int frame = 0; frame < 100; ++frame) {
+        hud.setField(label, 0, 12);
+        hud.setField(label, 1, 34);
+        EXPECT_EQ(hud.batchCount(), 1u);
+    }
+    EXPECT_EQ(hud.layoutCount(), 1u);
+
+    hud.setField(label, 1, 345);
+    EXPECT_EQ(hud.vertices(label).size(), 9u * 6u);
+    EXPECT_EQ(hud.layoutCount(), 2u);
+
+    // UTF-8 decodificado: um quad por caractere, não por byte
+    hud.setText(label, "Posição");
+    EXPECT_EQ(hud.vertices(label).size(), 7u * 6u);
+
+    // Quebra de linha desce a linha seguinte
+    hud.setText(label, "a\nb");
+    const auto& lines = hud.vertices(label);
+    ASSERT_EQ(lines.size(), 12u);
+    EXPECT_GT(lines[6].position.y, lines[0].position.y);
+}
+
+TEST(Hud, BatchesPerFontAtlasWithShapesFirst) {
+    Hud hud;
+    const WidgetId panel = hud.addPanel({{0.f, 0.f}, {200.f, 50.f}}, sf::Color(0, 0, 0, 160));
+    const WidgetId gauge = hud.addGauge({{10.f, 30.f}, {100.f, 8.f}}, sf::Color::Black, sf::Color::Green, 0.5f);
+    hud.addLabel(uiFont(), 14, {10.f, 10.f}, "HP");
+    hud.addLabel(uiFont(), 14, {40.f, 10.f}, "MP");
+    const WidgetId title = hud.addLabel(uiFont(), 24, {10.f, 60.f}, "Lumy");
+
+    // Painel + gauge num lote sem textura; dois tamanhos de fonte, dois atlas
+    EXPECT_EQ(hud.batchCount(), 3u);
+    EXPECT_EQ(hud.vertices(panel).size(), 6u);
+    ASSERT_EQ(hud.vertices(gauge).size(), 12u);
+    EXPECT_FLOAT_EQ(hud.vertices(gauge)[7].position.x, 60.f); // Metade de 100 px
+
+    hud.setRatio(gauge, 2.f);
+    EXPECT_FLOAT_EQ(hud.vertices(gauge)[7].position.x, 110.f);
+    hud.setRatio(gauge, 0.f);
+    EXPECT_EQ(hud.vertices(gauge).size(), 6u); // Sem preenchimento
+
+    const std::uint64_t layouts = hud.layoutCount();
+    hud.setVisible(title, false);
+    EXPECT_EQ(hud.batchCount(), 2u);
+    EXPECT_EQ(hud.layoutCount(), layouts); // Esconder não refaz o layout
+
+    RenderCommandList commands;
+    hud.record(commands);
+    EXPECT_EQ(commands.size(), 2u);
+    sf::RenderTexture target({64, 64});
+    hud.draw(target);
+}
+
+TEST(Hud, NewGlyphsFenceTheRenderThread) {
+    Hud hud;
+    int fences = 0;
+    hud.setFence([&] { ++fences; });
+    const WidgetId label = hud.addLabel(uiFont(), 15, {0.f, 0.f}, "HP {}");
+    EXPECT_EQ(fences, 1); // Padrão e dígitos carregados de uma vez
+
+    // Números usam só glifos já carregados
+    hud.setField(label, 0, -1234567890);
+    EXPECT_EQ(hud.batchCount(), 1u);
+    EXPECT_EQ(fences, 1);
+
+    // Texto com letras novas espera o render antes de carregá-las
+    hud.setField(label, 0, "Zé");
+    EXPECT_EQ(hud.batchCount(), 1u);
+    EXPECT_EQ(fences, 2);
+    hud.setField(label, 0, "éZ");
+    EXPECT_EQ(hud.batchCount(), 1u);
+    EXPECT_EQ(fences, 2);
+}
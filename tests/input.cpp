@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "input.hpp"
+#include "save_codec.hpp"
+
+namespace {
+std::filesystem::path tempInputPath(const char* name) {
+    return std::filesystem::temp_directory_path() / name;
+}
+
+InputSnapshot snapshot(std::initializer_list<InputAction> held, std::initializer_list<InputAction> pressed = {}) {
+    InputSnapshot s;
+    for (auto action : held) {
+        s.held |= InputSnapshot::bit(action);
+    }
+    for (auto action : pressed) {
+        s.pressed |= InputSnapshot::bit(action);
+    }
+    return s;
+}
+} // namespace
+
+TEST(Input, DefaultBindings) {
+    InputMap map;
+    EXPECT_EQ(map.actionsFor(sf::Keyboard::Key::W), InputSnapshot::bit(InputAction::Up));
+    EXPECT_EQ(map.actionsFor(sf::Keyboard::Key::Space), InputSnapshot::bit(InputAction::Confirm));
+    EXPECT_EQ(map.actionsFor(sf::Keyboard::Key::Q), 0);
+
+    map.bind(InputAction::Cancel, sf::Keyboard::Key::Q);
+    EXPECT_EQ(map.actionsFor(sf::Keyboard::Key::Q), InputSnapshot::bit(InputAction::Cancel));
+    map.unbind(InputAction::Up);
+    EXPECT_EQ(map.actionsFor(sf::Keyboard::Key::W), 0);
+}
+
+TEST(Input, KeyPressBecomesEdgeOfNextStep) {
+    Input& input = Input::instance();
+    input.stop();
+
+    input.handleEvent(sf::Event::KeyPressed{sf::Keyboard::Key::Enter});
+    EXPECT_FALSE(input.wasPressed(InputAction::Confirm)); // Só no próximo passo
+    input.beginStep();
+    EXPECT_TRUE(input.wasPressed(InputAction::Confirm));
+    input.beginStep();
+    EXPECT_FALSE(input.wasPressed(InputAction::Confirm));
+    input.stop();
+}
+
+TEST(Input, RecorderRoundTripIsCompact) {
+    const auto path = tempInputPath("lumy_input_roundtrip.linp");
+    std::vector<InputSnapshot> steps;
+    steps.insert(steps.end(), 600, InputSnapshot{});
+    steps.push_back(snapshot({InputAction::Right}, {InputAction::Right}));
+    steps.insert(steps.end(), 120, snapshot({InputAction::Right}));
+    steps.push_back(snapshot({}, {InputAction::Confirm}));
+
+    InputRecorder recorder;
+    ASSERT_TRUE(recorder.open(path.string(), 1234, 60));
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        if (i == 700) {
+            recorder.writeSeed(99);
+        }
+        recorder.write(steps[i]);
+    }
+    recorder.close();
+    EXPECT_LT(std::filesystem::file_size(path), 40u); // 722 passos em poucas runs
+
+    InputReplay replay;
+    ASSERT_TRUE(replay.load(path.string()));
+    EXPECT_EQ(replay.stepHz(), 60);
+    ASSERT_EQ(replay.size(), steps.size());
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        EXPECT_EQ(replay.step(i), steps[i]) << "passo " << i;
+    }
+    ASSERT_EQ(replay.seeds().size(), 2u);
+    EXPECT_EQ(replay.seeds()[0], (std::pair<std::size_t, std::uint32_t>{0, 1234}));
+    EXPECT_EQ(replay.seeds()[1], (std::pair<std::size_t, std::uint32_t>{700, 99}));
+    std::filesystem::remove(path);
+}
+
+TEST(Input, ReplayRejectsCorruptRunLength) {
+    const auto path = tempInputPath("lumy_input_corrupt.linp");
+    const auto appendRuns = [&](std::initializer_list<std::uint64_t> runs) {
+        InputRecorder recorder;
+        ASSERT_TRUE(recorder.open(path.string(), 7, 60));
+        recorder.close(); // Só o cabeçalho
+        ByteBuffer records;
+        for (const std::uint64_t run : runs) {
+            encodeVarint(records, run << 1); // RunRecord
+            encodeVarint(records, 0);
+            encodeVarint(records, 0);
+        }
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size()));
+    };
+
+    // Uma run de bilhões de passos em poucos bytes: recusada, sem expandir
+    appendRuns({std::uint64_t{1} << 40});
+    InputReplay replay;
+    EXPECT_FALSE(replay.load(path.string()));
+    EXPECT_EQ(replay.size(), 0u);
+    EXPECT_TRUE(replay.seeds().empty());
+
+    // Runs válidas uma a uma, mas que juntas passam do limite
+    appendRuns({InputReplay::MaxSteps, 1});
+    EXPECT_FALSE(replay.load(path.string()));
+    EXPECT_EQ(replay.size(), 0u);
+
+    appendRuns({3, 2});
+    ASSERT_TRUE(replay.load(path.string()));
+    EXPECT_EQ(replay.size(), 5u);
+    std::filesystem::remove(path);
+}
+
+TEST(Input, ReplayReproducesInputAndRandomness) {
+    const auto path = tempInputPath("lumy_input_session.linp");
+    Input& input = Input::instance();
+
+    ASSERT_TRUE(input.startRecording(path.string(), 42, 60));
+    std::vector<InputSnapshot> recorded;
+    std::vector<std::uint32_t> rolls;
+    for (int i = 0; i < 10; ++i) {
+        if (i == 3) {
+            input.handleEvent(sf::Event::KeyPressed{sf::Keyboard::Key::Space});
+        }
+        if (i == 5) {
+            input.reseed(7);
+        }
+        input.beginStep();
+        recorded.push_back(input.current());
+        rolls.push_back(input.rng()());
+    }
+    input.stop();
+
+    ASSERT_TRUE(input.startReplay(path.string()));
+    input.handleEvent(sf::Event::KeyPressed{sf::Keyboard::Key::Enter}); // Ignorado no replay
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(input.replayFinished());
+        input.beginStep();
+        EXPECT_EQ(input.current(), recorded[i]) << "passo " << i;
+        EXPECT_EQ(input.rng()(), rolls[i]) << "passo " << i;
+    }
+    EXPECT_TRUE(input.replayFinished());
+    EXPECT_TRUE(recorded[3].wasPressed(InputAction::Confirm));
+    input.stop();
+    std::filesystem::remove(path);
+}
+
+TEST(Input, ReseedInsideStepReplaysAtTheSamePoint) {
+    const auto path = tempInputPath("lumy_input_midstep.linp");
+    Input& input = Input::instance();
+
+    // Como uma cena que troca a semente no meio do update: sorteia antes e
+    // depois do reseed no mesmo passo, duas vezes no passo 4
+    const auto session = [&input](std::vector<std::uint32_t>& rolls) {
+        for (std::uint32_t i = 0; i < 8; ++i) {
+            input.beginStep();
+            rolls.push_back(input.rng()());
+            if (i == 2 || i == 4) {
+                input.reseed(100 + i);
+                rolls.push_back(input.rng()());
+            }
+            if (i == 4) {
+                input.reseed(200);
+                rolls.push_back(input.rng()());
+            }
+        }
+    };
+
+    std::vector<std::uint32_t> recorded;
+    ASSERT_TRUE(input.startRecording(path.string(), 42, 60));
+    session(recorded);
+    input.stop();
+
+    // No replay o argumento não importa: vale a semente gravada
+    std::vector<std::uint32_t> replayed;
+    ASSERT_TRUE(input.startReplay(path.string()));
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        input.beginStep();
+        replayed.push_back(input.rng()());
+        if (i == 2 || i == 4) {
+            input.reseed(0);
+            replayed.push_back(input.rng()());
+        }
+        if (i == 4) {
+            input.reseed(0);
+            replayed.push_back(input.rng()());
+        }
+    }
+    EXPECT_EQ(replayed, recorded);
+    input.stop();
+    std::filesystem::remove(path);
+}
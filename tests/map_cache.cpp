@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "event_system.hpp"
+#include "map_cache.hpp"
+#include "texture_manager.hpp"
+
+namespace {
+const std::string HelloMap = "game/assets/maps/hello.tmx";
+// Mesmo arquivo com outra chave, para ter dois mapas no cache
+const std::string HelloAgain = "game/assets/maps/../maps/hello.tmx";
+
+void waitReady(MapCache& cache, const std::string& path) {
+    for (int i = 0; i < 2000 && cache.contains(path) && !cache.isReady(path); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        cache.update();
+    }
+}
+} // namespace
+
+TEST(MapCache, PrefetchedMapIsHandedOverOnce) {
+    TextureManager textures;
+    MapCache cache(textures);
+    cache.prefetch({HelloMap});
+    EXPECT_TRUE(cache.contains(HelloMap));
+    waitReady(cache, HelloMap);
+    ASSERT_TRUE(cache.isReady(HelloMap));
+    EXPECT_GT(cache.bytes(), 0u);
+
+    const std::unique_ptr<PreparedMap> prepared = cache.take(HelloMap);
+    ASSERT_NE(prepared, nullptr);
+    EXPECT_EQ(prepared->path, HelloMap);
+    EXPECT_GT(prepared->map.getLayerCount(), 0u);
+    EXPECT_FALSE(cache.contains(HelloMap));
+    EXPECT_EQ(cache.bytes(), 0u);
+
+    // Fora do cache: carregado na hora; arquivo inexistente dá nulo
+    EXPECT_NE(cache.take(HelloMap), nullptr);
+    EXPECT_EQ(cache.take("game/assets/maps/nao_existe.tmx"), nullptr);
+
+    // Pré-carga que falha some do cache no update
+    cache.prefetch({"game/assets/maps/nao_existe.tmx"});
+    waitReady(cache, "game/assets/maps/nao_existe.tmx");
+    EXPECT_FALSE(cache.contains("game/assets/maps/nao_existe.tmx"));
+}
+
+TEST(MapCache, BudgetDropsLeastRecentlyRequested) {
+    TextureManager textures;
+    const std::size_t mapBytes = MapCache::load(textures, HelloMap)->bytes;
+    ASSERT_GT(mapBytes, 0u);
+
+    // Cabe um mapa só: o pedido mais antigo é descartado
+    MapCache cache(textures, mapBytes + mapBytes / 2);
+    cache.prefetch({HelloMap});
+    waitReady(cache, HelloMap);
+    cache.prefetch({HelloAgain});
+    waitReady(cache, HelloAgain);
+    cache.update();
+    EXPECT_FALSE(cache.contains(HelloMap));
+    EXPECT_TRUE(cache.isReady(HelloAgain));
+    EXPECT_LE(cache.bytes(), cache.budget());
+}
+
+TEST(MapCache, PrefetchesLoadOneAtATime) {
+    TextureManager textures;
+    MapCache cache(textures);
+    const std::vector<std::string> paths = {HelloMap, HelloAgain, "game/assets/maps/./hello.tmx"};
+    cache.prefetch(paths);
+    // O último da lista começa; os outros esperam na fila
+    int ready = 0;
+    for (int i = 0; i < 2000 && ready < 3; ++i) {
+        int loading = 0;
+        ready = 0;
+        for (const std::string& path : paths) {
+            EXPECT_TRUE(cache.contains(path));
+            loading += cache.isLoading(path) ? 1 : 0;
+            ready += cache.isReady(path) ? 1 : 0;
+        }
+        EXPECT_LE(loading, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        cache.update();
+    }
+    EXPECT_EQ(ready, 3);
+
+    for (const std::string& path : paths) {
+        EXPECT_NE(cache.take(path), nullptr);
+    }
+
+    // Ainda na fila: take() carrega na hora, sem esperar a carga em andamento
+    const std::vector<std::string> more = {"game/assets/maps/./../maps/hello.tmx", "game/assets/maps/.././maps/hello.tmx"};
+    cache.prefetch(more);
+    const std::string& queued = cache.isLoading(more[0]) ? more[1] : more[0];
+    EXPECT_FALSE(cache.isLoading(queued));
+    EXPECT_NE(cache.take(queued), nullptr);
+    EXPECT_FALSE(cache.contains(queued));
+}
+
+TEST(MapCache, EvictionReleasesTextures) {
+    TextureManager textures;
+    const std::size_t mapBytes = MapCache::load(textures, HelloMap)->bytes;
+    textures.clear();
+    {
+        MapCache cache(textures, mapBytes + mapBytes / 2);
+        cache.prefetch({HelloMap});
+        waitReady(cache, HelloMap);
+        EXPECT_EQ(textures.size(), 1u);
+
+        // A carga em andamento conta no orçamento: o mapa antigo sai antes
+        cache.prefetch({HelloAgain});
+        EXPECT_FALSE(cache.contains(HelloMap));
+        EXPECT_TRUE(cache.isLoading(HelloAgain));
+        EXPECT_LE(cache.bytes(), cache.budget());
+        waitReady(cache, HelloAgain);
+        EXPECT_EQ(textures.size(), 1u);
+
+        // O mapa entregue fica com a textura
+        EXPECT_NE(cache.take(HelloAgain), nullptr);
+        cache.prefetch({HelloMap});
+        waitReady(cache, HelloMap);
+    }
+    // O cache destruído solta só o que não foi entregue
+    EXPECT_EQ(textures.size(), 1u);
+    EXPECT_TRUE(textures.release("game/assets/maps/tiles.png"));
+    EXPECT_EQ(textures.size(), 0u);
+}
+
+TEST(MapCache, TransferTargetsFromEventCommands) {
+    EventCommandParams params;
+    params.intParams = {3, 64, 96};
+    const auto byId = EventSystem::transferTarget(params);
+    ASSERT_TRUE(byId.has_value());
+    EXPECT_EQ(byId->mapId, 3);
+    EXPECT_TRUE(byId->mapFile.empty());
+    EXPECT_FLOAT_EQ(byId->position.x, 64.f);
+    EXPECT_FLOAT_EQ(byId->position.y, 96.f);
+
+    params.stringParams = {"casa.tmx"};
+    EXPECT_EQ(EventSystem::transferTarget(params)->mapFile, "casa.tmx");
+
+    params.intParams = {3};
+    EXPECT_FALSE(EventSystem::transferTarget(params).has_value());
+
+    // Todos os TransferPlayer dos eventos, para pré-carregar
+    EventSystem events(nullptr, nullptr);
+    GameEvent door(7, "Porta", 0, 0);
+    EventPage page;
+    EventCommandParams transfer;
+    transfer.intParams = {2, 10, 20};
+    page.commands.emplace_back(EventCommandType::ShowText, EventCommandParams{{"Entrando"}, {}, {}, {}});
+    page.commands.emplace_back(EventCommandType::TransferPlayer, transfer);
+    door.pages.push_back(page);
+    events.addEvent(door);
+    const std::vector<TransferTarget> targets = events.transferTargets();
+    ASSERT_EQ(targets.size(), 1u);
+    EXPECT_EQ(targets[0].mapId, 2);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <sol/sol.hpp>
+
+#include "map.hpp"
+#include "map_lua.hpp"
+#include "render_commands.hpp"
+#include "texture_manager.hpp"
+
+// hello.tmx: 25x15, borda de tile 1 (colidível), interior vazio
+
+TEST(MapRegion, ReadWriteFillAndReplace) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    // Canto superior esquerdo: borda em cima e à esquerda
+    std::vector<std::uint32_t> ids;
+    map.getRegion(0, {{0, 0}, {3, 2}}, ids);
+    EXPECT_EQ(ids, (std::vector<std::uint32_t>{1, 1, 1, 1, 0, 0}));
+
+    // Fora do mapa lê 0 e a escrita é ignorada
+    map.getRegion(0, {{-1, -1}, {2, 2}}, ids);
+    EXPECT_EQ(ids, (std::vector<std::uint32_t>{0, 0, 0, 1}));
+
+    const std::vector<std::uint32_t> block{1, 0, 0, 1};
+    EXPECT_TRUE(map.setRegion(0, {{5, 5}, {2, 2}}, block));
+    EXPECT_EQ(map.getTileID(0, 5, 5), 1u);
+    EXPECT_EQ(map.getTileID(0, 6, 6), 1u);
+    EXPECT_TRUE(map.isCollidable(5, 5));
+    EXPECT_FALSE(map.isCollidable(6, 5));
+    // Tamanho errado ou camada inexistente: nada muda
+    EXPECT_FALSE(map.setRegion(0, {{5, 5}, {3, 3}}, block));
+    EXPECT_FALSE(map.setRegion(9, {{5, 5}, {2, 2}}, block));
+
+    map.fillRegion(0, {{10, 5}, {4, 3}}, 1);
+    EXPECT_EQ(map.countCollidable({{10, 5}, {4, 3}}), 12u);
+    EXPECT_EQ(map.replaceInRegion(0, {{10, 5}, {2, 3}}, 1, 0), 6u);
+    EXPECT_EQ(map.countCollidable({{10, 5}, {4, 3}}), 6u);
+    EXPECT_EQ(map.replaceInRegion(0, {{10, 5}, {2, 3}}, 1, 0), 0u);
+}
+
+TEST(MapRegion, CollisionRegionCountsOutsideAsBlocked) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    std::vector<std::uint8_t> blocked;
+    map.getCollisionRegion({{-1, 0}, {3, 2}}, blocked);
+    EXPECT_EQ(blocked, (std::vector<std::uint8_t>{1, 1, 1, 1, 1, 0}));
+    EXPECT_EQ(map.countCollidable({{0, 0}, {25, 15}}), 2u * 25u + 2u * 13u);
+    EXPECT_EQ(map.countCollidable({{5, 5}, {0, 4}}), 0u);
+}
+
+TEST(MapRegion, BatchedEditUpdatesGeometryOnEnd) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    const sf::FloatRect interior{{160.f, 160.f}, {96.f, 96.f}};
+    RenderCommandList commands;
+
+    // Dentro do grupo só ids e colisão mudam; os quads vêm no endEdit
+    map.beginEdit();
+    map.setTileID(0, 6, 6, 1);
+    map.fillRegion(0, {{5, 7}, {2, 1}}, 1);
+    EXPECT_TRUE(map.isCollidable(6, 6));
+    EXPECT_EQ(map.getTileID(0, 5, 7), 1u);
+    map.recordRange(0, map.getLayerCount(), commands, interior);
+    EXPECT_TRUE(commands.empty());
+    map.endEdit();
+
+    map.recordRange(0, map.getLayerCount(), commands, interior);
+    EXPECT_EQ(commands.size(), 1u);
+
+    // Borda intacta depois de reconstruir as linhas
+    commands.clear();
+    map.recordRange(0, map.getLayerCount(), commands, sf::FloatRect{{0.f, 0.f}, {64.f, 64.f}});
+    EXPECT_EQ(commands.size(), 1u);
+
+    // Apagar tudo de volta
+    map.fillRegion(0, {{5, 6}, {2, 2}}, 0);
+    commands.clear();
+    map.recordRange(0, map.getLayerCount(), commands, interior);
+    EXPECT_TRUE(commands.empty());
+}
+
+TEST(MapRegion, LuaWritesRegionThroughTileBuffer) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    sol::state lua;
+    lua.open_libraries(sol::lib::base);
+    bindMapApi(lua, map);
+
+    const auto result = lua.safe_script(R"(
+        local room = TileBuffer.new(5, 3, 1)
+        for x = 1, 3 do room:set(x, 1, 0) end
+        map.write(0, 8, 4, room)
+        map.edit(function()
+            map.set(0, 20, 10, 1)
+            map.fill(0, 2, 10, 2, 2, 1)
+        end)
+        local ids = map.read_table(0, 8, 4, 5, 1)
+        first_row = #ids
+        blocked = map.count_collidable(8, 4, 5, 3)
+        hole = map.collision(8, 4, 5, 3):get(2, 1)
+    )", sol::script_pass_on_error);
+    ASSERT_TRUE(result.valid());
+
+    EXPECT_EQ(lua["first_row"].get<int>(), 5);
+    EXPECT_EQ(lua["blocked"].get<int>(), 12);
+    EXPECT_EQ(lua["hole"].get<int>(), 0);
+    EXPECT_EQ(map.getTileID(0, 20, 10), 1u);
+    EXPECT_EQ(map.countCollidable({{2, 10}, {2, 2}}), 4u);
+
+    // Erros do script viram erro Lua, sem derrubar o jogo
+    EXPECT_FALSE(lua.safe_script("map.fill(7, 0, 0, 1, 1, 1)", sol::script_pass_on_error).valid());
+    EXPECT_FALSE(lua.safe_script("map.edit(function() error('x') end)", sol::script_pass_on_error).valid());
+}
+
+TEST(MapRegion, LuaRegionsAreCheckedBeforeReachingTheMap) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+
+    sol::state lua;
+    lua.open_libraries(sol::lib::base);
+    bindMapApi(lua, map);
+
+    // Borda estourando int ou buffer maior que o mapa: erro, sem alocar
+    EXPECT_FALSE(lua.safe_script("map.fill(0, 2147483000, 0, 1000, 1, 1)", sol::script_pass_on_error).valid());
+    EXPECT_FALSE(lua.safe_script("map.read(0, 0, 0, 100000, 100000)", sol::script_pass_on_error).valid());
+    EXPECT_FALSE(lua.safe_script("map.collision(-1, 0, 3, 2)", sol::script_pass_on_error).valid());
+    EXPECT_FALSE(lua.safe_script("map.write_table(0, 24, 0, 2, 1, {})", sol::script_pass_on_error).valid());
+    EXPECT_FALSE(lua.safe_script("TileBuffer.new(100000, 100000)", sol::script_pass_on_error).valid());
+    EXPECT_FALSE(lua.safe_script("TileBuffer.new(-1, 2, 1)", sol::script_pass_on_error).valid());
+
+    // Sem buffer o retângulo é recortado ao mapa
+    const auto result = lua.safe_script(R"(
+        map.fill(0, -100000, 5, 200000, 1, 1)
+        blocked = map.count_collidable(-2000000000, -2000000000, 2100000000, 2100000000)
+        local view = map.view(0, -1, 4, 3, 3)
+        before = view:get(1, 1)
+        map.set(0, 0, 5, 0)
+        after = view:get(1, 1)
+        outside = view:get(0, 1)
+        size = view.width * view.height
+    )", sol::script_pass_on_error);
+    ASSERT_TRUE(result.valid());
+
+    EXPECT_EQ(map.getTileID(0, 1, 5), 1u);
+    EXPECT_EQ(map.getTileID(0, 24, 5), 1u);
+    EXPECT_EQ(lua["blocked"].get<int>(), 2 * 25 + 2 * 13 + 23);
+    // A view lê as linhas do mapa: a escrita posterior aparece
+    EXPECT_EQ(lua["before"].get<int>(), 1);
+    EXPECT_EQ(lua["after"].get<int>(), 0);
+    EXPECT_EQ(lua["outside"].get<int>(), 0);
+    EXPECT_EQ(lua["size"].get<int>(), 9);
+}
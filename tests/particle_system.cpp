@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "particle_system.hpp"
+
+namespace {
+// Partículas paradas com vida exata, para contar mortes por passo
+EmitterDesc fixedLife(float lifetime, std::size_t capacity) {
+    EmitterDesc desc;
+    desc.capacity = capacity;
+    desc.lifetimeMin = lifetime;
+    desc.lifetimeMax = lifetime;
+    return desc;
+}
+} // namespace
+
+TEST(ParticleSystem, EmitsAtRateUpToCapacity) {
+    ParticleSystem particles;
+    EmitterDesc desc = fixedLife(10.f, 50);
+    desc.rate = 30.f;
+    const EmitterId id = particles.addEmitter(desc);
+
+    // 30/s a 60 Hz: uma partícula a cada dois passos
+    for (int step = 0; step < 60; ++step) {
+        particles.update(1.f / 60.f);
+    }
+    EXPECT_NEAR(static_cast<double>(particles.particleCount(id)), 30.0, 1.0);
+
+    // Pool cheio: a emissão pausa em vez de crescer
+    for (int step = 0; step < 240; ++step) {
+        particles.update(1.f / 60.f);
+    }
+    EXPECT_EQ(particles.particleCount(id), 50u);
+    particles.burst(id, 10);
+    EXPECT_EQ(particles.particleCount(id), 50u);
+}
+
+TEST(ParticleSystem, DeadParticlesAreSwapRemoved) {
+    ParticleSystem particles;
+    const EmitterId shortLived = particles.addEmitter(fixedLife(0.1f, 64));
+    const EmitterId longLived = particles.addEmitter(fixedLife(1.f, 64));
+    particles.burst(shortLived, 40);
+    particles.burst(longLived, 20);
+    EXPECT_EQ(particles.particleCount(), 60u);
+
+    for (int step = 0; step < 12; ++step) {
+        particles.update(1.f / 60.f);
+    }
+    EXPECT_EQ(particles.particleCount(shortLived), 0u);
+    EXPECT_EQ(particles.particleCount(longLived), 20u);
+
+    // Um burst no meio da vida dos outros: só os antigos morrem
+    for (int step = 0; step < 30; ++step) {
+        particles.update(1.f / 60.f);
+    }
+    particles.burst(longLived, 5);
+    for (int step = 0; step < 35; ++step) {
+        particles.update(1.f / 60.f);
+    }
+    EXPECT_EQ(particles.particleCount(longLived), 5u);
+
+    particles.removeEmitter(longLived);
+    EXPECT_EQ(particles.particleCount(), 0u);
+    particles.burst(longLived, 5); // Id removido: ignorado
+    EXPECT_EQ(particles.particleCount(), 0u);
+}
+
+TEST(ParticleSystem, MovesWithVelocityAndGravity) {
+    ParticleSystem particles;
+    EmitterDesc desc = fixedLife(10.f, 4);
+    desc.position = {100.f, 50.f};
+    desc.velocityMin = desc.velocityMax = {60.f, 0.f};
+    desc.acceleration = {0.f, 120.f};
+    desc.sizeStart = desc.sizeEnd = {2.f, 2.f};
+    const EmitterId id = particles.addEmitter(desc);
+    particles.burst(id, 1);
+    for (int step = 0; step < 60; ++step) {
+        particles.update(1.f / 60.f);
+    }
+
+    // Quad em torno da posição: x = 100 + 60, y ~= 50 + 120/2 (Euler semi-implícito)
+    const auto& batches = particles.buildBatches(1.f);
+    ASSERT_EQ(batches.size(), 1u);
+    ASSERT_EQ(batches[0].size(), 6u);
+    const sf::Vector2f center = (batches[0][0].position + batches[0][2].position) * 0.5f;
+    EXPECT_NEAR(center.x, 160.f, 0.01f);
+    EXPECT_NEAR(center.y, 111.f, 0.5f);
+    EXPECT_NEAR(batches[0][2].position.x - batches[0][0].position.x, 2.f, 1e-4f);
+
+    // alpha 0 fica no passo anterior
+    const auto& previous = particles.buildBatches(0.f)[0];
+    EXPECT_NEAR((previous[0].position.x + previous[2].position.x) * 0.5f, 159.f, 0.01f);
+}
+
+TEST(ParticleSystem, FadesColorAndBatchesPerTexture) {
+    ParticleSystem particles;
+    sf::Texture texture;
+    EmitterDesc plain = fixedLife(1.f, 16);
+    plain.colorStart = sf::Color(255, 0, 0, 255);
+    plain.colorEnd = sf::Color(255, 0, 0, 0);
+    EmitterDesc textured = plain;
+    textured.texture = &texture;
+    textured.textureRect = {{8, 16}, {8, 8}};
+
+    const EmitterId a = particles.addEmitter(plain);
+    const EmitterId b = particles.addEmitter(textured);
+    const EmitterId c = particles.addEmitter(textured);
+    particles.burst(a, 3);
+    particles.burst(b, 2);
+    particles.burst(c, 4);
+    for (int step = 0; step < 30; ++step) {
+        particles.update(1.f / 60.f);
+    }
+
+    // Um lote por textura: b e c dividem o mesmo
+    const auto& batches = particles.buildBatches(1.f);
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_EQ(batches[0].size(), 3u * 6u);
+    EXPECT_EQ(batches[1].size(), 6u * 6u);
+    EXPECT_NEAR(batches[0][0].color.a, 127, 2); // Metade da vida
+    EXPECT_EQ(batches[1][0].texCoords, sf::Vector2f(8.f, 16.f));
+    EXPECT_EQ(batches[1][2].texCoords, sf::Vector2f(16.f, 24.f));
+}
+
+TEST(ParticleSystem, WeatherPresetsFillTheirArea) {
+    ParticleSystem particles;
+    const sf::Vector2f area{640.f, 360.f};
+    const EmitterId rain = particles.addEmitter(EmitterDesc::rain(area));
+    particles.setPosition(rain, {1000.f, 1000.f});
+    for (int step = 0; step < 120; ++step) {
+        particles.update(1.f / 60.f);
+    }
+    EXPECT_GT(particles.particleCount(rain), 100u);
+    for (const sf::Vertex& vertex : particles.buildBatches(1.f)[0]) {
+        EXPECT_GT(vertex.position.x, 1000.f - area.x);
+        EXPECT_LT(vertex.position.x, 1000.f + area.x);
+    }
+}
@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include "map.hpp"
+#include "pathfinding.hpp"
+#include "texture_manager.hpp"
+
+namespace {
+constexpr std::uint32_t WallTile = 1; // Tile 0 do tileset.tsx é colidível
+
+// Verifica passos vizinhos, tiles livres e diagonais sem cortar quina.
+// Devolve o custo do caminho.
+float checkPath(const Pathfinder& pathfinder, const GridPath& path, GridPos start, GridPos goal) {
+    EXPECT_FALSE(path.empty());
+    if (path.empty()) {
+        return 0.f;
+    }
+    EXPECT_EQ(path.front(), start);
+    EXPECT_EQ(path.back(), goal);
+    float cost = 0.f;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        EXPECT_TRUE(pathfinder.walkable(path[i])) << "tile " << path[i].x << "," << path[i].y;
+        if (i == 0) {
+            continue;
+        }
+        const int dx = path[i].x - path[i - 1].x;
+        const int dy = path[i].y - path[i - 1].y;
+        EXPECT_LE(std::abs(dx), 1);
+        EXPECT_LE(std::abs(dy), 1);
+        if (dx != 0 && dy != 0) {
+            EXPECT_TRUE(pathfinder.walkable({path[i - 1].x + dx, path[i - 1].y}));
+            EXPECT_TRUE(pathfinder.walkable({path[i - 1].x, path[i - 1].y + dy}));
+            cost += std::sqrt(2.f);
+        } else {
+            cost += 1.f;
+        }
+    }
+    return cost;
+}
+
+// Labirinto de paredes internas com aberturas, sempre o mesmo
+void buildWalls(Map& map) {
+    for (unsigned x = 4; x < 21; x += 4) {
+        for (unsigned y = 1; y < 14; ++y) {
+            if ((y + x) % 6 != 0) {
+                map.setTileID(0, x, y, WallTile);
+            }
+        }
+    }
+    for (unsigned x = 1; x < 24; ++x) {
+        if (x % 5 != 2) {
+            map.setTileID(0, x, 7, WallTile);
+        }
+    }
+}
+
+// Mapa quadrado grande o bastante para o grafo de clusters: borda de parede
+// e paredes verticais alternando a passagem em cima e embaixo (serpentina)
+std::filesystem::path writeSerpentineMap(int size) {
+    const auto dir = std::filesystem::temp_directory_path() / "lumy_pathfinding_test";
+    std::filesystem::create_directories(dir);
+    for (const char* file : {"tileset.tsx", "tiles.png"}) {
+        std::filesystem::copy_file(std::filesystem::path("game/assets/maps") / file, dir / file,
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+    const auto path = dir / "serpentine.tmx";
+    std::ofstream out(path);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<map version=\"1.10\" orientation=\"orthogonal\" renderorder=\"right-down\" width=\"" << size
+        << "\" height=\"" << size << "\" tilewidth=\"32\" tileheight=\"32\" infinite=\"0\" nextlayerid=\"2\""
+        << " nextobjectid=\"1\">\n <tileset firstgid=\"1\" source=\"tileset.tsx\"/>\n"
+        << " <layer id=\"1\" name=\"Tile Layer 1\" width=\"" << size << "\" height=\"" << size << "\">\n"
+        << "  <data encoding=\"csv\">\n";
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+            const bool wall = x % 8 == 0 && (x / 8 % 2 == 0 ? y < size - 3 : y > 2);
+            out << (border || wall ? WallTile : 0u) << (x + 1 < size || y + 1 < size ? "," : "");
+        }
+        out << "\n";
+    }
+    out << "  </data>\n </layer>\n</map>\n";
+    return path;
+}
+} // namespace
+
+TEST(Pathfinding, JumpPointSearchMatchesFlowFieldDistances) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+    buildWalls(map);
+    Pathfinder pathfinder(map);
+
+    const GridPos goal{22, 12};
+    const auto field = pathfinder.flowField(goal);
+    ASSERT_TRUE(field);
+    int compared = 0;
+    for (int y = 1; y < 14; y += 3) {
+        for (int x = 1; x < 24; x += 2) {
+            const GridPos start{x, y};
+            if (!pathfinder.walkable(start)) {
+                continue;
+            }
+            const GridPath path = pathfinder.findPathJps(start, goal);
+            if (!field->reachable(start)) {
+                EXPECT_TRUE(path.empty());
+                continue;
+            }
+            EXPECT_NEAR(checkPath(pathfinder, path, start, goal), field->distance(start), 1e-3f)
+                << "de " << x << "," << y;
+            ++compared;
+        }
+    }
+    EXPECT_GT(compared, 20);
+
+    // Seguir o campo leva ao objetivo pelo mesmo custo
+    GridPos at{1, 1};
+    int steps = 0;
+    while (!(at == goal) && steps++ < 200) {
+        at = field->next(at);
+    }
+    EXPECT_EQ(at, goal);
+}
+
+TEST(Pathfinding, TileEditsInvalidatePathsAndFields) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+    Pathfinder pathfinder(map, 4);
+
+    const GridPos start{2, 7};
+    const GridPos goal{22, 7};
+    EXPECT_EQ(pathfinder.findPathJps(start, goal).size(), 21u);
+    const auto before = pathfinder.flowField(goal);
+    const auto revision = pathfinder.revision();
+
+    // Parede vertical com uma única passagem em y = 1
+    for (unsigned y = 2; y < 14; ++y) {
+        map.setTileID(0, 12, y, WallTile);
+    }
+    const GridPath path = pathfinder.findPathJps(start, goal);
+    EXPECT_GT(pathfinder.revision(), revision);
+    checkPath(pathfinder, path, start, goal);
+    EXPECT_NE(std::find(path.begin(), path.end(), GridPos{12, 1}), path.end());
+
+    const auto after = pathfinder.flowField(goal);
+    EXPECT_NE(before, after);
+    EXPECT_GT(after->distance(start), before->distance(start));
+
+    const GridPath coarse = pathfinder.findPathHierarchical(start, goal);
+    checkPath(pathfinder, coarse, start, goal);
+    EXPECT_NE(std::find(coarse.begin(), coarse.end(), GridPos{12, 1}), coarse.end());
+
+    map.setTileID(0, 12, 1, WallTile); // Fecha a passagem
+    EXPECT_TRUE(pathfinder.findPathJps(start, goal).empty());
+    EXPECT_TRUE(pathfinder.findPathHierarchical(start, goal).empty());
+    EXPECT_FALSE(pathfinder.flowField(goal)->reachable(start));
+}
+
+TEST(Pathfinding, HierarchicalPathsStayCloseToOptimal) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+    buildWalls(map);
+    Pathfinder pathfinder(map, 5);
+
+    const GridPos goal{23, 13};
+    const auto field = pathfinder.flowField(goal);
+    for (const GridPos start : {GridPos{1, 1}, GridPos{6, 3}, GridPos{1, 13}, GridPos{18, 2}, GridPos{22, 12}}) {
+        const GridPath path = pathfinder.findPathHierarchical(start, goal);
+        ASSERT_EQ(path.empty(), !field->reachable(start));
+        if (path.empty()) {
+            continue;
+        }
+        const float cost = checkPath(pathfinder, path, start, goal);
+        EXPECT_GE(cost, field->distance(start) - 1e-3f);
+        EXPECT_LE(cost, field->distance(start) * 1.5f + 2.f) << "de " << start.x << "," << start.y;
+    }
+}
+
+TEST(Pathfinding, QueueSpreadsRequestsOverFrames) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load("game/assets/maps/hello.tmx"));
+    buildWalls(map);
+    Pathfinder pathfinder(map);
+
+    int delivered = 0;
+    int flowDelivered = 0;
+    for (int i = 0; i < 200; ++i) {
+        pathfinder.requestPath({1 + i % 3, 1}, {22, 13 - i % 5}, [&delivered](const GridPath& path) {
+            EXPECT_FALSE(path.empty());
+            ++delivered;
+        });
+    }
+    const auto canceled = pathfinder.requestPath({1, 1}, {2, 2}, [](const GridPath&) { FAIL(); });
+    pathfinder.requestFlowField({22, 13}, [&flowDelivered](std::shared_ptr<const FlowField> field) {
+        EXPECT_TRUE(field && field->reachable({1, 1}));
+        ++flowDelivered;
+    });
+    EXPECT_TRUE(pathfinder.cancel(canceled));
+    EXPECT_FALSE(pathfinder.cancel(canceled));
+
+    // Orçamento zero: uma fatia por chamada, nunca tudo de uma vez
+    pathfinder.process(std::chrono::microseconds(0));
+    EXPECT_LT(delivered, 200);
+    int frames = 1;
+    while (pathfinder.pendingRequests() > 0 && frames < 10000) {
+        pathfinder.process(std::chrono::microseconds(0));
+        ++frames;
+    }
+    EXPECT_EQ(delivered, 200);
+    EXPECT_EQ(flowDelivered, 1);
+    EXPECT_GT(frames, 1);
+}
+
+TEST(Pathfinding, LargeMapRequestSpansSeveralSlices) {
+    TextureManager textures;
+    Map map(textures);
+    ASSERT_TRUE(map.load(writeSerpentineMap(160).string()));
+    Pathfinder pathfinder(map);
+    ASSERT_GE(static_cast<std::size_t>(pathfinder.width() * pathfinder.height()), Pathfinder::HierarchicalMinTiles);
+
+    const GridPos start{1, 1};
+    const GridPos goal{158, 158};
+    GridPath delivered;
+    pathfinder.requestPath(start, goal, [&delivered](const GridPath& path) { delivered = path; });
+
+    // Clusters ainda não montados e o grafo inteiro entre os cantos: nem a
+    // montagem nem a busca cabem numa fatia
+    int frames = 0;
+    while (pathfinder.pendingRequests() > 0 && frames < 100000) {
+        pathfinder.process(std::chrono::microseconds(0));
+        ++frames;
+    }
+    EXPECT_GT(frames, 10);
+    checkPath(pathfinder, delivered, start, goal);
+    EXPECT_EQ(delivered, pathfinder.findPathHierarchical(start, goal));
+
+    // Edição no meio do caminho: os clusters tocados são refeitos aos poucos
+    // e a serpentina passa a ter um atalho
+    for (unsigned y = 3; y < 157; ++y) {
+        map.setTileID(0, 8, y, 0);
+    }
+    delivered.clear();
+    pathfinder.requestPath(start, goal, [&delivered](const GridPath& path) { delivered = path; });
+    frames = 0;
+    while (pathfinder.pendingRequests() > 0 && frames < 100000) {
+        pathfinder.process(std::chrono::microseconds(0));
+        ++frames;
+    }
+    EXPECT_GT(frames, 1);
+    checkPath(pathfinder, delivered, start, goal);
+    EXPECT_EQ(delivered, pathfinder.findPathHierarchical(start, goal));
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "profiler.hpp"
+
+#if defined(LUMY_PROFILER)
+
+TEST(Profiler, AggregatesZonesFromSeveralThreads) {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+
+    {
+        LUMY_PROFILE_SCOPE("Test::outer");
+        LUMY_PROFILE_SCOPE("Test::inner");
+    }
+    std::thread worker([] {
+        for (int i = 0; i < 3; ++i) {
+            LUMY_PROFILE_SCOPE("Test::worker");
+        }
+    });
+    worker.join();
+    LUMY_PROFILE_FRAME();
+
+    std::uint32_t workerCalls = 0;
+    bool sawOuter = false;
+    for (const auto& zone : profiler.lastFrameZones()) {
+        if (zone.name == "Test::worker") workerCalls = zone.calls;
+        if (zone.name == "Test::outer") sawOuter = true;
+    }
+    EXPECT_EQ(workerCalls, 3u);
+    EXPECT_TRUE(sawOuter);
+    EXPECT_EQ(profiler.droppedZones(), 0u);
+
+    // Próximo frame começa vazio
+    LUMY_PROFILE_FRAME();
+    EXPECT_TRUE(profiler.lastFrameZones().empty());
+    EXPECT_EQ(profiler.frameHistory().size(), 1u);
+}
+
+TEST(Profiler, ExitedThreadsHandTheirBuffersBack) {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+
+    // Threads de vida curta em sequência (prepareScene, simulateBattles)
+    const auto burst = [] {
+        std::thread worker([] { LUMY_PROFILE_SCOPE("Test::shortLived"); });
+        worker.join();
+    };
+    burst();
+    LUMY_PROFILE_FRAME(); // Drena: o buffer livre pode ser reaproveitado
+    const std::size_t buffers = profiler.threadBufferCount();
+    for (int i = 0; i < 8; ++i) {
+        burst();
+        LUMY_PROFILE_FRAME();
+        ASSERT_EQ(profiler.lastFrameZones().size(), 1u);
+        EXPECT_EQ(profiler.lastFrameZones().front().calls, 1u);
+    }
+    EXPECT_EQ(profiler.threadBufferCount(), buffers);
+
+    // Sem drenar, o buffer ainda tem registros da thread antiga: a próxima
+    // thread pega outro, e nada se perde
+    burst();
+    burst();
+    EXPECT_LE(profiler.threadBufferCount(), buffers + 1);
+    LUMY_PROFILE_FRAME();
+    ASSERT_EQ(profiler.lastFrameZones().size(), 1u);
+    EXPECT_EQ(profiler.lastFrameZones().front().calls, 2u);
+}
+
+TEST(Profiler, ExportsChromeTrace) {
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+    {
+        LUMY_PROFILE_SCOPE("Test::traced");
+    }
+    LUMY_PROFILE_FRAME();
+
+    const auto path = std::filesystem::temp_directory_path() / "lumy_trace_test.json";
+    ASSERT_TRUE(profiler.exportChromeTrace(path.string()));
+
+    std::ifstream file(path);
+    const auto trace = nlohmann::json::parse(file);
+    ASSERT_EQ(trace["traceEvents"].size(), 1u);
+    EXPECT_EQ(trace["traceEvents"][0]["name"], "Test::traced");
+    EXPECT_EQ(trace["traceEvents"][0]["ph"], "X");
+    std::filesystem::remove(path);
+}
+
+#endif
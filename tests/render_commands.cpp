@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "render_commands.hpp"
+#include "scene_stack.hpp"
+
+namespace {
+class RecordingScene : public Scene {
+public:
+    explicit RecordingScene(bool overlay = false) : overlay_(overlay) {}
+    void handleEvent(const sf::Event&) override {}
+    void update(float) override {}
+    void draw(sf::RenderTarget&) const override {}
+    void record(RenderCommandList& commands, float) const override {
+        commands.draw(sf::RectangleShape({8.f, 8.f}));
+    }
+    bool isOverlay() const override { return overlay_; }
+
+private:
+    bool overlay_;
+};
+
+RenderCommandList& recordShapes(RenderQueue& queue, int count) {
+    RenderCommandList& list = queue.back();
+    for (int i = 0; i < count; ++i) {
+        list.draw(sf::RectangleShape({1.f, 1.f}));
+    }
+    return list;
+}
+} // namespace
+
+TEST(RenderCommands, ListRecordsAndClears) {
+    RenderCommandList list;
+    list.setView(std::nullopt);
+    list.draw(sf::RectangleShape({4.f, 4.f}));
+    list.fillScreen(sf::Color::Black);
+    list.draw(std::make_shared<const std::vector<sf::Vertex>>(), sf::PrimitiveType::Triangles);
+    EXPECT_EQ(list.size(), 3u); // Snapshot vazio é ignorado
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+}
+
+TEST(RenderCommands, TextIsRecordedAsGeometryAfterFencedPreload) {
+    sf::Font font;
+    ASSERT_TRUE(font.openFromFile("game/font.ttf"));
+    int fences = 0;
+    GlyphPreloader glyphs;
+    glyphs.setFence([&] { ++fences; });
+
+    sf::Text text(font, "Ola\nmundo", 18);
+    glyphs.preload(text);
+    EXPECT_EQ(fences, 1);
+    // Só glifos já carregados (o espaço entra no primeiro preload)
+    text.setString("mundo Ola");
+    glyphs.preload(text);
+    EXPECT_EQ(fences, 1);
+    // Outro tamanho é outra página da fonte
+    text.setCharacterSize(24);
+    glyphs.preload(text);
+    EXPECT_EQ(fences, 2);
+
+    // O texto vira um único comando de vértices; texto vazio não grava nada
+    RenderCommandList list;
+    list.draw(text);
+    EXPECT_EQ(list.size(), 1u);
+    list.draw(sf::Text(font, "", 18));
+    EXPECT_EQ(list.size(), 1u);
+}
+
+TEST(RenderCommands, QueueHandsOffLatestFrame) {
+    RenderQueue queue;
+    recordShapes(queue, 2);
+    queue.publish();
+    EXPECT_TRUE(queue.back().empty()); // Nova lista de gravação
+
+    const RenderCommandList* frame = queue.acquire();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->size(), 2u);
+
+    // Com o quadro anterior já consumido, publish não bloqueia
+    recordShapes(queue, 3);
+    queue.publish();
+    queue.release();
+    frame = queue.acquire();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->size(), 3u);
+    queue.release();
+}
+
+TEST(RenderCommands, PublishWaitsForPreviousFrame) {
+    RenderQueue queue;
+    recordShapes(queue, 1);
+    queue.publish();
+
+    std::atomic<bool> published{false};
+    std::thread simulation([&] {
+        recordShapes(queue, 2);
+        queue.publish(); // No máximo um quadro à frente do render
+        published = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(published);
+
+    const RenderCommandList* frame = queue.acquire();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->size(), 1u);
+    simulation.join();
+    EXPECT_TRUE(published);
+    queue.release();
+
+    frame = queue.acquire();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->size(), 2u);
+    queue.release();
+}
+
+TEST(RenderCommands, DrainDropsPendingFrameAndStopUnblocks) {
+    RenderQueue queue;
+    recordShapes(queue, 1);
+    queue.publish();
+    queue.drain();
+
+    std::atomic<bool> stopped{false};
+    std::thread render([&] {
+        EXPECT_EQ(queue.acquire(), nullptr);
+        stopped = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(stopped); // O quadro descartado não chega ao render
+    queue.stop();
+    render.join();
+    EXPECT_TRUE(stopped);
+}
+
+TEST(RenderCommands, SceneStackRecordsOverlayOverDimmedScenes) {
+    SceneStack stack;
+    stack.pushScene(std::make_unique<RecordingScene>());
+    stack.applyPending();
+
+    RenderCommandList list;
+    stack.record(list, 1.f);
+    EXPECT_EQ(list.size(), 1u);
+
+    stack.pushScene(std::make_unique<RecordingScene>(true));
+    list.clear();
+    stack.record(list, 1.f);
+    EXPECT_EQ(list.size(), 1u); // Só entra no applyPending
+    stack.applyPending();
+
+    list.clear();
+    stack.record(list, 1.f);
+    EXPECT_EQ(list.size(), 3u); // Cena de baixo, escurecimento, overlay
+}
+
+namespace {
+// Cena cuja destruição só é válida com o render thread sem lista na mão
+class FencedScene : public RecordingScene {
+public:
+    FencedScene(const std::atomic<bool>& rendering, const bool& fenced) : rendering_(rendering), fenced_(fenced) {}
+    ~FencedScene() override {
+        EXPECT_TRUE(fenced_);
+        EXPECT_FALSE(rendering_);
+    }
+
+private:
+    const std::atomic<bool>& rendering_;
+    const bool& fenced_;
+};
+} // namespace
+
+TEST(RenderCommands, PreparedSceneFinishingInsideApplyPendingIsFenced) {
+    RenderQueue queue;
+    std::atomic<bool> rendering{false};
+    std::thread render([&] {
+        while (queue.acquire()) {
+            rendering = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5)); // "Replay" lento
+            rendering = false;
+            queue.release();
+        }
+    });
+
+    bool fenced = false;
+    SceneStack stack;
+    stack.setRenderFence([&] {
+        queue.drain();
+        fenced = true;
+    });
+    stack.pushScene(std::make_unique<FencedScene>(rendering, fenced));
+    stack.applyPending();
+
+    std::atomic<bool> release{false};
+    ASSERT_TRUE(stack.prepareScene(
+        [&]() -> SceneStack::SceneFactory {
+            while (!release) {
+                std::this_thread::yield();
+            }
+            return [] { return std::make_unique<RecordingScene>(); };
+        },
+        SceneStack::ActionType::Switch, 0.f));
+
+    // O quadro gravado aponta para a cena atual e está com o render thread
+    stack.record(queue.back(), 1.f);
+    queue.publish();
+
+    // O loader termina só agora, com o quadro já publicado: a troca acontece
+    // no applyPending, e a cena antiga só é destruída depois do fence
+    release = true;
+    stack.setWaitForPreparedScenes(true);
+    EXPECT_FALSE(fenced);
+    stack.applyPending();
+    EXPECT_TRUE(fenced);
+    EXPECT_FALSE(stack.isTransitioning());
+
+    stack.setRenderFence(nullptr);
+    queue.stop();
+    render.join();
+}
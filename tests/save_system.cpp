@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "save_codec.hpp"
+#include "save_system.hpp"
+
+namespace {
+std::filesystem::path makeTempGameDir(const char* name) {
+    auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+} // namespace
+
+TEST(SaveCodec, VarintRoundTrip) {
+    const std::vector<int> values{0, 1, -1, 127, 128, -300, 1 << 30};
+    ByteBuffer bytes = encodeVarintArray(values);
+    std::vector<int> decoded;
+    ASSERT_TRUE(decodeVarintArray(bytes, decoded));
+    EXPECT_EQ(decoded, values);
+
+    bytes.pop_back();
+    EXPECT_FALSE(decodeVarintArray(bytes, decoded));
+}
+
+TEST(SaveCodec, SwitchBitsOnlyKeepOnSwitches) {
+    std::unordered_map<int, bool> switches{{1, true}, {2, false}, {900, true}};
+    ByteBuffer bits = packSwitchBits(switches);
+    EXPECT_EQ(bits.size(), 900u / 8 + 1);
+
+    auto unpacked = unpackSwitchBits(bits);
+    EXPECT_EQ(unpacked.size(), 2u);
+    EXPECT_TRUE(unpacked[1]);
+    EXPECT_TRUE(unpacked[900]);
+    EXPECT_TRUE(packSwitchBits({{3, false}}).empty());
+}
+
+TEST(SaveSystem, BinaryRoundTrip) {
+    auto dir = makeTempGameDir("lumy_save_roundtrip");
+    SaveSystem saves;
+    ASSERT_TRUE(saves.initialize(dir.string()));
+
+    saves.setSwitch(5, true);
+    saves.setVariable(42, -7);
+    saves.setPlayerPosition(3, 12.5f, 40.f, 1);
+    saves.setInventory({4, 4, 9});
+    ASSERT_TRUE(saves.saveGame(2));
+
+    SaveSystem loaded;
+    ASSERT_TRUE(loaded.initialize(dir.string()));
+    ASSERT_TRUE(loaded.loadGame(2));
+    EXPECT_TRUE(loaded.getSwitch(5));
+    EXPECT_FALSE(loaded.getSwitch(6));
+    EXPECT_EQ(loaded.getVariable(42), -7);
+    int mapId = 0, direction = 0;
+    float x = 0.f, y = 0.f;
+    loaded.getPlayerPosition(mapId, x, y, direction);
+    EXPECT_EQ(mapId, 3);
+    EXPECT_FLOAT_EQ(x, 12.5f);
+    EXPECT_EQ(direction, 1);
+    EXPECT_EQ(loaded.getParty(), std::vector<int>{1});
+    EXPECT_EQ(loaded.getInventory(), (std::vector<int>{4, 4, 9}));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SaveSystem, MigratesLegacyJson) {
+    auto dir = makeTempGameDir("lumy_save_legacy");
+    SaveSystem saves;
+    ASSERT_TRUE(saves.initialize(dir.string()));
+    {
+        std::ofstream legacy(saves.getLegacySaveFilePath(1));
+        legacy << R"({"version":"1.0","switches":{"3":true},"variables":null,
+                     "player":{"mapId":2,"x":1.0,"y":2.0,"party":[1,2]}})";
+    }
+
+    ASSERT_TRUE(saves.saveExists(1));
+    ASSERT_TRUE(saves.loadGame(1));
+    EXPECT_TRUE(saves.getSwitch(3));
+    EXPECT_EQ(saves.getParty(), (std::vector<int>{1, 2}));
+    EXPECT_NE(saves.exportJson().find("\"mapId\": 2"), std::string::npos);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SaveSystem, ListSlotsReadsHeaders) {
+    auto dir = makeTempGameDir("lumy_save_slots");
+    SaveSystem saves;
+    ASSERT_TRUE(saves.initialize(dir.string()));
+
+    saves.setPlayerPosition(7, 0.f, 0.f);
+    saves.setPlayerStats(12, 0, 0);
+    saves.setParty({1, 2, 3, 4, 5});
+    saves.setMapName("hello");
+    saves.addPlaytime(125.5f);
+    saves.setThumbnail({0x89, 'P', 'N', 'G'});
+    ASSERT_TRUE(saves.saveGame(42));
+    {
+        std::ofstream legacy(saves.getLegacySaveFilePath(3));
+        legacy << R"({"version":"1.0","player":{"mapId":2}})";
+    }
+
+    auto slots = saves.listSlots();
+    ASSERT_EQ(slots.size(), 2u);
+    EXPECT_EQ(slots[0].slotId, 3);
+    EXPECT_TRUE(slots[0].legacy);
+    EXPECT_EQ(slots[0].mapId, 2);
+
+    const SaveSlotInfo& info = slots[1];
+    EXPECT_EQ(info.slotId, 42);
+    EXPECT_FALSE(info.legacy);
+    EXPECT_EQ(info.mapId, 7);
+    EXPECT_EQ(info.level, 12);
+    EXPECT_EQ(info.mapName, "hello");
+    EXPECT_EQ(info.playtimeSeconds, 125u);
+    EXPECT_EQ(info.party, (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_GT(info.timestamp, 0);
+    EXPECT_EQ(saves.loadThumbnail(42), (std::vector<std::uint8_t>{0x89, 'P', 'N', 'G'}));
+
+    SaveSystem loaded;
+    ASSERT_TRUE(loaded.initialize(dir.string()));
+    ASSERT_TRUE(loaded.loadGame(42));
+    EXPECT_EQ(loaded.getParty().size(), 5u);
+    EXPECT_DOUBLE_EQ(loaded.getPlaytime(), 125.5);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SaveSystem, AutosaveAppendsJournalAndReplays) {
+    auto dir = makeTempGameDir("lumy_save_journal");
+    SaveSystem saves;
+    ASSERT_TRUE(saves.initialize(dir.string()));
+
+    // Primeiro autosave não tem snapshot base: grava o .lsav completo
+    ASSERT_TRUE(saves.autosave());
+    const auto snapshotSize = std::filesystem::file_size(saves.getSaveFilePath(SaveSystem::AutosaveSlot));
+
+    saves.setSwitch(10, true);
+    saves.setVariable(3, 99);
+    saves.setPlayerPosition(2, 64.f, 32.f, 3);
+    ASSERT_TRUE(saves.autosave());
+    EXPECT_EQ(std::filesystem::file_size(saves.getSaveFilePath(SaveSystem::AutosaveSlot)), snapshotSize);
+    const auto journalPath = saves.getJournalFilePath(SaveSystem::AutosaveSlot);
+    const auto journalSize = std::filesystem::file_size(journalPath);
+    EXPECT_GT(journalSize, 10u);
+
+    SaveSystem loaded;
+    ASSERT_TRUE(loaded.initialize(dir.string()));
+    ASSERT_TRUE(loaded.loadGame(SaveSystem::AutosaveSlot));
+    EXPECT_TRUE(loaded.getSwitch(10));
+    EXPECT_EQ(loaded.getVariable(3), 99);
+    int mapId = 0, direction = 0;
+    float x = 0.f, y = 0.f;
+    loaded.getPlayerPosition(mapId, x, y, direction);
+    EXPECT_EQ(mapId, 2);
+    EXPECT_FLOAT_EQ(x, 64.f);
+    EXPECT_EQ(direction, 3);
+
+    // Escrita interrompida: o registro incompleto no fim é descartado
+    saves.setVariable(4, 5);
+    ASSERT_TRUE(saves.autosave());
+    std::filesystem::resize_file(journalPath, journalSize + 2);
+    ASSERT_TRUE(loaded.loadGame(SaveSystem::AutosaveSlot));
+    EXPECT_EQ(loaded.getVariable(3), 99);
+    EXPECT_EQ(loaded.getVariable(4), 0);
+
+    // Save explícito compacta o journal
+    ASSERT_TRUE(saves.saveGame(SaveSystem::AutosaveSlot));
+    EXPECT_LT(std::filesystem::file_size(journalPath), journalSize);
+    ASSERT_TRUE(loaded.loadGame(SaveSystem::AutosaveSlot));
+    EXPECT_EQ(loaded.getVariable(4), 5);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SaveSystem, AutosaveFallsBackToSnapshotWhenJournalOverflows) {
+    auto dir = makeTempGameDir("lumy_save_journal_overflow");
+    SaveSystem saves;
+    ASSERT_TRUE(saves.initialize(dir.string()));
+    ASSERT_TRUE(saves.autosave());
+    const auto journalPath = saves.getJournalFilePath(SaveSystem::AutosaveSlot);
+    const auto emptyJournal = std::filesystem::file_size(journalPath);
+
+    // O registro Meta do próprio autosave passa do limite e descarta o journal
+    // pendente; as mudanças têm que ir num snapshot completo
+    saves.setSwitch(7, true);
+    saves.setVariable(2, 42);
+    saves.setMapName(std::string(SaveSystem::JournalCompactBytes, 'm'));
+    ASSERT_TRUE(saves.autosave());
+    EXPECT_EQ(std::filesystem::file_size(journalPath), emptyJournal);
+
+    SaveSystem loaded;
+    ASSERT_TRUE(loaded.initialize(dir.string()));
+    ASSERT_TRUE(loaded.loadGame(SaveSystem::AutosaveSlot));
+    EXPECT_TRUE(loaded.getSwitch(7));
+    EXPECT_EQ(loaded.getVariable(2), 42);
+
+    // O slot volta a aceitar autosaves incrementais
+    saves.setMapName("Vila");
+    saves.setVariable(2, 43);
+    ASSERT_TRUE(saves.autosave());
+    EXPECT_GT(std::filesystem::file_size(journalPath), emptyJournal);
+    ASSERT_TRUE(loaded.loadGame(SaveSystem::AutosaveSlot));
+    EXPECT_EQ(loaded.getVariable(2), 43);
+
+    std::filesystem::remove_all(dir);
+}
@@ -1,12 +1,40 @@
 #include <gtest/gtest.h>
+#include <chrono>
 #include <memory>
+#include <thread>
 
 #include "boot_scene.hpp"
+#include "input.hpp"
 #include "map_scene.hpp"
+#include "pause_scene.hpp"
 #include "scene_stack.hpp"
 #include "title_scene.hpp"
 #include "texture_manager.hpp"
 
+namespace {
+// A MapScene é preparada em segundo plano: avança o fade até o commit
+void finishTransition(SceneStack& stack) {
+    for (int i = 0; i < 1000 && stack.isTransitioning(); ++i) {
+        stack.update(0.05f);
+        stack.applyPending();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+// Tecla vira ação do próximo passo fixo (Enter: Confirm, Backspace: Cancel)
+void press(SceneStack& stack, sf::Keyboard::Key key) {
+    const sf::Event event = sf::Event::KeyPressed{key};
+    Input::instance().handleEvent(event);
+    Input::instance().beginStep();
+    stack.current()->update(0.f);
+    Input::instance().handleEvent(sf::Event::KeyReleased{key});
+}
+
+void pressEnter(SceneStack& stack) {
+    press(stack, sf::Keyboard::Key::Enter);
+}
+} // namespace
+
 TEST(SceneFlow, BootTitleMap) {
     TextureManager textures;
     SceneStack stack;
@@ -20,20 +48,56 @@ TEST(SceneFlow, BootTitleMap) {
     stack.applyPending();
     EXPECT_NE(dynamic_cast<TitleScene*>(stack.current()), nullptr);
 
-    const sf::Event event = sf::Event::KeyPressed{sf::Keyboard::Key::Enter};
-    stack.current()->handleEvent(event);
+    pressEnter(stack);
     EXPECT_NE(dynamic_cast<TitleScene*>(stack.current()), nullptr);
-    stack.applyPending();
+    EXPECT_TRUE(stack.isTransitioning());
+    finishTransition(stack);
     EXPECT_NE(dynamic_cast<MapScene*>(stack.current()), nullptr);
 
     stack.switchScene(std::make_unique<TitleScene>(stack, textures));
     stack.applyPending();
     EXPECT_NE(dynamic_cast<TitleScene*>(stack.current()), nullptr);
 
-    const sf::Event again = sf::Event::KeyPressed{sf::Keyboard::Key::Enter};
-    stack.current()->handleEvent(again);
+    pressEnter(stack);
     EXPECT_NE(dynamic_cast<TitleScene*>(stack.current()), nullptr);
-    stack.applyPending();
+    finishTransition(stack);
     EXPECT_NE(dynamic_cast<MapScene*>(stack.current()), nullptr);
 }
 
+
+TEST(SceneFlow, CancelPausesMapOverCachedBackdrop) {
+    TextureManager textures;
+    SceneStack stack;
+    stack.pushScene(std::make_unique<TitleScene>(stack, textures));
+    stack.applyPending();
+    pressEnter(stack);
+    finishTransition(stack);
+    auto* map = dynamic_cast<MapScene*>(stack.current());
+    ASSERT_NE(map, nullptr);
+
+    // Cancel abre a pausa por cima do mapa
+    press(stack, sf::Keyboard::Key::Backspace);
+    EXPECT_TRUE(map->isDirty()); // O passo que abriu a pausa mexeu no mapa
+    stack.applyPending();
+    auto* pause = dynamic_cast<PauseScene*>(stack.current());
+    ASSERT_NE(pause, nullptr);
+    EXPECT_TRUE(pause->isOverlay());
+
+    // O fundo é guardado uma vez; com a pausa aberta o mapa não é
+    // atualizado e nada o marca de novo
+    sf::RenderTexture target({64, 64});
+    stack.draw(target, 1.f);
+    EXPECT_FALSE(map->isDirty());
+    Input::instance().beginStep();
+    stack.current()->update(0.f);
+    stack.applyPending();
+    stack.draw(target, 1.f);
+    EXPECT_EQ(stack.current(), pause);
+    EXPECT_FALSE(map->isDirty());
+
+    // Confirm fecha a pausa e o mapa volta a rodar
+    pressEnter(stack);
+    stack.applyPending();
+    EXPECT_EQ(stack.current(), map);
+    Input::instance().beginStep();
+}
@@ -9,7 +9,7 @@ public:
     int updates = 0;
     void handleEvent(const sf::Event&) override {}
     void update(float) override { ++updates; }
-    void draw(sf::RenderWindow&) const override {}
+    void draw(sf::RenderTarget&) const override {}
 };
 } // namespace
 
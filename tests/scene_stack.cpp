@@ -1,4 +1,8 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
 #include "scene_stack.hpp"
 
 namespace {
@@ -6,7 +10,20 @@ class DummyScene : public Scene {
 public:
     void handleEvent(const sf::Event&) override {}
     void update(float) override {}
-    void draw(sf::RenderWindow&) const override {}
+    void draw(sf::RenderTarget&) const override {}
+};
+
+class DrawCountingScene : public Scene {
+public:
+    explicit DrawCountingScene(bool overlay = false) : overlay_(overlay) {}
+    mutable int draws = 0;
+    void handleEvent(const sf::Event&) override {}
+    void update(float) override {}
+    void draw(sf::RenderTarget&) const override { ++draws; }
+    bool isOverlay() const override { return overlay_; }
+
+private:
+    bool overlay_;
 };
 } // namespace
 
@@ -57,3 +74,172 @@ TEST(SceneStack, PushPopSwitch) {
     EXPECT_EQ(stack.current(), fourthPtr);
 }
 
+
+TEST(SceneStack, PrepareSceneCommitsOnlyWhenReady) {
+    SceneStack stack;
+    auto first = std::make_unique<DummyScene>();
+    Scene* firstPtr = first.get();
+    stack.pushScene(std::move(first));
+    stack.applyPending();
+
+    std::atomic<bool> release{false};
+    std::atomic<Scene*> preparedPtr{nullptr};
+    std::thread::id builtOn;
+    ASSERT_TRUE(stack.prepareScene([&]() -> SceneStack::SceneFactory {
+        while (!release) {
+            std::this_thread::yield();
+        }
+        // A cena em si é montada no commit, na thread principal
+        return [&] {
+            builtOn = std::this_thread::get_id();
+            auto scene = std::make_unique<DummyScene>();
+            preparedPtr = scene.get();
+            return std::unique_ptr<Scene>(std::move(scene));
+        };
+    }, SceneStack::ActionType::Switch, 0.2f));
+    EXPECT_FALSE(stack.prepareScene([] { return SceneStack::SceneFactory(); }));
+
+    // Enquanto carrega, a cena atual continua ativa e sem fade
+    stack.update(1.f);
+    stack.applyPending();
+    EXPECT_EQ(stack.current(), firstPtr);
+    EXPECT_FLOAT_EQ(stack.transitionAlpha(), 0.f);
+
+    release = true;
+    for (int i = 0; i < 1000 && stack.transitionAlpha() == 0.f; ++i) {
+        stack.update(0.01f);
+        stack.applyPending();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(stack.current(), firstPtr); // Fade-out antes do commit
+
+    EXPECT_EQ(preparedPtr.load(), nullptr);
+
+    stack.update(0.1f);
+    stack.applyPending();
+    EXPECT_EQ(stack.current(), preparedPtr.load());
+    EXPECT_EQ(builtOn, std::this_thread::get_id());
+    EXPECT_FLOAT_EQ(stack.transitionAlpha(), 1.f);
+
+    stack.update(0.1f);
+    EXPECT_FALSE(stack.isTransitioning());
+    EXPECT_FLOAT_EQ(stack.transitionAlpha(), 0.f);
+}
+
+TEST(SceneStack, PreparedSceneIsDroppedWhenRequesterLeaves) {
+    SceneStack stack;
+    stack.pushScene(std::make_unique<DummyScene>());
+    stack.applyPending();
+
+    std::atomic<bool> release{false};
+    bool built = false;
+    ASSERT_TRUE(stack.prepareScene([&]() -> SceneStack::SceneFactory {
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return [&] {
+            built = true;
+            return std::unique_ptr<Scene>(std::make_unique<DummyScene>());
+        };
+    }, SceneStack::ActionType::Switch, 0.f));
+
+    // Outra cena assume o topo antes do commit: a fábrica não roda
+    auto other = std::make_unique<DummyScene>();
+    Scene* otherPtr = other.get();
+    stack.switchScene(std::move(other));
+    stack.applyPending();
+    release = true;
+    stack.setWaitForPreparedScenes(true);
+    stack.applyPending();
+    EXPECT_FALSE(built);
+    EXPECT_EQ(stack.current(), otherPtr);
+    EXPECT_FALSE(stack.isTransitioning());
+}
+
+namespace {
+// Sempre no mesmo endereço: a cena seguinte ocupa o lugar da anterior
+class SameSlotScene : public DummyScene {
+public:
+    static void* operator new(std::size_t size) {
+        EXPECT_LE(size, sizeof(slot));
+        return slot;
+    }
+    static void operator delete(void*) {}
+
+private:
+    alignas(std::max_align_t) static inline unsigned char slot[256];
+};
+} // namespace
+
+TEST(SceneStack, PreparedSceneIsDroppedWhenANewSceneReusesTheRequesterAddress) {
+    SceneStack stack;
+    stack.pushScene(std::make_unique<DummyScene>());
+    stack.pushScene(std::unique_ptr<Scene>(new SameSlotScene));
+    stack.applyPending();
+    const Scene* requester = stack.current();
+
+    std::atomic<bool> release{false};
+    bool built = false;
+    ASSERT_TRUE(stack.prepareScene([&]() -> SceneStack::SceneFactory {
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return [&] {
+            built = true;
+            return std::unique_ptr<Scene>(std::make_unique<DummyScene>());
+        };
+    }, SceneStack::ActionType::Switch, 0.f));
+
+    // Quem pediu sai e outra cena nasce no mesmo endereço antes do commit
+    stack.popScene();
+    stack.applyPending();
+    stack.pushScene(std::unique_ptr<Scene>(new SameSlotScene));
+    stack.applyPending();
+    ASSERT_EQ(stack.current(), requester);
+
+    release = true;
+    stack.setWaitForPreparedScenes(true);
+    stack.applyPending();
+    EXPECT_FALSE(built);
+    EXPECT_EQ(stack.current(), requester);
+    EXPECT_FALSE(stack.isTransitioning());
+}
+
+TEST(SceneStack, OverlayReusesCachedBackdrop) {
+    sf::RenderTexture target({64, 64});
+    SceneStack stack;
+    auto map = std::make_unique<DrawCountingScene>();
+    DrawCountingScene* mapPtr = map.get();
+    stack.pushScene(std::move(map));
+    stack.applyPending();
+
+    stack.draw(target, 1.f);
+    stack.draw(target, 1.f);
+    EXPECT_EQ(mapPtr->draws, 2);
+
+    auto menu = std::make_unique<DrawCountingScene>(true);
+    DrawCountingScene* menuPtr = menu.get();
+    stack.pushScene(std::move(menu));
+    stack.applyPending();
+
+    // O mapa é desenhado uma vez no cache; o menu a cada quadro
+    for (int i = 0; i < 3; ++i) {
+        stack.draw(target, 1.f);
+    }
+    EXPECT_EQ(mapPtr->draws, 3);
+    EXPECT_EQ(menuPtr->draws, 3);
+
+    mapPtr->markDirty();
+    stack.draw(target, 1.f);
+    stack.draw(target, 1.f);
+    EXPECT_EQ(mapPtr->draws, 4);
+
+    stack.invalidateBackdrop();
+    stack.draw(target, 1.f);
+    EXPECT_EQ(mapPtr->draws, 5);
+
+    stack.popScene();
+    stack.applyPending();
+    stack.draw(target, 1.f);
+    EXPECT_EQ(mapPtr->draws, 6);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "render_commands.hpp"
+#include "sprite_batch.hpp"
+#include "texture_atlas.hpp"
+#include "texture_manager.hpp"
+
+TEST(SpriteBatch, ShelfPackerFillsRowsWithoutOverlap) {
+    ShelfPacker packer({64, 64}, 1);
+    EXPECT_EQ(packer.insert({16, 16}), sf::Vector2u(0, 0));
+    EXPECT_EQ(packer.insert({16, 16}), sf::Vector2u(17, 0));
+    EXPECT_EQ(packer.insert({16, 16}), sf::Vector2u(34, 0));
+    // Não cabe mais na linha: abre outra abaixo, já com o espaçamento
+    EXPECT_EQ(packer.insert({20, 10}), sf::Vector2u(0, 17));
+    // Baixinho vai para a linha mais justa que ainda tem espaço
+    EXPECT_EQ(packer.insert({8, 8}), sf::Vector2u(21, 17));
+
+    // Maior que a página ou vazio nunca entra
+    EXPECT_FALSE(packer.insert({65, 1}).has_value());
+    EXPECT_FALSE(packer.insert({0, 4}).has_value());
+
+    // Enche a página com retângulos variados: nenhum se sobrepõe nem sai dela
+    packer.clear();
+    std::vector<sf::IntRect> placed;
+    for (unsigned i = 0;; ++i) {
+        const sf::Vector2u size{4 + (i * 7) % 13, 3 + (i * 5) % 11};
+        const auto position = packer.insert(size);
+        if (!position) {
+            break;
+        }
+        const sf::IntRect rect{sf::Vector2i(*position), sf::Vector2i(size)};
+        EXPECT_LE(rect.position.x + rect.size.x, 64);
+        EXPECT_LE(rect.position.y + rect.size.y, 64);
+        for (const sf::IntRect& other : placed) {
+            EXPECT_FALSE(rect.findIntersection(other).has_value());
+        }
+        placed.push_back(rect);
+    }
+    EXPECT_GT(placed.size(), 20u);
+    EXPECT_GT(packer.occupancy(), 0.5f);
+}
+
+TEST(SpriteBatch, SortsByLayerThenTextureAndMergesRuns) {
+    const sf::Texture atlas;
+    const sf::Texture other;
+    SpriteBatch batch;
+    const sf::FloatRect rect{{0.f, 0.f}, {16.f, 16.f}};
+    const sf::IntRect source{{0, 0}, {16, 16}};
+
+    batch.add(0, &atlas, rect, source);
+    batch.add(0, &other, rect, source);
+    batch.add(0, &atlas, rect, source); // Junta com o primeiro
+    batch.add(1, &atlas, rect, source); // Camada de cima: other(0) fica entre os dois, chamada própria
+    batch.add(-1, &other, rect, source); // Vai para o começo
+    EXPECT_EQ(batch.size(), 5u);
+    // other(-1) | atlas(0) atlas(0) | other(0) | atlas(1)
+    EXPECT_EQ(batch.batchCount(), 4u);
+
+    RenderCommandList commands;
+    batch.record(commands);
+    EXPECT_EQ(commands.size(), 4u);
+
+    // Sem textura (herói, NPCs sem folha) em camadas seguidas: uma chamada só
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+    batch.add(0, nullptr, rect, {});
+    batch.add(0, nullptr, rect, {});
+    batch.add(1, nullptr, rect, {});
+    EXPECT_EQ(batch.batchCount(), 1u);
+
+    // Tudo no mesmo atlas, qualquer camada: uma chamada
+    batch.clear();
+    for (int i = 0; i < 10; ++i) {
+        batch.add(i % 3, AtlasRegion{&atlas, {{i * 16, 0}, {16, 16}}}, {static_cast<float>(i), 0.f});
+    }
+    EXPECT_EQ(batch.batchCount(), 1u);
+}
+
+TEST(SpriteBatch, HeadlessAtlasFallsBackToWholeTexture) {
+    TextureManager textures(true);
+    TextureAtlas atlas(textures);
+
+    // Sem GL não há página: volta a textura do TextureManager
+    const AtlasRegion villager = atlas.acquire("game/assets/sprites/villager.png");
+    EXPECT_EQ(villager.texture, &textures.acquire("game/assets/sprites/villager.png"));
+    EXPECT_EQ(atlas.acquire("game/assets/sprites/villager.png").texture, villager.texture); // Em cache
+    EXPECT_EQ(atlas.pageCount(), 0u);
+
+    const AtlasRegion icon = atlas.add("icon", sf::Image({8, 8}));
+    EXPECT_EQ(icon.texture, nullptr);
+    EXPECT_EQ(icon.rect.size, sf::Vector2i(8, 8));
+    EXPECT_EQ(atlas.regionCount(), 2u);
+
+    EXPECT_THROW(atlas.acquire("game/assets/sprites/nao_existe.png"), std::runtime_error);
+}
+
+TEST(SpriteBatch, AtlasFencesBeforeWritingAPublishedPage) {
+    TextureManager textures;
+    TextureAtlas atlas(textures, 64, 32);
+    int fences = 0;
+    atlas.setFence([&] { ++fences; });
+
+    // Página nova: ninguém a desenhou ainda, então não espera o render
+    const AtlasRegion first = atlas.add("a", sf::Image({16, 16}));
+    EXPECT_EQ(atlas.pageCount(), 1u);
+    EXPECT_EQ(fences, 0);
+
+    // Mesma página, já publicada: espera antes de escrever
+    const AtlasRegion second = atlas.add("b", sf::Image({16, 16}));
+    EXPECT_EQ(second.texture, first.texture);
+    EXPECT_EQ(fences, 1);
+
+    // Em cache ou grande demais para uma página: nada é escrito nas páginas
+    atlas.add("a", sf::Image({16, 16}));
+    atlas.add("grande", sf::Image({48, 48}));
+    EXPECT_EQ(fences, 1);
+}